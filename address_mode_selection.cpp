@@ -0,0 +1,209 @@
+#include <cassert>
+#include <map>
+#include <vector>
+#include "instruction.h"
+#include "operand.h"
+#include "highlevel.h"
+#include "address_mode_selection.h"
+
+namespace{
+
+  bool mentions(const Operand& op, int vreg){
+    if(op.is_non_reg()){
+      return false;
+    }
+    return (op.has_base_reg() && op.get_base_reg() == vreg) || (op.has_index_reg() && op.get_index_reg() == vreg);
+  }
+
+  bool mentions(Instruction* ins, int vreg){
+    for(unsigned i = 0; i < ins->get_num_operands(); i++){
+      if(mentions(ins->get_operand(i), vreg)){
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Conservatively, any instruction whose first operand is the vreg
+  // might assign to it
+  bool writes(Instruction* ins, int vreg){
+    if(ins->get_num_operands() == 0){
+      return false;
+    }
+    Operand dest = ins->get_operand(0);
+    return dest.get_kind() == Operand::VREG && dest.get_base_reg() == vreg;
+  }
+
+  bool is_vreg(const Operand& op){
+    return op.get_kind() == Operand::VREG;
+  }
+
+  bool is_scale(const Operand& op){
+    if(!op.is_imm_ival()){
+      return false;
+    }
+    long scale = op.get_imm_ival();
+    return scale == 1 || scale == 2 || scale == 4 || scale == 8;
+  }
+
+  // If the only memory operand of the instruction is (vreg), and
+  // no other operand mentions vreg, return its operand index
+  int find_sole_memref(Instruction* ins, int vreg){
+    int result = -1;
+    for(unsigned i = 0; i < ins->get_num_operands(); i++){
+      Operand op = ins->get_operand(i);
+      if(op.is_memref()){
+        if(result != -1 || op.get_kind() != Operand::VREG_MEM || op.get_base_reg() != vreg){
+          return -1;
+        }
+        result = int(i);
+      } else if(mentions(op, vreg)){
+        return -1;
+      }
+    }
+    return result;
+  }
+
+}
+
+AddressModeSelection::AddressModeSelection(const std::shared_ptr<ControlFlowGraph>& cfg)
+  : ControlFlowGraphTransform(cfg)
+  , m_live_vregs(cfg){
+  m_live_vregs.execute();
+}
+
+AddressModeSelection::~AddressModeSelection(){
+}
+
+std::shared_ptr<InstructionSequence> AddressModeSelection::transform_basic_block(const BasicBlock* orig_bb){
+  unsigned len = orig_bb->get_length();
+  std::vector<bool> folded(len, false);
+  // instruction index -> (operand index, replacement memref)
+  std::map<unsigned, std::pair<unsigned, Operand>> rewrites;
+
+  for(unsigned i = 0; i < len; i++){
+    Instruction* add = orig_bb->get_instruction(i);
+    if(folded[i] || add->get_opcode() != HINS_add_q){
+      continue;
+    }
+    Operand dest = add->get_operand(0);
+    Operand base = add->get_operand(1);
+    Operand index = add->get_operand(2);
+    if(!is_vreg(dest) || !is_vreg(base)){
+      continue;
+    }
+    int addr_vreg = dest.get_base_reg();
+    int base_vreg = base.get_base_reg();
+
+    // the computed address must be used exactly once, as a memref
+    int use = find_next_mention(orig_bb, i + 1, addr_vreg);
+    if(use == -1 || rewrites.count(use) > 0){
+      continue;
+    }
+    Instruction* use_ins = orig_bb->get_instruction(use);
+    int mem_operand = find_sole_memref(use_ins, addr_vreg);
+    if(mem_operand == -1 || is_live_after(orig_bb, use, addr_vreg)){
+      continue;
+    }
+
+    // the base must still have the same value at the use
+    if(is_redefined(orig_bb, i + 1, use, base_vreg)){
+      continue;
+    }
+
+    Operand memref;
+    int folded_def = -1;
+    if(index.is_imm_ival()){
+      memref = Operand(Operand::VREG_MEM_OFF, base_vreg, index.get_imm_ival());
+    } else if(is_vreg(index)){
+      int index_vreg = index.get_base_reg();
+
+      // see if the index was computed by a constant or a multiplication
+      // by a scale factor which is not needed anywhere else
+      int def = find_prev_mention(orig_bb, i, index_vreg);
+      bool index_dead = index_vreg == addr_vreg || !is_live_after(orig_bb, i, index_vreg);
+      if(def != -1 && !folded[def] && index_dead && index_vreg != base_vreg && writes(orig_bb->get_instruction(def), index_vreg)){
+        Instruction* def_ins = orig_bb->get_instruction(def);
+        if(def_ins->get_opcode() == HINS_mov_q && def_ins->get_operand(1).is_imm_ival()){
+          memref = Operand(Operand::VREG_MEM_OFF, base_vreg, def_ins->get_operand(1).get_imm_ival());
+          folded_def = def;
+        } else if(def_ins->get_opcode() == HINS_mul_q && is_vreg(def_ins->get_operand(1)) && is_scale(def_ins->get_operand(2))){
+          int scaled_vreg = def_ins->get_operand(1).get_base_reg();
+          // the add itself is removed, so it doesn't count as a redefinition
+          if(!is_redefined(orig_bb, def + 1, i, scaled_vreg) && !is_redefined(orig_bb, i + 1, use, scaled_vreg)){
+            memref = Operand(Operand::VREG_MEM_IDX, base_vreg, scaled_vreg, int(def_ins->get_operand(2).get_imm_ival()));
+            folded_def = def;
+          }
+        }
+      }
+
+      if(memref.get_kind() == Operand::NONE && index_vreg != addr_vreg && !is_redefined(orig_bb, i + 1, use, index_vreg)){
+        memref = Operand(Operand::VREG_MEM_IDX, base_vreg, index_vreg, 1);
+      }
+    }
+    if(memref.get_kind() == Operand::NONE){
+      continue;
+    }
+
+    folded[i] = true;
+    if(folded_def != -1){
+      folded[folded_def] = true;
+    }
+    rewrites[use] = std::make_pair(unsigned(mem_operand), memref);
+  }
+
+  std::shared_ptr<InstructionSequence> result(new InstructionSequence());
+  for(unsigned i = 0; i < len; i++){
+    if(folded[i]){
+      continue;
+    }
+    Instruction* ins = orig_bb->get_instruction(i);
+    auto rewrite = rewrites.find(i);
+    if(rewrite == rewrites.end()){
+      result->append(ins->duplicate());
+      continue;
+    }
+
+    Instruction* new_ins = ins->duplicate();
+    new_ins->set_operand(rewrite->second.second, rewrite->second.first);
+    result->append(new_ins);
+  }
+  return result;
+}
+
+// index of the first instruction at or after start which mentions the vreg
+int AddressModeSelection::find_next_mention(const BasicBlock* bb, unsigned start, int vreg){
+  for(unsigned i = start; i < bb->get_length(); i++){
+    if(mentions(bb->get_instruction(i), vreg)){
+      return int(i);
+    }
+  }
+  return -1;
+}
+
+// index of the last instruction before start which mentions the vreg
+int AddressModeSelection::find_prev_mention(const BasicBlock* bb, unsigned start, int vreg){
+  for(unsigned i = start; i-- > 0; ){
+    if(mentions(bb->get_instruction(i), vreg)){
+      return int(i);
+    }
+  }
+  return -1;
+}
+
+bool AddressModeSelection::is_redefined(const BasicBlock* bb, unsigned start, unsigned end, int vreg){
+  for(unsigned i = start; i < end; i++){
+    if(writes(bb->get_instruction(i), vreg)){
+      return true;
+    }
+  }
+  return false;
+}
+
+bool AddressModeSelection::is_live_after(const BasicBlock* bb, unsigned index, int vreg){
+  if(vreg >= int(LiveVregs::FactType().size())){
+    return true;
+  }
+  LiveVregs::FactType live = m_live_vregs.get_fact_after_instruction(bb, bb->get_instruction(index));
+  return live.test(vreg);
+}
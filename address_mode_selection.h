@@ -0,0 +1,41 @@
+#ifndef ADDRESS_MODE_SELECTION_H
+#define ADDRESS_MODE_SELECTION_H
+
+#include <memory>
+#include "cfg.h"
+#include "cfg_transform.h"
+#include "live_vregs.h"
+
+// AddressModeSelection folds address arithmetic in high-level code into
+// the memory operands that use it. Array element and struct field
+// accesses are generated as
+//
+//    mul_q    vr14, vr14, $4          mov_q    vr16, $8
+//    add_q    vr15, vr13, vr14        add_q    vr16, vr12, vr16
+//    mov_l    (vr15), vr17            mov_l    vr17, (vr16)
+//
+// and become
+//
+//    mov_l    (vr13, vt14, 4), vr17   mov_l    vr17, 8(vr12q)
+//
+// which the low-level code generator turns into scaled-index and
+// displacement addressing modes. This is only done when the computed
+// address is used exactly once, by the memory operand.
+class AddressModeSelection : public ControlFlowGraphTransform{
+private:
+  LiveVregs m_live_vregs;
+
+public:
+  AddressModeSelection(const std::shared_ptr<ControlFlowGraph>& cfg);
+  ~AddressModeSelection();
+
+  virtual std::shared_ptr<InstructionSequence> transform_basic_block(const BasicBlock* orig_bb);
+
+private:
+  int find_next_mention(const BasicBlock* bb, unsigned start, int vreg);
+  int find_prev_mention(const BasicBlock* bb, unsigned start, int vreg);
+  bool is_redefined(const BasicBlock* bb, unsigned start, unsigned end, int vreg);
+  bool is_live_after(const BasicBlock* bb, unsigned index, int vreg);
+};
+
+#endif // ADDRESS_MODE_SELECTION_H
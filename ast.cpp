@@ -33,6 +33,10 @@ std::string ASTTreePrint::node_tag_to_string(int tag) const {
   case AST_FOR_STATEMENT: return "AST_FOR_STATEMENT";
   case AST_IF_STATEMENT: return "AST_IF_STATEMENT";
   case AST_IF_ELSE_STATEMENT: return "AST_IF_ELSE_STATEMENT";
+  case AST_SWITCH_STATEMENT: return "AST_SWITCH_STATEMENT";
+  case AST_CASE_STATEMENT: return "AST_CASE_STATEMENT";
+  case AST_DEFAULT_STATEMENT: return "AST_DEFAULT_STATEMENT";
+  case AST_BREAK_STATEMENT: return "AST_BREAK_STATEMENT";
   case AST_STRUCT_TYPE_DEFINITION: return "AST_STRUCT_TYPE_DEFINITION";
   case AST_UNION_TYPE_DEFINITION: return "AST_UNION_TYPE_DEFINITION";
   case AST_FIELD_DEFINITION_LIST: return "AST_FIELD_DEFINITION_LIST";
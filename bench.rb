@@ -0,0 +1,97 @@
+#! /usr/bin/env ruby
+
+# Measure how long the compiler takes to compile generated programs
+# (see gen_bench_program.rb), with and without optimization. Each
+# program is compiled several times with -t, and the median time of
+# each phase is recorded. Results are written to bench_out/bench.csv
+# and bench_out/bench.json, so they can be compared across commits.
+#
+# Usage: ./bench.rb [runs]      (default 3 runs per program)
+
+require 'json'
+require 'fileutils'
+
+RUNS = (ARGV[0] || 3).to_i
+OUT_DIR = 'bench_out'
+COMPILER = './nearly_cc'
+
+# Each input scales one aspect of the program, starting from the
+# generator's defaults (-f 20 -s 20 -d 3 -S 2 -l 10)
+INPUTS = [
+  ['base', ''],
+  ['functions', '-f 400'],
+  ['statements', '-s 1000'],
+  ['nesting', '-s 200 -d 10'],
+  ['structs', '-f 200 -S 200'],
+  ['strings', '-l 5000'],
+]
+
+PHASES = %w(scan parse analyze hl_codegen optimize ll_codegen print other total)
+
+def median(values)
+  sorted = values.sort
+  sorted[sorted.size / 2]
+end
+
+# compile a program, returning the time of each phase, or nil
+# if the compiler fails
+def compile(src, optimize)
+  cmd = [COMPILER, '-t']
+  cmd << '-o' if optimize
+  cmd += ['-f', '/dev/null', src]
+  output = IO.popen(cmd, err: [:child, :out], &:read)
+  unless $?.success?
+    STDERR.puts "#{cmd.join(' ')} failed:", output.lines.last(3)
+    return nil
+  end
+
+  times = {}
+  output.each_line do |line|
+    phase, seconds = line.strip.split(',')
+    times[phase] = seconds.to_f if PHASES.include?(phase)
+  end
+  times
+end
+
+FileUtils.mkdir_p(OUT_DIR)
+
+results = []
+INPUTS.each do |name, gen_opts|
+  src = File.join(OUT_DIR, "#{name}.c")
+  system("./gen_bench_program.rb #{gen_opts} > #{src}") or raise "couldn't generate #{src}"
+
+  [false, true].each do |optimize|
+    result = { 'input' => name, 'optimized' => optimize, 'bytes' => File.size(src) }
+    runs = []
+    RUNS.times do
+      times = compile(src, optimize)
+      break if times.nil?
+      runs << times
+    end
+    if runs.size < RUNS
+      # a failure is recorded, so it shows up when comparing results
+      result['status'] = 'failed'
+      PHASES.each { |phase| result[phase] = nil }
+      printf("%-12s %-3s %9d bytes  failed\n", name, optimize ? '-o' : '', result['bytes'])
+    else
+      result['status'] = 'ok'
+      PHASES.each { |phase| result[phase] = median(runs.map { |r| r[phase] || 0.0 }) }
+      printf("%-12s %-3s %9d bytes  %8.4f s\n", name, optimize ? '-o' : '', result['bytes'], result['total'])
+    end
+    results << result
+  end
+end
+
+File.open(File.join(OUT_DIR, 'bench.csv'), 'w') do |f|
+  f.puts((%w(input optimized bytes status) + PHASES).join(','))
+  results.each do |r|
+    times = PHASES.map { |p| r[p] ? '%.6f' % r[p] : '' }
+    f.puts(([r['input'], r['optimized'] ? 1 : 0, r['bytes'], r['status']] + times).join(','))
+  end
+end
+
+File.open(File.join(OUT_DIR, 'bench.json'), 'w') do |f|
+  f.puts(JSON.pretty_generate({ 'runs' => RUNS, 'results' => results }))
+end
+
+puts "Results written to #{OUT_DIR}/bench.csv and #{OUT_DIR}/bench.json"
@@ -0,0 +1,284 @@
+#include <cassert>
+#include <algorithm>
+#include <set>
+#include "instruction.h"
+#include "highlevel.h"
+#include "block_layout.h"
+
+namespace{
+
+  // loops nested deeper than this are all considered equally hot
+  const int MAX_LOOP_DEPTH = 6;
+
+  bool is_interior(const BasicBlock* bb){
+    return bb->get_kind() == BASICBLOCK_INTERIOR;
+  }
+
+  bool is_cjmp(int opcode){
+    return opcode == HINS_cjmp_t || opcode == HINS_cjmp_f;
+  }
+
+}
+
+BlockLayout::BlockLayout(const std::shared_ptr<ControlFlowGraph>& cfg, unsigned next_label_num)
+  : m_cfg(cfg)
+  , m_next_label_num(next_label_num){
+}
+
+BlockLayout::~BlockLayout(){
+}
+
+std::shared_ptr<InstructionSequence> BlockLayout::create_instruction_sequence(){
+  compute_loop_depths();
+  std::vector<BasicBlock*> order = place_blocks();
+  assign_labels(order);
+
+  std::shared_ptr<InstructionSequence> result(new InstructionSequence());
+  for(unsigned i = 0; i < order.size(); i++){
+    BasicBlock* next = (i + 1 < order.size()) ? order[i + 1] : nullptr;
+    append_block(result, order[i], next);
+  }
+  return result;
+}
+
+// The loop depth of a block is the number of natural loops containing it.
+// Back edges are found by a depth-first search from the entry block.
+void BlockLayout::compute_loop_depths(){
+  std::map<BasicBlock*, std::set<BasicBlock*>> loops;
+  std::map<BasicBlock*, int> state; // 0 = unvisited, 1 = on the DFS stack, 2 = finished
+  std::vector<std::pair<BasicBlock*, unsigned>> stack;
+
+  BasicBlock* entry = m_cfg->get_entry_block();
+  state[entry] = 1;
+  stack.push_back(std::make_pair(entry, 0U));
+  while(!stack.empty()){
+    BasicBlock* bb = stack.back().first;
+    unsigned next_edge = stack.back().second;
+    const ControlFlowGraph::EdgeList& outgoing = m_cfg->get_outgoing_edges(bb);
+    if(next_edge == outgoing.size()){
+      state[bb] = 2;
+      stack.pop_back();
+      continue;
+    }
+    stack.back().second++;
+
+    BasicBlock* succ = outgoing[next_edge]->get_target();
+    if(state[succ] == 0){
+      state[succ] = 1;
+      stack.push_back(std::make_pair(succ, 0U));
+    } else if(state[succ] == 1){
+      // back edge: the loop body is everything which reaches the
+      // latch without going through the header
+      std::set<BasicBlock*>& body = loops[succ];
+      body.insert(succ);
+      std::vector<BasicBlock*> work_list = { bb };
+      while(!work_list.empty()){
+        BasicBlock* b = work_list.back();
+        work_list.pop_back();
+        if(!body.insert(b).second){
+          continue;
+        }
+        const ControlFlowGraph::EdgeList& incoming = m_cfg->get_incoming_edges(b);
+        for(auto i = incoming.cbegin(); i != incoming.cend(); ++i){
+          work_list.push_back((*i)->get_source());
+        }
+      }
+    }
+  }
+
+  for(auto i = loops.cbegin(); i != loops.cend(); ++i){
+    for(BasicBlock* bb : i->second){
+      m_loop_depth[bb]++;
+    }
+  }
+}
+
+std::vector<BasicBlock*> BlockLayout::place_blocks(){
+  // the block containing the enter instruction has to come first
+  BasicBlock* first = get_successor(m_cfg->get_entry_block(), EDGE_FALLTHROUGH);
+  assert(first != nullptr && is_interior(first));
+
+  std::vector<std::vector<BasicBlock*>> chains;
+  std::map<BasicBlock*, unsigned> chain_of;
+  std::vector<Edge*> edges;
+  for(auto i = m_cfg->bb_begin(); i != m_cfg->bb_end(); ++i){
+    BasicBlock* bb = *i;
+    if(!is_interior(bb)){
+      continue;
+    }
+    chain_of[bb] = chains.size();
+    chains.push_back({ bb });
+
+    const ControlFlowGraph::EdgeList& outgoing = m_cfg->get_outgoing_edges(bb);
+    for(auto j = outgoing.cbegin(); j != outgoing.cend(); ++j){
+      if(is_interior((*j)->get_target()) && (*j)->get_target() != bb){
+        edges.push_back(*j);
+      }
+    }
+  }
+
+  // estimated frequency of an edge: 10 to the power of the loop depth
+  auto weight = [this](Edge* e){
+    int depth = std::min(m_loop_depth[e->get_source()], m_loop_depth[e->get_target()]);
+    long result = 1;
+    for(int i = 0; i < std::min(depth, MAX_LOOP_DEPTH); i++){
+      result *= 10;
+    }
+    return result;
+  };
+
+  // visit edges from most to least frequent; for equal frequencies,
+  // prefer the original fall-throughs so the code order is kept when
+  // there is no reason to change it
+  std::stable_sort(edges.begin(), edges.end(), [&](Edge* a, Edge* b){
+    long weight_a = weight(a), weight_b = weight(b);
+    if(weight_a != weight_b){
+      return weight_a > weight_b;
+    }
+    if(a->get_kind() != b->get_kind()){
+      return a->get_kind() == EDGE_FALLTHROUGH;
+    }
+    return a->get_source()->get_code_order() < b->get_source()->get_code_order();
+  });
+
+  for(Edge* e : edges){
+    BasicBlock* source = e->get_source();
+    BasicBlock* target = e->get_target();
+    unsigned source_chain = chain_of[source], target_chain = chain_of[target];
+    if(target == first || source_chain == target_chain){
+      continue;
+    }
+    if(chains[source_chain].back() != source || chains[target_chain].front() != target){
+      continue;
+    }
+    for(BasicBlock* bb : chains[target_chain]){
+      chains[source_chain].push_back(bb);
+      chain_of[bb] = source_chain;
+    }
+    chains[target_chain].clear();
+  }
+
+  // the chain starting with the first block goes first, the others
+  // follow in the original code order of their first blocks
+  std::vector<std::vector<BasicBlock*>*> placed;
+  for(auto& chain : chains){
+    if(!chain.empty() && chain.front() != first){
+      placed.push_back(&chain);
+    }
+  }
+  std::sort(placed.begin(), placed.end(), [](std::vector<BasicBlock*>* a, std::vector<BasicBlock*>* b){
+    return a->front()->get_code_order() < b->front()->get_code_order();
+  });
+  placed.insert(placed.begin(), &chains[chain_of[first]]);
+
+  std::vector<BasicBlock*> order;
+  for(auto chain : placed){
+    order.insert(order.end(), chain->begin(), chain->end());
+  }
+  return order;
+}
+
+// Blocks which were only reached by falling through need a label
+// if their predecessor is no longer placed right before them.
+void BlockLayout::assign_labels(const std::vector<BasicBlock*>& order){
+  for(unsigned i = 0; i < order.size(); i++){
+    BasicBlock* next = (i + 1 < order.size()) ? order[i + 1] : nullptr;
+    BasicBlock* succ = get_successor(order[i], EDGE_FALLTHROUGH);
+    if(succ != nullptr && is_interior(succ) && succ != next && !succ->has_label() && m_labels.count(succ) == 0){
+      m_labels[succ] = ".LBB" + std::to_string(m_next_label_num++);
+    }
+  }
+}
+
+void BlockLayout::append_block(const std::shared_ptr<InstructionSequence>& iseq, BasicBlock* bb, BasicBlock* next){
+  BasicBlock* exit = m_cfg->get_exit_block();
+  // the local optimizations can leave a block empty
+  Instruction* last = bb->get_length() > 0 ? bb->get_last_instruction() : nullptr;
+  int opcode = last != nullptr ? last->get_opcode() : int(HINS_nop);
+
+  bool has_label = bb->has_label() || m_labels.count(bb) > 0;
+  if(has_label){
+    iseq->define_label(get_label(bb));
+  }
+
+  // everything but the branch at the end (if any) is copied unchanged
+  unsigned body_len = (opcode == HINS_jmp || is_cjmp(opcode)) ? bb->get_length() - 1 : bb->get_length();
+  for(unsigned i = 0; i < body_len; i++){
+    iseq->append(bb->get_instruction(i)->duplicate());
+  }
+
+  if(opcode == HINS_jmp){
+    // a block consisting only of a jump still needs an instruction to
+    // carry its label
+    if(get_successor(bb, EDGE_BRANCH) != next || (body_len == 0 && has_label)){
+      iseq->append(last->duplicate());
+    }
+  } else if(is_cjmp(opcode)){
+    BasicBlock* taken = get_successor(bb, EDGE_BRANCH);
+    BasicBlock* not_taken = get_successor(bb, EDGE_FALLTHROUGH);
+    if(skip_empty_blocks(taken) == skip_empty_blocks(not_taken)){
+      // the local optimizations can empty the blocks between a cjmp
+      // and its target, so it goes to the same place either way and
+      // isn't needed
+      if(not_taken != next && not_taken != exit){
+        iseq->append(new Instruction(HINS_jmp, Operand(Operand::LABEL, get_label(not_taken))));
+      } else if(body_len == 0 && has_label){
+        iseq->append(new Instruction(HINS_nop));
+      }
+    } else if(not_taken == next || (not_taken == exit && next == nullptr)){
+      iseq->append(last->duplicate());
+    } else if(taken == next){
+      int inverted = (opcode == HINS_cjmp_t) ? HINS_cjmp_f : HINS_cjmp_t;
+      iseq->append(new Instruction(inverted, last->get_operand(0), Operand(Operand::LABEL, get_label(not_taken))));
+    } else{
+      iseq->append(last->duplicate());
+      iseq->append(new Instruction(HINS_jmp, Operand(Operand::LABEL, get_label(not_taken))));
+    }
+  } else if(opcode != HINS_ret && opcode != HINS_tailcall){
+    BasicBlock* succ = get_successor(bb, EDGE_FALLTHROUGH);
+    if(succ != nullptr && succ != exit && succ != next){
+      iseq->append(new Instruction(HINS_jmp, Operand(Operand::LABEL, get_label(succ))));
+    } else if(body_len == 0 && has_label){
+      iseq->append(new Instruction(HINS_nop));
+    }
+  }
+}
+
+// The block control really gets to from a block: empty blocks (or
+// ones with just a jmp) are passed through to their successors
+BasicBlock* BlockLayout::skip_empty_blocks(BasicBlock* bb){
+  std::set<BasicBlock*> seen;
+  while(is_interior(bb) && seen.insert(bb).second){
+    bool empty = true;
+    for(unsigned i = 0; i < bb->get_length(); i++){
+      int opcode = bb->get_instruction(i)->get_opcode();
+      if(opcode != HINS_nop && !(opcode == HINS_jmp && i == bb->get_length() - 1)){
+        empty = false;
+      }
+    }
+    const ControlFlowGraph::EdgeList& outgoing = m_cfg->get_outgoing_edges(bb);
+    if(!empty || outgoing.size() != 1){
+      break;
+    }
+    bb = outgoing[0]->get_target();
+  }
+  return bb;
+}
+
+BasicBlock* BlockLayout::get_successor(BasicBlock* bb, EdgeKind kind){
+  const ControlFlowGraph::EdgeList& outgoing = m_cfg->get_outgoing_edges(bb);
+  for(auto i = outgoing.cbegin(); i != outgoing.cend(); ++i){
+    if((*i)->get_kind() == kind){
+      return (*i)->get_target();
+    }
+  }
+  return nullptr;
+}
+
+std::string BlockLayout::get_label(BasicBlock* bb){
+  if(bb->has_label()){
+    return bb->get_label();
+  }
+  assert(m_labels.count(bb) > 0);
+  return m_labels[bb];
+}
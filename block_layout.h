@@ -0,0 +1,53 @@
+#ifndef BLOCK_LAYOUT_H
+#define BLOCK_LAYOUT_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "cfg.h"
+
+// BlockLayout flattens a high-level ControlFlowGraph into an
+// InstructionSequence, choosing the order of the basic blocks rather
+// than following the original code order.
+//
+// The placement is Pettis-Hansen style chain merging: every edge gets
+// an estimated execution frequency (10^loop depth), and in order of
+// decreasing frequency, the source block's chain and the target
+// block's chain are joined whenever the source is the last block of
+// its chain and the target the first block of its own, so that the
+// most frequent edges become fall-throughs. The branches are then
+// fixed up for the chosen order:
+//   - a jmp to the next block is removed
+//   - a cjmp_t/cjmp_f whose target is the next block is inverted
+//   - a fall-through to a block which is not next becomes a jmp
+class BlockLayout{
+private:
+  std::shared_ptr<ControlFlowGraph> m_cfg;
+  std::map<const BasicBlock*, int> m_loop_depth;
+  std::map<const BasicBlock*, std::string> m_labels;
+  unsigned m_next_label_num;
+
+public:
+  // blocks which need a label only because of the new layout are
+  // labeled .LBB<n>, numbered starting from next_label_num
+  BlockLayout(const std::shared_ptr<ControlFlowGraph>& cfg, unsigned next_label_num);
+  ~BlockLayout();
+
+  std::shared_ptr<InstructionSequence> create_instruction_sequence();
+
+  // the number of the next label after the ones used so far, so that
+  // labels are not reused between functions
+  unsigned get_next_label_num() const{ return m_next_label_num; }
+
+private:
+  void compute_loop_depths();
+  std::vector<BasicBlock*> place_blocks();
+  void assign_labels(const std::vector<BasicBlock*>& order);
+  void append_block(const std::shared_ptr<InstructionSequence>& iseq, BasicBlock* bb, BasicBlock* next);
+  BasicBlock* skip_empty_blocks(BasicBlock* bb);
+  BasicBlock* get_successor(BasicBlock* bb, EdgeKind kind);
+  std::string get_label(BasicBlock* bb);
+};
+
+#endif // BLOCK_LAYOUT_H
@@ -2,6 +2,7 @@
 #include <cstdio>
 #include <algorithm>
 #include <iterator>
+#include <set>
 #include "cpputil.h"
 #include "exceptions.h"
 #include "highlevel.h"
@@ -10,6 +11,7 @@
 #include "highlevel_formatter.h"
 #include "lowlevel_formatter.h"
 #include "cfg.h"
+#include "phase_timer.h"
 
 ////////////////////////////////////////////////////////////////////////
 // BasicBlock implementation
@@ -20,6 +22,7 @@ BasicBlock::BasicBlock(BasicBlockKind kind, unsigned id, int code_order, const s
   , m_id(id)
   , m_label(label)
   , m_code_order(code_order) {
+  PhaseTimer::count(CountedObject::BASIC_BLOCK);
 }
 
 BasicBlock::~BasicBlock() {
@@ -488,6 +491,21 @@ std::shared_ptr<ControlFlowGraph> ControlFlowGraphBuilder::build() {
       work_list.push_back({ ins_index: target_index, pred: bb, edge_kind: EDGE_BRANCH, label: target_label });
     }
 
+    // a multiway jump also branches to each (distinct) label in its table
+    Instruction *last_ins = bb->get_last_instruction();
+    if (last_ins->has_jump_table()) {
+      std::set<std::string> targets;
+      if (ends_in_branch(bb)) {
+        targets.insert(last_ins->get_operand(last_ins->get_num_operands() - 1).get_label());
+      }
+      for (const std::string &target_label : last_ins->get_jump_table().labels) {
+        if (targets.insert(target_label).second) {
+          unsigned target_index = m_iseq->get_index_of_labeled_instruction(target_label);
+          work_list.push_back({ ins_index: target_index, pred: bb, edge_kind: EDGE_BRANCH, label: target_label });
+        }
+      }
+    }
+
     // if this basic block falls through, prepare to create an edge
     // to the BasicBlock for successor instruction (creating it if it doesn't
     // exist yet)
@@ -502,11 +520,18 @@ std::shared_ptr<ControlFlowGraph> ControlFlowGraphBuilder::build() {
         // fall through to basic block starting at successor instruction
         work_list.push_back({ ins_index: target_index, pred: bb, edge_kind: EDGE_FALLTHROUGH });
       }
+    } else if (!ends_in_branch(bb) && !last_ins->has_jump_table()) {
+      // a return, or a function call which doesn't fall through (a tail
+      // call): control leaves the function, so the successor is the exit block
+      m_cfg->create_edge(bb, exit, EDGE_BRANCH);
     }
   }
 
-  assert(last != nullptr);
-  m_cfg->create_edge(last, exit, EDGE_FALLTHROUGH);
+  // if every path out of the function is a tail call, the code at
+  // the end of the InstructionSequence might not be reachable
+  if (last != nullptr)
+    m_cfg->create_edge(last, exit, EDGE_FALLTHROUGH);
+  assert(!m_cfg->get_incoming_edges(exit).empty());
 
   return m_cfg;
 }
@@ -551,6 +576,11 @@ BasicBlock *ControlFlowGraphBuilder::scan_basic_block(const WorkItem &item, cons
       break;
     }
 
+    if (!falls_through(ins)) {
+      // The instruction we just added is a return (or tail call)
+      break;
+    }
+
     if (m_iseq->has_label(index)) {
       // Next instruction has a label, so assume it is a branch target
       // (and thus the beginning of a different basic block)
@@ -598,12 +628,14 @@ HighLevelControlFlowGraphBuilder::~HighLevelControlFlowGraphBuilder() {
 }
 
 bool HighLevelControlFlowGraphBuilder::is_function_call(Instruction *ins) {
-  return ins->get_opcode() == HINS_call;
+  return ins->get_opcode() == HINS_call || ins->get_opcode() == HINS_tailcall;
 }
 
 bool HighLevelControlFlowGraphBuilder::falls_through(Instruction *ins) {
-  // only an unconditional jump instruction does not fall through
-  return ins->get_opcode() != HINS_jmp;
+  // only an unconditional (or multiway) jump, a return, or a tail
+  // call (which leaves the function) does not fall through
+  int opcode = ins->get_opcode();
+  return opcode != HINS_jmp && opcode != HINS_jmptab && opcode != HINS_ret && opcode != HINS_tailcall;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -618,12 +650,22 @@ LowLevelControlFlowGraphBuilder::~LowLevelControlFlowGraphBuilder() {
 }
 
 bool LowLevelControlFlowGraphBuilder::is_function_call(Instruction *ins) {
-  return ins->get_opcode() == MINS_CALL;
+  if (ins->get_opcode() == MINS_CALL)
+    return true;
+
+  // a jmp to a function (rather than to a local .L label) is a tail call
+  if (ins->get_opcode() == MINS_JMP) {
+    Operand target = ins->get_operand(0);
+    return target.is_label() && target.get_label().compare(0, 2, ".L") != 0;
+  }
+
+  return false;
 }
 
 bool LowLevelControlFlowGraphBuilder::falls_through(Instruction *ins) {
-  // only an unconditional jump instruction does not fall through
-  return ins->get_opcode() != MINS_JMP;
+  // only an unconditional (or indirect) jump or a return does not fall through
+  int opcode = ins->get_opcode();
+  return opcode != MINS_JMP && opcode != MINS_JMPQ && opcode != MINS_RET;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,681 @@
+#include <cassert>
+#include <algorithm>
+#include "instruction.h"
+#include "operand.h"
+#include "highlevel.h"
+#include "live_vregs.h"
+#include "local_storage_allocation.h"
+#include "cfg_simplification.h"
+
+namespace{
+
+  // block "indices" for a missing successor and for the exit block
+  const int NO_BLOCK = -1;
+  const int EXIT_BLOCK = -2;
+
+  // longest block (including its cjmp) that is copied to thread an edge
+  const unsigned MAX_THREAD_LENGTH = 4;
+
+  // longest arm (not counting a jmp at its end) that is if-converted
+  const unsigned MAX_IF_CONVERT_LENGTH = 4;
+
+  bool in_range(int opcode, int first, int last){
+    return opcode >= first && opcode <= last;
+  }
+
+  bool is_cjmp(int opcode){
+    return opcode == HINS_cjmp_t || opcode == HINS_cjmp_f;
+  }
+
+  // sign extend the low size bytes of value
+  long truncate(long value, int size){
+    switch(size){
+      case 1: return (signed char) value;
+      case 2: return (short) value;
+      case 4: return (int) value;
+      default: return value;
+    }
+  }
+
+  bool get_value(const Operand& op, const std::map<int, long>& known, long& value){
+    if(op.is_imm_ival()){
+      value = op.get_imm_ival();
+      return true;
+    }
+    if(op.get_kind() == Operand::VREG){
+      auto i = known.find(op.get_base_reg());
+      if(i != known.end()){
+        value = i->second;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Whether the instruction only computes a vreg from vregs and
+  // constants, so it can be evaluated (and safely copied)
+  bool is_pure(Instruction* ins){
+    int opcode = ins->get_opcode();
+    if(!in_range(opcode, HINS_add_b, HINS_mul_q) && !in_range(opcode, HINS_cmplt_b, HINS_cmpneq_q)
+       && !in_range(opcode, HINS_mov_b, HINS_uconv_lq)){
+      return false;
+    }
+    if(ins->get_operand(0).get_kind() != Operand::VREG){
+      return false;
+    }
+    for(unsigned i = 1; i < ins->get_num_operands(); i++){
+      Operand op = ins->get_operand(i);
+      if(op.get_kind() != Operand::VREG && !op.is_imm_ival()){
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Whether the instruction can be executed when the branch it is on
+  // isn't taken: it only computes a local or temporary vreg from vregs,
+  // constants and locations in the frame, and can't trap
+  bool is_speculatable(Instruction* ins){
+    int opcode = ins->get_opcode();
+    if(!in_range(opcode, HINS_add_b, HINS_mul_q) && !in_range(opcode, HINS_lshift_b, HINS_dec_q)
+       && !in_range(opcode, HINS_mov_b, HINS_uconv_lq) && !in_range(opcode, HINS_select_b, HINS_select_q)){
+      return false;
+    }
+    Operand dest = ins->get_operand(0);
+    if(dest.get_kind() != Operand::VREG || dest.get_base_reg() < LocalStorageAllocation::VREG_FIRST_LOCAL){
+      return false;
+    }
+    for(unsigned i = 1; i < ins->get_num_operands(); i++){
+      Operand op = ins->get_operand(i);
+      if(op.get_kind() != Operand::VREG && !op.is_imm_ival() && op.get_kind() != Operand::FRAME_MEM_OFF){
+        return false;
+      }
+    }
+    return true;
+  }
+
+  HighLevelOpcode get_select_opcode(int size){
+    switch(size){
+      case 1: return HINS_select_b;
+      case 2: return HINS_select_w;
+      case 4: return HINS_select_l;
+      default: return HINS_select_q;
+    }
+  }
+
+  // Update the known vreg values for a pure instruction
+  void evaluate(Instruction* ins, std::map<int, long>& known){
+    int opcode = ins->get_opcode();
+    int dest = ins->get_operand(0).get_base_reg();
+    int size = highlevel_opcode_get_source_operand_size(HighLevelOpcode(opcode));
+
+    long a, b;
+    bool have_a = get_value(ins->get_operand(1), known, a);
+    bool have_b = ins->get_num_operands() > 2 && get_value(ins->get_operand(2), known, b);
+    if(!have_a || (ins->get_num_operands() > 2 && !have_b)){
+      known.erase(dest);
+      return;
+    }
+    a = truncate(a, size);
+    b = have_b ? truncate(b, size) : 0;
+
+    long result;
+    if(in_range(opcode, HINS_add_b, HINS_add_q)){
+      result = a + b;
+    } else if(in_range(opcode, HINS_sub_b, HINS_sub_q)){
+      result = a - b;
+    } else if(in_range(opcode, HINS_mul_b, HINS_mul_q)){
+      result = a * b;
+    } else if(in_range(opcode, HINS_cmplt_b, HINS_cmplt_q)){
+      result = a < b;
+    } else if(in_range(opcode, HINS_cmplte_b, HINS_cmplte_q)){
+      result = a <= b;
+    } else if(in_range(opcode, HINS_cmpgt_b, HINS_cmpgt_q)){
+      result = a > b;
+    } else if(in_range(opcode, HINS_cmpgte_b, HINS_cmpgte_q)){
+      result = a >= b;
+    } else if(in_range(opcode, HINS_cmpeq_b, HINS_cmpeq_q)){
+      result = a == b;
+    } else if(in_range(opcode, HINS_cmpneq_b, HINS_cmpneq_q)){
+      result = a != b;
+    } else if(in_range(opcode, HINS_uconv_bw, HINS_uconv_lq)){
+      result = (size == 8) ? a : (a & ((1L << (size * 8)) - 1));
+    } else{
+      // mov and sconv
+      result = a;
+    }
+    known[dest] = truncate(result, highlevel_opcode_get_dest_operand_size(HighLevelOpcode(opcode)));
+  }
+
+}
+
+CfgSimplification::CfgSimplification(const std::shared_ptr<ControlFlowGraph>& cfg, int next_vreg)
+  : m_cfg(cfg)
+  , m_first(NO_BLOCK)
+  , m_next_vreg(next_vreg){
+}
+
+CfgSimplification::~CfgSimplification(){
+  for(Block& b : m_blocks){
+    for(Instruction* ins : b.ins){
+      delete ins;
+    }
+  }
+}
+
+std::shared_ptr<ControlFlowGraph> CfgSimplification::simplify(){
+  load_blocks();
+
+  // threading copies code, so it's only done once; the other
+  // simplifications are repeated as long as they find something to do
+  bypass_empty_blocks();
+  thread_branches();
+  bool changed = true;
+  while(changed){
+    changed = bypass_empty_blocks();
+    changed = merge_blocks() || changed;
+    changed = if_convert() || changed;
+  }
+
+  return build_cfg();
+}
+
+void CfgSimplification::load_blocks(){
+  std::map<const BasicBlock*, int> index_of;
+  for(auto i = m_cfg->bb_begin(); i != m_cfg->bb_end(); ++i){
+    BasicBlock* bb = *i;
+    if(bb->get_kind() == BASICBLOCK_INTERIOR){
+      index_of[bb] = int(m_blocks.size());
+      m_blocks.push_back({ bb->get_code_order(), bb->get_label(), {}, NO_BLOCK, NO_BLOCK, {}, false });
+    } else if(bb->get_kind() == BASICBLOCK_EXIT){
+      index_of[bb] = EXIT_BLOCK;
+    }
+  }
+
+  for(auto i = m_cfg->bb_begin(); i != m_cfg->bb_end(); ++i){
+    BasicBlock* bb = *i;
+    const ControlFlowGraph::EdgeList& outgoing = m_cfg->get_outgoing_edges(bb);
+    if(bb->get_kind() == BASICBLOCK_ENTRY){
+      assert(outgoing.size() == 1);
+      m_first = index_of[outgoing[0]->get_target()];
+      continue;
+    }
+    if(bb->get_kind() != BASICBLOCK_INTERIOR){
+      continue;
+    }
+
+    Block& b = m_blocks[index_of[bb]];
+    for(auto j = bb->cbegin(); j != bb->cend(); ++j){
+      b.ins.push_back((*j)->duplicate());
+    }
+    // a jmptab's default label is its taken branch, any other label
+    // in its table is one of the block's table targets
+    bool is_jmptab = get_last_opcode(b) == HINS_jmptab;
+    for(auto j = outgoing.cbegin(); j != outgoing.cend(); ++j){
+      int target = index_of[(*j)->get_target()];
+      if((*j)->get_kind() != EDGE_BRANCH){
+        b.next = target;
+      } else if(is_jmptab && (*j)->get_target()->get_label() != b.ins.back()->get_operand(1).get_label()){
+        b.table.push_back(target);
+      } else{
+        b.taken = target;
+      }
+    }
+  }
+}
+
+// A block with only nops, possibly followed by a jmp, is removed and
+// its predecessors go directly to its successor
+bool CfgSimplification::bypass_empty_blocks(){
+  bool changed = false;
+  for(int e = 0; e < int(m_blocks.size()); e++){
+    Block& b = m_blocks[e];
+    if(b.removed || e == m_first){
+      continue;
+    }
+    bool empty = true;
+    for(unsigned i = 0; i < b.ins.size(); i++){
+      int opcode = b.ins[i]->get_opcode();
+      if(opcode != HINS_nop && !(opcode == HINS_jmp && i == b.ins.size() - 1)){
+        empty = false;
+      }
+    }
+    int target = (b.taken != NO_BLOCK) ? b.taken : b.next;
+    if(!empty || target == e || target < 0){
+      continue;
+    }
+
+    // the successor takes over the label if it doesn't have one, so
+    // branches to the removed block don't need to be changed
+    if(m_blocks[target].label.empty()){
+      m_blocks[target].label = b.label;
+    }
+    for(Block& pred : m_blocks){
+      if(!pred.removed){
+        retarget(pred, e, target);
+      }
+    }
+    remove_block(e);
+    changed = true;
+  }
+  return changed;
+}
+
+// If the only successor of a block ends in a cjmp that is decided by
+// values the block assigns, the block does the successor's computations
+// itself and falls through to the cjmp's destination
+bool CfgSimplification::thread_branches(){
+  bool changed = false;
+  for(int p = 0; p < int(m_blocks.size()); p++){
+    Block& pred = m_blocks[p];
+    int q = get_single_successor(pred);
+    if(pred.removed || q < 0 || q == p || q == m_first || get_last_opcode(pred) == HINS_call){
+      continue;
+    }
+    Block& succ = m_blocks[q];
+    if(succ.ins.size() > MAX_THREAD_LENGTH || !is_cjmp(get_last_opcode(succ))){
+      continue;
+    }
+
+    // find the constant vregs at the end of the predecessor
+    std::map<int, long> known;
+    for(Instruction* ins : pred.ins){
+      if(is_pure(ins)){
+        evaluate(ins, known);
+      } else if(ins->get_opcode() == HINS_call){
+        known.clear();
+      } else if(ins->get_num_operands() > 0 && ins->get_operand(0).get_kind() == Operand::VREG){
+        known.erase(ins->get_operand(0).get_base_reg());
+      }
+    }
+
+    bool pure = true;
+    for(unsigned i = 0; i + 1 < succ.ins.size() && pure; i++){
+      pure = is_pure(succ.ins[i]);
+      if(pure){
+        evaluate(succ.ins[i], known);
+      }
+    }
+    Instruction* cjmp = succ.ins.back();
+    long cond;
+    if(!pure || !get_value(cjmp->get_operand(0), known, cond)){
+      continue;
+    }
+    bool taken = (cjmp->get_opcode() == HINS_cjmp_t) ? cond != 0 : cond == 0;
+    int dest = taken ? succ.taken : succ.next;
+    if(dest == q){
+      continue;
+    }
+
+    if(get_last_opcode(pred) == HINS_jmp){
+      delete pred.ins.back();
+      pred.ins.pop_back();
+    }
+    for(unsigned i = 0; i + 1 < succ.ins.size(); i++){
+      pred.ins.push_back(succ.ins[i]->duplicate());
+    }
+    pred.taken = NO_BLOCK;
+    pred.next = dest;
+    changed = true;
+  }
+  return changed;
+}
+
+// A block is appended to its only predecessor if that has no other
+// successor. Calls stay at the end of their blocks, and the return
+// block is kept separate, since TailCallElimination looks for it by
+// its label.
+bool CfgSimplification::merge_blocks(){
+  std::vector<int> num_preds = count_predecessors();
+  bool changed = false;
+  for(int p = 0; p < int(m_blocks.size()); p++){
+    Block& pred = m_blocks[p];
+    int s;
+    while(!pred.removed && (s = get_single_successor(pred)) >= 0 && s != p && num_preds[s] == 1
+          && get_last_opcode(pred) != HINS_call && m_blocks[s].ins.front()->get_opcode() != HINS_leave){
+      Block& succ = m_blocks[s];
+      if(get_last_opcode(pred) == HINS_jmp){
+        delete pred.ins.back();
+        pred.ins.pop_back();
+      }
+      pred.ins.insert(pred.ins.end(), succ.ins.begin(), succ.ins.end());
+      succ.ins.clear();
+      pred.taken = succ.taken;
+      pred.next = succ.next;
+      pred.table = succ.table;
+      fold_branch(pred);
+      remove_block(s);
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+// A cjmp on a flag, around one arm (a triangle) or two arms which
+// meet again (a diamond), is removed: the arms are appended to the
+// block with the cjmp, assigning fresh vregs instead of the ones they
+// assign, and a select for each of those picks the new value it gets
+// on the path the flag chooses (or keeps the old one)
+bool CfgSimplification::if_convert(){
+  std::vector<int> num_preds = count_predecessors();
+  bool changed = false;
+  for(int h = 0; h < int(m_blocks.size()); h++){
+    Block& head = m_blocks[h];
+    if(head.removed || head.taken < 0 || head.next < 0 || !is_cjmp(get_last_opcode(head))){
+      continue;
+    }
+    int cond = get_flag_vreg(head);
+    if(cond < 0){
+      continue;
+    }
+    bool if_true = head.ins.back()->get_opcode() == HINS_cjmp_t;
+    int true_block = if_true ? head.taken : head.next;
+    int false_block = if_true ? head.next : head.taken;
+    bool true_arm = is_arm(h, true_block, num_preds);
+    bool false_arm = is_arm(h, false_block, num_preds);
+    int join;
+    if(true_arm && false_arm
+       && get_single_successor(m_blocks[true_block]) == get_single_successor(m_blocks[false_block])){
+      join = get_single_successor(m_blocks[true_block]);
+    } else if(true_arm && get_single_successor(m_blocks[true_block]) == false_block){
+      join = false_block;
+      false_arm = false;
+    } else if(false_arm && get_single_successor(m_blocks[false_block]) == true_block){
+      join = true_block;
+      true_arm = false;
+    } else{
+      continue;
+    }
+    if(join == h){
+      continue;
+    }
+
+    // every vreg assigned by an arm needs a select, which has to be of
+    // the size the arms assign it with
+    std::map<int, int> sizes;
+    int num_defs = 0;
+    bool sizes_agree = true;
+    for(int arm : { true_arm ? true_block : NO_BLOCK, false_arm ? false_block : NO_BLOCK }){
+      if(arm == NO_BLOCK){
+        continue;
+      }
+      for(Instruction* ins : m_blocks[arm].ins){
+        int opcode = ins->get_opcode();
+        if(opcode == HINS_nop || opcode == HINS_jmp){
+          continue;
+        }
+        int size = highlevel_opcode_get_dest_operand_size(HighLevelOpcode(opcode));
+        auto i = sizes.insert({ ins->get_operand(0).get_base_reg(), size }).first;
+        sizes_agree = sizes_agree && i->second == size;
+        num_defs++;
+      }
+    }
+    if(!sizes_agree || m_next_vreg + num_defs > int(LiveVregsAnalysis::MAX_VREGS)){
+      continue;
+    }
+
+    delete head.ins.back();
+    head.ins.pop_back();
+    std::map<int, int> true_names, false_names;
+    if(true_arm){
+      append_arm(head, true_block, true_names);
+      remove_block(true_block);
+    }
+    if(false_arm){
+      append_arm(head, false_block, false_names);
+      remove_block(false_block);
+    }
+    // the arms may reuse the condition's vreg (as a temporary), so its
+    // select comes last
+    std::vector<int> order;
+    for(auto i = sizes.begin(); i != sizes.end(); ++i){
+      if(i->first != cond){
+        order.push_back(i->first);
+      }
+    }
+    if(sizes.count(cond) > 0){
+      order.push_back(cond);
+    }
+    Operand flag(Operand::VREG, cond);
+    for(int vreg : order){
+      Operand dest(Operand::VREG, vreg);
+      auto t = true_names.find(vreg);
+      auto f = false_names.find(vreg);
+      Operand true_value = (t != true_names.end()) ? Operand(Operand::VREG, t->second) : dest;
+      Operand false_value = (f != false_names.end()) ? Operand(Operand::VREG, f->second) : dest;
+      head.ins.push_back(new Instruction(get_select_opcode(sizes[vreg]), dest, flag, true_value, false_value));
+    }
+    head.taken = NO_BLOCK;
+    head.next = join;
+    changed = true;
+  }
+  return changed;
+}
+
+std::shared_ptr<ControlFlowGraph> CfgSimplification::build_cfg(){
+  // blocks which are no longer reachable are left out
+  std::vector<bool> reachable(m_blocks.size(), false);
+  std::vector<int> work_list = { m_first };
+  while(!work_list.empty()){
+    int b = work_list.back();
+    work_list.pop_back();
+    if(b < 0 || reachable[b]){
+      continue;
+    }
+    reachable[b] = true;
+    work_list.push_back(m_blocks[b].taken);
+    work_list.push_back(m_blocks[b].next);
+    work_list.insert(work_list.end(), m_blocks[b].table.begin(), m_blocks[b].table.end());
+  }
+
+  std::shared_ptr<ControlFlowGraph> result(new ControlFlowGraph());
+  BasicBlock* entry = result->create_basic_block(BASICBLOCK_ENTRY, -1);
+  BasicBlock* exit = result->create_basic_block(BASICBLOCK_EXIT, 2000000);
+
+  std::vector<BasicBlock*> new_blocks(m_blocks.size(), nullptr);
+  for(unsigned i = 0; i < m_blocks.size(); i++){
+    Block& b = m_blocks[i];
+    if(!reachable[i]){
+      continue;
+    }
+    fold_branch(b);
+    new_blocks[i] = result->create_basic_block(BASICBLOCK_INTERIOR, b.code_order, b.label);
+    for(Instruction* ins : b.ins){
+      new_blocks[i]->append(ins);
+    }
+    b.ins.clear();
+  }
+
+  auto get_block = [&](int index){
+    return (index == EXIT_BLOCK) ? exit : new_blocks[index];
+  };
+  result->create_edge(entry, new_blocks[m_first], EDGE_FALLTHROUGH);
+  for(unsigned i = 0; i < m_blocks.size(); i++){
+    if(!reachable[i]){
+      continue;
+    }
+    if(m_blocks[i].taken != NO_BLOCK){
+      result->create_edge(new_blocks[i], get_block(m_blocks[i].taken), EDGE_BRANCH);
+    }
+    if(m_blocks[i].next != NO_BLOCK){
+      result->create_edge(new_blocks[i], get_block(m_blocks[i].next), EDGE_FALLTHROUGH);
+    }
+    for(int target : m_blocks[i].table){
+      result->create_edge(new_blocks[i], get_block(target), EDGE_BRANCH);
+    }
+  }
+  return result;
+}
+
+// Make the edges from pred to from go to to instead
+void CfgSimplification::retarget(Block& pred, int from, int to){
+  if(pred.taken == from){
+    pred.taken = to;
+    Instruction* branch = pred.ins.back();
+    int opcode = branch->get_opcode();
+    if(opcode == HINS_jmp || is_cjmp(opcode) || opcode == HINS_jmptab){
+      unsigned label_operand = branch->get_num_operands() - 1;
+      branch->set_operand(Operand(Operand::LABEL, m_blocks[to].label), label_operand);
+    }
+  }
+  if(pred.next == from){
+    pred.next = to;
+  }
+  if(get_last_opcode(pred) == HINS_jmptab){
+    retarget_table(pred, from, to);
+  }
+  fold_branch(pred);
+}
+
+// A cjmp going to the same place either way isn't needed: the block
+// just falls through to it
+void CfgSimplification::fold_branch(Block& b){
+  if(b.taken == b.next && b.taken != NO_BLOCK){
+    assert(is_cjmp(get_last_opcode(b)));
+    delete b.ins.back();
+    b.ins.pop_back();
+    b.taken = NO_BLOCK;
+    if(b.ins.empty()){
+      b.ins.push_back(new Instruction(HINS_nop));
+    }
+  }
+}
+
+// Make a jmptab's table entries for from go to to instead; the
+// table targets stay distinct from each other and from the default.
+// The entries for the default are in the jump table's labels too, so
+// those are renamed even if from is only the default.
+void CfgSimplification::retarget_table(Block& pred, int from, int to){
+  auto i = std::find(pred.table.begin(), pred.table.end(), from);
+  if(i != pred.table.end()){
+    pred.table.erase(i);
+    if(std::find(pred.table.begin(), pred.table.end(), to) == pred.table.end()){
+      pred.table.push_back(to);
+    }
+  }
+  pred.table.erase(std::remove(pred.table.begin(), pred.table.end(), pred.taken), pred.table.end());
+
+  Instruction* jmptab = pred.ins.back();
+  std::vector<std::string> labels = jmptab->get_jump_table().labels;
+  for(std::string& label : labels){
+    if(label == m_blocks[from].label){
+      label = m_blocks[to].label;
+    }
+  }
+  jmptab->set_jump_table(jmptab->get_jump_table().name, labels);
+}
+
+void CfgSimplification::remove_block(int index){
+  Block& b = m_blocks[index];
+  for(Instruction* ins : b.ins){
+    delete ins;
+  }
+  b.ins.clear();
+  b.taken = NO_BLOCK;
+  b.next = NO_BLOCK;
+  b.table.clear();
+  b.removed = true;
+}
+
+std::vector<int> CfgSimplification::count_predecessors(){
+  std::vector<int> num_preds(m_blocks.size(), 0);
+  num_preds[m_first]++;
+  for(Block& b : m_blocks){
+    if(b.removed){
+      continue;
+    }
+    if(b.taken >= 0){
+      num_preds[b.taken]++;
+    }
+    if(b.next >= 0){
+      num_preds[b.next]++;
+    }
+    for(int target : b.table){
+      num_preds[target]++;
+    }
+  }
+  return num_preds;
+}
+
+// The vreg tested by the cjmp ending a block, if the block computes
+// it with a comparison or a !, so it is known to be 0 or 1; -1 if not
+int CfgSimplification::get_flag_vreg(const Block& head){
+  Operand cond = head.ins.back()->get_operand(0);
+  if(cond.get_kind() != Operand::VREG){
+    return -1;
+  }
+  for(auto i = head.ins.rbegin() + 1; i != head.ins.rend(); ++i){
+    Instruction* ins = *i;
+    if(ins->get_num_operands() == 0 || is_cjmp(ins->get_opcode()) || ins->get_opcode() == HINS_jmp){
+      continue;
+    }
+    Operand dest = ins->get_operand(0);
+    if(dest.get_kind() == Operand::VREG && dest.get_base_reg() == cond.get_base_reg()){
+      int opcode = ins->get_opcode();
+      bool is_flag = in_range(opcode, HINS_cmplt_b, HINS_cmpneq_q) || in_range(opcode, HINS_not_b, HINS_not_q);
+      return is_flag ? cond.get_base_reg() : -1;
+    }
+    if(ins->get_opcode() == HINS_call){
+      return -1;
+    }
+  }
+  return -1;
+}
+
+// Whether a successor of the head block can be if-converted: only
+// the head goes to it, it has a single successor, and it is a few
+// speculatable instructions
+bool CfgSimplification::is_arm(int head, int index, const std::vector<int>& num_preds){
+  if(index < 0 || index == head || index == m_first || num_preds[index] != 1){
+    return false;
+  }
+  const Block& b = m_blocks[index];
+  int succ = get_single_successor(b);
+  if(succ < 0 || succ == index){
+    return false;
+  }
+  unsigned length = 0;
+  for(unsigned i = 0; i < b.ins.size(); i++){
+    Instruction* ins = b.ins[i];
+    if(ins->get_opcode() == HINS_nop || (ins->get_opcode() == HINS_jmp && i == b.ins.size() - 1)){
+      continue;
+    }
+    if(!is_speculatable(ins) || ++length > MAX_IF_CONVERT_LENGTH){
+      return false;
+    }
+  }
+  return true;
+}
+
+// Append the computations of an arm to the head, with each vreg it
+// assigns renamed to a fresh one; names maps the vregs to the names
+// of their final values
+void CfgSimplification::append_arm(Block& head, int arm, std::map<int, int>& names){
+  for(Instruction* ins : m_blocks[arm].ins){
+    int opcode = ins->get_opcode();
+    if(opcode == HINS_nop || opcode == HINS_jmp){
+      continue;
+    }
+    Instruction* copy = ins->duplicate();
+    for(unsigned i = 1; i < copy->get_num_operands(); i++){
+      Operand op = copy->get_operand(i);
+      if(op.get_kind() == Operand::VREG && names.count(op.get_base_reg()) > 0){
+        copy->set_operand(Operand(Operand::VREG, names[op.get_base_reg()]), i);
+      }
+    }
+    names[ins->get_operand(0).get_base_reg()] = m_next_vreg;
+    copy->set_operand(Operand(Operand::VREG, m_next_vreg++), 0);
+    head.ins.push_back(copy);
+  }
+}
+
+int CfgSimplification::get_single_successor(const Block& b){
+  if((b.taken != NO_BLOCK && b.next != NO_BLOCK) || get_last_opcode(b) == HINS_jmptab){
+    return NO_BLOCK;
+  }
+  return (b.taken != NO_BLOCK) ? b.taken : b.next;
+}
+
+int CfgSimplification::get_last_opcode(const Block& b){
+  return b.ins.empty() ? -1 : b.ins.back()->get_opcode();
+}
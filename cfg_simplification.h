@@ -0,0 +1,76 @@
+#ifndef CFG_SIMPLIFICATION_H
+#define CFG_SIMPLIFICATION_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "cfg.h"
+
+// CfgSimplification cleans up the control flow of a high-level
+// ControlFlowGraph, mostly the leftovers of how statements are
+// generated:
+//   - blocks containing nothing but a jmp (or nops) are bypassed, so
+//     jumps to jumps go straight to their final target
+//   - an edge into a short block ending in a cjmp whose outcome is
+//     known from the constants assigned before the edge is threaded to
+//     the block the cjmp goes to, with the short block's computations
+//     copied onto the edge
+//   - a block with a single successor is merged with that successor
+//     if it is the successor's only predecessor
+//   - a cjmp around one or two short arms which only compute vregs
+//     (the shape an if, an if/else or a ?: with branches has) is
+//     if-converted: both arms are computed, into fresh vregs, and
+//     selects pick the values the vregs end up with
+// The result is a new CFG whose edge kinds follow from the branch at
+// the end of each block: the targets of a jmp, cjmp or jmptab are
+// branch edges, everything else is a fall-through, which BlockLayout
+// turns into a jmp only when it has to.
+class CfgSimplification{
+private:
+  struct Block{
+    int code_order;
+    std::string label;
+    std::vector<Instruction*> ins;
+    int taken;    // target of the branch (or return) ending the block
+    int next;     // fall-through successor
+    std::vector<int> table;  // other targets of a jmptab ending the block
+    bool removed;
+  };
+
+  std::shared_ptr<ControlFlowGraph> m_cfg;
+  std::vector<Block> m_blocks;
+  int m_first;
+  int m_next_vreg;
+
+public:
+  // next_vreg is the first vreg the function doesn't use
+  CfgSimplification(const std::shared_ptr<ControlFlowGraph>& cfg, int next_vreg);
+  ~CfgSimplification();
+
+  std::shared_ptr<ControlFlowGraph> simplify();
+
+  // the first vreg not used by the simplified code
+  int get_next_vreg() const{ return m_next_vreg; }
+
+private:
+  void load_blocks();
+  bool bypass_empty_blocks();
+  bool thread_branches();
+  bool merge_blocks();
+  bool if_convert();
+  std::shared_ptr<ControlFlowGraph> build_cfg();
+
+  void retarget(Block& pred, int from, int to);
+  void retarget_table(Block& pred, int from, int to);
+  void fold_branch(Block& b);
+  void remove_block(int index);
+  std::vector<int> count_predecessors();
+  int get_flag_vreg(const Block& head);
+  bool is_arm(int head, int index, const std::vector<int>& num_preds);
+  void append_arm(Block& head, int arm, std::map<int, int>& names);
+  int get_single_successor(const Block& b);
+  int get_last_opcode(const Block& b);
+};
+
+#endif // CFG_SIMPLIFICATION_H
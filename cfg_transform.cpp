@@ -31,11 +31,8 @@ std::shared_ptr<ControlFlowGraph> ControlFlowGraphTransform::transform_cfg(){
     BasicBlock* orig = *i;
 
     // Transform the instructions
-    std::shared_ptr<InstructionSequence> transformed_bb = dead_store(orig);
-    // for(auto i = 0; i < 2; i++){
-    // transformed_bb = constant_fold(transformed_bb.get());
-    transformed_bb = lvn(transformed_bb.get(), orig);
-    // }
+    std::shared_ptr<InstructionSequence> transformed_bb = transform_basic_block(orig);
+
     // Create transformed basic block; note that we set its
     // code order to be the same as the code order of the original
     // block (with the hope of eventually reconstructing an InstructionSequence
@@ -75,190 +72,361 @@ MyOptimization::MyOptimization(const std::shared_ptr<ControlFlowGraph>& cfg)
 MyOptimization::~MyOptimization(){
 }
 
-struct myCompare{
-  bool operator()(const Instruction* a, const Instruction* b) const{
-    int a_op_cnt = a->get_num_operands();
-    if(a_op_cnt != b->get_num_operands()){
-      return true;
+std::shared_ptr<InstructionSequence> MyOptimization::transform_basic_block(const BasicBlock* orig_bb){
+  std::shared_ptr<InstructionSequence> transformed_bb = dead_store(orig_bb);
+  // for(auto i = 0; i < 2; i++){
+  // transformed_bb = constant_fold(transformed_bb.get());
+  transformed_bb = lvn(transformed_bb.get(), orig_bb);
+  // }
+  return transformed_bb;
+}
+
+namespace{
+
+  bool in_range(int opcode, int first, int last){
+    return opcode >= first && opcode <= last;
+  }
+
+  bool is_vreg(const Operand& op){
+    return op.get_kind() == Operand::VREG;
+  }
+
+  bool same_operand(const Operand& a, const Operand& b){
+    if(a.get_kind() != b.get_kind()){
+      return false;
+    }
+    if(a.has_base_reg() && a.get_base_reg() != b.get_base_reg()){
+      return false;
+    }
+    if(a.has_index_reg() && (a.get_index_reg() != b.get_index_reg() || a.get_scale() != b.get_scale())){
+      return false;
+    }
+    if(a.has_imm_ival() && a.get_imm_ival() != b.get_imm_ival()){
+      return false;
     }
-    if(a->get_opcode() != b->get_opcode()){
-      return true;
+    if(a.get_kind() == Operand::FRAME_MEM_OFF && a.get_frame_slot() != b.get_frame_slot()){
+      return false;
     }
-    for(int i = 0; i < a_op_cnt; i++){
-      Operand opa = a->get_operand(i);
-      Operand opb = b->get_operand(i);
-      if(opa.is_imm_ival() && opb.is_imm_ival() && opa.get_imm_ival() == opb.get_imm_ival()){
-      } else if(opa.has_base_reg() && opb.has_base_reg() && opa.get_base_reg() == opb.get_base_reg()){
-        if(opa.is_memref() && opb.is_memref()){
+    return !a.has_label() || a.get_label() == b.get_label();
+  }
 
-        } else if(opa.is_reg() && opb.is_reg()){
+  bool same_instruction(const Instruction* a, const Instruction* b){
+    if(a->get_opcode() != b->get_opcode() || a->get_num_operands() != b->get_num_operands()){
+      return false;
+    }
+    for(unsigned i = 0; i < a->get_num_operands(); i++){
+      if(!same_operand(a->get_operand(i), b->get_operand(i))){
+        return false;
+      }
+    }
+    return true;
+  }
 
-        } else{
-          return true;
-        }
+  // whether any operand of the instruction uses the vreg
+  // (operand_start 1 checks only the source operands of a def)
+  bool mentions(const Instruction* ins, int vreg, unsigned operand_start = 0){
+    for(unsigned i = operand_start; i < ins->get_num_operands(); i++){
+      Operand op = ins->get_operand(i);
+      if((op.has_base_reg() && op.get_base_reg() == vreg) || (op.has_index_reg() && op.get_index_reg() == vreg)){
+        return true;
+      }
+    }
+    return false;
+  }
 
-      } else{ return true; }
+  bool reads_memory(const Instruction* ins){
+    for(unsigned i = 1; i < ins->get_num_operands(); i++){
+      if(ins->get_operand(i).is_memref()){
+        return true;
+      }
     }
     return false;
   }
-};
 
+  // whether the low-level code generator accepts an immediate as a
+  // source operand of the instruction
+  bool allows_immediate(int opcode){
+    return in_range(opcode, HINS_add_b, HINS_xor_q) || in_range(opcode, HINS_neg_b, HINS_compl_q)
+           || in_range(opcode, HINS_mov_b, HINS_sconv_lq) || in_range(opcode, HINS_select_b, HINS_select_q);
+  }
+
+  // sign extend the low size bytes of value
+  long truncate(long value, int size){
+    switch(size){
+      case 1: return (signed char) value;
+      case 2: return (short) value;
+      case 4: return (int) value;
+      default: return value;
+    }
+  }
+
+  // Evaluate an instruction whose source operands are all constants;
+  // returns false if it can't (or shouldn't) be evaluated
+  bool evaluate(const Instruction* ins, long& result){
+    int opcode = ins->get_opcode();
+    if(!in_range(opcode, HINS_add_b, HINS_xor_q) && !in_range(opcode, HINS_neg_b, HINS_compl_q)
+       && !in_range(opcode, HINS_sconv_bw, HINS_uconv_lq)){
+      return false;
+    }
+    for(unsigned i = 1; i < ins->get_num_operands(); i++){
+      if(!ins->get_operand(i).is_imm_ival()){
+        return false;
+      }
+    }
+    int size = highlevel_opcode_get_source_operand_size(HighLevelOpcode(opcode));
+    long a = truncate(ins->get_operand(1).get_imm_ival(), size);
+    long b = ins->get_num_operands() > 2 ? truncate(ins->get_operand(2).get_imm_ival(), size) : 0;
+
+    if(in_range(opcode, HINS_add_b, HINS_add_q)){
+      result = a + b;
+    } else if(in_range(opcode, HINS_sub_b, HINS_sub_q)){
+      result = a - b;
+    } else if(in_range(opcode, HINS_mul_b, HINS_mul_q)){
+      result = a * b;
+    } else if(in_range(opcode, HINS_div_b, HINS_mod_q)){
+      // leave the trap (or the overflow) to run time
+      if(b == 0 || (b == -1 && a == truncate(1L << (size * 8 - 1), size))){
+        return false;
+      }
+      result = in_range(opcode, HINS_div_b, HINS_div_q) ? a / b : a % b;
+    } else if(in_range(opcode, HINS_lshift_b, HINS_urshift_q)){
+      // as in C, a count which isn't less than the width is undefined
+      if(b < 0 || b >= size * 8){
+        return false;
+      }
+      if(in_range(opcode, HINS_lshift_b, HINS_lshift_q)){
+        result = long((unsigned long) a << b);
+      } else if(in_range(opcode, HINS_rshift_b, HINS_rshift_q)){
+        result = a >> b;
+      } else{
+        // a was sign extended by truncate
+        unsigned long bits = (size == 8) ? a : (a & ((1L << (size * 8)) - 1));
+        result = long(bits >> b);
+      }
+    } else if(in_range(opcode, HINS_cmplt_b, HINS_cmplt_q)){
+      result = a < b;
+    } else if(in_range(opcode, HINS_cmplte_b, HINS_cmplte_q)){
+      result = a <= b;
+    } else if(in_range(opcode, HINS_cmpgt_b, HINS_cmpgt_q)){
+      result = a > b;
+    } else if(in_range(opcode, HINS_cmpgte_b, HINS_cmpgte_q)){
+      result = a >= b;
+    } else if(in_range(opcode, HINS_cmpeq_b, HINS_cmpeq_q)){
+      result = a == b;
+    } else if(in_range(opcode, HINS_cmpneq_b, HINS_cmpneq_q)){
+      result = a != b;
+    } else if(in_range(opcode, HINS_and_b, HINS_and_q)){
+      result = a & b;
+    } else if(in_range(opcode, HINS_or_b, HINS_or_q)){
+      result = a | b;
+    } else if(in_range(opcode, HINS_xor_b, HINS_xor_q)){
+      result = a ^ b;
+    } else if(in_range(opcode, HINS_neg_b, HINS_neg_q)){
+      result = -a;
+    } else if(in_range(opcode, HINS_not_b, HINS_not_q)){
+      result = a == 0;
+    } else if(in_range(opcode, HINS_compl_b, HINS_compl_q)){
+      result = ~a;
+    } else if(in_range(opcode, HINS_uconv_bw, HINS_uconv_lq)){
+      result = (size == 8) ? a : (a & ((1L << (size * 8)) - 1));
+    } else{
+      // sconv
+      result = a;
+    }
+    result = truncate(result, highlevel_opcode_get_dest_operand_size(HighLevelOpcode(opcode)));
+    // immediates are at most 32 bits in the generated code
+    return result == (int) result;
+  }
+
+  HighLevelOpcode get_mov_opcode(int size){
+    switch(size){
+      case 1: return HINS_mov_b;
+      case 2: return HINS_mov_w;
+      case 4: return HINS_mov_l;
+      default: return HINS_mov_q;
+    }
+  }
+
+}
 
-static long val = 0;
 std::shared_ptr<InstructionSequence>
 MyOptimization::lvn(const InstructionSequence* orig_bb, const BasicBlock* orig){
   std::shared_ptr<InstructionSequence> result_iseq(new InstructionSequence());
-  std::set<Instruction*, myCompare> ins_dup;
-  val_to_ival.clear();
-  Instruction* prev1 = nullptr, * prev2 = nullptr;
   LiveVregs::FactType live_after = m_live_vregs.get_fact_at_end_of_block(orig);
-  HighLevelFormatter formatter;
+  val_to_ival.clear();
+  m_available.clear();
 
   for(auto i = orig_bb->cbegin(); i != orig_bb->cend(); ++i){
-    Instruction* orig_ins = *i;
-    Instruction* new_ins = orig_ins->duplicate();
-    int original_size = ins_dup.size();
-    ins_dup.insert(orig_ins);
-    if(original_size == ins_dup.size()){
+    Instruction* new_ins = (*i)->duplicate();
+    int opcode = new_ins->get_opcode();
+    replace_uses(new_ins, result_iseq);
+
+    if(opcode == HINS_call || opcode == HINS_tailcall){
+      // the callee may change memory, and the argument and
+      // return value vregs
+      for(int vreg = 0; vreg < 10; vreg++){
+        kill(vreg, result_iseq);
+      }
+      kill_memory();
+      result_iseq->append(new_ins);
       continue;
     }
-    Operand first, second;
-    HighLevelOpcode opcode = (HighLevelOpcode)orig_ins->get_opcode();
-
-    std::string formatted_ins = formatter.format_instruction(new_ins);
-    // printf("\t%s\n", formatted_ins.c_str());
-
-    // can ignore moving constant or register to register, but not memory
-    if(match_hl(HINS_mov_b, opcode)){
-      first = orig_ins->get_operand(0);
-      second = orig_ins->get_operand(1);
-      recursive_find(second);
-      new_ins->set_operand(second, 1);
-      if(first.is_reg()){
-        val_to_ival[first.get_base_reg()] = second;
-        if(second.is_reg()){
-          if(orig_ins->get_operand(1).is_memref()){
-            new_ins->set_operand(second.to_memref(), 1);
-          } else{
-            if(first.get_base_reg() > 9 && !live_after.test(first.get_base_reg())){
-              delete new_ins;
-              new_ins = nullptr;
-            }
-          }
-        } else if(second.is_memref()){
-          second = Operand(Operand::VREG, second.get_base_reg());
-          recursive_find(second);
-          if(orig_ins->get_operand(1).is_memref()){
-            new_ins->set_operand(second.to_memref(), 1);
-          }
-        }
-        // cannot ignore argument assignment
-        else if(first.get_base_reg() > 9 && !live_after.test(first.get_base_reg())){
-          erase_depend(first);
-          delete new_ins;
-          new_ins = nullptr;
-        }
-        // can ignore if both registers are the same
-        else if(second.is_reg() && first.get_base_reg() == second.get_base_reg()){
-          delete new_ins;
-          new_ins = nullptr;
-        }
-      } else if(first.is_memref()){
-        if(val_to_ival.find(first.get_base_reg()) != val_to_ival.end()){
-          Operand candidate = val_to_ival[first.get_base_reg()];
-          if(candidate.is_reg()){
-            candidate = candidate.to_memref();
-            new_ins->set_operand(candidate, 0);
-          }
-          val_to_ival[first.get_base_reg()] = candidate;
-        }
+    if(!HighLevel::is_def(new_ins)){
+      if(new_ins->get_num_operands() > 0 && new_ins->get_operand(0).is_memref()){
+        kill_memory();
       }
-    } else if(HighLevel::is_def(orig_ins)){
-      int dest_reg = orig_ins->get_operand(0).get_base_reg();
-      int foldable = 0;
-      for(int i = 1; i < orig_ins->get_num_operands(); i++){
-        second = orig_ins->get_operand(i);
-        if(second.is_imm_ival()){
-          foldable++;
-        }
-        if(second.is_reg() && !m_live_vregs.get_fact_after_instruction(orig, orig_ins).test(second.get_base_reg())){
-          recursive_find(second);
-          if(second.is_imm_ival()){
-            foldable++;
-          }
-          new_ins->set_operand(second, i);
-        }
+      result_iseq->append(new_ins);
+      continue;
+    }
+
+    Operand dest = new_ins->get_operand(0);
+    int dest_reg = dest.get_base_reg();
+
+    // constant fold
+    long value;
+    if(evaluate(new_ins, value)){
+      int size = highlevel_opcode_get_dest_operand_size(HighLevelOpcode(opcode));
+      delete new_ins;
+      new_ins = new Instruction(get_mov_opcode(size), dest, Operand(Operand::IMM_IVAL, value));
+      opcode = new_ins->get_opcode();
+    }
+
+    if(match_hl(HINS_mov_b, opcode) && !new_ins->get_operand(1).is_memref()){
+      Operand src = new_ins->get_operand(1);
+      // can ignore if both registers are the same
+      if(is_vreg(src) && src.get_base_reg() == dest_reg){
+        delete new_ins;
+        continue;
       }
-      if(orig_ins->get_num_operands() == 3){
-        first = orig_ins->get_operand(1);
-        second = orig_ins->get_operand(2);
-        if(first.is_reg() && second.is_reg()){
-          int a = first.get_base_reg();
-          int b = second.get_base_reg();
-          if(val_to_ival.find(a) != val_to_ival.end() && val_to_ival[a].is_memref()
-            && val_to_ival.find(b) != val_to_ival.end() && val_to_ival[b].is_memref()){
-            prev2 = prev2->duplicate();
-            result_iseq->append(prev2);
-
-            prev1 = prev1->duplicate();
-            result_iseq->append(prev1);
-          }
+      kill(dest_reg, result_iseq);
+      // only copies of locals and temporaries are propagated: the
+      // low-level code keeps vr0 and the argument vregs in registers
+      // which other instructions clobber
+      if(dest_reg > 9 && (src.is_imm_ival() || (is_vreg(src) && src.get_base_reg() > 9))){
+        val_to_ival[dest_reg] = src;
+        if(!live_after.test(dest_reg)){
+          m_removed_copies[dest_reg] = new_ins;
+          continue;
         }
       }
-      val_to_ival.erase(orig_ins->get_operand(0).get_base_reg());
-      // if all operands are constants for 2 operand operations, constant fold
-      opcode = is_basic_operation(opcode);
-      if(foldable == 2 && opcode){
-        first = new_ins->get_operand(1);
-        second = new_ins->get_operand(2);
-        assert(first.is_imm_ival() && second.is_imm_ival());
-        int first_ival = first.get_imm_ival();
-        int second_ival = second.get_imm_ival();
-        if(opcode == HINS_add_b){
-          first_ival = first_ival + second_ival;
-        } else if(opcode == HINS_sub_b){
-          first_ival = first_ival - second_ival;
-        } else if(opcode == HINS_div_b){
-          first_ival = first_ival / second_ival;
-        } else if(opcode == HINS_mul_b){
-          first_ival = first_ival * second_ival;
-        }
-        val_to_ival[dest_reg] = Operand(Operand::IMM_IVAL, first_ival);
-        delete new_ins;
-        new_ins = nullptr;
+      result_iseq->append(new_ins);
+      continue;
+    }
+
+    // an identical computation whose result is still in the dest
+    // makes this one redundant
+    bool redundant = false;
+    for(Instruction* avail : m_available){
+      if(same_instruction(avail, new_ins)){
+        redundant = true;
+        break;
       }
-    } else if(orig_ins->get_opcode() == HINS_localaddr){
-      first = orig_ins->get_operand(0);
-      second = orig_ins->get_operand(1);
-      val_to_ival.erase(first.get_base_reg());
-    } else if(orig_ins->get_opcode() >= HINS_sconv_bw && orig_ins->get_opcode() <= HINS_sconv_lq){
-      first = orig_ins->get_operand(0);
-      second = orig_ins->get_operand(1);
-      recursive_find(second);
-      if(second.is_imm_ival()){
-        val_to_ival[first.get_base_reg()] = second;
-        delete new_ins;
-        new_ins = nullptr;
+    }
+    if(redundant){
+      delete new_ins;
+      continue;
+    }
+
+    kill(dest_reg, result_iseq);
+    result_iseq->append(new_ins);
+    if(dest_reg > 9 && !mentions(new_ins, dest_reg, 1)){
+      m_available.push_back(new_ins);
+    }
+  }
+
+  // the removed copies aren't live at the end of the block,
+  // so the rest can be dropped
+  for(auto i = m_removed_copies.begin(); i != m_removed_copies.end(); ++i){
+    delete i->second;
+  }
+  m_removed_copies.clear();
+
+  return result_iseq;
+}
+
+// Replace the vregs used by an instruction with their known values,
+// materializing the copies of those which can't be replaced
+void MyOptimization::replace_uses(Instruction* ins, const std::shared_ptr<InstructionSequence>& iseq){
+  bool is_def = HighLevel::is_def(ins);
+  for(unsigned j = 0; j < ins->get_num_operands(); j++){
+    Operand op = ins->get_operand(j);
+    if(is_vreg(op)){
+      if(j == 0 && is_def){
+        continue;
+      }
+      Operand val = op;
+      recursive_find(val);
+      if(val.is_imm_ival() && !(is_def && allows_immediate(ins->get_opcode()))){
+        materialize(op.get_base_reg(), iseq);
+      } else{
+        ins->set_operand(val, j);
+      }
+    } else if(op.get_kind() == Operand::VREG_MEM){
+      Operand base(Operand::VREG, op.get_base_reg());
+      recursive_find(base);
+      if(is_vreg(base)){
+        ins->set_operand(base.to_memref(), j);
+      } else{
+        materialize(op.get_base_reg(), iseq);
+      }
+    } else if(op.is_memref()){
+      if(op.has_base_reg()){
+        materialize(op.get_base_reg(), iseq);
+      }
+      if(op.has_index_reg()){
+        materialize(op.get_index_reg(), iseq);
       }
     }
+  }
+}
 
+void MyOptimization::materialize(int vreg, const std::shared_ptr<InstructionSequence>& iseq){
+  auto i = m_removed_copies.find(vreg);
+  if(i != m_removed_copies.end()){
+    iseq->append(i->second);
+    m_removed_copies.erase(i);
+  }
+}
 
-    if(new_ins){
-      result_iseq->append(new_ins);
-      new_ins = nullptr;
+// Forget what is known about a vreg which is about to be assigned
+void MyOptimization::kill(int vreg, const std::shared_ptr<InstructionSequence>& iseq){
+  // removed copies of the old value have to be made before it changes
+  std::vector<long> dependents;
+  for(auto i = val_to_ival.begin(); i != val_to_ival.end(); ++i){
+    if(is_vreg(i->second) && i->second.get_base_reg() == vreg){
+      dependents.push_back(i->first);
     }
-    prev2 = prev1;
-    prev1 = orig_ins;
+  }
+  for(long d : dependents){
+    materialize(d, iseq);
+    val_to_ival.erase(d);
+  }
+  val_to_ival.erase(vreg);
 
+  auto copy = m_removed_copies.find(vreg);
+  if(copy != m_removed_copies.end()){
+    delete copy->second;
+    m_removed_copies.erase(copy);
   }
 
-  for(auto i = result_iseq->cbegin(); i != result_iseq->cend(); i++){
-    std::string formatted_ins = formatter.format_instruction(*i);
-    printf("\t%s\n", formatted_ins.c_str());
+  for(auto i = m_available.begin(); i != m_available.end(); ){
+    if(mentions(*i, vreg)){
+      i = m_available.erase(i);
+    } else{
+      ++i;
+    }
   }
-  puts("");
+}
 
-  return result_iseq;
+// Forget the loads, after a store or a call
+void MyOptimization::kill_memory(){
+  for(auto i = m_available.begin(); i != m_available.end(); ){
+    if(reads_memory(*i)){
+      i = m_available.erase(i);
+    } else{
+      ++i;
+    }
+  }
 }
 
 std::shared_ptr<InstructionSequence>
@@ -286,27 +454,8 @@ MyOptimization::dead_store(const InstructionSequence* orig_bb){
   return result_iseq;
 }
 
-void MyOptimization::loop_check(int i, Instruction*& new_ins, Instruction*& orig_ins, std::unordered_map<int, long>& vregVal){
-  for(int j = i; j < orig_ins->get_num_operands(); j++){
-    Operand op = orig_ins->get_operand(j);
-    if(!op.is_memref() && !op.is_non_reg()){
-      int op_vreg = op.get_base_reg();
-      if(vregVal.find(op_vreg) != vregVal.end()){
-        Operand new_op(Operand::IMM_IVAL, vregVal[op_vreg]);
-        new_ins->set_operand(new_op, j);
-      }
-    }
-  }
-}
-long MyOptimization::set_val(std::map<long, long>& m, Operand o){
-  if(m.find(o.get_base_reg()) != m.end()){
-    return m[o.get_base_reg()];
-  }
-  m[o.get_base_reg()] = val;
-  return val++;
-}
 void MyOptimization::recursive_find(Operand& o){
-  if(o.is_imm_ival() || o.is_memref() || o.get_base_reg() < 10 || val_to_ival.find(o.get_base_reg()) == val_to_ival.end()){
+  if(!o.has_base_reg() || o.is_memref() || o.get_base_reg() < 10 || val_to_ival.find(o.get_base_reg()) == val_to_ival.end()){
     return;
   }
   Operand key = val_to_ival[o.get_base_reg()];
@@ -316,27 +465,3 @@ void MyOptimization::recursive_find(Operand& o){
   o = key;
   recursive_find(o);
 }
-HighLevelOpcode MyOptimization::is_basic_operation(HighLevelOpcode opcode){
-  if(match_hl(HINS_add_b, opcode)){
-    return HINS_add_b;
-  } else if(match_hl(HINS_sub_b, opcode)){
-    return HINS_sub_b;
-  } else if(match_hl(HINS_mul_b, opcode)){
-    return HINS_mul_b;
-  } else if(match_hl(HINS_div_b, opcode)){
-    return HINS_div_b;
-  } else{
-    return HINS_nop;
-  }
-}
-void MyOptimization::erase_depend(Operand a){
-  std::vector<long> dead;
-  for(auto i : val_to_ival){
-    if(i.second.has_base_reg() && i.second.get_base_reg() == a.get_base_reg()){
-      dead.push_back(i.first);
-    }
-  }
-  for(auto i : dead){
-    val_to_ival.erase(i);
-  }
-}
\ No newline at end of file
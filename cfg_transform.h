@@ -29,34 +29,36 @@ public:
   //
   //    Instruction *orig_ins = /* an Instruction object */
   //    Instruction *dup_ins = orig_ins->duplicate();
-  // virtual std::shared_ptr<InstructionSequence> transform_basic_block(const InstructionSequence* orig_bb) = 0;
-
-  // virtual std::shared_ptr<InstructionSequence> constant_fold(const InstructionSequence* orig_bb) = 0;
-  virtual std::shared_ptr<InstructionSequence> dead_store(const InstructionSequence* orig_bb) = 0;
-  virtual std::shared_ptr<InstructionSequence> lvn(const InstructionSequence* orig_bb, const BasicBlock*) = 0;
+  virtual std::shared_ptr<InstructionSequence> transform_basic_block(const BasicBlock* orig_bb) = 0;
 
 };
 
 class MyOptimization : public ControlFlowGraphTransform{
 private:
   LiveVregs m_live_vregs;
+  // the value (a constant or another vreg) known to be in a vreg
   std::map<long, Operand> val_to_ival;
-  std::map<long, long> op_to_val;
+  // copies which were left out because every use so far was replaced
+  // by the copied value; a copy is put back (materialized) when a later
+  // instruction needs the vreg itself
+  std::map<long, Instruction*> m_removed_copies;
+  // computations in the block whose result is still in their dest
+  std::vector<Instruction*> m_available;
 
 public:
   MyOptimization(const std::shared_ptr<ControlFlowGraph>& cfg);
   ~MyOptimization();
 
-  // virtual std::shared_ptr<InstructionSequence> constant_fold(const InstructionSequence* orig_bb);
-  virtual std::shared_ptr<InstructionSequence> dead_store(const InstructionSequence* orig_bb);
-  virtual std::shared_ptr<InstructionSequence> lvn(const InstructionSequence* orig_bb, const BasicBlock*);
+  virtual std::shared_ptr<InstructionSequence> transform_basic_block(const BasicBlock* orig_bb);
+
+  std::shared_ptr<InstructionSequence> dead_store(const InstructionSequence* orig_bb);
+  std::shared_ptr<InstructionSequence> lvn(const InstructionSequence* orig_bb, const BasicBlock*);
 
 private:
-  void loop_check(int, Instruction*&, Instruction*&, std::unordered_map<int, long>&);
-  // void map_value(int, Operand, );
-  long set_val(std::map<long, long>&, Operand);
   void recursive_find(Operand&);
-  HighLevelOpcode is_basic_operation(HighLevelOpcode);
-  void erase_depend(Operand);
+  void replace_uses(Instruction* ins, const std::shared_ptr<InstructionSequence>& iseq);
+  void materialize(int vreg, const std::shared_ptr<InstructionSequence>& iseq);
+  void kill(int vreg, const std::shared_ptr<InstructionSequence>& iseq);
+  void kill_memory();
 };
-#endif // CFG_TRANSFORM_H
\ No newline at end of file
+#endif // CFG_TRANSFORM_H
@@ -0,0 +1,194 @@
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "exceptions.h"
+#include "compile_server.h"
+
+// The requests and responses exchanged over one input (stdin or a
+// socket connection). The connection is only used by the thread reading
+// it and the workers running its requests; serve() waits for all of
+// them to be answered before it returns, so it can live on the stack.
+struct CompileServer::Connection {
+  int out_fd;
+  unsigned pending;
+  std::mutex lock;
+  std::condition_variable done;
+};
+
+namespace {
+
+void write_fully(int fd, const std::string &s) {
+  size_t off = 0;
+  while (off < s.size()) {
+    ssize_t n = write(fd, s.data() + off, s.size() - off);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      // the client went away: there is no one left to tell
+      return;
+    }
+    off += size_t(n);
+  }
+}
+
+}
+
+CompileServer::CompileServer(CompileFn compile, unsigned num_workers)
+  : m_compile(compile)
+  , m_shutdown(false) {
+  if (num_workers == 0) {
+    num_workers = 1;
+  }
+  for (unsigned i = 0; i < num_workers; i++) {
+    m_workers.emplace_back([this]() { run_worker(); });
+  }
+}
+
+CompileServer::~CompileServer() {
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_shutdown = true;
+  }
+  m_cond.notify_all();
+  for (auto i = m_workers.begin(); i != m_workers.end(); ++i) {
+    i->join();
+  }
+}
+
+void CompileServer::serve(int in_fd, int out_fd) {
+  Connection conn;
+  conn.out_fd = out_fd;
+  conn.pending = 0;
+
+  unsigned num_requests = 0;
+  std::string buf;
+  char chunk[4096];
+  bool eof = false;
+
+  while (!eof) {
+    ssize_t n = read(in_fd, chunk, sizeof(chunk));
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      // treat a final line without a newline as a request too
+      eof = true;
+      if (!buf.empty()) {
+        buf += '\n';
+      }
+    } else {
+      buf.append(chunk, size_t(n));
+    }
+
+    size_t start = 0, end;
+    while ((end = buf.find('\n', start)) != std::string::npos) {
+      std::istringstream line(buf.substr(start, end - start));
+      start = end + 1;
+
+      std::vector<std::string> args;
+      std::string arg;
+      while (line >> arg) {
+        args.push_back(arg);
+      }
+      if (args.empty()) {
+        continue;
+      }
+
+      {
+        std::lock_guard<std::mutex> guard(conn.lock);
+        conn.pending++;
+      }
+      {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_jobs.push_back({ &conn, ++num_requests, args });
+      }
+      m_cond.notify_one();
+    }
+    buf.erase(0, start);
+  }
+
+  std::unique_lock<std::mutex> guard(conn.lock);
+  conn.done.wait(guard, [&conn]() { return conn.pending == 0; });
+}
+
+void CompileServer::listen(const std::string &socket_path) {
+  sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (socket_path.size() >= sizeof(addr.sun_path)) {
+    RuntimeError::raise("Socket path '%s' is too long", socket_path.c_str());
+  }
+  strcpy(addr.sun_path, socket_path.c_str());
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    RuntimeError::raise("Couldn't create socket: %s", strerror(errno));
+  }
+
+  // a socket left over from a previous server would make bind fail
+  unlink(socket_path.c_str());
+  if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 || ::listen(fd, 64) != 0) {
+    int err = errno;
+    close(fd);
+    RuntimeError::raise("Couldn't listen on '%s': %s", socket_path.c_str(), strerror(err));
+  }
+
+  for (;;) {
+    int conn_fd = accept(fd, nullptr, nullptr);
+    if (conn_fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      int err = errno;
+      close(fd);
+      RuntimeError::raise("Couldn't accept connection: %s", strerror(err));
+    }
+
+    std::thread([this, conn_fd]() {
+      serve(conn_fd, conn_fd);
+      close(conn_fd);
+    }).detach();
+  }
+}
+
+void CompileServer::run_worker() {
+  for (;;) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> guard(m_lock);
+      m_cond.wait(guard, [this]() { return m_shutdown || !m_jobs.empty(); });
+      if (m_jobs.empty()) {
+        return;
+      }
+      job = std::move(m_jobs.front());
+      m_jobs.pop_front();
+    }
+
+    std::string err = m_compile(job.args);
+    std::string response = std::to_string(job.num);
+    if (err.empty()) {
+      response += " ok\n";
+    } else {
+      // keep the response on one line
+      for (auto i = err.begin(); i != err.end(); ++i) {
+        if (*i == '\n') {
+          *i = ' ';
+        }
+      }
+      response += " error " + err + "\n";
+    }
+    respond(job.conn, response);
+  }
+}
+
+void CompileServer::respond(Connection *conn, const std::string &response) {
+  std::lock_guard<std::mutex> guard(conn->lock);
+  write_fully(conn->out_fd, response);
+  if (--conn->pending == 0) {
+    conn->done.notify_all();
+  }
+}
@@ -0,0 +1,70 @@
+#ifndef COMPILE_SERVER_H
+#define COMPILE_SERVER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// CompileServer runs compile requests on a pool of worker threads,
+// so that a build which compiles many files pays for starting the
+// compiler (and initializing its tables) only once.
+//
+// Requests are read one per line. A request is the command line
+// arguments for a single compilation, separated by whitespace, e.g.
+//
+//   -o -f build/foo.s src/foo.c
+//
+// For each request the server writes a line "<n> ok" or
+// "<n> error <message>", where n is the number of the request on its
+// connection (starting at 1). Requests run concurrently, so the
+// responses may arrive in a different order than the requests.
+class CompileServer {
+public:
+  // compile a request, returning an empty string on success or an
+  // error message on failure; called concurrently from the workers
+  typedef std::function<std::string(const std::vector<std::string> &)> CompileFn;
+
+private:
+  struct Connection;
+
+  struct Job {
+    Connection *conn;
+    unsigned num;
+    std::vector<std::string> args;
+  };
+
+  CompileFn m_compile;
+  std::vector<std::thread> m_workers;
+  std::mutex m_lock;
+  std::condition_variable m_cond;
+  std::deque<Job> m_jobs;
+  bool m_shutdown;
+
+  // value semantics are not allowed
+  CompileServer(const CompileServer &);
+  CompileServer &operator=(const CompileServer &);
+
+public:
+  CompileServer(CompileFn compile, unsigned num_workers);
+  ~CompileServer();
+
+  // serve requests read from in_fd, writing responses to out_fd,
+  // until the end of the input; returns once every request has
+  // been answered
+  void serve(int in_fd, int out_fd);
+
+  // listen for connections on a Unix domain socket, serving each one
+  // as above on its own thread; only returns if the socket can't be
+  // created
+  void listen(const std::string &socket_path);
+
+private:
+  void run_worker();
+  void respond(Connection *conn, const std::string &response);
+};
+
+#endif // COMPILE_SERVER_H
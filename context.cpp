@@ -27,8 +27,14 @@
 #include "node.h"
 #include "ast.h"
 #include "parse.tab.h"
+#ifdef FAST_LEXER
+#include "fast_lexer.h"
+#else
 #include "lex.yy.h"
+#endif
 #include "parser_state.h"
+#include "source_buffer.h"
+#include "phase_timer.h"
 #include "semantic_analysis.h"
 #include "symtab.h"
 #include "highlevel_codegen.h"
@@ -44,35 +50,35 @@ Context::~Context(){
   delete m_ast;
 }
 
-struct CloseFile{
-  void operator()(FILE* in){
-    if(in != nullptr){
-      fclose(in);
-    }
-  }
-};
+size_t Context::get_source_size() const{
+  return m_source ? m_source->get_size() : 0;
+}
 
 namespace{
 
   template<typename Fn>
-  void process_source_file(const std::string& filename, Fn fn){
-    // open the input source file
-    std::unique_ptr<FILE, CloseFile> in(fopen(filename.c_str(), "r"));
-    if(!in){
-      RuntimeError::raise("Couldn't open '%s'", filename.c_str());
-    }
-
+  void process_source_file(SourceBuffer* source, Fn fn){
     // create an initialize ParserState; note that its destructor
     // will take responsibility for cleaning up the lexer state
     std::unique_ptr<ParserState> pp(new ParserState);
-    pp->cur_loc = Location(filename, 1, 1);
-
-    // prepare the lexer
+    pp->cur_loc = Location(source->get_filename(), 1, 1);
+    pp->source = source;
+
+#ifdef FAST_LEXER
+    // the hand-written scanner works directly on the source buffer
+    std::unique_ptr<FastLexer> lexer(new FastLexer(pp.get()));
+    pp->scan_info = lexer.get();
+#else
+    // prepare the lexer to scan the source buffer in place
+    // (the size includes the two NUL bytes following the contents)
     yylex_init(&pp->scan_info);
-    yyset_in(in.get(), pp->scan_info);
+    if(yy_scan_buffer(source->get_data(), source->get_size() + 2, pp->scan_info) == nullptr){
+      RuntimeError::raise("Couldn't scan '%s'", source->get_filename().c_str());
+    }
 
     // make the ParserState available from the lexer state
     yyset_extra(pp.get(), pp->scan_info);
+#endif
 
     // use the ParserState to either scan tokens or parse the input
     // to build an AST
@@ -83,6 +89,7 @@ namespace{
 
 void Context::scan_tokens(const std::string& filename, std::vector<Node*>& tokens){
   auto callback = [&](ParserState* pp){
+    PhaseScope phase(Phase::SCAN);
     YYSTYPE yylval;
 
     // the lexer will store pointers to all of the allocated
@@ -94,16 +101,21 @@ void Context::scan_tokens(const std::string& filename, std::vector<Node*>& token
     std::copy(pp->tokens.begin(), pp->tokens.end(), std::back_inserter(tokens));
   };
 
-  process_source_file(filename, callback);
+  m_source.reset(new SourceBuffer(filename));
+  process_source_file(m_source.get(), callback);
 }
 
 void Context::parse(const std::string& filename){
   auto callback = [&](ParserState* pp){
+    PhaseScope phase(Phase::PARSE);
+
     // parse the input source code
     yyparse(pp);
 
+#ifndef FAST_LEXER
     // free memory allocated by flex
     yylex_destroy(pp->scan_info);
+#endif
 
     m_ast = pp->parse_tree;
 
@@ -118,15 +130,18 @@ void Context::parse(const std::string& filename){
     }
   };
 
-  process_source_file(filename, callback);
+  m_source.reset(new SourceBuffer(filename));
+  process_source_file(m_source.get(), callback);
 }
 
 void Context::analyze(){
   assert(m_ast != nullptr);
+  PhaseScope phase(Phase::ANALYZE);
   m_sema.visit(m_ast);
 }
 
 void Context::highlevel_codegen(ModuleCollector* module_collector){
+  PhaseScope phase(Phase::HL_CODEGEN);
 
   LocalStorageAllocation allocator;
   allocator.visit(m_ast);
@@ -186,9 +201,11 @@ namespace{
   private:
     ModuleCollector* m_delegate;
     bool m_optimize;
+    unsigned m_max_unroll;
+    unsigned m_next_label_num;
 
   public:
-    LowLevelCodeGenModuleCollector(ModuleCollector* delegate, bool optimize);
+    LowLevelCodeGenModuleCollector(ModuleCollector* delegate, bool optimize, unsigned max_unroll);
     virtual ~LowLevelCodeGenModuleCollector();
 
     virtual void collect_string_constant(const std::string& name, const std::string& strval);
@@ -196,9 +213,11 @@ namespace{
     virtual void collect_function(const std::string& name, const std::shared_ptr<InstructionSequence>& iseq);
   };
 
-  LowLevelCodeGenModuleCollector::LowLevelCodeGenModuleCollector(ModuleCollector* delegate, bool optimize)
+  LowLevelCodeGenModuleCollector::LowLevelCodeGenModuleCollector(ModuleCollector* delegate, bool optimize, unsigned max_unroll)
     : m_delegate(delegate)
-    , m_optimize(optimize){
+    , m_optimize(optimize)
+    , m_max_unroll(max_unroll)
+    , m_next_label_num(0){
   }
 
   LowLevelCodeGenModuleCollector::~LowLevelCodeGenModuleCollector(){
@@ -213,18 +232,22 @@ namespace{
   }
 
   void LowLevelCodeGenModuleCollector::collect_function(const std::string& name, const std::shared_ptr<InstructionSequence>& iseq){
-    LowLevelCodeGen ll_codegen(m_optimize);
+    PhaseScope phase(Phase::LL_CODEGEN);
+    LowLevelCodeGen ll_codegen(m_optimize, m_next_label_num, m_max_unroll);
 
     // translate high-level code to low-level code
     std::shared_ptr<InstructionSequence> ll_iseq = ll_codegen.generate(iseq);
 
+    // make sure labels added by the optimizer are not reused between functions
+    m_next_label_num = ll_codegen.get_next_label_num();
+
     // send the low-level code on to the delegate (i.e., print the code)
     m_delegate->collect_function(name, ll_iseq);
   }
 
 }
 
-void Context::lowlevel_codegen(ModuleCollector* module_collector, bool optimize){
-  LowLevelCodeGenModuleCollector ll_codegen_module_collector(module_collector, optimize);
+void Context::lowlevel_codegen(ModuleCollector* module_collector, bool optimize, unsigned max_unroll){
+  LowLevelCodeGenModuleCollector ll_codegen_module_collector(module_collector, optimize, max_unroll);
   highlevel_codegen(&ll_codegen_module_collector);
 }
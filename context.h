@@ -23,15 +23,20 @@
 
 #include <vector>
 #include <string>
+#include <memory>
 #include "semantic_analysis.h"
 #include "module_collector.h"
 class Node;
+class SourceBuffer;
 
 // The Context class gathers together all of the objects/data
 // used in the compilation process, and orchestrates the various
 // passes and transformations.
 class Context {
 private:
+  // the tokens in the AST refer to the source buffer,
+  // so it must live as long as the AST does
+  std::unique_ptr<SourceBuffer> m_source;
   Node *m_ast;
   SemanticAnalysis m_sema;
 
@@ -49,13 +54,16 @@ public:
   // Parse an input file and build an AST
   void parse(const std::string &filename);
 
+  // size in bytes of the source file most recently scanned or parsed
+  size_t get_source_size() const;
+
   // Get pointer to root of AST
   Node *get_ast() const { return m_ast; }
 
   // functions for semantic analysis, code generation, etc.
   void analyze();
   void highlevel_codegen(ModuleCollector *module_collector);
-  void lowlevel_codegen(ModuleCollector *module_collector, bool optimize = false);
+  void lowlevel_codegen(ModuleCollector *module_collector, bool optimize = false, unsigned max_unroll = 1);
 };
 
 #endif // CONTEXT_H
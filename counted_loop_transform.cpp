@@ -0,0 +1,478 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <map>
+#include "instruction.h"
+#include "operand.h"
+#include "highlevel.h"
+#include "highlevel_defuse.h"
+#include "local_storage_allocation.h"
+#include "counted_loop_transform.h"
+
+namespace{
+
+  bool in_range(int opcode, int first, int last){
+    return opcode >= first && opcode <= last;
+  }
+
+  bool is_cjmp(int opcode){
+    return opcode == HINS_cjmp_t || opcode == HINS_cjmp_f;
+  }
+
+  // the opcodes of an operation come in _b, _w, _l, _q order
+  int get_size_index(unsigned size){
+    return (size == 8) ? 3 : (size == 4) ? 2 : (size == 2) ? 1 : 0;
+  }
+
+  // If ins computes iv plus or minus a constant of the given size,
+  // get the constant (negated for a subtraction)
+  bool get_step(Instruction* ins, int iv, unsigned size, long& step){
+    int opcode = ins->get_opcode();
+    bool is_add = opcode == HINS_add_b + get_size_index(size);
+    bool is_sub = opcode == HINS_sub_b + get_size_index(size);
+    if(!is_add && !is_sub){
+      return false;
+    }
+    Operand left = ins->get_operand(1), right = ins->get_operand(2);
+    if(is_add && left.is_imm_ival()){
+      std::swap(left, right);
+    }
+    if(left.get_kind() != Operand::VREG || left.get_base_reg() != iv || !right.is_imm_ival()){
+      return false;
+    }
+    step = is_add ? right.get_imm_ival() : -right.get_imm_ival();
+    return true;
+  }
+
+}
+
+CountedLoopTransform::CountedLoopTransform(const std::shared_ptr<ControlFlowGraph>& cfg, int next_vreg,
+                                           unsigned next_label_num, const std::string& label_prefix)
+  : m_cfg(cfg)
+  , m_first(NO_BLOCK)
+  , m_next_vreg(next_vreg)
+  , m_next_label_num(next_label_num)
+  , m_label_prefix(label_prefix){
+}
+
+CountedLoopTransform::~CountedLoopTransform(){
+  for(Block& b : m_blocks){
+    for(Instruction* ins : b.ins){
+      delete ins;
+    }
+  }
+}
+
+std::shared_ptr<ControlFlowGraph> CountedLoopTransform::transform_cfg(){
+  load_blocks();
+
+  // only the original loops are looked at, and each of them once (so
+  // not the copies transform_loop makes)
+  int num_blocks = int(m_blocks.size());
+  std::vector<bool> visited(num_blocks, false);
+  bool changed = false;
+  for(int test = 0; test < num_blocks; test++){
+    Loop loop;
+    if(visited[test] || !find_loop(test, loop)){
+      continue;
+    }
+    for(int b : loop.blocks){
+      visited[b] = true;
+    }
+    std::vector<Instruction*> body = get_body(loop.blocks, 0);
+    if(find_induction_variable(body, loop) && transform_loop(loop, body)){
+      changed = true;
+    }
+  }
+
+  return changed ? build_cfg() : m_cfg;
+}
+
+bool CountedLoopTransform::is_local_vreg(const Operand& op){
+  return op.get_kind() == Operand::VREG && op.get_base_reg() >= LocalStorageAllocation::VREG_FIRST_LOCAL;
+}
+
+// The vregs an operand mentions (a FRAME_MEM_OFF's base is a slot
+// in local storage, not a vreg)
+void CountedLoopTransform::get_vregs(const Operand& op, std::vector<int>& vregs){
+  switch(op.get_kind()){
+    case Operand::VREG: case Operand::VREG_MEM: case Operand::VREG_MEM_OFF:
+      vregs.push_back(op.get_base_reg());
+      break;
+    case Operand::VREG_MEM_IDX:
+      vregs.push_back(op.get_base_reg());
+      vregs.push_back(op.get_index_reg());
+      break;
+    default:
+      break;
+  }
+}
+
+// The number of instructions in the body assigning a vreg
+unsigned CountedLoopTransform::count_defs(const std::vector<Instruction*>& body, int vreg){
+  unsigned count = 0;
+  for(Instruction* ins : body){
+    if(HighLevel::is_def(ins) && ins->get_operand(0).get_base_reg() == vreg){
+      count++;
+    }
+  }
+  return count;
+}
+
+// The number of operands of the instructions in the body using a vreg
+unsigned CountedLoopTransform::count_uses(const std::vector<Instruction*>& body, int vreg){
+  unsigned count = 0;
+  for(Instruction* ins : body){
+    for(unsigned i = 0; i < ins->get_num_operands(); i++){
+      if(HighLevel::is_use(ins, i)){
+        std::vector<int> vregs;
+        get_vregs(ins->get_operand(i), vregs);
+        count += std::count(vregs.begin(), vregs.end(), vreg);
+      }
+    }
+  }
+  return count;
+}
+
+void CountedLoopTransform::load_blocks(){
+  std::map<const BasicBlock*, int> index_of;
+  for(auto i = m_cfg->bb_begin(); i != m_cfg->bb_end(); ++i){
+    BasicBlock* bb = *i;
+    if(bb->get_kind() == BASICBLOCK_INTERIOR){
+      index_of[bb] = int(m_blocks.size());
+      m_blocks.push_back({ bb->get_code_order(), bb->get_label(), {}, NO_BLOCK, NO_BLOCK, {}, bb });
+    } else if(bb->get_kind() == BASICBLOCK_EXIT){
+      index_of[bb] = EXIT_BLOCK;
+    }
+  }
+
+  for(auto i = m_cfg->bb_begin(); i != m_cfg->bb_end(); ++i){
+    BasicBlock* bb = *i;
+    const ControlFlowGraph::EdgeList& outgoing = m_cfg->get_outgoing_edges(bb);
+    if(bb->get_kind() == BASICBLOCK_ENTRY){
+      assert(outgoing.size() == 1);
+      m_first = index_of[outgoing[0]->get_target()];
+      continue;
+    }
+    if(bb->get_kind() != BASICBLOCK_INTERIOR){
+      continue;
+    }
+
+    Block& b = m_blocks[index_of[bb]];
+    for(auto j = bb->cbegin(); j != bb->cend(); ++j){
+      b.ins.push_back((*j)->duplicate());
+    }
+    bool is_jmptab = !b.ins.empty() && b.ins.back()->get_opcode() == HINS_jmptab;
+    for(auto j = outgoing.cbegin(); j != outgoing.cend(); ++j){
+      int target = index_of[(*j)->get_target()];
+      if((*j)->get_kind() != EDGE_BRANCH){
+        b.next = target;
+      } else if(is_jmptab && (*j)->get_target()->get_label() != b.ins.back()->get_operand(1).get_label()){
+        b.table.push_back(target);
+      } else{
+        b.taken = target;
+      }
+    }
+  }
+}
+
+// Whether the block ending in a cjmp is the test of a loop whose other
+// blocks just go from one to the next, entered at a single block
+bool CountedLoopTransform::find_loop(int test, Loop& loop){
+  const Block& t = m_blocks[test];
+  if(t.ins.empty() || !is_cjmp(t.ins.back()->get_opcode())){
+    return false;
+  }
+
+  for(bool taken : { true, false }){
+    int start = taken ? t.taken : t.next;
+    int exit = taken ? t.next : t.taken;
+    if(start < 0 || exit == NO_BLOCK){
+      continue;
+    }
+    std::vector<int> blocks;
+    int b = start;
+    while(b != test && b >= 0 && blocks.size() < m_blocks.size()){
+      const Block& block = m_blocks[b];
+      if(!block.table.empty() || (block.taken != NO_BLOCK && block.next != NO_BLOCK)){
+        break;
+      }
+      blocks.push_back(b);
+      b = (block.taken != NO_BLOCK) ? block.taken : block.next;
+    }
+    if(b != test){
+      continue;
+    }
+    blocks.push_back(test);
+    if(std::find(blocks.begin(), blocks.end(), exit) != blocks.end()){
+      return false;
+    }
+
+    // every block of the loop is only reached from the one before it,
+    // except the one where the loop is entered
+    std::vector<std::vector<int>> preds = get_predecessors();
+    int entry = -1;
+    for(unsigned i = 0; i < blocks.size(); i++){
+      unsigned num_outside = preds[blocks[i]].size() - 1 + (blocks[i] == m_first ? 1 : 0);
+      if(num_outside == 0){
+        continue;
+      }
+      if(entry >= 0){
+        return false;
+      }
+      entry = int(i);
+      for(int pred : preds[blocks[i]]){
+        if(!m_blocks[pred].table.empty()){
+          return false;
+        }
+      }
+    }
+    if(entry < 0){
+      return false;
+    }
+
+    for(int b : blocks){
+      for(Instruction* ins : m_blocks[b].ins){
+        int opcode = ins->get_opcode();
+        if(opcode == HINS_call || opcode == HINS_enter || opcode == HINS_leave || opcode == HINS_ret
+           || opcode == HINS_tailcall || opcode == HINS_jmptab){
+          return false;
+        }
+      }
+    }
+
+    loop.blocks = blocks;
+    loop.entry = unsigned(entry);
+    loop.continue_taken = taken;
+    loop.exit = exit;
+    return true;
+  }
+  return false;
+}
+
+// Find the comparison of the test, and the induction variable and
+// bound it compares; the body ends with the comparison
+bool CountedLoopTransform::find_induction_variable(const std::vector<Instruction*>& body, Loop& loop){
+  Instruction* cjmp = m_blocks[loop.blocks.back()].ins.back();
+  Instruction* cmp = body.back();
+  int opcode = cmp->get_opcode();
+  if(!in_range(opcode, HINS_cmplt_b, HINS_cmpgte_q) || cjmp->get_operand(0).get_kind() != Operand::VREG
+     || cjmp->get_operand(0).get_base_reg() != cmp->get_operand(0).get_base_reg()){
+    return false;
+  }
+  loop.size = highlevel_opcode_get_source_operand_size(HighLevelOpcode(opcode));
+  if(loop.size != 4 && loop.size != 8){
+    return false;
+  }
+
+  // the comparison is 0 (<), 1 (<=), 2 (>) or 3 (>=): swapping the
+  // operands swaps < and >, and negating it makes < into >= and so on
+  auto is_invariant = [&](const Operand& op){
+    return op.is_imm_ival() || (is_local_vreg(op) && count_defs(body, op.get_base_reg()) == 0);
+  };
+  loop.compare = (opcode - HINS_cmplt_b) / 4;
+  Operand left = cmp->get_operand(1), right = cmp->get_operand(2);
+  if(!is_local_vreg(left) || !is_invariant(right)){
+    std::swap(left, right);
+    loop.compare ^= 2;
+  }
+  if(!is_local_vreg(left) || !is_invariant(right)){
+    return false;
+  }
+  if((cjmp->get_opcode() == HINS_cjmp_t) != loop.continue_taken){
+    loop.compare = 3 - loop.compare;
+  }
+  loop.iv = left.get_base_reg();
+  loop.bound = right;
+
+  // the iv is changed once, by iv = iv + step, or by a temporary
+  // computing that which is then copied to the iv
+  if(count_defs(body, loop.iv) != 1){
+    return false;
+  }
+  unsigned d = 0;
+  while(!HighLevel::is_def(body[d]) || body[d]->get_operand(0).get_base_reg() != loop.iv){
+    d++;
+  }
+  if(body[d]->get_opcode() == HINS_mov_b + get_size_index(loop.size)){
+    Operand src = body[d]->get_operand(1);
+    if(d == 0 || src.get_kind() != Operand::VREG || !HighLevel::is_def(body[d - 1])
+       || body[d - 1]->get_operand(0).get_base_reg() != src.get_base_reg()){
+      return false;
+    }
+    d--;
+  }
+  loop.iv_update = d;
+  if(!get_step(body[d], loop.iv, loop.size, loop.step) || loop.step < INT32_MIN || loop.step > INT32_MAX){
+    return false;
+  }
+
+  // the iv has to move towards the bound
+  return (loop.compare < 2) ? loop.step > 0 : loop.step < 0;
+}
+
+// The instructions of the blocks of a loop, starting with the given
+// one, up to the comparison of the test (leaving out the jmps, and
+// the cjmp of the test)
+std::vector<Instruction*> CountedLoopTransform::get_body(const std::vector<int>& blocks, unsigned first){
+  std::vector<Instruction*> body;
+  for(unsigned i = first; i < blocks.size(); i++){
+    const Block& b = m_blocks[blocks[i]];
+    for(unsigned j = 0; j < b.ins.size(); j++){
+      int opcode = b.ins[j]->get_opcode();
+      if(opcode == HINS_nop || (j == b.ins.size() - 1 && (opcode == HINS_jmp || is_cjmp(opcode)))){
+        continue;
+      }
+      body.push_back(b.ins[j]);
+    }
+  }
+  return body;
+}
+
+// A guard, setting its last instruction's destination to whether the
+// test will pass the next factor-1 times (so the iv plus
+// (factor-1)*step still compares true with the bound). For an int iv,
+// this is computed with longs, so it can't overflow; for a long, the
+// step is taken off a constant bound instead, if it doesn't overflow
+// doing that.
+bool CountedLoopTransform::get_guard(const Loop& loop, unsigned factor, std::vector<Instruction*>& guard){
+  long span = long(factor - 1) * loop.step;
+  HighLevelOpcode compare = HighLevelOpcode(HINS_cmplt_b + 4 * loop.compare + 3);
+  Operand iv(Operand::VREG, loop.iv);
+  if(loop.size == 8){
+    if(!loop.bound.is_imm_ival()){
+      return false;
+    }
+    __int128 bound = __int128(loop.bound.get_imm_ival()) - span;
+    if(bound < INT64_MIN || bound > INT64_MAX){
+      return false;
+    }
+    guard.push_back(new Instruction(compare, Operand(Operand::VREG, m_next_vreg++), iv, Operand(Operand::IMM_IVAL, long(bound))));
+    return true;
+  }
+
+  Operand wide_iv(Operand::VREG, m_next_vreg++);
+  guard.push_back(new Instruction(HINS_sconv_lq, wide_iv, iv));
+  guard.push_back(new Instruction(HINS_add_q, wide_iv, wide_iv, Operand(Operand::IMM_IVAL, span)));
+  Operand bound;
+  if(loop.bound.is_imm_ival()){
+    bound = Operand(Operand::IMM_IVAL, long(int(loop.bound.get_imm_ival())));
+  } else{
+    bound = Operand(Operand::VREG, m_next_vreg++);
+    guard.push_back(new Instruction(HINS_sconv_lq, bound, loop.bound));
+  }
+  guard.push_back(new Instruction(compare, Operand(Operand::VREG, m_next_vreg++), wide_iv, bound));
+  return true;
+}
+
+// End a block with (a copy of) the test's branch, going to target if
+// the loop continues
+void CountedLoopTransform::append_test(const Loop& loop, int block, int target){
+  Block& b = m_blocks[block];
+  Instruction* branch = m_blocks[loop.blocks.back()].ins.back()->duplicate();
+  if(loop.continue_taken){
+    branch->set_operand(Operand(Operand::LABEL, m_blocks[target].label), 1);
+    b.taken = target;
+    b.next = loop.exit;
+  } else{
+    b.taken = loop.exit;
+    b.next = target;
+  }
+  b.ins.push_back(branch);
+}
+
+// Make the edges entering the loop from outside go to target instead.
+// Entering the loop in the middle, the rest of the first iteration is
+// copied in front of target.
+void CountedLoopTransform::enter_through(const Loop& loop, int target){
+  int head = loop.blocks[loop.entry];
+  if(loop.entry > 0){
+    std::vector<Instruction*> rest;
+    for(Instruction* ins : get_body(loop.blocks, loop.entry)){
+      rest.push_back(ins->duplicate());
+    }
+    int first_iteration = add_block(m_blocks[head].code_order, rest, NO_BLOCK, NO_BLOCK);
+    append_test(loop, first_iteration, target);
+    target = first_iteration;
+  }
+  int inside = (loop.entry > 0) ? loop.blocks[loop.entry - 1] : loop.blocks.back();
+  std::vector<int> preds = get_predecessors()[head];
+  for(int pred : preds){
+    if(pred != inside && pred != target){
+      retarget(m_blocks[pred], head, target);
+    }
+  }
+  if(m_first == head){
+    m_first = target;
+  }
+}
+
+// Make the edges from pred to from go to to instead
+void CountedLoopTransform::retarget(Block& pred, int from, int to){
+  if(pred.taken == from){
+    pred.taken = to;
+    Instruction* branch = pred.ins.back();
+    assert(branch->get_opcode() == HINS_jmp || is_cjmp(branch->get_opcode()));
+    branch->set_operand(Operand(Operand::LABEL, m_blocks[to].label), branch->get_num_operands() - 1);
+  }
+  if(pred.next == from){
+    pred.next = to;
+  }
+}
+
+int CountedLoopTransform::add_block(int code_order, const std::vector<Instruction*>& ins, int taken, int next){
+  std::string label = m_label_prefix + std::to_string(m_next_label_num++);
+  m_blocks.push_back({ code_order, label, ins, taken, next, {}, nullptr });
+  return int(m_blocks.size()) - 1;
+}
+
+// The predecessors of each block (a block with two edges to the same
+// successor is listed twice)
+std::vector<std::vector<int>> CountedLoopTransform::get_predecessors(){
+  std::vector<std::vector<int>> preds(m_blocks.size());
+  for(unsigned i = 0; i < m_blocks.size(); i++){
+    const Block& b = m_blocks[i];
+    std::vector<int> targets = b.table;
+    targets.push_back(b.taken);
+    targets.push_back(b.next);
+    for(int target : targets){
+      if(target >= 0){
+        preds[target].push_back(int(i));
+      }
+    }
+  }
+  return preds;
+}
+
+std::shared_ptr<ControlFlowGraph> CountedLoopTransform::build_cfg(){
+  std::shared_ptr<ControlFlowGraph> result(new ControlFlowGraph());
+  BasicBlock* entry = result->create_basic_block(BASICBLOCK_ENTRY, -1);
+  BasicBlock* exit = result->create_basic_block(BASICBLOCK_EXIT, 2000000);
+
+  std::vector<BasicBlock*> new_blocks(m_blocks.size(), nullptr);
+  for(unsigned i = 0; i < m_blocks.size(); i++){
+    Block& b = m_blocks[i];
+    new_blocks[i] = result->create_basic_block(BASICBLOCK_INTERIOR, b.code_order, b.label);
+    for(Instruction* ins : b.ins){
+      new_blocks[i]->append(ins);
+    }
+    b.ins.clear();
+  }
+
+  auto get_block = [&](int index){
+    return (index == EXIT_BLOCK) ? exit : new_blocks[index];
+  };
+  result->create_edge(entry, new_blocks[m_first], EDGE_FALLTHROUGH);
+  for(unsigned i = 0; i < m_blocks.size(); i++){
+    if(m_blocks[i].taken != NO_BLOCK){
+      result->create_edge(new_blocks[i], get_block(m_blocks[i].taken), EDGE_BRANCH);
+    }
+    if(m_blocks[i].next != NO_BLOCK){
+      result->create_edge(new_blocks[i], get_block(m_blocks[i].next), EDGE_FALLTHROUGH);
+    }
+    for(int target : m_blocks[i].table){
+      result->create_edge(new_blocks[i], get_block(target), EDGE_BRANCH);
+    }
+  }
+  return result;
+}
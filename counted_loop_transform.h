@@ -0,0 +1,99 @@
+#ifndef COUNTED_LOOP_TRANSFORM_H
+#define COUNTED_LOOP_TRANSFORM_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "cfg.h"
+#include "operand.h"
+
+// CountedLoopTransform is the base class of the transformations of the
+// innermost counted loops of a high-level ControlFlowGraph (as left by
+// CfgSimplification), such as LoopUnrolling and LoopVectorization. A
+// counted loop is a cycle of blocks with no branches except the test
+// at the end of one of them, which compares an induction variable (a
+// local vreg the loop changes once per iteration, by a constant step)
+// against a constant or a vreg the loop doesn't assign, with <, <=, >
+// or >=. Loops containing calls aren't transformed.
+//
+// The blocks are copied into a simpler representation, which the
+// subclass's transform_loop changes, and which is turned back into a
+// ControlFlowGraph if any loop was transformed.
+class CountedLoopTransform{
+protected:
+  // block "indices" for a missing successor and for the exit block
+  static const int NO_BLOCK = -1;
+  static const int EXIT_BLOCK = -2;
+
+  struct Block{
+    int code_order;
+    std::string label;
+    std::vector<Instruction*> ins;
+    int taken;    // target of the branch ending the block
+    int next;     // fall-through successor
+    std::vector<int> table;  // other targets of a jmptab ending the block
+    const BasicBlock* orig;  // the block of the original cfg, if any
+  };
+
+  // A counted loop found by find_loop
+  struct Loop{
+    std::vector<int> blocks;  // the cycle, from the block after the test to the test block
+    unsigned entry;           // the position in blocks of the block entered from outside
+    bool continue_taken;      // whether the test's branch goes around the loop again
+    int exit;                 // the block the test leaves the loop to
+    int iv;                   // the induction variable
+    long step;
+    int compare;              // cmplt, cmplte, cmpgt or cmpgte, of the iv against the bound
+    unsigned size;            // of the iv
+    Operand bound;
+    unsigned iv_update;       // the position in the body of the iv + step computation
+  };
+
+  std::shared_ptr<ControlFlowGraph> m_cfg;
+  std::vector<Block> m_blocks;
+  int m_first;
+  int m_next_vreg;
+  unsigned m_next_label_num;
+
+private:
+  std::string m_label_prefix;
+
+public:
+  // next_vreg is the first vreg the function doesn't use; the new
+  // blocks are labeled <label_prefix><n>, numbered starting from
+  // next_label_num
+  CountedLoopTransform(const std::shared_ptr<ControlFlowGraph>& cfg, int next_vreg, unsigned next_label_num,
+                       const std::string& label_prefix);
+  virtual ~CountedLoopTransform();
+
+  std::shared_ptr<ControlFlowGraph> transform_cfg();
+
+  int get_next_vreg() const{ return m_next_vreg; }
+  unsigned get_next_label_num() const{ return m_next_label_num; }
+
+protected:
+  // Transform a counted loop, whose body is as returned by get_body;
+  // returns whether anything was changed
+  virtual bool transform_loop(const Loop& loop, const std::vector<Instruction*>& body) = 0;
+
+  std::vector<Instruction*> get_body(const std::vector<int>& blocks, unsigned first);
+  bool find_induction_variable(const std::vector<Instruction*>& body, Loop& loop);
+  bool get_guard(const Loop& loop, unsigned factor, std::vector<Instruction*>& guard);
+  void append_test(const Loop& loop, int block, int target);
+  void enter_through(const Loop& loop, int target);
+  void retarget(Block& pred, int from, int to);
+  int add_block(int code_order, const std::vector<Instruction*>& ins, int taken, int next);
+  std::vector<std::vector<int>> get_predecessors();
+
+  static bool is_local_vreg(const Operand& op);
+  static void get_vregs(const Operand& op, std::vector<int>& vregs);
+  static unsigned count_defs(const std::vector<Instruction*>& body, int vreg);
+  static unsigned count_uses(const std::vector<Instruction*>& body, int vreg);
+
+private:
+  void load_blocks();
+  bool find_loop(int test, Loop& loop);
+  std::shared_ptr<ControlFlowGraph> build_cfg();
+};
+
+#endif // COUNTED_LOOP_TRANSFORM_H
@@ -103,9 +103,6 @@ public:
   // Data type representing a dataflow fact
   typedef typename Analysis::FactType FactType;
 
-  // We assume there won't be more than this many basic blocks.
-  static const unsigned MAX_BLOCKS = 1024;
-
 private:
   // The Analysis object encapsulates all of the details about the
   // analysis to be performed: direction (forward or backward),
@@ -182,7 +179,7 @@ private:
 
   // Postorder traversal on the CFG (or reversed CFG, depending on
   // analysis direction)
-  void postorder_on_cfg(std::bitset<MAX_BLOCKS>& visited, const BasicBlock* bb);
+  void postorder_on_cfg(std::vector<bool>& visited, const BasicBlock* bb);
 };
 
 template<typename Analysis>
@@ -319,7 +316,7 @@ typename Analysis::FactType Dataflow<Analysis>::get_instruction_fact(const Basic
 
 template<typename Analysis>
 void Dataflow<Analysis>::compute_iter_order(){
-  std::bitset<MAX_BLOCKS> visited;
+  std::vector<bool> visited(m_cfg->get_num_blocks());
 
   const auto& to_logical_successors = m_analysis.LOGICAL_FORWARD;
 
@@ -331,16 +328,16 @@ void Dataflow<Analysis>::compute_iter_order(){
 }
 
 template<typename Analysis>
-void Dataflow<Analysis>::postorder_on_cfg(std::bitset<MAX_BLOCKS>& visited, const BasicBlock* bb){
+void Dataflow<Analysis>::postorder_on_cfg(std::vector<bool>& visited, const BasicBlock* bb){
   const auto& to_logical_successors = m_analysis.LOGICAL_FORWARD;
 
   // already arrived at this block?
-  if(visited.test(bb->get_id())){
+  if(visited[bb->get_id()]){
     return;
   }
 
   // this block is now guaranteed to be visited
-  visited.set(bb->get_id());
+  visited[bb->get_id()] = true;
 
   // recursively visit (logical) successors
   //const ControlFlowGraph::EdgeList &incoming_edges = cfg->get_incoming_edges(bb);
@@ -0,0 +1,381 @@
+#include <cassert>
+#include <cstring>
+#include <elf.h>
+#include "instruction_seq.h"
+#include "type.h"
+#include "exceptions.h"
+#include "phase_timer.h"
+#include "elf_object_writer.h"
+
+namespace{
+
+  // section header indices
+  const unsigned SHN_TEXT = 1;
+  const unsigned SHN_RELA_TEXT = 2;
+  const unsigned SHN_DATA = 3;
+  const unsigned SHN_BSS = 4;
+  const unsigned SHN_RODATA = 5;
+  const unsigned SHN_RELA_RODATA = 6;
+  const unsigned SHN_NOTE_GNU_STACK = 7;
+  const unsigned SHN_SYMTAB = 8;
+  const unsigned SHN_STRTAB = 9;
+  const unsigned SHN_SHSTRTAB = 10;
+  const unsigned NUM_SECTIONS = 11;
+
+  // symbol table indices of the section symbols
+  const unsigned SYM_TEXT = 1;
+  const unsigned SYM_DATA = 2;
+  const unsigned SYM_BSS = 3;
+  const unsigned SYM_RODATA = 4;
+  const unsigned NUM_SECTION_SYMS = 5;
+
+  bool fits_int8(int64_t val){
+    return val >= -128 && val <= 127;
+  }
+
+  // A string table (.strtab, .shstrtab): names are NUL-terminated,
+  // and offset 0 is the empty name
+  class StringTable{
+  private:
+    std::vector<uint8_t> m_data;
+
+  public:
+    StringTable() : m_data(1, 0){ }
+
+    uint32_t add(const std::string& s){
+      uint32_t offset = uint32_t(m_data.size());
+      m_data.insert(m_data.end(), s.begin(), s.end());
+      m_data.push_back(0);
+      return offset;
+    }
+
+    const std::vector<uint8_t>& get_data() const{ return m_data; }
+  };
+
+  template<typename T>
+  void append_struct(std::vector<uint8_t>& out, const T& val){
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&val);
+    out.insert(out.end(), p, p + sizeof(T));
+  }
+
+  void align_to(std::vector<uint8_t>& out, unsigned align){
+    while(out.size() % align != 0){
+      out.push_back(0);
+    }
+  }
+
+  // Decode the escape sequences the assembler would interpret in a
+  // .string directive
+  std::string unescape(const std::string& s){
+    std::string result;
+    for(size_t i = 0; i < s.size(); i++){
+      if(s[i] != '\\' || i + 1 == s.size()){
+        result.push_back(s[i]);
+        continue;
+      }
+      char c = s[++i];
+      switch(c){
+        case 'n': result.push_back('\n'); break;
+        case 't': result.push_back('\t'); break;
+        case 'r': result.push_back('\r'); break;
+        case 'b': result.push_back('\b'); break;
+        case 'f': result.push_back('\f'); break;
+        default:
+          if(c >= '0' && c <= '7'){
+            int val = 0;
+            for(int n = 0; n < 3 && i < s.size() && s[i] >= '0' && s[i] <= '7'; n++, i++){
+              val = val * 8 + (s[i] - '0');
+            }
+            i--;
+            result.push_back(char(val));
+          } else{
+            result.push_back(c);
+          }
+          break;
+      }
+    }
+    return result;
+  }
+
+}
+
+ElfObjectWriter::ElfObjectWriter()
+  : m_data_align(1)
+  , m_rodata_align(1){
+}
+
+ElfObjectWriter::~ElfObjectWriter(){
+}
+
+void ElfObjectWriter::collect_string_constant(const std::string& name, const std::string& strval){
+  define(name, RODATA, m_rodata.size(), false);
+  std::string val = unescape(strval);
+  m_rodata.insert(m_rodata.end(), val.begin(), val.end());
+  m_rodata.push_back(0);
+}
+
+void ElfObjectWriter::collect_global_var(const std::string& name, const std::shared_ptr<Type>& type){
+  unsigned align = type->get_alignment();
+  if(align > m_data_align){
+    m_data_align = align;
+  }
+  align_to(m_data, align);
+  define(name, DATA, m_data.size(), true);
+  m_data.resize(m_data.size() + type->get_storage_size(), 0);
+}
+
+void ElfObjectWriter::collect_function(const std::string& name, const std::shared_ptr<InstructionSequence>& iseq){
+  PhaseScope phase(Phase::PRINT);
+  define(name, TEXT, m_code.size(), true);
+  m_labels[name] = m_code.size();
+
+  for(auto i = iseq->cbegin(); i != iseq->cend(); ++i){
+    if(i.has_label()){
+      m_labels[i.get_label()] = m_code.size();
+    }
+    m_code.emplace_back();
+    m_encoder.encode(*i, m_code.back());
+
+    // the entries of a jump table are filled in by the linker
+    if((*i)->has_jump_table()){
+      const JumpTable& table = (*i)->get_jump_table();
+      m_rodata_align = 8;
+      align_to(m_rodata, 8);
+      define(table.name, RODATA, m_rodata.size(), false);
+      for(const std::string& label : table.labels){
+        m_table_relocs.push_back({ m_rodata.size(), label, X86_RELOC_64, 0 });
+        m_rodata.resize(m_rodata.size() + 8, 0);
+      }
+    }
+  }
+}
+
+// Assign addresses to the instructions and emit .text. Every jump to a
+// label in the module starts out in its short form, and the ones which
+// don't reach their target are made long until nothing changes (a jump
+// only ever gets longer, so this terminates). Jumps elsewhere are
+// always long, with a relocation.
+void ElfObjectWriter::layout(){
+  std::vector<bool> is_short(m_code.size(), false);
+  std::vector<unsigned> target(m_code.size(), 0);
+  for(unsigned k = 0; k < m_code.size(); k++){
+    if(m_code[k].is_branch){
+      auto t = m_labels.find(m_code[k].target);
+      if(t != m_labels.end()){
+        target[k] = t->second;
+        is_short[k] = true;
+      } else if(m_code[k].target.compare(0, 2, ".L") == 0){
+        RuntimeError::raise("undefined label %s", m_code[k].target.c_str());
+      }
+    }
+  }
+
+  std::vector<uint64_t> addr(m_code.size() + 1);
+  bool changed = true;
+  while(changed){
+    changed = false;
+    addr[0] = 0;
+    for(unsigned k = 0; k < m_code.size(); k++){
+      unsigned size = m_code[k].is_branch ? X86Encoder::get_branch_size(m_code[k].condition, is_short[k])
+                                          : m_code[k].bytes.size();
+      addr[k + 1] = addr[k] + size;
+    }
+    for(unsigned k = 0; k < m_code.size(); k++){
+      if(is_short[k] && !fits_int8(int64_t(addr[target[k]]) - int64_t(addr[k + 1]))){
+        is_short[k] = false;
+        changed = true;
+      }
+    }
+  }
+
+  for(unsigned k = 0; k < m_code.size(); k++){
+    const X86Encoding& enc = m_code[k];
+    if(enc.is_branch && m_labels.count(enc.target) > 0){
+      int32_t displacement = int32_t(int64_t(addr[target[k]]) - int64_t(addr[k + 1]));
+      X86Encoder::encode_branch(enc.condition, is_short[k], displacement, m_text);
+    } else if(enc.is_branch){
+      X86Encoder::encode_branch(enc.condition, false, 0, m_text);
+      m_relocs.push_back({ m_text.size() - 4, enc.target, X86_RELOC_PLT32, -4 });
+    } else{
+      for(const X86Fixup& fixup : enc.fixups){
+        m_relocs.push_back({ addr[k] + fixup.offset, fixup.symbol, fixup.type, fixup.addend });
+      }
+      m_text.insert(m_text.end(), enc.bytes.begin(), enc.bytes.end());
+    }
+    assert(m_text.size() == addr[k + 1]);
+  }
+
+  for(auto& def : m_defs){
+    if(def.second.section == TEXT){
+      def.second.offset = addr[def.second.offset];
+    }
+  }
+
+  // jump table entries are relative to .text
+  for(Relocation& reloc : m_table_relocs){
+    auto t = m_labels.find(reloc.symbol);
+    if(t == m_labels.end()){
+      RuntimeError::raise("undefined label %s", reloc.symbol.c_str());
+    }
+    reloc.addend = addr[t->second];
+  }
+}
+
+void ElfObjectWriter::write(FILE* out){
+  PhaseScope phase(Phase::PRINT);
+  layout();
+
+  StringTable strtab, shstrtab;
+
+  // Symbols: null, section symbols, then the local symbols, then the
+  // global ones (defined first, then those referenced but not defined)
+  std::vector<Elf64_Sym> syms(NUM_SECTION_SYMS);
+  memset(syms.data(), 0, syms.size() * sizeof(Elf64_Sym));
+  const unsigned section_syms[][2] = {
+    { SYM_TEXT, SHN_TEXT }, { SYM_DATA, SHN_DATA }, { SYM_BSS, SHN_BSS }, { SYM_RODATA, SHN_RODATA },
+  };
+  for(auto& s : section_syms){
+    syms[s[0]].st_info = ELF64_ST_INFO(STB_LOCAL, STT_SECTION);
+    syms[s[0]].st_shndx = s[1];
+  }
+  auto get_shndx = [](Section section){
+    return (section == TEXT) ? SHN_TEXT : (section == DATA) ? SHN_DATA : SHN_RODATA;
+  };
+
+  std::map<std::string, unsigned> sym_index;
+  auto add_symbol = [&](const std::string& name, unsigned char bind, unsigned shndx, uint64_t value){
+    Elf64_Sym sym;
+    memset(&sym, 0, sizeof(sym));
+    sym.st_name = strtab.add(name);
+    sym.st_info = ELF64_ST_INFO(bind, STT_NOTYPE);
+    sym.st_shndx = shndx;
+    sym.st_value = value;
+    sym_index[name] = syms.size();
+    syms.push_back(sym);
+  };
+  for(const std::string& name : m_def_order){
+    const Definition& def = m_defs[name];
+    if(!def.is_global){
+      add_symbol(name, STB_LOCAL, get_shndx(def.section), def.offset);
+    }
+  }
+  unsigned first_global = syms.size();
+  for(const std::string& name : m_def_order){
+    const Definition& def = m_defs[name];
+    if(def.is_global){
+      add_symbol(name, STB_GLOBAL, get_shndx(def.section), def.offset);
+    }
+  }
+  for(const Relocation& reloc : m_relocs){
+    if(m_defs.count(reloc.symbol) == 0 && sym_index.count(reloc.symbol) == 0){
+      add_symbol(reloc.symbol, STB_GLOBAL, SHN_UNDEF, 0);
+    }
+  }
+
+  // references to local symbols are made relative to their section
+  std::vector<Elf64_Rela> relas;
+  for(const Relocation& reloc : m_relocs){
+    Elf64_Rela rela;
+    rela.r_offset = reloc.offset;
+    rela.r_addend = reloc.addend;
+    unsigned sym = sym_index[reloc.symbol];
+    auto def = m_defs.find(reloc.symbol);
+    if(def != m_defs.end() && !def->second.is_global){
+      Section section = def->second.section;
+      sym = (section == TEXT) ? SYM_TEXT : (section == DATA) ? SYM_DATA : SYM_RODATA;
+      rela.r_addend += def->second.offset;
+    }
+    rela.r_info = ELF64_R_INFO(sym, reloc.type);
+    relas.push_back(rela);
+  }
+  std::vector<Elf64_Rela> rodata_relas;
+  for(const Relocation& reloc : m_table_relocs){
+    Elf64_Rela rela;
+    rela.r_offset = reloc.offset;
+    rela.r_addend = reloc.addend;
+    rela.r_info = ELF64_R_INFO(SYM_TEXT, reloc.type);
+    rodata_relas.push_back(rela);
+  }
+
+  // section headers
+  std::vector<Elf64_Shdr> shdrs(NUM_SECTIONS);
+  memset(shdrs.data(), 0, shdrs.size() * sizeof(Elf64_Shdr));
+  auto set_section = [&](unsigned index, const char* name, uint32_t type, uint64_t flags, uint64_t align){
+    shdrs[index].sh_name = shstrtab.add(name);
+    shdrs[index].sh_type = type;
+    shdrs[index].sh_flags = flags;
+    shdrs[index].sh_addralign = align;
+  };
+  set_section(SHN_TEXT, ".text", SHT_PROGBITS, SHF_ALLOC | SHF_EXECINSTR, 1);
+  set_section(SHN_RELA_TEXT, ".rela.text", SHT_RELA, SHF_INFO_LINK, 8);
+  set_section(SHN_DATA, ".data", SHT_PROGBITS, SHF_WRITE | SHF_ALLOC, m_data_align);
+  set_section(SHN_BSS, ".bss", SHT_NOBITS, SHF_WRITE | SHF_ALLOC, 1);
+  set_section(SHN_RODATA, ".rodata", SHT_PROGBITS, SHF_ALLOC, m_rodata_align);
+  set_section(SHN_RELA_RODATA, ".rela.rodata", SHT_RELA, SHF_INFO_LINK, 8);
+  set_section(SHN_NOTE_GNU_STACK, ".note.GNU-stack", SHT_PROGBITS, 0, 1);
+  set_section(SHN_SYMTAB, ".symtab", SHT_SYMTAB, 0, 8);
+  set_section(SHN_STRTAB, ".strtab", SHT_STRTAB, 0, 1);
+  set_section(SHN_SHSTRTAB, ".shstrtab", SHT_STRTAB, 0, 1);
+  shdrs[SHN_RELA_TEXT].sh_link = SHN_SYMTAB;
+  shdrs[SHN_RELA_TEXT].sh_info = SHN_TEXT;
+  shdrs[SHN_RELA_TEXT].sh_entsize = sizeof(Elf64_Rela);
+  shdrs[SHN_RELA_RODATA].sh_link = SHN_SYMTAB;
+  shdrs[SHN_RELA_RODATA].sh_info = SHN_RODATA;
+  shdrs[SHN_RELA_RODATA].sh_entsize = sizeof(Elf64_Rela);
+  shdrs[SHN_SYMTAB].sh_link = SHN_STRTAB;
+  shdrs[SHN_SYMTAB].sh_info = first_global;
+  shdrs[SHN_SYMTAB].sh_entsize = sizeof(Elf64_Sym);
+
+  // section contents follow the ELF header, section headers come last
+  std::vector<uint8_t> image(sizeof(Elf64_Ehdr), 0);
+  auto place = [&](unsigned index, const uint8_t* data, size_t size){
+    align_to(image, shdrs[index].sh_addralign);
+    shdrs[index].sh_offset = image.size();
+    shdrs[index].sh_size = size;
+    image.insert(image.end(), data, data + size);
+  };
+  place(SHN_TEXT, m_text.data(), m_text.size());
+  place(SHN_RELA_TEXT, reinterpret_cast<const uint8_t*>(relas.data()), relas.size() * sizeof(Elf64_Rela));
+  place(SHN_DATA, m_data.data(), m_data.size());
+  place(SHN_BSS, nullptr, 0);
+  place(SHN_RODATA, m_rodata.data(), m_rodata.size());
+  place(SHN_RELA_RODATA, reinterpret_cast<const uint8_t*>(rodata_relas.data()), rodata_relas.size() * sizeof(Elf64_Rela));
+  place(SHN_NOTE_GNU_STACK, nullptr, 0);
+  place(SHN_SYMTAB, reinterpret_cast<const uint8_t*>(syms.data()), syms.size() * sizeof(Elf64_Sym));
+  place(SHN_STRTAB, strtab.get_data().data(), strtab.get_data().size());
+  // (the section names must all be added before .shstrtab is placed)
+  place(SHN_SHSTRTAB, shstrtab.get_data().data(), shstrtab.get_data().size());
+
+  align_to(image, 8);
+  Elf64_Ehdr ehdr;
+  memset(&ehdr, 0, sizeof(ehdr));
+  memcpy(ehdr.e_ident, ELFMAG, SELFMAG);
+  ehdr.e_ident[EI_CLASS] = ELFCLASS64;
+  ehdr.e_ident[EI_DATA] = ELFDATA2LSB;
+  ehdr.e_ident[EI_VERSION] = EV_CURRENT;
+  ehdr.e_ident[EI_OSABI] = ELFOSABI_NONE;
+  ehdr.e_type = ET_REL;
+  ehdr.e_machine = EM_X86_64;
+  ehdr.e_version = EV_CURRENT;
+  ehdr.e_shoff = image.size();
+  ehdr.e_ehsize = sizeof(Elf64_Ehdr);
+  ehdr.e_shentsize = sizeof(Elf64_Shdr);
+  ehdr.e_shnum = NUM_SECTIONS;
+  ehdr.e_shstrndx = SHN_SHSTRTAB;
+  memcpy(image.data(), &ehdr, sizeof(ehdr));
+  for(const Elf64_Shdr& shdr : shdrs){
+    append_struct(image, shdr);
+  }
+
+  if(fwrite(image.data(), 1, image.size(), out) != image.size()){
+    RuntimeError::raise("error writing object file");
+  }
+}
+
+void ElfObjectWriter::define(const std::string& name, Section section, uint64_t offset, bool is_global){
+  if(m_defs.count(name) > 0){
+    RuntimeError::raise("symbol %s defined more than once", name.c_str());
+  }
+  m_defs[name] = { section, offset, is_global };
+  m_def_order.push_back(name);
+}
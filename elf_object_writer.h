@@ -0,0 +1,71 @@
+#ifndef ELF_OBJECT_WRITER_H
+#define ELF_OBJECT_WRITER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "module_collector.h"
+#include "x86_encoder.h"
+
+// Implementation of ModuleCollector which assembles low-level code
+// directly into a relocatable ELF64 object file, instead of printing
+// it for the system assembler.
+//
+// Functions go in .text, global variables in .data, and string
+// constants and jump tables in .rodata. Jumps to labels and functions
+// defined in the module are resolved here (using the short form when
+// the target is close enough); calls, jumps to external functions,
+// addresses of string constants and the entries of jump tables (which
+// are absolute addresses in .text) become relocations. The object file
+// is written by write(), once every function has been collected, since
+// jumps may refer to functions which come later.
+class ElfObjectWriter : public ModuleCollector{
+private:
+  enum Section{
+    TEXT,
+    DATA,
+    RODATA,
+  };
+
+  struct Definition{
+    Section section;
+    uint64_t offset;        // for TEXT, the index of the instruction until layout()
+    bool is_global;
+  };
+
+  struct Relocation{
+    uint64_t offset;        // offset in .text (or .rodata, for a jump table entry)
+    std::string symbol;
+    X86RelocType type;
+    int64_t addend;
+  };
+
+  X86Encoder m_encoder;
+  std::vector<X86Encoding> m_code;
+  std::map<std::string, unsigned> m_labels;
+  std::vector<uint8_t> m_text, m_data, m_rodata;
+  unsigned m_data_align, m_rodata_align;
+  std::map<std::string, Definition> m_defs;
+  std::vector<std::string> m_def_order;
+  std::vector<Relocation> m_relocs;
+  std::vector<Relocation> m_table_relocs;   // symbol is the label of the entry
+
+public:
+  ElfObjectWriter();
+  virtual ~ElfObjectWriter();
+
+  virtual void collect_string_constant(const std::string& name, const std::string& strval);
+  virtual void collect_global_var(const std::string& name, const std::shared_ptr<Type>& type);
+  virtual void collect_function(const std::string& name, const std::shared_ptr<InstructionSequence>& iseq);
+
+  void write(FILE* out);
+
+private:
+  void layout();
+  void define(const std::string& name, Section section, uint64_t offset, bool is_global);
+};
+
+#endif // ELF_OBJECT_WRITER_H
@@ -0,0 +1,325 @@
+#include <cassert>
+#include <cstring>
+#include "yyerror.h"
+#include "phase_timer.h"
+#include "fast_lexer.h"
+
+namespace{
+
+  enum CharClass{
+    CC_IDENT = 1,           // [A-Za-z_0-9]
+    CC_DIGIT = 2,           // [0-9]
+    CC_HEX_DIGIT = 4,       // [0-9A-Fa-f]
+    CC_INT_SUFFIX = 8,      // [ULul]
+    CC_SPACE = 16,          // [ \t\r]
+  };
+
+  struct Keyword{
+    const char* name;
+    unsigned len;
+    int tag;
+  };
+
+  // Keywords are all 2 to 8 characters long, and the combination of
+  // their length, first character and last character is enough to
+  // tell them apart: KeywordTable's constructor checks that the hash
+  // below maps each of them to a different slot.
+  const unsigned KEYWORD_TABLE_SIZE = 64;
+
+  unsigned keyword_hash(const char* s, unsigned len){
+    return (len + 9 * (unsigned char) s[0] + 6 * (unsigned char) s[len - 1]) & (KEYWORD_TABLE_SIZE - 1);
+  }
+
+  struct ScannerTables{
+    unsigned char char_class[256];
+    Keyword keywords[KEYWORD_TABLE_SIZE];
+
+    ScannerTables(){
+      memset(char_class, 0, sizeof(char_class));
+      for(int c = 0; c < 256; c++){
+        if(c == '_' || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9'))
+          char_class[c] |= CC_IDENT;
+        if(c >= '0' && c <= '9')
+          char_class[c] |= CC_DIGIT | CC_HEX_DIGIT;
+        if((c >= 'A' && c <= 'F') || (c >= 'a' && c <= 'f'))
+          char_class[c] |= CC_HEX_DIGIT;
+      }
+      for(const char* s = "ULul"; *s; s++)
+        char_class[(unsigned char) *s] |= CC_INT_SUFFIX;
+      for(const char* s = " \t\r"; *s; s++)
+        char_class[(unsigned char) *s] |= CC_SPACE;
+
+      static const Keyword all_keywords[] = {
+        { "if", 2, TOK_IF }, { "else", 4, TOK_ELSE }, { "while", 5, TOK_WHILE },
+        { "for", 3, TOK_FOR }, { "do", 2, TOK_DO }, { "switch", 6, TOK_SWITCH },
+        { "case", 4, TOK_CASE }, { "char", 4, TOK_CHAR }, { "short", 5, TOK_SHORT },
+        { "int", 3, TOK_INT }, { "long", 4, TOK_LONG }, { "unsigned", 8, TOK_UNSIGNED },
+        { "signed", 6, TOK_SIGNED }, { "float", 5, TOK_FLOAT }, { "double", 6, TOK_DOUBLE },
+        { "void", 4, TOK_VOID }, { "return", 6, TOK_RETURN }, { "break", 5, TOK_BREAK },
+        { "continue", 8, TOK_CONTINUE }, { "static", 6, TOK_STATIC }, { "extern", 6, TOK_EXTERN },
+        { "auto", 4, TOK_AUTO }, { "const", 5, TOK_CONST }, { "volatile", 8, TOK_VOLATILE },
+        { "struct", 6, TOK_STRUCT }, { "union", 5, TOK_UNION }, { "default", 7, TOK_DEFAULT },
+      };
+      memset(keywords, 0, sizeof(keywords));
+      for(const Keyword& kw : all_keywords){
+        Keyword& slot = keywords[keyword_hash(kw.name, kw.len)];
+        assert(slot.name == nullptr);
+        slot = kw;
+      }
+    }
+
+    bool is(char c, unsigned cc) const{
+      return (char_class[(unsigned char) c] & cc) != 0;
+    }
+
+    int lookup_ident(const char* s, unsigned len) const{
+      if(len >= 2 && len <= 8){
+        const Keyword& kw = keywords[keyword_hash(s, len)];
+        if(kw.len == len && memcmp(kw.name, s, len) == 0)
+          return kw.tag;
+      }
+      return TOK_IDENT;
+    }
+  };
+
+  const ScannerTables tables;
+
+}
+
+FastLexer::FastLexer(ParserState* pp)
+  : m_pp(pp)
+  , m_pos(pp->source->get_data())
+  , m_end(pp->source->get_data() + pp->source->get_size()){
+}
+
+FastLexer::~FastLexer(){
+}
+
+// Note that the source buffer has two NUL bytes after its contents,
+// so the scanner can always look at the two characters following
+// the one at m_pos without checking for the end of the input. NUL
+// isn't part of any token, so it stops every loop below.
+int FastLexer::next_token(YYSTYPE* semantic_value){
+  for(;;){
+    const char* p = m_pos;
+    if(p >= m_end){
+      return 0;
+    }
+
+    switch(*p){
+    case ' ': case '\t': case '\r':{
+      const char* q = p + 1;
+      while(tables.is(*q, CC_SPACE))
+        q++;
+      m_pp->cur_loc.advance(int(q - p));
+      m_pos = q;
+      continue;
+    }
+
+    case '\n':
+      m_pp->cur_loc.next_line();
+      m_pos = p + 1;
+      continue;
+
+    case '(': return create_token(TOK_LPAREN, p + 1, semantic_value);
+    case ')': return create_token(TOK_RPAREN, p + 1, semantic_value);
+    case '[': return create_token(TOK_LBRACKET, p + 1, semantic_value);
+    case ']': return create_token(TOK_RBRACKET, p + 1, semantic_value);
+    case '{': return create_token(TOK_LBRACE, p + 1, semantic_value);
+    case '}': return create_token(TOK_RBRACE, p + 1, semantic_value);
+    case ';': return create_token(TOK_SEMICOLON, p + 1, semantic_value);
+    case ':': return create_token(TOK_COLON, p + 1, semantic_value);
+    case ',': return create_token(TOK_COMMA, p + 1, semantic_value);
+    case '.': return create_token(TOK_DOT, p + 1, semantic_value);
+    case '?': return create_token(TOK_QUESTION, p + 1, semantic_value);
+    case '~': return create_token(TOK_BITWISE_COMPL, p + 1, semantic_value);
+
+    case '!':
+      if(p[1] == '=') return create_token(TOK_INEQUALITY, p + 2, semantic_value);
+      return create_token(TOK_NOT, p + 1, semantic_value);
+    case '=':
+      if(p[1] == '=') return create_token(TOK_EQUALITY, p + 2, semantic_value);
+      return create_token(TOK_ASSIGN, p + 1, semantic_value);
+    case '+':
+      if(p[1] == '+') return create_token(TOK_INCREMENT, p + 2, semantic_value);
+      if(p[1] == '=') return create_token(TOK_ADD_ASSIGN, p + 2, semantic_value);
+      return create_token(TOK_PLUS, p + 1, semantic_value);
+    case '-':
+      if(p[1] == '-') return create_token(TOK_DECREMENT, p + 2, semantic_value);
+      if(p[1] == '=') return create_token(TOK_SUB_ASSIGN, p + 2, semantic_value);
+      if(p[1] == '>') return create_token(TOK_ARROW, p + 2, semantic_value);
+      return create_token(TOK_MINUS, p + 1, semantic_value);
+    case '*':
+      if(p[1] == '=') return create_token(TOK_MUL_ASSIGN, p + 2, semantic_value);
+      return create_token(TOK_ASTERISK, p + 1, semantic_value);
+    case '%':
+      if(p[1] == '=') return create_token(TOK_MOD_ASSIGN, p + 2, semantic_value);
+      return create_token(TOK_MOD, p + 1, semantic_value);
+    case '^':
+      if(p[1] == '=') return create_token(TOK_XOR_ASSIGN, p + 2, semantic_value);
+      return create_token(TOK_BITWISE_XOR, p + 1, semantic_value);
+    case '&':
+      if(p[1] == '&') return create_token(TOK_LOGICAL_AND, p + 2, semantic_value);
+      if(p[1] == '=') return create_token(TOK_AND_ASSIGN, p + 2, semantic_value);
+      return create_token(TOK_AMPERSAND, p + 1, semantic_value);
+    case '|':
+      if(p[1] == '|') return create_token(TOK_LOGICAL_OR, p + 2, semantic_value);
+      if(p[1] == '=') return create_token(TOK_OR_ASSIGN, p + 2, semantic_value);
+      return create_token(TOK_BITWISE_OR, p + 1, semantic_value);
+    case '<':
+      if(p[1] == '<' && p[2] == '=') return create_token(TOK_LEFT_ASSIGN, p + 3, semantic_value);
+      if(p[1] == '<') return create_token(TOK_LEFT_SHIFT, p + 2, semantic_value);
+      if(p[1] == '=') return create_token(TOK_LTE, p + 2, semantic_value);
+      return create_token(TOK_LT, p + 1, semantic_value);
+    case '>':
+      if(p[1] == '>' && p[2] == '=') return create_token(TOK_RIGHT_ASSIGN, p + 3, semantic_value);
+      if(p[1] == '>') return create_token(TOK_RIGHT_SHIFT, p + 2, semantic_value);
+      if(p[1] == '=') return create_token(TOK_GTE, p + 2, semantic_value);
+      return create_token(TOK_GT, p + 1, semantic_value);
+
+    case '/':
+      if(p[1] == '*'){
+        skip_block_comment();
+        continue;
+      }
+      if(p[1] == '/'){
+        // like lex.l, a // comment must end with a newline,
+        // otherwise the slashes are scanned as operators
+        const char* nl = static_cast<const char*>(memchr(p + 2, '\n', m_end - (p + 2)));
+        if(nl != nullptr){
+          m_pp->cur_loc.next_line();
+          m_pos = nl + 1;
+          continue;
+        }
+      }
+      if(p[1] == '=') return create_token(TOK_DIV_ASSIGN, p + 2, semantic_value);
+      return create_token(TOK_DIVIDE, p + 1, semantic_value);
+
+    case '"':{
+      // \"([^\\\"]|\\.)*\"
+      const char* q = p + 1;
+      while(q < m_end && *q != '"'){
+        if(*q == '\\'){
+          if(q + 1 >= m_end || q[1] == '\n')
+            break;
+          q++;
+        }
+        q++;
+      }
+      if(q < m_end && *q == '"')
+        return create_token(TOK_STR_LIT, q + 1, semantic_value);
+      break;
+    }
+
+    case '\'':{
+      // '(\\.|[^\\'\n])'
+      const char* q = p + 1;
+      if(*q == '\\' && q[1] != '\n' && q + 1 < m_end)
+        q += 2;
+      else if(q < m_end && *q != '\'' && *q != '\\' && *q != '\n')
+        q++;
+      else
+        break;
+      if(q < m_end && *q == '\'')
+        return create_token(TOK_CHAR_LIT, q + 1, semantic_value);
+      break;
+    }
+
+    case '0': case '1': case '2': case '3': case '4':
+    case '5': case '6': case '7': case '8': case '9':
+      return scan_number(semantic_value);
+
+    default:
+      if(tables.is(*p, CC_IDENT)){
+        // digits were handled above, so this is [A-Za-z_]
+        const char* q = p + 1;
+        while(tables.is(*q, CC_IDENT))
+          q++;
+        return create_token(tables.lookup_ident(p, unsigned(q - p)), q, semantic_value);
+      }
+      break;
+    }
+
+    yyerror(m_pp, "Unrecognized character");
+  }
+}
+
+// Creates a token for the lexeme from m_pos up to (but not
+// including) end, exactly as create_token() in lex.l does
+int FastLexer::create_token(int token_tag, const char* end, YYSTYPE* semantic_value){
+  const char* lexeme = m_pos;
+  unsigned offset = unsigned(lexeme - m_pp->source->get_data());
+  unsigned len = unsigned(end - lexeme);
+  Node* tok = new Node(token_tag, m_pp->source, offset, len);
+  tok->set_loc(m_pp->cur_loc);
+
+  semantic_value->node = tok;
+
+  m_pp->cur_loc.advance(int(len));
+  m_pos = end;
+
+  // keep track of the Nodes created by the lexer
+  m_pp->tokens.push_back(tok);
+
+  return token_tag;
+}
+
+// Skips the comment starting at m_pos. As in lex.l, a comment which
+// is never closed extends to the end of the input.
+void FastLexer::skip_block_comment(){
+  const char* start = m_pos;
+  const char* body = start + 2;
+
+  // find the closing */
+  const char* stop = m_end;
+  const char* s = body;
+  while((s = static_cast<const char*>(memchr(s, '*', m_end - s))) != nullptr){
+    if(s[1] == '/'){
+      stop = s + 2;
+      break;
+    }
+    s++;
+  }
+
+  // the location is advanced past each character of the comment,
+  // and moves to the next line at each newline
+  const char* line_start = nullptr;
+  for(const char* nl = body; (nl = static_cast<const char*>(memchr(nl, '\n', stop - nl))) != nullptr; nl++){
+    m_pp->cur_loc.next_line();
+    line_start = nl + 1;
+  }
+  m_pp->cur_loc.advance(int(stop - (line_start != nullptr ? line_start : start)));
+
+  m_pos = stop;
+}
+
+// [0-9]+[ULul]*  0[Xx][0-9A-Fa-f]+[ULul]*  [0-9]+\.[0-9]*[Ff]?
+int FastLexer::scan_number(YYSTYPE* semantic_value){
+  const char* p = m_pos;
+  const char* q;
+  if(p[0] == '0' && (p[1] == 'x' || p[1] == 'X') && tables.is(p[2], CC_HEX_DIGIT)){
+    q = p + 3;
+    while(tables.is(*q, CC_HEX_DIGIT))
+      q++;
+  } else{
+    q = p + 1;
+    while(tables.is(*q, CC_DIGIT))
+      q++;
+    if(*q == '.'){
+      q++;
+      while(tables.is(*q, CC_DIGIT))
+        q++;
+      if(*q == 'F' || *q == 'f')
+        q++;
+      return create_token(TOK_FP_LIT, q, semantic_value);
+    }
+  }
+  while(tables.is(*q, CC_INT_SUFFIX))
+    q++;
+  return create_token(TOK_INT_LIT, q, semantic_value);
+}
+
+int yylex(YYSTYPE* semantic_value, void* scanner){
+  FineGrainedPhaseScope phase(Phase::SCAN);
+  return static_cast<FastLexer*>(scanner)->next_token(semantic_value);
+}
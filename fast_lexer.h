@@ -0,0 +1,43 @@
+#ifndef FAST_LEXER_H
+#define FAST_LEXER_H
+
+#include "node.h"
+#include "parse.tab.h"
+#include "parser_state.h"
+
+// FastLexer is a hand-written replacement for the flex-generated
+// scanner in lex.yy.cpp, used when the compiler is built with
+// "make LEXER=fast". It recognizes exactly the same tokens as lex.l
+// (with the same tags, lexemes and locations), but as a direct-coded
+// DFA over the source buffer: each token is recognized by a switch on
+// its first character, comments are skipped by searching for their
+// terminators with memchr, and keywords are recognized with a perfect
+// hash rather than by separate automaton states.
+class FastLexer{
+private:
+  ParserState* m_pp;
+  const char* m_pos;
+  const char* m_end;
+
+  // value semantics are not allowed
+  FastLexer(const FastLexer&);
+  FastLexer& operator=(const FastLexer&);
+
+public:
+  // scans pp->source, which must be set
+  FastLexer(ParserState* pp);
+  ~FastLexer();
+
+  // returns the tag of the next token, or 0 at the end of the input
+  int next_token(YYSTYPE* semantic_value);
+
+private:
+  int create_token(int token_tag, const char* lexeme, YYSTYPE* semantic_value);
+  void skip_block_comment();
+  int scan_number(YYSTYPE* semantic_value);
+};
+
+// Entry point called by the parser; scanner is the FastLexer
+int yylex(YYSTYPE* semantic_value, void* scanner);
+
+#endif // FAST_LEXER_H
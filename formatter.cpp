@@ -1,5 +1,6 @@
 #include <stdexcept>
 #include "cpputil.h"
+#include "output_buffer.h"
 #include "formatter.h"
 
 Formatter::Formatter() {
@@ -26,3 +27,29 @@ std::string Formatter::format_operand(const Operand &operand) const {
     }
   }
 }
+
+void Formatter::write_operand(const Operand &operand, OutputBuffer &out) const {
+  switch (operand.get_kind()) {
+  case Operand::IMM_IVAL:
+    out.append('$');
+    out.append_int(operand.get_imm_ival());
+    break;
+
+  case Operand::LABEL:
+    out.append(operand.get_label());
+    break;
+
+  case Operand::IMM_LABEL:
+    out.append('$');
+    out.append(operand.get_label());
+    break;
+
+  default:
+    out.append(format_operand(operand));
+    break;
+  }
+}
+
+void Formatter::write_instruction(const Instruction *ins, OutputBuffer &out) const {
+  out.append(format_instruction(ins));
+}
@@ -3,6 +3,7 @@
 
 #include "operand.h"
 class Instruction;
+class OutputBuffer;
 
 // A Formatter turns Operand and Instruction objects into
 // strings, which in turn allows high-level and low-level code
@@ -17,6 +18,12 @@ public:
   virtual std::string format_operand(const Operand &operand) const;
 
   virtual std::string format_instruction(const Instruction *ins) const = 0;
+
+  // Write an operand or instruction directly to an OutputBuffer.
+  // The default implementations append the formatted string; a
+  // subclass can override them to avoid the temporary strings.
+  virtual void write_operand(const Operand &operand, OutputBuffer &out) const;
+  virtual void write_instruction(const Instruction *ins, OutputBuffer &out) const;
 };
 
 #endif // FORMATTER_H
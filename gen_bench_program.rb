@@ -0,0 +1,157 @@
+#! /usr/bin/env ruby
+
+# Generate a synthetic C program for measuring how fast the compiler
+# is. The program uses only the subset of C the compiler supports, and
+# its size and shape are controlled by the options below. The same
+# options and seed always produce the same program.
+#
+# Usage: ./gen_bench_program.rb [options] > program.c
+#   -f N   number of functions (default 20)
+#   -s N   statements per function, counting nested ones (default 20)
+#   -d N   maximum nesting depth of if/while/for statements (default 3)
+#   -S N   number of struct types (default 2)
+#   -l N   number of string literals (default 10)
+#   -r N   random seed (default 1)
+
+require 'optparse'
+
+opts = { functions: 20, statements: 20, depth: 3, structs: 2, strings: 10, seed: 1 }
+OptionParser.new do |p|
+  p.on('-f N', Integer) { |n| opts[:functions] = n }
+  p.on('-s N', Integer) { |n| opts[:statements] = n }
+  p.on('-d N', Integer) { |n| opts[:depth] = n }
+  p.on('-S N', Integer) { |n| opts[:structs] = n }
+  p.on('-l N', Integer) { |n| opts[:strings] = n }
+  p.on('-r N', Integer) { |n| opts[:seed] = n }
+end.parse!
+
+NUM_VARS = 6
+NUM_FIELDS = 4
+ARRAY_LEN = 8
+
+$rng = Random.new(opts[:seed])
+$out = []
+
+def rand_var
+  "v#{$rng.rand(NUM_VARS)}"
+end
+
+# an int-valued expression, which may call any function defined so far
+def gen_expr(depth, fn_index, struct_index)
+  if depth <= 0 || $rng.rand(3) == 0
+    case $rng.rand(4)
+    when 0 then return $rng.rand(100).to_s
+    when 1 then return "a[#{$rng.rand(ARRAY_LEN)}]"
+    when 2 then return struct_index ? "s.f#{$rng.rand(NUM_FIELDS)}" : rand_var
+    else return rand_var
+    end
+  end
+  if fn_index > 0 && $rng.rand(6) == 0
+    return "fn#{$rng.rand(fn_index)}(#{gen_expr(depth - 1, fn_index, struct_index)})"
+  end
+  op = ['+', '-', '*', '/', '%'][$rng.rand(5)]
+  rhs = gen_expr(depth - 1, fn_index, struct_index)
+  # only divide by nonzero constants
+  rhs = (1 + $rng.rand(9)).to_s if op == '/' || op == '%'
+  "(#{gen_expr(depth - 1, fn_index, struct_index)} #{op} #{rhs})"
+end
+
+def gen_cond(fn_index, struct_index)
+  op = ['<', '<=', '>', '>=', '=='][$rng.rand(5)]
+  "#{rand_var} #{op} #{gen_expr(1, fn_index, struct_index)}"
+end
+
+# Generate statements into lines, using up budget[0] statements
+def gen_block(indent, depth, budget, ctx)
+  lines = []
+  loop do
+    break if budget[0] <= 0
+    budget[0] -= 1
+    pad = '  ' * indent
+    kind = $rng.rand(depth > 0 ? 7 : 4)
+    case kind
+    when 0, 1
+      lines << "#{pad}#{rand_var} = #{gen_expr(2, ctx[:fn_index], ctx[:struct_index])};"
+    when 2
+      lines << "#{pad}a[#{$rng.rand(ARRAY_LEN)}] = #{gen_expr(2, ctx[:fn_index], ctx[:struct_index])};"
+    when 3
+      if ctx[:struct_index]
+        lines << "#{pad}s.f#{$rng.rand(NUM_FIELDS)} = #{gen_expr(2, ctx[:fn_index], ctx[:struct_index])};"
+      elsif !ctx[:strings].empty?
+        lines << "#{pad}printf(#{ctx[:strings][$rng.rand(ctx[:strings].size)]}, #{rand_var});"
+      else
+        lines << "#{pad}#{rand_var} = #{rand_var} + 1;"
+      end
+    when 4
+      lines << "#{pad}if (#{gen_cond(ctx[:fn_index], ctx[:struct_index])}) {"
+      lines.concat(gen_block(indent + 1, depth - 1, [[budget[0], 1 + $rng.rand(4)].min], ctx))
+      lines << "#{pad}} else {"
+      lines.concat(gen_block(indent + 1, depth - 1, [[budget[0], 1 + $rng.rand(4)].min], ctx))
+      lines << "#{pad}}"
+    when 5
+      # loops run a bounded number of times: each nesting level has
+      # its own counter, which the loop body doesn't assign
+      v = "i#{depth - 1}"
+      lines << "#{pad}#{v} = 0;"
+      lines << "#{pad}while (#{v} < #{1 + $rng.rand(10)}) {"
+      lines.concat(gen_block(indent + 1, depth - 1, [[budget[0], 1 + $rng.rand(4)].min], ctx))
+      lines << "#{pad}  #{v} = #{v} + 1;"
+      lines << "#{pad}}"
+    else
+      v = "i#{depth - 1}"
+      lines << "#{pad}for (#{v} = 0; #{v} < #{1 + $rng.rand(10)}; #{v} = #{v} + 1) {"
+      lines.concat(gen_block(indent + 1, depth - 1, [[budget[0], 1 + $rng.rand(4)].min], ctx))
+      lines << "#{pad}}"
+    end
+  end
+  lines
+end
+
+$out << "int printf(const char *fmt, int n);"
+$out << ''
+
+opts[:structs].times do |i|
+  $out << "struct s#{i} {"
+  NUM_FIELDS.times { |j| $out << "  int f#{j};" }
+  $out << '};'
+  $out << ''
+end
+
+$out << "int g[#{ARRAY_LEN}];"
+$out << ''
+
+strings = []
+opts[:strings].times do |i|
+  strings << "\"string #{i}: %d\\n\""
+end
+
+opts[:functions].times do |i|
+  struct_index = opts[:structs] > 0 ? i % opts[:structs] : nil
+  # distribute the string literals among the functions
+  per_fn = (strings.size + opts[:functions] - 1) / [opts[:functions], 1].max
+  ctx = { fn_index: i, struct_index: struct_index,
+          strings: strings[i * per_fn, per_fn] || [] }
+
+  $out << "int fn#{i}(int p) {"
+  NUM_VARS.times { |j| $out << "  int v#{j};" }
+  opts[:depth].times { |j| $out << "  int i#{j};" }
+  $out << "  int a[#{ARRAY_LEN}];"
+  $out << "  struct s#{struct_index} s;" if struct_index
+  NUM_VARS.times { |j| $out << "  v#{j} = p + #{j};" }
+  ARRAY_LEN.times { |j| $out << "  a[#{j}] = #{j};" }
+  NUM_FIELDS.times { |j| $out << "  s.f#{j} = #{j};" } if struct_index
+  ctx[:strings].each { |s| $out << "  printf(#{s}, v0);" }
+  $out.concat(gen_block(1, opts[:depth], [opts[:statements]], ctx))
+  $out << "  return v#{$rng.rand(NUM_VARS)} + a[0];"
+  $out << '}'
+  $out << ''
+end
+
+$out << 'int main(void) {'
+$out << '  int r;'
+$out << '  r = 0;'
+opts[:functions].times { |i| $out << "  r = r + fn#{i}(#{i});" }
+$out << '  return r % 256;'
+$out << '}'
+
+puts $out.join("\n")
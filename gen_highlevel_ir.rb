@@ -11,7 +11,8 @@ ARITH = [
   :div,
   :mod,
   :lshift,
-  :rshift,
+  :rshift,    # Arithmetic right shift (signed left operand)
+  :urshift,   # Logical right shift (unsigned left operand)
 
   # Integer comparisons to compute a boolean value:
   # note that all of these assign to a destination vreg
@@ -84,6 +85,11 @@ OPCODES = [
   :jmp,
   :call,
 
+  # Call a function in tail position: the stack frame is torn down
+  # first, and control transfers to the callee with a jump, so that
+  # the callee returns directly to our caller.
+  :tailcall,
+
   # Enter the stack frame. Allocates specified amount of local storage.
   :enter,
 
@@ -98,6 +104,26 @@ OPCODES = [
   # conditional jump
   :cjmp_t,    # conditional jump if boolean is true
   :cjmp_f,    # conditional jump if boolean is false
+
+  # Choose between two values by a boolean (which must be 0 or 1):
+  # select dest, cond, if_true, if_false
+  *SIZES.map { |s| "select_#{s}".to_sym },
+
+  # Multiway jump: jmptab index, default_label
+  # jumps to entry index (a quad, compared unsigned) of the table of
+  # labels carried by the instruction, or to the default label if the
+  # index is past the end of the table
+  :jmptab,
+
+  # Vector (SSE2) operations on 16 byte vectors of longs or quads. A
+  # vector vreg takes up two vreg numbers, its own and the next one
+  # (which isn't otherwise used), and vmov can load or store a vector
+  # from or to memory, which needn't be aligned.
+  #   vmov dest, src
+  #   vdup dest, src              set each element to the scalar src
+  #   vadd dest, left, right      (likewise vsub, vand, vor, vxor)
+  #   vsum dest, src              set the scalar dest to the sum of the elements
+  *([:vmov, :vdup, :vadd, :vsub, :vand, :vor, :vxor, :vsum].product([:l, :q]).map { |pair| "#{pair[0]}_#{pair[1]}".to_sym }),
 ]
 
 $opcode_names = OPCODES.map { |sym| "HINS_#{sym.to_s}" }
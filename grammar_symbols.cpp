@@ -54,6 +54,7 @@ const char *s_grammar_symbol_names[] = {
   "TOK_DO",
   "TOK_SWITCH",
   "TOK_CASE",
+  "TOK_DEFAULT",
   "TOK_CHAR",
   "TOK_SHORT",
   "TOK_INT",
@@ -131,7 +132,7 @@ const char *get_grammar_symbol_name(int tag) {
   if (tag < 1000) {
     // must be a token
     int which_token = tag - 258;
-    if (which_token >= 77) {
+    if (which_token >= 78) {
       return NULL;
     } else {
       return s_grammar_symbol_names[which_token];
@@ -142,7 +143,7 @@ const char *get_grammar_symbol_name(int tag) {
   if (which_production >= 41) {
     return NULL;
   }
-  return s_grammar_symbol_names[77 + which_production];
+  return s_grammar_symbol_names[78 + which_production];
 }
 
 ParseTreePrint::ParseTreePrint() {
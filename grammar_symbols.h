@@ -56,6 +56,7 @@ enum GrammarSymbol {
   NODE_TOK_DO,
   NODE_TOK_SWITCH,
   NODE_TOK_CASE,
+  NODE_TOK_DEFAULT,
   NODE_TOK_CHAR,
   NODE_TOK_SHORT,
   NODE_TOK_INT,
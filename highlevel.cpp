@@ -34,6 +34,10 @@ const char *highlevel_opcode_to_str(HighLevelOpcode opcode) {
   case HINS_rshift_w:   return "rshift_w";
   case HINS_rshift_l:   return "rshift_l";
   case HINS_rshift_q:   return "rshift_q";
+  case HINS_urshift_b:  return "urshift_b";
+  case HINS_urshift_w:  return "urshift_w";
+  case HINS_urshift_l:  return "urshift_l";
+  case HINS_urshift_q:  return "urshift_q";
   case HINS_cmplt_b:    return "cmplt_b";
   case HINS_cmplt_w:    return "cmplt_w";
   case HINS_cmplt_l:    return "cmplt_l";
@@ -109,11 +113,33 @@ const char *highlevel_opcode_to_str(HighLevelOpcode opcode) {
   case HINS_ret:        return "ret";
   case HINS_jmp:        return "jmp";
   case HINS_call:       return "call";
+  case HINS_tailcall:   return "tailcall";
   case HINS_enter:      return "enter";
   case HINS_leave:      return "leave";
   case HINS_localaddr:  return "localaddr";
   case HINS_cjmp_t:     return "cjmp_t";
   case HINS_cjmp_f:     return "cjmp_f";
+  case HINS_select_b:   return "select_b";
+  case HINS_select_w:   return "select_w";
+  case HINS_select_l:   return "select_l";
+  case HINS_select_q:   return "select_q";
+  case HINS_jmptab:     return "jmptab";
+  case HINS_vmov_l:     return "vmov_l";
+  case HINS_vmov_q:     return "vmov_q";
+  case HINS_vdup_l:     return "vdup_l";
+  case HINS_vdup_q:     return "vdup_q";
+  case HINS_vadd_l:     return "vadd_l";
+  case HINS_vadd_q:     return "vadd_q";
+  case HINS_vsub_l:     return "vsub_l";
+  case HINS_vsub_q:     return "vsub_q";
+  case HINS_vand_l:     return "vand_l";
+  case HINS_vand_q:     return "vand_q";
+  case HINS_vor_l:      return "vor_l";
+  case HINS_vor_q:      return "vor_q";
+  case HINS_vxor_l:     return "vxor_l";
+  case HINS_vxor_q:     return "vxor_q";
+  case HINS_vsum_l:     return "vsum_l";
+  case HINS_vsum_q:     return "vsum_q";
   default: return nullptr;
   } // end switch
 } // end opcode_to_str function
@@ -149,6 +175,10 @@ int highlevel_opcode_get_source_operand_size(HighLevelOpcode opcode) {
   case HINS_rshift_w: return 2;
   case HINS_rshift_l: return 4;
   case HINS_rshift_q: return 8;
+  case HINS_urshift_b: return 1;
+  case HINS_urshift_w: return 2;
+  case HINS_urshift_l: return 4;
+  case HINS_urshift_q: return 8;
   case HINS_cmplt_b: return 1;
   case HINS_cmplt_w: return 2;
   case HINS_cmplt_l: return 4;
@@ -224,11 +254,33 @@ int highlevel_opcode_get_source_operand_size(HighLevelOpcode opcode) {
   case HINS_ret: return 0;
   case HINS_jmp: return 0;
   case HINS_call: return 0;
+  case HINS_tailcall: return 0;
   case HINS_enter: return 0;
   case HINS_leave: return 0;
   case HINS_localaddr: return 0;
   case HINS_cjmp_t: return 0;
   case HINS_cjmp_f: return 0;
+  case HINS_select_b: return 1;
+  case HINS_select_w: return 2;
+  case HINS_select_l: return 4;
+  case HINS_select_q: return 8;
+  case HINS_jmptab: return 0;
+  case HINS_vmov_l: return 4;
+  case HINS_vmov_q: return 8;
+  case HINS_vdup_l: return 4;
+  case HINS_vdup_q: return 8;
+  case HINS_vadd_l: return 4;
+  case HINS_vadd_q: return 8;
+  case HINS_vsub_l: return 4;
+  case HINS_vsub_q: return 8;
+  case HINS_vand_l: return 4;
+  case HINS_vand_q: return 8;
+  case HINS_vor_l: return 4;
+  case HINS_vor_q: return 8;
+  case HINS_vxor_l: return 4;
+  case HINS_vxor_q: return 8;
+  case HINS_vsum_l: return 4;
+  case HINS_vsum_q: return 8;
   default: return 0;
   }
 }
@@ -264,6 +316,10 @@ int highlevel_opcode_get_dest_operand_size(HighLevelOpcode opcode) {
   case HINS_rshift_w: return 2;
   case HINS_rshift_l: return 4;
   case HINS_rshift_q: return 8;
+  case HINS_urshift_b: return 1;
+  case HINS_urshift_w: return 2;
+  case HINS_urshift_l: return 4;
+  case HINS_urshift_q: return 8;
   case HINS_cmplt_b: return 1;
   case HINS_cmplt_w: return 2;
   case HINS_cmplt_l: return 4;
@@ -339,11 +395,33 @@ int highlevel_opcode_get_dest_operand_size(HighLevelOpcode opcode) {
   case HINS_ret: return 0;
   case HINS_jmp: return 0;
   case HINS_call: return 0;
+  case HINS_tailcall: return 0;
   case HINS_enter: return 0;
   case HINS_leave: return 0;
   case HINS_localaddr: return 0;
   case HINS_cjmp_t: return 0;
   case HINS_cjmp_f: return 0;
+  case HINS_select_b: return 1;
+  case HINS_select_w: return 2;
+  case HINS_select_l: return 4;
+  case HINS_select_q: return 8;
+  case HINS_jmptab: return 0;
+  case HINS_vmov_l: return 4;
+  case HINS_vmov_q: return 8;
+  case HINS_vdup_l: return 4;
+  case HINS_vdup_q: return 8;
+  case HINS_vadd_l: return 4;
+  case HINS_vadd_q: return 8;
+  case HINS_vsub_l: return 4;
+  case HINS_vsub_q: return 8;
+  case HINS_vand_l: return 4;
+  case HINS_vand_q: return 8;
+  case HINS_vor_l: return 4;
+  case HINS_vor_q: return 8;
+  case HINS_vxor_l: return 4;
+  case HINS_vxor_q: return 8;
+  case HINS_vsum_l: return 4;
+  case HINS_vsum_q: return 8;
   default: return 0;
   }
 }
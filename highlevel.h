@@ -36,6 +36,10 @@ enum HighLevelOpcode {
   HINS_rshift_w,
   HINS_rshift_l,
   HINS_rshift_q,
+  HINS_urshift_b,
+  HINS_urshift_w,
+  HINS_urshift_l,
+  HINS_urshift_q,
   HINS_cmplt_b,
   HINS_cmplt_w,
   HINS_cmplt_l,
@@ -111,11 +115,33 @@ enum HighLevelOpcode {
   HINS_ret,
   HINS_jmp,
   HINS_call,
+  HINS_tailcall,
   HINS_enter,
   HINS_leave,
   HINS_localaddr,
   HINS_cjmp_t,
   HINS_cjmp_f,
+  HINS_select_b,
+  HINS_select_w,
+  HINS_select_l,
+  HINS_select_q,
+  HINS_jmptab,
+  HINS_vmov_l,
+  HINS_vmov_q,
+  HINS_vdup_l,
+  HINS_vdup_q,
+  HINS_vadd_l,
+  HINS_vadd_q,
+  HINS_vsub_l,
+  HINS_vsub_q,
+  HINS_vand_l,
+  HINS_vand_q,
+  HINS_vor_l,
+  HINS_vor_q,
+  HINS_vxor_l,
+  HINS_vxor_q,
+  HINS_vsum_l,
+  HINS_vsum_q,
 }; // HighLevelOpcode enumeration
 
 // Translate a high-level opcode to its assembler mnemonic.
@@ -7,6 +7,7 @@
 #include "grammar_symbols.h"
 #include "exceptions.h"
 #include "highlevel_codegen.h"
+#include "trace_log.h"
 #include <algorithm>
 
 
@@ -21,6 +22,112 @@ HighLevelOpcode get_opcode(HighLevelOpcode base_opcode, const std::shared_ptr<Ty
   }
 }
 
+namespace{
+
+  // A constant right operand (folded or literal) can be used directly
+  // as an immediate, as long as it fits in the 32 bits an x86-64
+  // instruction can encode
+  bool is_immediate_operand(int tag, Node* operand){
+    std::shared_ptr<LiteralValue> lit = operand->get_lit();
+    if(!lit || tag == TOK_LOGICAL_AND || tag == TOK_LOGICAL_OR){
+      return false;
+    }
+    int64_t value = lit->get_int_value();
+    return value >= INT32_MIN && value <= INT32_MAX;
+  }
+
+  // the most operators an arm of a ?: can have and still be computed
+  // unconditionally (so the ?: becomes a select instead of a branch)
+  const int MAX_SPECULATED_OPS = 2;
+
+  // The number of operators in an expression which can be evaluated
+  // even when its value isn't needed: one which can't trap, has no
+  // side effects and doesn't dereference a pointer. Returns -1 for any
+  // other expression.
+  int get_speculation_cost(Node* n){
+    if(n->get_lit()){
+      return 0;
+    }
+    if(n->get_tag() == AST_VARIABLE_REF){
+      std::shared_ptr<Type> type = n->get_symbol()->get_type();
+      return (type->is_integral() || type->is_pointer()) ? 0 : -1;
+    }
+    int tag = n->get_num_kids() > 0 ? n->get_kid(0)->get_tag() : -1;
+    if(n->get_tag() == AST_UNARY_EXPRESSION && (tag == TOK_MINUS || tag == TOK_NOT || tag == TOK_BITWISE_COMPL)){
+      int cost = get_speculation_cost(n->get_kid(1));
+      return (cost < 0) ? -1 : cost + 1;
+    }
+    if(n->get_tag() == AST_BINARY_EXPRESSION){
+      switch(tag){
+        case TOK_PLUS: case TOK_MINUS: case TOK_ASTERISK:
+        case TOK_LT: case TOK_LTE: case TOK_GT: case TOK_GTE: case TOK_EQUALITY: case TOK_INEQUALITY:
+        case TOK_AMPERSAND: case TOK_BITWISE_OR: case TOK_BITWISE_XOR: case TOK_LEFT_SHIFT: case TOK_RIGHT_SHIFT:{
+          int left = get_speculation_cost(n->get_kid(1));
+          int right = get_speculation_cost(n->get_kid(2));
+          return (left < 0 || right < 0) ? -1 : left + right + 1;
+        }
+        default:
+          break;
+      }
+    }
+    return -1;
+  }
+
+  // whether an expression's value is already 0 or 1
+  bool is_flag_expression(Node* n){
+    int tag = n->get_num_kids() > 0 ? n->get_kid(0)->get_tag() : -1;
+    if(n->get_tag() == AST_UNARY_EXPRESSION){
+      return tag == TOK_NOT;
+    }
+    if(n->get_tag() == AST_BINARY_EXPRESSION){
+      return tag == TOK_LT || tag == TOK_LTE || tag == TOK_GT || tag == TOK_GTE || tag == TOK_EQUALITY
+             || tag == TOK_INEQUALITY || tag == TOK_LOGICAL_AND || tag == TOK_LOGICAL_OR;
+    }
+    return false;
+  }
+
+  // the opcode extending an integer of one size to a wider one
+  HighLevelOpcode get_extend_opcode(unsigned from, unsigned to, bool is_signed){
+    int index;
+    if(from == 1){
+      index = (to == 2) ? 0 : (to == 4) ? 1 : 2;
+    } else if(from == 2){
+      index = (to == 4) ? 3 : 4;
+    } else{
+      index = 5;
+    }
+    return HighLevelOpcode((is_signed ? HINS_sconv_bw : HINS_uconv_bw) + index);
+  }
+
+  // an opcode for an int (size 4) or long (size 8) operation
+  HighLevelOpcode get_int_opcode(HighLevelOpcode base_opcode, unsigned size){
+    return HighLevelOpcode(base_opcode + ((size == 8) ? 3 : 2));
+  }
+
+  // A switch goes through a jump table if it has at least this many
+  // cases, and its table would have at most this many entries per case
+  const unsigned MIN_JUMP_TABLE_CASES = 4;
+  const unsigned MAX_JUMP_TABLE_SPREAD = 3;
+
+  // the most cases the decision tree tests one after another
+  const unsigned MAX_LINEAR_CASES = 3;
+
+  // Find the case and default statements of a switch, but not those of
+  // switches nested in its body
+  void collect_case_labels(Node* n, std::vector<Node*>& labels){
+    if(n->get_tag() == AST_SWITCH_STATEMENT){
+      return;
+    }
+    if(n->get_tag() == AST_CASE_STATEMENT || n->get_tag() == AST_DEFAULT_STATEMENT){
+      labels.push_back(n);
+    }
+    for(auto i = n->cbegin(); i != n->cend(); ++i){
+      collect_case_labels(*i, labels);
+    }
+  }
+
+}
+
 
 HighLevelCodegen::HighLevelCodegen(int next_label_num)
   : m_next_label_num(next_label_num)
@@ -33,12 +140,13 @@ HighLevelCodegen::HighLevelCodegen(int next_label_num)
 HighLevelCodegen::~HighLevelCodegen(){
 }
 
-int debugs = 0;
 void HighLevelCodegen::visit_function_definition(Node* n){
-  printf("%s", debugs ? "hc visit_function_definition\n" : "");
+  TRACE_EVENT(HL_CODEGEN, "visit_function_definition", n);
   // generate the name of the label that return instructions should target
   curVreg = n->get_vreg();
   imVreg = curVreg;
+  // the locals need storage even if there are no temporaries
+  highestVreg = imVreg - 1;
   std::string fn_name = n->get_kid(1)->get_str();
   m_return_label_name = ".L" + fn_name + "_return";
   unsigned total_local_storage = n->get_symbol()->get_addr();
@@ -55,34 +163,36 @@ void HighLevelCodegen::visit_function_definition(Node* n){
     Operand first = param->get_op();
     Operand second(Operand::VREG, argVreg++);
     m_hl_iseq->append(new Instruction(get_opcode(HINS_mov_b, param->get_type()), first, second));
+    curVreg = imVreg;
   }
   // reset arg register
   argVreg = 1;
   // visit body
   visit(n->get_kid(3));
 
-  m_hl_iseq->define_label(m_return_label_name);
+  define_label(m_return_label_name);
   m_hl_iseq->append(new Instruction(HINS_leave, Operand(Operand::IMM_IVAL, total_local_storage)));
   m_hl_iseq->append(new Instruction(HINS_ret));
 
 
   n->get_symbol()->set_addr(total_local_storage);
   n->get_symbol()->set_vreg(highestVreg);
-  // printf("total vreg %d\n" , highestVreg);
+  TRACE_EVENT(HL_CODEGEN, "peak vregs", long(highestVreg + 1));
 }
 
 void HighLevelCodegen::visit_return_statement(Node* n){
-  printf("%s", debugs ? "hc visit_return_statement\n" : "");
+  TRACE_EVENT(HL_CODEGEN, "visit_return_statement", n);
   // jump to the return label
   m_hl_iseq->append(new Instruction(HINS_jmp, Operand(Operand::LABEL, m_return_label_name)));
 }
 
 void HighLevelCodegen::visit_return_expression_statement(Node* n){
-  printf("%s", debugs ? "hc visit_return_expression_statement\n" : "");
+  TRACE_EVENT(HL_CODEGEN, "visit_return_expression_statement", n);
   // A possible implementation:
   Node* expr = n->get_kid(0);
 
   // generate code to evaluate the expression
+  unsigned temps = curVreg;
   visit(expr);
 
   std::shared_ptr<Type> index_type = expr->get_type();
@@ -93,87 +203,203 @@ done:
   // move the computed value to the return value vreg
   HighLevelOpcode mov_opcode = get_opcode(HINS_mov_b, n->get_type());
   m_hl_iseq->append(new Instruction(mov_opcode, Operand(Operand::VREG, 0), expr->get_op()));
+  curVreg = temps;
 
   // jump to the return label
   visit_return_statement(n);
 }
 
 void HighLevelCodegen::visit_while_statement(Node* n){
-  printf("%s", debugs ? "hc visit_while_statement\n" : "");
+  TRACE_EVENT(HL_CODEGEN, "visit_while_statement", n);
   std::string body_label = ".L" + std::to_string(get_next_label_num());
   std::string cond_label = ".L" + std::to_string(get_next_label_num());
 
+  enter_breakable();
   m_hl_iseq->append(new Instruction(HINS_jmp, Operand(Operand::LABEL, cond_label)));
-  m_hl_iseq->define_label(body_label);
+  define_label(body_label);
   visit(n->get_kid(1));
-  m_hl_iseq->define_label(cond_label);
-  visit(n->get_kid(0));
-  m_hl_iseq->append(new Instruction(HINS_cjmp_t, n->get_kid(0)->get_op(), Operand(Operand::LABEL, body_label)));
+  define_label(cond_label);
+  unsigned temps = curVreg;
+  gen_branch(n->get_kid(0), true, body_label);
+  curVreg = temps;
+  leave_breakable();
 }
 
 void HighLevelCodegen::visit_do_while_statement(Node* n){
-  printf("%s", debugs ? "hc visit_do_while_statement\n" : "");
+  TRACE_EVENT(HL_CODEGEN, "visit_do_while_statement", n);
   std::string body_label = ".L" + std::to_string(get_next_label_num());
-  m_hl_iseq->define_label(body_label);
+  enter_breakable();
+  define_label(body_label);
   visit(n->get_kid(0));
-  visit(n->get_kid(1));
-  m_hl_iseq->append(new Instruction(HINS_cjmp_t, n->get_kid(1)->get_op(), Operand(Operand::LABEL, body_label)));
+  unsigned temps = curVreg;
+  gen_branch(n->get_kid(1), true, body_label);
+  curVreg = temps;
+  leave_breakable();
 }
 
 void HighLevelCodegen::visit_for_statement(Node* n){
-  printf("%s", debugs ? "hc visit_for_statement\n" : "");
+  TRACE_EVENT(HL_CODEGEN, "visit_for_statement", n);
   std::string body_label = ".L" + std::to_string(get_next_label_num());
   std::string cond_label = ".L" + std::to_string(get_next_label_num());
 
+  unsigned temps = curVreg;
   visit(n->get_kid(0));
+  curVreg = temps;
+  enter_breakable();
   m_hl_iseq->append(new Instruction(HINS_jmp, Operand(Operand::LABEL, cond_label)));
-  m_hl_iseq->define_label(body_label);
+  define_label(body_label);
   visit(n->get_kid(3));
   visit(n->get_kid(2));
-  m_hl_iseq->define_label(cond_label);
-  visit(n->get_kid(1));
-  m_hl_iseq->append(new Instruction(HINS_cjmp_t, n->get_kid(1)->get_op(), Operand(Operand::LABEL, body_label)));
+  curVreg = temps;
+  define_label(cond_label);
+  gen_branch(n->get_kid(1), true, body_label);
+  curVreg = temps;
+  leave_breakable();
 }
 
 void HighLevelCodegen::visit_if_statement(Node* n){
-  printf("%s", debugs ? "hc visit_if_statement\n" : "");
+  TRACE_EVENT(HL_CODEGEN, "visit_if_statement", n);
   std::string body_label = ".L" + std::to_string(get_next_label_num());
   // cond
-  visit(n->get_kid(0));
+  unsigned temps = curVreg;
   // if false, don't reach body, jump to label
-  m_hl_iseq->append(new Instruction(HINS_cjmp_f, n->get_kid(0)->get_op(), Operand(Operand::LABEL, body_label)));
+  gen_branch(n->get_kid(0), false, body_label);
+  curVreg = temps;
   // body
   visit(n->get_kid(1));
-  m_hl_iseq->define_label(body_label);
+  define_label(body_label);
 }
 
 void HighLevelCodegen::visit_if_else_statement(Node* n){
-  printf("%s", debugs ? "hc visit_if_else_statement\n" : "");
+  TRACE_EVENT(HL_CODEGEN, "visit_if_else_statement", n);
   std::string after_else_label = ".L" + std::to_string(get_next_label_num());
   std::string else_label = ".L" + std::to_string(get_next_label_num());
   // cond
-  visit(n->get_kid(0));
+  unsigned temps = curVreg;
   // if false, jump to label for else
-  m_hl_iseq->append(new Instruction(HINS_cjmp_f, n->get_kid(0)->get_op(), Operand(Operand::LABEL, else_label)));
+  gen_branch(n->get_kid(0), false, else_label);
+  curVreg = temps;
   // true body
   visit(n->get_kid(1));
   m_hl_iseq->append(new Instruction(HINS_jmp, Operand(Operand::LABEL, after_else_label)));
   // else body
-  m_hl_iseq->define_label(else_label);
+  define_label(else_label);
   visit(n->get_kid(2));
 
-  m_hl_iseq->define_label(after_else_label);
+  define_label(after_else_label);
+}
+
+// A switch dispatches on its value with a jump table if the case
+// values are dense, otherwise with a binary decision tree; either way,
+// the body follows, with the case and default statements labeled
+void HighLevelCodegen::visit_switch_statement(Node* n){
+  TRACE_EVENT(HL_CODEGEN, "visit_switch_statement", n);
+  enter_breakable();
+
+  std::vector<Node*> labels;
+  collect_case_labels(n->get_kid(1), labels);
+  std::string default_label;
+  std::vector<std::pair<long, std::string>> cases;
+  for(Node* label : labels){
+    std::string name = next_label();
+    m_case_labels[label] = name;
+    if(label->get_tag() == AST_DEFAULT_STATEMENT){
+      default_label = name;
+    } else{
+      cases.push_back(std::make_pair(label->get_lit()->get_int_value(), name));
+    }
+  }
+  if(default_label.empty()){
+    default_label = get_break_label();
+  }
+
+  // the value is compared in its promoted type; the decision tree uses
+  // signed comparisons, so the case values are ordered as signed values
+  // of that size (which works for unsigned values as well)
+  Node* expr = n->get_kid(0);
+  std::shared_ptr<Type> type = expr->get_type();
+  if(type->get_storage_size() < 4){
+    type = std::shared_ptr<Type>(new BasicType(BasicTypeKind::INT, true));
+  }
+  unsigned size = type->get_storage_size();
+  for(auto& c : cases){
+    c.first = (size == 8) ? c.first : int(c.first);
+  }
+  std::sort(cases.begin(), cases.end());
+
+  unsigned temps = curVreg;
+  Operand value = gen_arm_value(expr, type);
+  if(value.get_kind() != Operand::VREG){
+    Operand temp(next_vr());
+    m_hl_iseq->append(new Instruction(get_int_opcode(HINS_mov_b, size), temp, value));
+    value = temp;
+  }
+  bool dense = cases.size() >= MIN_JUMP_TABLE_CASES
+               && uint64_t(cases.back().first) - uint64_t(cases.front().first) < MAX_JUMP_TABLE_SPREAD * cases.size();
+  if(dense){
+    gen_jump_table(value, size, cases, default_label);
+  } else{
+    gen_case_tree(value, next_vr(), size, cases, 0, cases.size(), default_label);
+  }
+  curVreg = temps;
+
+  visit(n->get_kid(1));
+  leave_breakable();
+}
+
+void HighLevelCodegen::visit_case_statement(Node* n){
+  TRACE_EVENT(HL_CODEGEN, "visit_case_statement", n);
+  define_label(m_case_labels[n]);
+  visit(n->get_kid(1));
+}
+
+void HighLevelCodegen::visit_default_statement(Node* n){
+  TRACE_EVENT(HL_CODEGEN, "visit_default_statement", n);
+  define_label(m_case_labels[n]);
+  visit(n->get_kid(0));
+}
+
+void HighLevelCodegen::visit_break_statement(Node* n){
+  TRACE_EVENT(HL_CODEGEN, "visit_break_statement", n);
+  m_hl_iseq->append(new Instruction(HINS_jmp, Operand(Operand::LABEL, get_break_label())));
 }
 
 void HighLevelCodegen::visit_binary_expression(Node* n){
-  printf("%s", debugs ? "hc visit_binary_expression\n" : "");
+  TRACE_EVENT(HL_CODEGEN, "visit_binary_expression", n);
+  if(n->get_lit()){
+    // folded by semantic analysis
+    visit_literal_value(n);
+    return;
+  }
+  int tag = n->get_kid(0)->get_tag();
+  if(tag == TOK_LOGICAL_AND || tag == TOK_LOGICAL_OR){
+    // the value is 0 or 1, and the right operand is only
+    // evaluated if the left one doesn't decide it
+    std::string false_label = next_label();
+    std::string done_label = next_label();
+    HighLevelOpcode mov_opcode = get_opcode(HINS_mov_b, n->get_type());
+    Operand dest(next_vr());
+    gen_branch(n, false, false_label);
+    m_hl_iseq->append(new Instruction(mov_opcode, dest, Operand(Operand::IMM_IVAL, 1)));
+    m_hl_iseq->append(new Instruction(HINS_jmp, Operand(Operand::LABEL, done_label)));
+    define_label(false_label);
+    m_hl_iseq->append(new Instruction(mov_opcode, dest, Operand(Operand::IMM_IVAL, 0)));
+    define_label(done_label);
+    n->set_op(dest);
+    return;
+  }
   visit(n->get_kid(1));
-  visit(n->get_kid(2));
   Operand first = n->get_kid(1)->get_op();
-  Operand second = n->get_kid(2)->get_op();
+  Operand second;
+  if(is_immediate_operand(n->get_kid(0)->get_tag(), n->get_kid(2))){
+    second = Operand(Operand::IMM_IVAL, n->get_kid(2)->get_lit()->get_int_value());
+  } else{
+    visit(n->get_kid(2));
+    second = n->get_kid(2)->get_op();
+  }
 
   HighLevelOpcode op_code;
-  switch(n->get_kid(0)->get_tag()){
+  switch(tag){
     case TOK_ASSIGN:{
       std::shared_ptr<Type> type1 = n->get_kid(1)->get_type();
       std::shared_ptr<Type> type2 = n->get_kid(2)->get_type();
@@ -191,11 +417,12 @@ void HighLevelCodegen::visit_binary_expression(Node* n){
         Operand temp = next_vr();
         m_hl_iseq->append(new Instruction(get_opcode(HINS_mov_b, type1), temp, second));
         second = temp;
+      } else if(second.get_kind() == Operand::FRAME_MEM_OFF && type2->is_array()){
+        second = frame_address(second);
       } else if(type2->is_array()){
         second = Operand(Operand::VREG, n->get_kid(2)->get_vreg());
       }
       m_hl_iseq->append(new Instruction(get_opcode(HINS_mov_b, type1), first, second));
-      // curVreg = imVreg;
       return;
     }
     case TOK_PLUS:{
@@ -242,6 +469,28 @@ void HighLevelCodegen::visit_binary_expression(Node* n){
       op_code = HINS_mod_b;
       break;
     }
+    case TOK_AMPERSAND:{
+      op_code = HINS_and_b;
+      break;
+    }
+    case TOK_BITWISE_OR:{
+      op_code = HINS_or_b;
+      break;
+    }
+    case TOK_BITWISE_XOR:{
+      op_code = HINS_xor_b;
+      break;
+    }
+    case TOK_LEFT_SHIFT:{
+      op_code = HINS_lshift_b;
+      break;
+    }
+    case TOK_RIGHT_SHIFT:{
+      // the result has the type of the left operand, and an unsigned
+      // one is shifted in zeros
+      op_code = n->get_kid(1)->get_type()->is_signed() ? HINS_rshift_b : HINS_urshift_b;
+      break;
+    }
     default: RuntimeError::raise("should not reach here");
   }
   if(first.is_memref()){
@@ -258,12 +507,15 @@ void HighLevelCodegen::visit_binary_expression(Node* n){
   }
   Operand dest(next_vr());
   m_hl_iseq->append(new Instruction(get_opcode(op_code, n->get_kid(1)->get_type()), dest, first, second));
-  // curVreg = imVreg;
   n->set_op(dest);
 }
 
 void HighLevelCodegen::visit_unary_expression(Node* n){
-  printf("%s", debugs ? "hc visit_unary_expression\n" : "");
+  TRACE_EVENT(HL_CODEGEN, "visit_unary_expression", n);
+  if(n->get_lit()){
+    visit_literal_value(n);
+    return;
+  }
   int tag = n->get_kid(0)->get_tag();
   int addr;
   Operand dest = Operand(Operand::VREG, curVreg);
@@ -281,6 +533,13 @@ void HighLevelCodegen::visit_unary_expression(Node* n){
       m_hl_iseq->append(new Instruction(get_opcode(HINS_neg_b, var->get_type()), dest, first));
       break;
     }
+    case TOK_NOT:
+    case TOK_BITWISE_COMPL:{
+      dest = next_vr();
+      HighLevelOpcode op_code = (tag == TOK_NOT) ? HINS_not_b : HINS_compl_b;
+      m_hl_iseq->append(new Instruction(get_opcode(op_code, var->get_type()), dest, var->get_op()));
+      break;
+    }
     case TOK_ASTERISK:{
       visit(var);
       // if p of *p is already a pointer and p->get_op is memref, then we need to do extra work to store memref somewhere
@@ -295,19 +554,63 @@ void HighLevelCodegen::visit_unary_expression(Node* n){
       break;
     }
     case TOK_AMPERSAND:{
-      // dest = next_vr();
-      // addr = var->get_symbol()->get_addr();
-      // first = Operand(Operand::IMM_IVAL, addr);
-      // m_hl_iseq->append(new Instruction(HINS_localaddr, dest, first));
+      if(var->get_op().get_kind() == Operand::FRAME_MEM_OFF){
+        dest = frame_address(var->get_op());
+      } else if(var->get_op().get_kind() == Operand::VREG_MEM){
+        dest = Operand(Operand::VREG, var->get_op().get_base_reg());
+      }
       break;
     }
   }
-  curVreg = imVreg;
+  n->set_op(dest);
+}
+
+void HighLevelCodegen::visit_conditional_expression(Node* n){
+  TRACE_EVENT(HL_CODEGEN, "visit_conditional_expression", n);
+  if(n->get_lit()){
+    // folded by semantic analysis
+    visit_literal_value(n);
+    return;
+  }
+  std::shared_ptr<Type> type = n->get_type();
+  Node* cond = n->get_kid(0);
+  if(cond->get_lit()){
+    Operand value = gen_arm_value(n->get_kid(cond->get_lit()->get_int_value() ? 1 : 2), type);
+    Operand dest(next_vr());
+    m_hl_iseq->append(new Instruction(get_opcode(HINS_mov_b, type), dest, value));
+    n->set_op(dest);
+    return;
+  }
+
+  // arms which are cheap and safe to evaluate are both computed, and
+  // the select picks one, so there is no branch to mispredict
+  int true_cost = get_speculation_cost(n->get_kid(1));
+  int false_cost = get_speculation_cost(n->get_kid(2));
+  if(true_cost >= 0 && true_cost <= MAX_SPECULATED_OPS && false_cost >= 0 && false_cost <= MAX_SPECULATED_OPS){
+    Operand flag = gen_flag(cond);
+    Operand if_true = gen_arm_value(n->get_kid(1), type);
+    Operand if_false = gen_arm_value(n->get_kid(2), type);
+    Operand dest(next_vr());
+    m_hl_iseq->append(new Instruction(get_opcode(HINS_select_b, type), dest, flag, if_true, if_false));
+    n->set_op(dest);
+    return;
+  }
+
+  std::string false_label = next_label();
+  std::string done_label = next_label();
+  HighLevelOpcode mov_opcode = get_opcode(HINS_mov_b, type);
+  Operand dest(next_vr());
+  gen_branch(cond, false, false_label);
+  m_hl_iseq->append(new Instruction(mov_opcode, dest, gen_arm_value(n->get_kid(1), type)));
+  m_hl_iseq->append(new Instruction(HINS_jmp, Operand(Operand::LABEL, done_label)));
+  define_label(false_label);
+  m_hl_iseq->append(new Instruction(mov_opcode, dest, gen_arm_value(n->get_kid(2), type)));
+  define_label(done_label);
   n->set_op(dest);
 }
 
 void HighLevelCodegen::visit_function_call_expression(Node* n){
-  printf("%s", debugs ? "hc visit_function_call_expression\n" : "");
+  TRACE_EVENT(HL_CODEGEN, "visit_function_call_expression", n);
   //arg passing
   Node* arg_list = n->get_kid(1);
   std::shared_ptr<Type> func = n->get_func();
@@ -337,14 +640,35 @@ void HighLevelCodegen::visit_function_call_expression(Node* n){
     m_hl_iseq->append(new Instruction(get_opcode(HINS_mov_b, n->get_type()), rax, Operand(Operand::VREG, 0)));
     n->set_op(rax);
   }
-  curVreg = imVreg;
 }
 
 void HighLevelCodegen::visit_array_element_ref_expression(Node* n){
-  printf("%s", debugs ? "hc visit_array_element_ref_expression\n" : "");
+  TRACE_EVENT(HL_CODEGEN, "visit_array_element_ref_expression", n);
   Node* arr = n->get_kid(0);
   Node* index = n->get_kid(1);
-  visit(arr);
+
+  // the elements of a local array (or of an array in a local struct)
+  // are at known offsets in the frame, so the array's address is only
+  // needed for a non-constant index
+  Operand frame_loc;
+  if(arr->get_tag() == AST_VARIABLE_REF && arr->get_symbol()->get_addr() != -1 && arr->get_symbol()->get_type()->is_array()){
+    frame_loc = Operand(Operand::FRAME_MEM_OFF, arr->get_symbol()->get_addr(), 0);
+  } else{
+    visit(arr);
+    if(arr->get_op().get_kind() == Operand::FRAME_MEM_OFF){
+      frame_loc = arr->get_op();
+    }
+  }
+  if(frame_loc.get_kind() == Operand::FRAME_MEM_OFF && index->get_lit()){
+    long offset = frame_loc.get_offset() + index->get_lit()->get_int_value() * n->get_type()->get_storage_size();
+    if(!n->get_type()->is_array()){
+      n->set_actually_var(true);
+    }
+    n->set_op(Operand(Operand::FRAME_MEM_OFF, frame_loc.get_frame_slot(), offset));
+    n->set_symbol(arr->get_symbol());
+    return;
+  }
+
   //if array allocated, size will be ≥0
   int addr;
   Operand start_addr;
@@ -371,10 +695,9 @@ void HighLevelCodegen::visit_array_element_ref_expression(Node* n){
   }
   visit(index);
 
-  //find offset (mul_b offset index siz)
-  std::shared_ptr<Type> index_type = index->get_type();
+  //find offset (mul_b offset index siz), the index widened to a long
   // HighLevelOpcode code = HINS_nop;
-  convert(index_type, index);
+  convert(std::shared_ptr<Type>(new BasicType(BasicTypeKind::LONG, true)), index);
   first = index->get_op();
 
   // switch(index_type->get_basic_type_kind()){
@@ -411,7 +734,9 @@ void HighLevelCodegen::visit_array_element_ref_expression(Node* n){
   //adjust address with offset
   second = dest;
   dest = next_vr();
-  if(arr->get_type()->is_array()){
+  if(frame_loc.get_kind() == Operand::FRAME_MEM_OFF){
+    start_addr = frame_address(frame_loc);
+  } else if(arr->get_type()->is_array()){
     start_addr = Operand(Operand::VREG, arr->get_vreg());
   }
   if(!n->get_type()->is_array()){
@@ -421,25 +746,24 @@ void HighLevelCodegen::visit_array_element_ref_expression(Node* n){
   //memory dereference
   n->set_op(dest.to_memref());
   n->set_symbol(arr->get_symbol());
-  n->set_type(arr->get_type());
   n->set_vreg(dest.get_base_reg());
 }
 
 void HighLevelCodegen::visit_variable_ref(Node* n){
-  printf("%s", debugs ? "hc visit_variable_ref\n" : "");
+  TRACE_EVENT(HL_CODEGEN, "visit_variable_ref", n);
   Operand op;
-  // create operand for variables NOT allocated in memory
-  // otherwise, get its address into a register
+  // create operand for variables NOT allocated in memory;
+  // otherwise, an array evaluates to its address, and anything
+  // else is accessed directly in the frame
   if(n->get_symbol()->get_addr() == -1){
     op = Operand(Operand::VREG, n->get_symbol()->get_vreg());
-  } else{
+  } else if(n->get_type()->is_array()){
     int addr = n->get_symbol()->get_addr();
     Operand first(Operand::IMM_IVAL, addr);
     op = next_vr();
     m_hl_iseq->append(new Instruction(HINS_localaddr, op, first));
-    if(!n->get_type()->is_array()){
-      op = op.to_memref();
-    }
+  } else{
+    op = Operand(Operand::FRAME_MEM_OFF, n->get_symbol()->get_addr(), 0);
   }
 
   // puts("4jk");
@@ -449,15 +773,16 @@ void HighLevelCodegen::visit_variable_ref(Node* n){
 }
 void HighLevelCodegen::visit_expression_statement(Node* n){
   for(int i = 0; i < n->get_num_kids(); i++){
-    int origin = curVreg;
+    // the temporaries of a full expression are dead once it has been
+    // evaluated, so their vregs can be reused by the next one
+    unsigned temps = curVreg;
     visit(n->get_kid(i));
-    origin = curVreg;
+    curVreg = temps;
   }
-
 }
 
 void HighLevelCodegen::visit_field_ref_expression(Node* n){
-  printf("%s", debugs ? "hc visit_field_ref_expression\n" : "");
+  TRACE_EVENT(HL_CODEGEN, "visit_field_ref_expression", n);
   std::string field_name = n->get_kid(1)->get_str();
   visit(n->get_kid(0));
   Node* strt = n->get_kid(0);
@@ -480,6 +805,13 @@ void HighLevelCodegen::visit_field_ref_expression(Node* n){
   int offset = get_offset(var_type, field_name);
   // puts("<2>");
 
+  // a field of a local struct is just another location in the frame
+  if(strt->get_op().get_kind() == Operand::FRAME_MEM_OFF){
+    Operand loc = strt->get_op();
+    n->set_op(Operand(Operand::FRAME_MEM_OFF, loc.get_frame_slot(), loc.get_offset() + offset));
+    return;
+  }
+
   dest = next_vr();
   first = Operand(Operand::IMM_IVAL, offset);
   //adjust addr with offset
@@ -493,7 +825,7 @@ void HighLevelCodegen::visit_field_ref_expression(Node* n){
 }
 
 void HighLevelCodegen::visit_indirect_field_ref_expression(Node* n){
-  printf("%s", debugs ? "hc visit_indirect_field_ref_expression\n" : "");
+  TRACE_EVENT(HL_CODEGEN, "visit_indirect_field_ref_expression", n);
   Node* strt = n->get_kid(0);
   std::string field_name = n->get_kid(1)->get_str();
   //make sure dereference by get_base_type
@@ -510,7 +842,7 @@ void HighLevelCodegen::visit_indirect_field_ref_expression(Node* n){
 }
 
 void HighLevelCodegen::visit_literal_value(Node* n){
-  printf("%s", debugs ? "hc visit_literal_value\n" : "");
+  TRACE_EVENT(HL_CODEGEN, "visit_literal_value", n);
   // A partial implementation (note that this won't work correctly
   // for string constants!):
   LiteralValue val = n->get_type()->get_lit();
@@ -534,17 +866,196 @@ void HighLevelCodegen::visit_literal_value(Node* n){
   // printf("the shit is %s\n ", n->get_type()->as_str().c_str());
 }
 
+// Jump to label if the condition is jump_if, and fall through otherwise.
+// && and || (and !) only branch, so the right operand of && or || is
+// skipped once the left one decides the condition, and a comparison
+// is tested by the jump directly.
+void HighLevelCodegen::gen_branch(Node* cond, bool jump_if, const std::string& label){
+  if(cond->get_tag() == AST_UNARY_EXPRESSION && !cond->get_lit() && cond->get_kid(0)->get_tag() == TOK_NOT){
+    gen_branch(cond->get_kid(1), !jump_if, label);
+    return;
+  }
+  if(cond->get_tag() == AST_BINARY_EXPRESSION && !cond->get_lit()){
+    int tag = cond->get_kid(0)->get_tag();
+    if(tag == TOK_LOGICAL_AND || tag == TOK_LOGICAL_OR){
+      if(jump_if != (tag == TOK_LOGICAL_AND)){
+        // either operand alone decides it (a false operand of a &&,
+        // or a true operand of a ||)
+        gen_branch(cond->get_kid(1), jump_if, label);
+        gen_branch(cond->get_kid(2), jump_if, label);
+      } else{
+        // the left operand can only decide the other way
+        std::string skip_label = next_label();
+        gen_branch(cond->get_kid(1), !jump_if, skip_label);
+        gen_branch(cond->get_kid(2), jump_if, label);
+        define_label(skip_label);
+      }
+      return;
+    }
+  }
+  visit(cond);
+  m_hl_iseq->append(new Instruction(jump_if ? HINS_cjmp_t : HINS_cjmp_f, cond->get_op(), Operand(Operand::LABEL, label)));
+}
+
+// Compute a condition as a 0 or 1 flag, as a select tests it
+Operand HighLevelCodegen::gen_flag(Node* cond){
+  visit(cond);
+  Operand op = cond->get_op();
+  if(is_flag_expression(cond)){
+    return op;
+  }
+  HighLevelOpcode mov_opcode = get_opcode(HINS_mov_b, cond->get_type());
+  if(op.is_memref()){
+    Operand temp(next_vr());
+    m_hl_iseq->append(new Instruction(mov_opcode, temp, op));
+    op = temp;
+  }
+  Operand flag(next_vr());
+  m_hl_iseq->append(new Instruction(get_opcode(HINS_cmpneq_b, cond->get_type()), flag, op, Operand(Operand::IMM_IVAL, 0)));
+  return flag;
+}
+
+// Compute an arm of a ?: as a vreg or an immediate of the type of
+// the whole expression
+Operand HighLevelCodegen::gen_arm_value(Node* arm, const std::shared_ptr<Type>& type){
+  if(is_immediate_operand(TOK_ASSIGN, arm)){
+    return Operand(Operand::IMM_IVAL, arm->get_lit()->get_int_value());
+  }
+  visit(arm);
+  Operand op = arm->get_op();
+  std::shared_ptr<Type> arm_type = arm->get_type();
+  if(op.is_memref()){
+    Operand temp(next_vr());
+    m_hl_iseq->append(new Instruction(get_opcode(HINS_mov_b, arm_type), temp, op));
+    op = temp;
+  }
+  unsigned size = type->get_storage_size();
+  if(arm_type->is_integral() && arm_type->get_storage_size() < size){
+    Operand temp(next_vr());
+    m_hl_iseq->append(new Instruction(get_extend_opcode(arm_type->get_storage_size(), size, arm_type->is_signed()), temp, op));
+    op = temp;
+  }
+  return op;
+}
+
+// A case value, as an immediate if it fits in one
+Operand HighLevelCodegen::gen_case_value(long value, unsigned size){
+  if(value >= INT32_MIN && value <= INT32_MAX){
+    return Operand(Operand::IMM_IVAL, value);
+  }
+  Operand temp(next_vr());
+  m_hl_iseq->append(new Instruction(get_int_opcode(HINS_mov_b, size), temp, Operand(Operand::IMM_IVAL, value)));
+  return temp;
+}
+
+// Test the value against the (sorted) cases in [lo, hi): a few cases
+// are tested in turn, more are split in half by comparing against the
+// middle one
+void HighLevelCodegen::gen_case_tree(const Operand& value, const Operand& flag, unsigned size,
+                                     const std::vector<std::pair<long, std::string>>& cases,
+                                     unsigned lo, unsigned hi, const std::string& default_label){
+  if(hi - lo <= MAX_LINEAR_CASES){
+    for(unsigned i = lo; i < hi; i++){
+      Operand case_value = gen_case_value(cases[i].first, size);
+      m_hl_iseq->append(new Instruction(get_int_opcode(HINS_cmpeq_b, size), flag, value, case_value));
+      m_hl_iseq->append(new Instruction(HINS_cjmp_t, flag, Operand(Operand::LABEL, cases[i].second)));
+    }
+    m_hl_iseq->append(new Instruction(HINS_jmp, Operand(Operand::LABEL, default_label)));
+    return;
+  }
+
+  unsigned mid = lo + (hi - lo) / 2;
+  std::string upper_label = next_label();
+  Operand case_value = gen_case_value(cases[mid].first, size);
+  m_hl_iseq->append(new Instruction(get_int_opcode(HINS_cmpgte_b, size), flag, value, case_value));
+  m_hl_iseq->append(new Instruction(HINS_cjmp_t, flag, Operand(Operand::LABEL, upper_label)));
+  gen_case_tree(value, flag, size, cases, lo, mid, default_label);
+  define_label(upper_label);
+  gen_case_tree(value, flag, size, cases, mid, hi, default_label);
+}
+
+// Jump through a table indexed by the value minus the smallest case,
+// with the default label for the values in between the cases; the
+// jmptab goes to the default for an index past the end of the table,
+// which (as the index is unsigned) includes values below the smallest
+void HighLevelCodegen::gen_jump_table(const Operand& value, unsigned size,
+                                      const std::vector<std::pair<long, std::string>>& cases,
+                                      const std::string& default_label){
+  long min = cases.front().first;
+  std::vector<std::string> table(cases.back().first - min + 1, default_label);
+  for(const auto& c : cases){
+    table[c.first - min] = c.second;
+  }
+
+  Operand index = value;
+  if(min != 0){
+    Operand temp(next_vr());
+    m_hl_iseq->append(new Instruction(get_int_opcode(HINS_sub_b, size), temp, value, gen_case_value(min, size)));
+    index = temp;
+  }
+  if(size == 4){
+    Operand temp(next_vr());
+    m_hl_iseq->append(new Instruction(HINS_uconv_lq, temp, index));
+    index = temp;
+  }
+  Instruction* jmptab = new Instruction(HINS_jmptab, index, Operand(Operand::LABEL, default_label));
+  jmptab->set_jump_table(next_label(), table);
+  m_hl_iseq->append(jmptab);
+}
+
+// Loops and switches have a label a break statement in them goes to,
+// defined after the statement only if a break uses it
+void HighLevelCodegen::enter_breakable(){
+  m_break_labels.push_back("");
+}
+
+void HighLevelCodegen::leave_breakable(){
+  if(!m_break_labels.back().empty()){
+    define_label(m_break_labels.back());
+  }
+  m_break_labels.pop_back();
+}
+
+std::string HighLevelCodegen::get_break_label(){
+  if(m_break_labels.back().empty()){
+    m_break_labels.back() = next_label();
+  }
+  return m_break_labels.back();
+}
+
 std::string HighLevelCodegen::next_label(){
   std::string label = ".L" + std::to_string(m_next_label_num++);
   return label;
 }
 
+// Two labels can't be defined for the same instruction, which happens
+// when a statement ending with a label (e.g., an if) is the last one
+// in an enclosing statement, so the first label gets a nop
+void HighLevelCodegen::define_label(const std::string& label){
+  if(m_hl_iseq->has_label_at_end()){
+    m_hl_iseq->append(new Instruction(HINS_nop));
+  }
+  m_hl_iseq->define_label(label);
+}
+
 Operand HighLevelCodegen::next_vr(){
   highestVreg = std::max(highestVreg, curVreg);
   Operand a = Operand(Operand::VREG, curVreg++);
   return a;
 }
 
+// Get the address of a location in the frame into a vreg
+Operand HighLevelCodegen::frame_address(const Operand& loc){
+  Operand addr = next_vr();
+  m_hl_iseq->append(new Instruction(HINS_localaddr, addr, Operand(Operand::IMM_IVAL, loc.get_frame_slot())));
+  if(loc.get_offset() != 0){
+    Operand dest = next_vr();
+    m_hl_iseq->append(new Instruction(HINS_add_q, dest, addr, Operand(Operand::IMM_IVAL, loc.get_offset())));
+    addr = dest;
+  }
+  return addr;
+}
+
 //trynna get offset
 int HighLevelCodegen::get_offset(std::shared_ptr<Type> var_type, std::string field_name){
   int offset = 0;
@@ -560,49 +1071,19 @@ int HighLevelCodegen::get_offset(std::shared_ptr<Type> var_type, std::string fie
 
 //convert from node2 to node1
 void HighLevelCodegen::convert(std::shared_ptr<Type> type1, Node* node2){
-
-  // Node* expr = n->get_kid(0);
-  std::shared_ptr<Type> index_type = node2->get_type();
-  int dif = (int)type1->get_basic_type_kind();
-  HighLevelOpcode code = HINS_nop;
-
-  switch(index_type->get_basic_type_kind()){
-    case BasicTypeKind::CHAR:{
-      if(index_type->is_signed()){
-        dif += HINS_sconv_bw - 1;
-      } else{
-        dif += HINS_uconv_bw - 1;
-      }
-      break;
-    }
-    case BasicTypeKind::SHORT:{
-      if(index_type->is_signed()){
-        dif += HINS_sconv_wl - 1;
-      } else{
-        dif += HINS_uconv_wl - 1;
-      }
-      break;
-    }
-    case BasicTypeKind::INT:{
-      if(index_type->is_signed()){
-        dif += HINS_sconv_lq - 2;
-      } else{
-        dif += HINS_uconv_lq - 2;
-      }
-      break;
-    }
-    default: break;
+  std::shared_ptr<Type> type2 = node2->get_type();
+  if(!type1->is_integral() || !type2->is_integral()){
+    return;
   }
-  code = (HighLevelOpcode)dif;
-
-  if(code != HINS_nop){
-    curVreg = std::max((int)curVreg, node2->get_op().get_base_reg());
-    highestVreg = std::max(highestVreg, curVreg);
-    Operand temp = next_vr();
-    m_hl_iseq->append(new Instruction(code, temp, node2->get_op()));
-    node2->set_op(temp);
-    curVreg--;
+  // narrowing needs no code, the narrower move just takes the low bytes
+  unsigned from = type2->get_storage_size();
+  unsigned to = type1->get_storage_size();
+  if(from >= to){
+    return;
   }
+  Operand temp = next_vr();
+  m_hl_iseq->append(new Instruction(get_extend_opcode(from, to, type2->is_signed()), temp, node2->get_op()));
+  node2->set_op(temp);
 }
 bool HighLevelCodegen::are_same(std::shared_ptr<Type> type1, std::shared_ptr<Type> type2){
   if(type1->as_str() == type2->as_str()){
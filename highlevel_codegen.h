@@ -1,5 +1,8 @@
 #include <string>
 #include <memory>
+#include <map>
+#include <utility>
+#include <vector>
 #include "highlevel.h"
 #include "instruction_seq.h"
 #include "ast_visitor.h"
@@ -13,10 +16,18 @@ private:
   int m_next_label_num;
   std::string m_return_label_name; // name of the label that return instructions should target
   std::shared_ptr<InstructionSequence> m_hl_iseq;
+  // temporaries are allocated upward from imVreg (the first vreg after
+  // the locals); they only live until the end of the full expression
+  // which computes them, after which curVreg is reset
   unsigned curVreg;
   unsigned imVreg;
   unsigned argVreg;
   unsigned highestVreg;
+  // the labels which break statements go to, for the enclosing loops
+  // and switches (innermost last); empty until a break needs one
+  std::vector<std::string> m_break_labels;
+  // the labels of the case and default statements of the switches
+  std::map<Node*, std::string> m_case_labels;
 
 public:
   // the next_label_num controls where the next_label() member function
@@ -29,6 +40,7 @@ public:
 
   virtual void visit_array_element_ref_expression(Node* n);
   virtual void visit_binary_expression(Node* n);
+  virtual void visit_conditional_expression(Node* n);
   virtual void visit_do_while_statement(Node* n);
   virtual void visit_expression_statement(Node* n);
   virtual void visit_field_ref_expression(Node* n);
@@ -44,10 +56,29 @@ public:
   virtual void visit_unary_expression(Node* n);
   virtual void visit_variable_ref(Node* n);
   virtual void visit_while_statement(Node* n);
+  virtual void visit_switch_statement(Node* n);
+  virtual void visit_case_statement(Node* n);
+  virtual void visit_default_statement(Node* n);
+  virtual void visit_break_statement(Node* n);
 
 private:
+  void gen_branch(Node* cond, bool jump_if, const std::string& label);
+  Operand gen_flag(Node* cond);
+  Operand gen_arm_value(Node* arm, const std::shared_ptr<Type>& type);
+  Operand gen_case_value(long value, unsigned size);
+  void gen_case_tree(const Operand& value, const Operand& flag, unsigned size,
+                     const std::vector<std::pair<long, std::string>>& cases,
+                     unsigned lo, unsigned hi, const std::string& default_label);
+  void gen_jump_table(const Operand& value, unsigned size,
+                      const std::vector<std::pair<long, std::string>>& cases,
+                      const std::string& default_label);
+  void enter_breakable();
+  void leave_breakable();
+  std::string get_break_label();
   std::string next_label();
+  void define_label(const std::string& label);
   Operand next_vr();
+  Operand frame_address(const Operand& loc);
   int get_offset(std::shared_ptr<Type>, std::string);
   void convert(std::shared_ptr<Type> type1, Node* node2);
   bool are_same(std::shared_ptr<Type> type1, std::shared_ptr<Type> type2);
@@ -13,17 +13,12 @@ namespace{
     HINS_ret,
     HINS_jmp,
     HINS_call,
+    HINS_tailcall,
     HINS_enter,
     HINS_leave,
     HINS_cjmp_t,
     HINS_cjmp_f,
-    HINS_localaddr,
-    HINS_sconv_bw,
-    HINS_sconv_bl,
-    HINS_sconv_bq,
-    HINS_sconv_wl,
-    HINS_sconv_wq,
-    HINS_sconv_lq,
+    HINS_jmptab,
   };
 
   // Does the instruction have a destination operand?
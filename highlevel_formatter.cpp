@@ -17,9 +17,14 @@ std::string HighLevelFormatter::format_operand(const Operand &operand) const {
   case Operand::VREG_MEM:
     return cpputil::format("(vr%d)", operand.get_base_reg());
   case Operand::VREG_MEM_IDX:
+    if (operand.get_scale() != 1) {
+      return cpputil::format("(vr%d, vt%d, %d)", operand.get_base_reg(), operand.get_index_reg(), operand.get_scale());
+    }
     return cpputil::format("(vr%d, vt%d)", operand.get_base_reg(), operand.get_index_reg());
   case Operand::VREG_MEM_OFF:
     return cpputil::format("%ld(vr%dq)", operand.get_imm_ival(), operand.get_base_reg());
+  case Operand::FRAME_MEM_OFF:
+    return cpputil::format("%ld(local%ld)", operand.get_offset(), operand.get_frame_slot());
   default:
     return Formatter::format_operand(operand);
   }
@@ -1,5 +1,6 @@
 #include <cassert>
 #include "instruction.h"
+#include "phase_timer.h"
 
 Instruction::Instruction(int opcode)
   : Instruction(opcode, Operand(), Operand(), Operand(), 0){
@@ -16,7 +17,20 @@ Instruction::Instruction(int opcode, const Operand& op1, const Operand& op2)
 Instruction::Instruction(int opcode, const Operand& op1, const Operand& op2, const Operand& op3, unsigned num_operands)
   : m_opcode(opcode)
   , m_num_operands(num_operands)
-  , m_operands{ op1, op2, op3 } {
+  , m_operands{ op1, op2, op3, Operand() } {
+  PhaseTimer::count(CountedObject::INSTRUCTION);
+}
+
+Instruction::Instruction(int opcode, const Operand& op1, const Operand& op2, const Operand& op3, const Operand& op4)
+  : m_opcode(opcode)
+  , m_num_operands(4)
+  , m_operands{ op1, op2, op3, op4 } {
+  PhaseTimer::count(CountedObject::INSTRUCTION);
+}
+
+Instruction* Instruction::duplicate() const{
+  PhaseTimer::count(CountedObject::INSTRUCTION);
+  return new Instruction(*this);
 }
 
 Instruction::~Instruction(){
@@ -38,3 +52,7 @@ const Operand& Instruction::get_operand(unsigned index) const{
 void Instruction::set_operand(Operand a, int b){
   m_operands[b] = a;
 }
+
+void Instruction::set_jump_table(const std::string& name, const std::vector<std::string>& labels){
+  m_jump_table = std::make_shared<const JumpTable>(JumpTable{ name, labels });
+}
@@ -1,25 +1,39 @@
 #ifndef INSTRUCTION_H
 #define INSTRUCTION_H
 
+#include <memory>
+#include <string>
+#include <vector>
 #include "operand.h"
 
+// The table of a multiway jump: the labels it can go to, indexed by
+// the jump's index operand, and the label naming the table itself
+struct JumpTable{
+  std::string name;
+  std::vector<std::string> labels;
+};
+
 // Instruction object type.
 // Can be used for either high-level or low-level code.
 class Instruction{
 private:
   int m_opcode;
   unsigned m_num_operands;
-  Operand m_operands[3];
+  Operand m_operands[4];
+  // the table of a multiway jump (shared by duplicates, and replaced
+  // rather than modified)
+  std::shared_ptr<const JumpTable> m_jump_table;
 
 public:
   Instruction(int opcode);
   Instruction(int opcode, const Operand& op1);
   Instruction(int opcode, const Operand& op1, const Operand& op2);
   Instruction(int opcode, const Operand& op1, const Operand& op2, const Operand& op3, unsigned num_operands = 3);
+  Instruction(int opcode, const Operand& op1, const Operand& op2, const Operand& op3, const Operand& op4);
 
   ~Instruction();
 
-  Instruction* duplicate() const{ return new Instruction(*this); }
+  Instruction* duplicate() const;
 
   int get_opcode() const;
 
@@ -27,6 +41,10 @@ public:
 
   const Operand& get_operand(unsigned index) const;
   void set_operand(Operand, int);
+
+  bool has_jump_table() const { return bool(m_jump_table); }
+  const JumpTable& get_jump_table() const { return *m_jump_table; }
+  void set_jump_table(const std::string& name, const std::vector<std::string>& labels);
 };
 
 #endif // INSTRUCTION_H
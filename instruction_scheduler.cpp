@@ -0,0 +1,295 @@
+#include <cassert>
+#include <algorithm>
+#include "instruction.h"
+#include "operand.h"
+#include "lowlevel.h"
+#include "instruction_scheduler.h"
+
+namespace{
+
+  // pseudo-register number used for the condition codes (after the
+  // general and xmm registers)
+  const int FLAGS = 32;
+
+  unsigned long reg_bit(int reg){
+    return 1UL << reg;
+  }
+
+  bool in_range(int opcode, int first, int last){
+    return opcode >= first && opcode <= last;
+  }
+
+  bool is_mov(int opcode){
+    return in_range(opcode, MINS_MOVB, MINS_MOVQ) || in_range(opcode, MINS_MOVSBW, MINS_MOVZLQ) || opcode == MINS_MOVD;
+  }
+
+  // approximate result latencies (in cycles) for a modern x86-64 core
+  const int LOAD_LATENCY = 4;
+  const int IMUL_LATENCY = 3;
+  const int IDIVL_LATENCY = 26;
+  const int IDIVQ_LATENCY = 40;
+
+}
+
+InstructionScheduler::InstructionScheduler(const std::shared_ptr<ControlFlowGraph>& cfg)
+  : ControlFlowGraphTransform(cfg){
+}
+
+InstructionScheduler::~InstructionScheduler(){
+}
+
+std::shared_ptr<InstructionSequence> InstructionScheduler::transform_basic_block(const BasicBlock* orig_bb){
+  // build the scheduling units, keeping each flag consumer glued to
+  // the instruction immediately before it if that set the flags
+  std::vector<SchedNode> nodes;
+  for(auto i = orig_bb->cbegin(); i != orig_bb->cend(); ++i){
+    SchedNode node;
+    add_instruction(node, *i);
+    if((node.reads & reg_bit(FLAGS)) && !nodes.empty()){
+      SchedNode probe;
+      add_instruction(probe, nodes.back().ins.back());
+      if(probe.writes & reg_bit(FLAGS)){
+        add_instruction(nodes.back(), *i);
+        continue;
+      }
+    }
+    nodes.push_back(node);
+  }
+
+  unsigned num_nodes = nodes.size();
+
+  // build the dependency DAG; edges only go forward in the original order,
+  // so the original order is a valid topological order
+  for(unsigned i = 0; i < num_nodes; i++){
+    for(unsigned j = i + 1; j < num_nodes; j++){
+      int latency = get_dependence(nodes[i], nodes[j]);
+      if(latency >= 0){
+        nodes[i].succs.push_back(std::make_pair(j, latency));
+        nodes[j].num_preds++;
+      }
+    }
+  }
+
+  // priority is the length of the longest latency path to the end of the block
+  for(unsigned i = num_nodes; i-- > 0; ){
+    int priority = nodes[i].latency;
+    for(auto& succ : nodes[i].succs){
+      priority = std::max(priority, succ.second + nodes[succ.first].priority);
+    }
+    nodes[i].priority = priority;
+  }
+
+  // list scheduling: issue one node per cycle, preferring nodes whose
+  // operands are ready, and among those the one with the highest priority
+  std::shared_ptr<InstructionSequence> result(new InstructionSequence());
+  std::vector<bool> scheduled(num_nodes, false);
+  int cycle = 0;
+  for(unsigned count = 0; count < num_nodes; count++){
+    int best = -1;
+    for(unsigned i = 0; i < num_nodes; i++){
+      if(scheduled[i] || nodes[i].num_preds != 0){
+        continue;
+      }
+      if(best == -1){
+        best = i;
+        continue;
+      }
+      const SchedNode& cand = nodes[i];
+      const SchedNode& cur = nodes[best];
+      bool cand_ready = cand.earliest <= cycle, cur_ready = cur.earliest <= cycle;
+      if(cand_ready != cur_ready){
+        if(cand_ready){
+          best = i;
+        }
+      } else if(!cand_ready && cand.earliest != cur.earliest){
+        if(cand.earliest < cur.earliest){
+          best = i;
+        }
+      } else if(cand.priority > cur.priority){
+        best = i;
+      }
+    }
+    assert(best != -1);
+
+    SchedNode& node = nodes[best];
+    scheduled[best] = true;
+    int start = std::max(cycle, node.earliest);
+    cycle = start + 1;
+    for(auto& succ : node.succs){
+      SchedNode& succ_node = nodes[succ.first];
+      succ_node.num_preds--;
+      succ_node.earliest = std::max(succ_node.earliest, start + succ.second);
+    }
+
+    for(Instruction* ins : node.ins){
+      result->append(ins->duplicate());
+    }
+  }
+
+  return result;
+}
+
+void InstructionScheduler::add_instruction(SchedNode& node, Instruction* ins){
+  node.ins.push_back(ins);
+  node.latency += get_latency(ins);
+
+  int opcode = ins->get_opcode();
+  unsigned num_operands = ins->get_num_operands();
+
+  if(opcode == MINS_NOP){
+    return;
+  }
+  if(is_mov(opcode)){
+    add_operand(node, ins->get_operand(0), true, false);
+    add_operand(node, ins->get_operand(1), false, true);
+  } else if(opcode == MINS_MOVDQU){
+    add_operand(node, ins->get_operand(0), true, false, 16);
+    add_operand(node, ins->get_operand(1), false, true, 16);
+  } else if(in_range(opcode, MINS_PADDD, MINS_PXOR) || opcode == MINS_PUNPCKLQDQ){
+    // the SSE instructions don't change the flags
+    add_operand(node, ins->get_operand(0), true, false, 16);
+    add_operand(node, ins->get_operand(1), true, true, 16);
+  } else if(opcode == MINS_PSHUFD){
+    add_operand(node, ins->get_operand(1), true, false, 16);
+    add_operand(node, ins->get_operand(2), false, true, 16);
+  } else if(in_range(opcode, MINS_ADDB, MINS_SHRQ) || opcode == MINS_IMULL || opcode == MINS_IMULQ){
+    add_operand(node, ins->get_operand(0), true, false);
+    add_operand(node, ins->get_operand(1), true, true);
+    node.writes |= reg_bit(FLAGS);
+  } else if(in_range(opcode, MINS_NOTB, MINS_NOTQ)){
+    add_operand(node, ins->get_operand(0), true, true);
+  } else if(in_range(opcode, MINS_CMPB, MINS_CMPQ)){
+    add_operand(node, ins->get_operand(0), true, false);
+    add_operand(node, ins->get_operand(1), true, false);
+    node.writes |= reg_bit(FLAGS);
+  } else if(in_range(opcode, MINS_SETL, MINS_SETNE)){
+    node.reads |= reg_bit(FLAGS);
+    add_operand(node, ins->get_operand(0), false, true);
+  } else if(in_range(opcode, MINS_CMOVL, MINS_CMOVNE)){
+    // the destination keeps its value if the condition is false
+    node.reads |= reg_bit(FLAGS);
+    add_operand(node, ins->get_operand(0), true, false);
+    add_operand(node, ins->get_operand(1), true, true);
+  } else if(opcode == MINS_LEAQ){
+    // lea only computes the address, it doesn't access memory
+    Operand addr = ins->get_operand(0);
+    if(addr.has_base_reg()){
+      node.reads |= reg_bit(addr.get_base_reg());
+    }
+    if(addr.has_index_reg()){
+      node.reads |= reg_bit(addr.get_index_reg());
+    }
+    add_operand(node, ins->get_operand(1), false, true);
+  } else if(opcode == MINS_CDQ || opcode == MINS_CQTO){
+    node.reads |= reg_bit(MREG_RAX);
+    node.writes |= reg_bit(MREG_RDX);
+  } else if(opcode == MINS_IDIVL || opcode == MINS_IDIVQ){
+    add_operand(node, ins->get_operand(0), true, false);
+    node.reads |= reg_bit(MREG_RAX) | reg_bit(MREG_RDX);
+    node.writes |= reg_bit(MREG_RAX) | reg_bit(MREG_RDX) | reg_bit(FLAGS);
+  } else{
+    // jumps, calls, ret, push, and pop
+    node.barrier = true;
+    if(in_range(opcode, MINS_JE, MINS_JAE)){
+      node.reads |= reg_bit(FLAGS);
+    }
+    for(unsigned i = 0; i < num_operands; i++){
+      add_operand(node, ins->get_operand(i), true, true);
+    }
+  }
+}
+
+void InstructionScheduler::add_operand(SchedNode& node, const Operand& op, bool read, bool write, unsigned size){
+  Operand::Kind kind = op.get_kind();
+
+  if(op.is_memref()){
+    if(op.has_base_reg()){
+      node.reads |= reg_bit(op.get_base_reg());
+    }
+    if(op.has_index_reg()){
+      node.reads |= reg_bit(op.get_index_reg());
+    }
+    bool frame_slot = kind == Operand::MREG64_MEM_OFF && op.get_base_reg() == MREG_RBP;
+    long offset = frame_slot ? op.get_offset() : 0;
+    if(read){
+      node.mem.push_back({ false, frame_slot, offset, size });
+    }
+    if(write){
+      node.mem.push_back({ true, frame_slot, offset, size });
+    }
+    return;
+  }
+
+  if(kind == Operand::MREG8 || kind == Operand::MREG16 || kind == Operand::MREG32 || kind == Operand::MREG64
+     || kind == Operand::MREG128){
+    int reg = op.get_base_reg();
+    // the prologue and epilogue (and anything else touching the
+    // stack and frame pointers directly) stays where it is
+    if(reg == MREG_RSP || reg == MREG_RBP){
+      node.barrier = true;
+    }
+    if(read){
+      node.reads |= reg_bit(reg);
+    }
+    if(write){
+      node.writes |= reg_bit(reg);
+    }
+  }
+}
+
+int InstructionScheduler::get_latency(Instruction* ins){
+  int opcode = ins->get_opcode();
+
+  int latency = 1;
+  if(opcode == MINS_IMULL || opcode == MINS_IMULQ){
+    latency = IMUL_LATENCY;
+  } else if(opcode == MINS_IDIVL){
+    latency = IDIVL_LATENCY;
+  } else if(opcode == MINS_IDIVQ){
+    latency = IDIVQ_LATENCY;
+  }
+
+  // reading a memory operand adds the load latency (lea doesn't
+  // access memory, and a store's result isn't a register)
+  if(opcode != MINS_LEAQ && ins->get_num_operands() > 0 && ins->get_operand(0).is_memref()){
+    latency += LOAD_LATENCY;
+  }
+  return latency;
+}
+
+// Returns the latency of the dependence of second on first (which
+// precedes it in the original order), or -1 if the two are independent.
+int InstructionScheduler::get_dependence(const SchedNode& first, const SchedNode& second){
+  int latency = -1;
+
+  if(first.barrier || second.barrier){
+    latency = std::max(latency, first.latency);
+  }
+
+  // true dependence through a register or the flags
+  if(first.writes & second.reads){
+    latency = std::max(latency, first.latency);
+  }
+  // anti and output dependences only constrain the order
+  if((first.reads & second.writes) || (first.writes & second.writes)){
+    latency = std::max(latency, 0);
+  }
+
+  for(auto& a : first.mem){
+    for(auto& b : second.mem){
+      if(!a.write && !b.write){
+        continue;
+      }
+      // frame slots are 8 bytes (a vector spans two of them), so
+      // it's known whether they overlap; any other memory reference
+      // could point anywhere
+      if(a.frame_slot && b.frame_slot
+         && (a.offset + long(a.size) <= b.offset || b.offset + long(b.size) <= a.offset)){
+        continue;
+      }
+      latency = std::max(latency, (a.write && !b.write) ? first.latency : 0);
+    }
+  }
+
+  return latency;
+}
@@ -0,0 +1,64 @@
+#ifndef INSTRUCTION_SCHEDULER_H
+#define INSTRUCTION_SCHEDULER_H
+
+#include <memory>
+#include <vector>
+#include "cfg.h"
+#include "cfg_transform.h"
+
+// InstructionScheduler reorders the instructions within each basic block
+// of a low-level control-flow graph using list scheduling. A dependency
+// DAG is built from the registers, flags, and memory locations each
+// instruction reads and writes, and instructions on the longest latency
+// path are issued first, so that (for example) independent loads can
+// start before the result of a multiply or divide is needed.
+//
+// Some instructions are never moved:
+//   - control transfers (jumps, calls, ret) and push/pop, which must stay
+//     at the end of their block or in place
+//   - instructions which use %rsp or %rbp directly, i.e. the prologue and
+//     epilogue, since everything else depends on the frame being set up
+//
+// An instruction which reads the condition codes is always kept
+// immediately after the instruction that set them.
+class InstructionScheduler : public ControlFlowGraphTransform{
+private:
+  // A scheduling unit: usually one instruction, or a flag-setting
+  // instruction followed by the instruction consuming the flags
+  struct SchedNode{
+    struct MemAccess{
+      bool write;
+      bool frame_slot; // true if the location is a known offset from %rbp
+      long offset;
+      unsigned size;
+    };
+
+    std::vector<Instruction*> ins;
+    unsigned long reads, writes; // bitmasks of machine registers and flags
+    std::vector<MemAccess> mem;
+    bool barrier;
+    int latency;
+
+    // (successor, latency of the dependence) pairs
+    std::vector<std::pair<unsigned, int>> succs;
+    unsigned num_preds;
+    int priority;
+    int earliest;
+
+    SchedNode() : reads(0), writes(0), barrier(false), latency(0), num_preds(0), priority(0), earliest(0){ }
+  };
+
+public:
+  InstructionScheduler(const std::shared_ptr<ControlFlowGraph>& cfg);
+  ~InstructionScheduler();
+
+  virtual std::shared_ptr<InstructionSequence> transform_basic_block(const BasicBlock* orig_bb);
+
+private:
+  void add_instruction(SchedNode& node, Instruction* ins);
+  void add_operand(SchedNode& node, const Operand& op, bool read, bool write, unsigned size = 8);
+  int get_latency(Instruction* ins);
+  int get_dependence(const SchedNode& first, const SchedNode& second);
+};
+
+#endif // INSTRUCTION_SCHEDULER_H
@@ -50,7 +50,7 @@ public:
 
     Instruction* operator*() const { return slot_iter->ins; }
     bool has_label() const { return !slot_iter->label.empty(); }
-    std::string get_label() const { return slot_iter->label; }
+    const std::string &get_label() const { return slot_iter->label; }
 
     ISeqIterator<It> &operator++() {
       slot_iter++;
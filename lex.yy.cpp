@@ -590,20 +590,25 @@ static const flex_int16_t yy_chk[310] =
 #include "parse.tab.h"
 #include "parser_state.h"
 #include "yyerror.h"
+#include "phase_timer.h"
 
-int create_token(int, const char *, YYSTYPE *, ParserState *);
+int create_token(int, const char *, int, YYSTYPE *, ParserState *);
 
 // Macro to get the pointer to the ParserState from the lexer
 // state, which is available (according to YY_DECL) in the
-// "yyscanner" parameter to yylex()
+// "yyscanner" parameter to the scanner function
 #define PSTATE() static_cast<ParserState *>(yyget_extra(yyscanner))
 
 // Macro to create a token and return its tag value.
 // Avoids quite a bit of code duplication in the scanner rules.
-#define CRTOK(tag) return create_token(tag, yytext, yylval, PSTATE())
-#line 604 "lex.yy.cpp"
+#define CRTOK(tag) return create_token(tag, yytext, int(yyleng), yylval, PSTATE())
 
-#line 606 "lex.yy.cpp"
+// flex generates the scanner function as scan_token(); the parser
+// calls yylex(), defined below, so that scanning can be timed
+#define YY_DECL int scan_token(YYSTYPE *yylval_param, yyscan_t yyscanner)
+#line 609 "lex.yy.cpp"
+
+#line 611 "lex.yy.cpp"
 
 #define INITIAL 0
 #define C_COMMENT 1
@@ -876,10 +881,10 @@ YY_DECL
 		}
 
 	{
-#line 43 "lex.l"
+#line 48 "lex.l"
 
 
-#line 882 "lex.yy.cpp"
+#line 887 "lex.yy.cpp"
 
 	while ( /*CONSTCOND*/1 )		/* loops until end-of-file is reached */
 		{
@@ -938,363 +943,363 @@ do_action:	/* This label is used only to access EOF actions. */
 
 case 1:
 YY_RULE_SETUP
-#line 45 "lex.l"
+#line 50 "lex.l"
 { CRTOK(TOK_LPAREN); }
 	YY_BREAK
 case 2:
 YY_RULE_SETUP
-#line 46 "lex.l"
+#line 51 "lex.l"
 { CRTOK(TOK_RPAREN); }
 	YY_BREAK
 case 3:
 YY_RULE_SETUP
-#line 47 "lex.l"
+#line 52 "lex.l"
 { CRTOK(TOK_LBRACKET); }
 	YY_BREAK
 case 4:
 YY_RULE_SETUP
-#line 48 "lex.l"
+#line 53 "lex.l"
 { CRTOK(TOK_RBRACKET); }
 	YY_BREAK
 case 5:
 YY_RULE_SETUP
-#line 49 "lex.l"
+#line 54 "lex.l"
 { CRTOK(TOK_LBRACE); }
 	YY_BREAK
 case 6:
 YY_RULE_SETUP
-#line 50 "lex.l"
+#line 55 "lex.l"
 { CRTOK(TOK_RBRACE); }
 	YY_BREAK
 case 7:
 YY_RULE_SETUP
-#line 52 "lex.l"
+#line 57 "lex.l"
 { CRTOK(TOK_SEMICOLON); }
 	YY_BREAK
 case 8:
 YY_RULE_SETUP
-#line 53 "lex.l"
+#line 58 "lex.l"
 { CRTOK(TOK_COLON); }
 	YY_BREAK
 case 9:
 YY_RULE_SETUP
-#line 54 "lex.l"
+#line 59 "lex.l"
 { CRTOK(TOK_COMMA); }
 	YY_BREAK
 case 10:
 YY_RULE_SETUP
-#line 55 "lex.l"
+#line 60 "lex.l"
 { CRTOK(TOK_DOT); }
 	YY_BREAK
 case 11:
 YY_RULE_SETUP
-#line 56 "lex.l"
+#line 61 "lex.l"
 { CRTOK(TOK_QUESTION); }
 	YY_BREAK
 case 12:
 YY_RULE_SETUP
-#line 57 "lex.l"
+#line 62 "lex.l"
 { CRTOK(TOK_NOT); }
 	YY_BREAK
 case 13:
 YY_RULE_SETUP
-#line 58 "lex.l"
+#line 63 "lex.l"
 { CRTOK(TOK_ARROW); }
 	YY_BREAK
 case 14:
 YY_RULE_SETUP
-#line 60 "lex.l"
+#line 65 "lex.l"
 { CRTOK(TOK_INCREMENT); }
 	YY_BREAK
 case 15:
 YY_RULE_SETUP
-#line 61 "lex.l"
+#line 66 "lex.l"
 { CRTOK(TOK_PLUS); }
 	YY_BREAK
 case 16:
 YY_RULE_SETUP
-#line 62 "lex.l"
+#line 67 "lex.l"
 { CRTOK(TOK_DECREMENT); }
 	YY_BREAK
 case 17:
 YY_RULE_SETUP
-#line 63 "lex.l"
+#line 68 "lex.l"
 { CRTOK(TOK_MINUS); }
 	YY_BREAK
 case 18:
 YY_RULE_SETUP
-#line 64 "lex.l"
+#line 69 "lex.l"
 { CRTOK(TOK_ASTERISK); }
 	YY_BREAK
 case 19:
 YY_RULE_SETUP
-#line 65 "lex.l"
+#line 70 "lex.l"
 { CRTOK(TOK_DIVIDE); }
 	YY_BREAK
 case 20:
 YY_RULE_SETUP
-#line 66 "lex.l"
+#line 71 "lex.l"
 { CRTOK(TOK_MOD); }
 	YY_BREAK
 case 21:
 YY_RULE_SETUP
-#line 68 "lex.l"
+#line 73 "lex.l"
 { CRTOK(TOK_AMPERSAND); }
 	YY_BREAK
 case 22:
 YY_RULE_SETUP
-#line 69 "lex.l"
+#line 74 "lex.l"
 { CRTOK(TOK_BITWISE_OR); }
 	YY_BREAK
 case 23:
 YY_RULE_SETUP
-#line 70 "lex.l"
+#line 75 "lex.l"
 { CRTOK(TOK_BITWISE_XOR); }
 	YY_BREAK
 case 24:
 YY_RULE_SETUP
-#line 71 "lex.l"
+#line 76 "lex.l"
 { CRTOK(TOK_BITWISE_COMPL); }
 	YY_BREAK
 case 25:
 YY_RULE_SETUP
-#line 72 "lex.l"
+#line 77 "lex.l"
 { CRTOK(TOK_LEFT_SHIFT); }
 	YY_BREAK
 case 26:
 YY_RULE_SETUP
-#line 73 "lex.l"
+#line 78 "lex.l"
 { CRTOK(TOK_RIGHT_SHIFT); }
 	YY_BREAK
 case 27:
 YY_RULE_SETUP
-#line 75 "lex.l"
+#line 80 "lex.l"
 { CRTOK(TOK_LOGICAL_AND); }
 	YY_BREAK
 case 28:
 YY_RULE_SETUP
-#line 76 "lex.l"
+#line 81 "lex.l"
 { CRTOK(TOK_LOGICAL_OR); }
 	YY_BREAK
 case 29:
 YY_RULE_SETUP
-#line 78 "lex.l"
+#line 83 "lex.l"
 { CRTOK(TOK_EQUALITY); }
 	YY_BREAK
 case 30:
 YY_RULE_SETUP
-#line 79 "lex.l"
+#line 84 "lex.l"
 { CRTOK(TOK_INEQUALITY); }
 	YY_BREAK
 case 31:
 YY_RULE_SETUP
-#line 80 "lex.l"
+#line 85 "lex.l"
 { CRTOK(TOK_LT); }
 	YY_BREAK
 case 32:
 YY_RULE_SETUP
-#line 81 "lex.l"
+#line 86 "lex.l"
 { CRTOK(TOK_LTE); }
 	YY_BREAK
 case 33:
 YY_RULE_SETUP
-#line 82 "lex.l"
+#line 87 "lex.l"
 { CRTOK(TOK_GT); }
 	YY_BREAK
 case 34:
 YY_RULE_SETUP
-#line 83 "lex.l"
+#line 88 "lex.l"
 { CRTOK(TOK_GTE); }
 	YY_BREAK
 case 35:
 YY_RULE_SETUP
-#line 85 "lex.l"
+#line 90 "lex.l"
 { CRTOK(TOK_ASSIGN); }
 	YY_BREAK
 case 36:
 YY_RULE_SETUP
-#line 86 "lex.l"
+#line 91 "lex.l"
 { CRTOK(TOK_MUL_ASSIGN); }
 	YY_BREAK
 case 37:
 YY_RULE_SETUP
-#line 87 "lex.l"
+#line 92 "lex.l"
 { CRTOK(TOK_DIV_ASSIGN); }
 	YY_BREAK
 case 38:
 YY_RULE_SETUP
-#line 88 "lex.l"
+#line 93 "lex.l"
 { CRTOK(TOK_MOD_ASSIGN); }
 	YY_BREAK
 case 39:
 YY_RULE_SETUP
-#line 89 "lex.l"
+#line 94 "lex.l"
 { CRTOK(TOK_ADD_ASSIGN); }
 	YY_BREAK
 case 40:
 YY_RULE_SETUP
-#line 90 "lex.l"
+#line 95 "lex.l"
 { CRTOK(TOK_SUB_ASSIGN); }
 	YY_BREAK
 case 41:
 YY_RULE_SETUP
-#line 91 "lex.l"
+#line 96 "lex.l"
 { CRTOK(TOK_LEFT_ASSIGN); }
 	YY_BREAK
 case 42:
 YY_RULE_SETUP
-#line 92 "lex.l"
+#line 97 "lex.l"
 { CRTOK(TOK_RIGHT_ASSIGN); }
 	YY_BREAK
 case 43:
 YY_RULE_SETUP
-#line 93 "lex.l"
+#line 98 "lex.l"
 { CRTOK(TOK_AND_ASSIGN); }
 	YY_BREAK
 case 44:
 YY_RULE_SETUP
-#line 94 "lex.l"
+#line 99 "lex.l"
 { CRTOK(TOK_XOR_ASSIGN); }
 	YY_BREAK
 case 45:
 YY_RULE_SETUP
-#line 95 "lex.l"
+#line 100 "lex.l"
 { CRTOK(TOK_OR_ASSIGN); }
 	YY_BREAK
 case 46:
 YY_RULE_SETUP
-#line 97 "lex.l"
+#line 102 "lex.l"
 { CRTOK(TOK_IF); }
 	YY_BREAK
 case 47:
 YY_RULE_SETUP
-#line 98 "lex.l"
+#line 103 "lex.l"
 { CRTOK(TOK_ELSE); }
 	YY_BREAK
 case 48:
 YY_RULE_SETUP
-#line 99 "lex.l"
+#line 104 "lex.l"
 { CRTOK(TOK_WHILE); }
 	YY_BREAK
 case 49:
 YY_RULE_SETUP
-#line 100 "lex.l"
+#line 105 "lex.l"
 { CRTOK(TOK_FOR); }
 	YY_BREAK
 case 50:
 YY_RULE_SETUP
-#line 101 "lex.l"
+#line 106 "lex.l"
 { CRTOK(TOK_DO); }
 	YY_BREAK
 case 51:
 YY_RULE_SETUP
-#line 102 "lex.l"
+#line 107 "lex.l"
 { CRTOK(TOK_SWITCH); }
 	YY_BREAK
 case 52:
 YY_RULE_SETUP
-#line 103 "lex.l"
+#line 108 "lex.l"
 { CRTOK(TOK_CASE); }
 	YY_BREAK
 case 53:
 YY_RULE_SETUP
-#line 104 "lex.l"
+#line 109 "lex.l"
 { CRTOK(TOK_CHAR); }
 	YY_BREAK
 case 54:
 YY_RULE_SETUP
-#line 105 "lex.l"
+#line 110 "lex.l"
 { CRTOK(TOK_SHORT); }
 	YY_BREAK
 case 55:
 YY_RULE_SETUP
-#line 106 "lex.l"
+#line 111 "lex.l"
 { CRTOK(TOK_INT); }
 	YY_BREAK
 case 56:
 YY_RULE_SETUP
-#line 107 "lex.l"
+#line 112 "lex.l"
 { CRTOK(TOK_LONG); }
 	YY_BREAK
 case 57:
 YY_RULE_SETUP
-#line 108 "lex.l"
+#line 113 "lex.l"
 { CRTOK(TOK_UNSIGNED); }
 	YY_BREAK
 case 58:
 YY_RULE_SETUP
-#line 109 "lex.l"
+#line 114 "lex.l"
 { CRTOK(TOK_SIGNED); }
 	YY_BREAK
 case 59:
 YY_RULE_SETUP
-#line 110 "lex.l"
+#line 115 "lex.l"
 { CRTOK(TOK_FLOAT); }
 	YY_BREAK
 case 60:
 YY_RULE_SETUP
-#line 111 "lex.l"
+#line 116 "lex.l"
 { CRTOK(TOK_DOUBLE); }
 	YY_BREAK
 case 61:
 YY_RULE_SETUP
-#line 112 "lex.l"
+#line 117 "lex.l"
 { CRTOK(TOK_VOID); }
 	YY_BREAK
 case 62:
 YY_RULE_SETUP
-#line 113 "lex.l"
+#line 118 "lex.l"
 { CRTOK(TOK_RETURN); }
 	YY_BREAK
 case 63:
 YY_RULE_SETUP
-#line 114 "lex.l"
+#line 119 "lex.l"
 { CRTOK(TOK_BREAK); }
 	YY_BREAK
 case 64:
 YY_RULE_SETUP
-#line 115 "lex.l"
+#line 120 "lex.l"
 { CRTOK(TOK_CONTINUE); }
 	YY_BREAK
 case 65:
 YY_RULE_SETUP
-#line 116 "lex.l"
+#line 121 "lex.l"
 { CRTOK(TOK_STATIC); }
 	YY_BREAK
 case 66:
 YY_RULE_SETUP
-#line 117 "lex.l"
+#line 122 "lex.l"
 { CRTOK(TOK_EXTERN); }
 	YY_BREAK
 case 67:
 YY_RULE_SETUP
-#line 118 "lex.l"
+#line 123 "lex.l"
 { CRTOK(TOK_AUTO); }
 	YY_BREAK
 case 68:
 YY_RULE_SETUP
-#line 119 "lex.l"
+#line 124 "lex.l"
 { CRTOK(TOK_CONST); }
 	YY_BREAK
 case 69:
 YY_RULE_SETUP
-#line 120 "lex.l"
+#line 125 "lex.l"
 { CRTOK(TOK_VOLATILE); }
 	YY_BREAK
 case 70:
 YY_RULE_SETUP
-#line 121 "lex.l"
+#line 126 "lex.l"
 { CRTOK(TOK_STRUCT); }
 	YY_BREAK
 case 71:
 YY_RULE_SETUP
-#line 122 "lex.l"
+#line 127 "lex.l"
 { CRTOK(TOK_UNION); }
 	YY_BREAK
 case 72:
 YY_RULE_SETUP
-#line 124 "lex.l"
-{ CRTOK(TOK_IDENT); }
+#line 129 "lex.l"
+{ CRTOK(strcmp(yytext, "default") == 0 ? TOK_DEFAULT : TOK_IDENT); }
 	YY_BREAK
 /*
    * String and character literals.
@@ -1303,12 +1308,12 @@ YY_RULE_SETUP
 case 73:
 /* rule 73 can match eol */
 YY_RULE_SETUP
-#line 130 "lex.l"
+#line 135 "lex.l"
 { CRTOK(TOK_STR_LIT); }
 	YY_BREAK
 case 74:
 YY_RULE_SETUP
-#line 131 "lex.l"
+#line 136 "lex.l"
 { CRTOK(TOK_CHAR_LIT); }
 	YY_BREAK
 /*
@@ -1317,28 +1322,28 @@ YY_RULE_SETUP
    */
 case 75:
 YY_RULE_SETUP
-#line 137 "lex.l"
+#line 142 "lex.l"
 { CRTOK(TOK_INT_LIT); }
 	YY_BREAK
 case 76:
 YY_RULE_SETUP
-#line 138 "lex.l"
+#line 143 "lex.l"
 { CRTOK(TOK_INT_LIT); }
 	YY_BREAK
 case 77:
 YY_RULE_SETUP
-#line 139 "lex.l"
+#line 144 "lex.l"
 { CRTOK(TOK_FP_LIT); }
 	YY_BREAK
 case 78:
 YY_RULE_SETUP
-#line 142 "lex.l"
+#line 147 "lex.l"
 { PSTATE()->cur_loc.advance(int(yyleng)); }
 	YY_BREAK
 case 79:
 /* rule 79 can match eol */
 YY_RULE_SETUP
-#line 143 "lex.l"
+#line 148 "lex.l"
 { PSTATE()->cur_loc.next_line(); }
 	YY_BREAK
 /*
@@ -1347,23 +1352,23 @@ YY_RULE_SETUP
    */
 case 80:
 YY_RULE_SETUP
-#line 149 "lex.l"
+#line 154 "lex.l"
 { BEGIN(C_COMMENT); PSTATE()->cur_loc.advance(int(yyleng)); }
 	YY_BREAK
 case 81:
 YY_RULE_SETUP
-#line 150 "lex.l"
+#line 155 "lex.l"
 { BEGIN(INITIAL); PSTATE()->cur_loc.advance(int(yyleng)); }
 	YY_BREAK
 case 82:
 /* rule 82 can match eol */
 YY_RULE_SETUP
-#line 151 "lex.l"
+#line 156 "lex.l"
 { PSTATE()->cur_loc.next_line(); }
 	YY_BREAK
 case 83:
 YY_RULE_SETUP
-#line 152 "lex.l"
+#line 157 "lex.l"
 { PSTATE()->cur_loc.advance(int(yyleng)); }
 	YY_BREAK
 /*
@@ -1372,20 +1377,20 @@ YY_RULE_SETUP
 case 84:
 /* rule 84 can match eol */
 YY_RULE_SETUP
-#line 157 "lex.l"
+#line 162 "lex.l"
 { PSTATE()->cur_loc.next_line(); }
 	YY_BREAK
 case 85:
 YY_RULE_SETUP
-#line 159 "lex.l"
+#line 164 "lex.l"
 { yyerror(PSTATE(), "Unrecognized character"); }
 	YY_BREAK
 case 86:
 YY_RULE_SETUP
-#line 162 "lex.l"
+#line 167 "lex.l"
 ECHO;
 	YY_BREAK
-#line 1388 "lex.yy.cpp"
+#line 1393 "lex.yy.cpp"
 case YY_STATE_EOF(INITIAL):
 case YY_STATE_EOF(C_COMMENT):
 	yyterminate();
@@ -2529,16 +2534,19 @@ void yyfree (void * ptr , yyscan_t yyscanner)
 
 #define YYTABLES_NAME "yytables"
 
-#line 162 "lex.l"
+#line 167 "lex.l"
 
 
-int create_token(int token_tag, const char *lexeme, YYSTYPE *semantic_value, ParserState *pp) {
-  Node *tok = new Node(token_tag, lexeme);
+int create_token(int token_tag, const char *lexeme, int len, YYSTYPE *semantic_value, ParserState *pp) {
+  // the scanner works on the source buffer in place, so the token
+  // can refer to its lexeme instead of copying it
+  unsigned offset = unsigned(lexeme - pp->source->get_data());
+  Node *tok = new Node(token_tag, pp->source, offset, unsigned(len));
   tok->set_loc(pp->cur_loc);
 
   semantic_value->node = tok;
 
-  pp->cur_loc.advance(int(tok->get_str().size()));
+  pp->cur_loc.advance(len);
 
   // keep track of the Nodes created by the lexer
   pp->tokens.push_back(tok);
@@ -2548,3 +2556,8 @@ int create_token(int token_tag, const char *lexeme, YYSTYPE *semantic_value, Par
   return token_tag;
 }
 
+int yylex(YYSTYPE *yylval_param, yyscan_t yyscanner) {
+  FineGrainedPhaseScope phase(Phase::SCAN);
+  return scan_token(yylval_param, yyscanner);
+}
+
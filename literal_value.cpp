@@ -1,4 +1,6 @@
 #include <cassert>
+#include <cerrno>
+#include <cstdlib>
 #include "exceptions.h"
 #include "location.h"
 #include "literal_value.h"
@@ -119,15 +121,13 @@ LiteralValue LiteralValue::from_char_literal(const std::string &lexeme, const Lo
 LiteralValue LiteralValue::from_int_literal(const std::string &lexeme, const Location &loc) const{
   std::string s = lexeme;
 
-  int64_t value;
-
-  if (s.rfind("0x", 0) == 0 || s.rfind("0X", 0) == 0) {
-    // hex constant
-    value = int64_t(std::stoll(lexeme, nullptr, 16));
-  } else {
-    // decimal int literal (we don't support octal constants)
-    value = int64_t(std::stoll(lexeme, nullptr, 10));
-  }
+  // hex constants, or decimal ones (we don't support octal constants);
+  // the suffixes end the digits
+  bool is_hex = s.rfind("0x", 0) == 0 || s.rfind("0X", 0) == 0;
+  errno = 0;
+  uint64_t magnitude = std::strtoull(s.c_str(), nullptr, is_hex ? 16 : 10);
+  if (errno == ERANGE)
+    SemanticError::raise(loc, "Integer literal %s is too large", s.c_str());
 
   // a somewhat crude way of checking for trailing 'L' and 'U' suffixes
   bool is_unsigned = false, is_long = false;
@@ -149,7 +149,22 @@ LiteralValue LiteralValue::from_int_literal(const std::string &lexeme, const Loc
     --i;
   }
 
-  return LiteralValue(value, is_unsigned, is_long);
+  // as in C, the type is the first of int, unsigned int, long and
+  // unsigned long that the suffixes allow and the value fits in; a
+  // decimal literal is only unsigned if it has a U suffix (or doesn't
+  // fit in a long)
+  if (!is_long && !is_unsigned && magnitude <= uint64_t(INT32_MAX)) {
+    // int
+  } else if (!is_long && (is_unsigned || is_hex) && magnitude <= uint64_t(UINT32_MAX)) {
+    is_unsigned = true;
+  } else if (!is_unsigned && magnitude <= uint64_t(INT64_MAX)) {
+    is_long = true;
+  } else {
+    is_unsigned = true;
+    is_long = true;
+  }
+
+  return LiteralValue(int64_t(magnitude), is_unsigned, is_long);
 }
 
 LiteralValue LiteralValue::from_str_literal(const std::string &lexeme, const Location &loc) const{
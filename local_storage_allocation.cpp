@@ -1,19 +1,21 @@
 #include <cassert>
+#include <algorithm>
 #include "node.h"
 #include "symtab.h"
 #include "local_storage_allocation.h"
+#include "trace_log.h"
 
 LocalStorageAllocation::LocalStorageAllocation()
   : m_total_local_storage(0U)
+  , m_max_local_storage(0U)
   , m_next_vreg(VREG_FIRST_LOCAL){
 }
 
 LocalStorageAllocation::~LocalStorageAllocation(){
 }
 
-bool debugg = 0;
 void LocalStorageAllocation::visit_declarator_list(Node* n){
-  printf("%s", debugg ? "lsa visit_declarator_list\n" : "");
+  TRACE_EVENT(STORAGE, "visit_declarator_list", n);
   for(auto i = 0; i < n->get_num_kids(); i++){
     Node* kid = n->get_kid(i);
     std::shared_ptr<Type> var_type = kid->get_type();
@@ -38,10 +40,17 @@ void LocalStorageAllocation::visit_declarator_list(Node* n){
 }
 
 void LocalStorageAllocation::visit_function_definition(Node* n){
-  printf("%s", debugg ? "lsa visit_function_definition\n" : "");
+  TRACE_EVENT(STORAGE, "visit_function_definition", n);
   m_total_local_storage = 0U;
+  m_max_local_storage = 0U;
   visit(n->get_kid(2));
   visit(n->get_kid(3));
+  m_total_local_storage = m_max_local_storage;
+  for(auto i : m_addr_taken){
+    i->set_addr(m_total_local_storage);
+    m_malloc(i->get_type()->get_storage_size(), 1);
+  }
+  m_addr_taken.clear();
   n->get_symbol()->set_addr(m_total_local_storage);
   // set register for every symbol
   for(auto i : m_sym){
@@ -54,27 +63,28 @@ void LocalStorageAllocation::visit_function_definition(Node* n){
 }
 
 void LocalStorageAllocation::visit_function_parameter(Node* n){
-  printf("%s", debugg ? "lsa visit_function_parameter\n" : "");
+  TRACE_EVENT(STORAGE, "visit_function_parameter", n);
   m_sym.push_back(n->get_symbol());
 }
 
 void LocalStorageAllocation::visit_statement_list(Node* n){
-  printf("%s", debugg ? "lsa visit_statement_list\n" : "");
+  TRACE_EVENT(STORAGE, "visit_statement_list", n);
+  // the arrays and structs of a block are dead after it, so the next
+  // block (e.g., the other branch of an if) can reuse their storage
+  unsigned block_start = m_total_local_storage;
   visit_children(n);
+  m_max_local_storage = std::max(m_max_local_storage, m_total_local_storage);
+  m_total_local_storage = block_start;
 }
 
 void LocalStorageAllocation::visit_unary_expression(Node* n){
-  printf("%s", debugg ? "lsa visit_unary_expression\n" : "");
+  TRACE_EVENT(STORAGE, "visit_unary_expression", n);
   if(n->get_kid(0)->get_tag() == TOK_AMPERSAND){
     visit_children(n);
-    std::shared_ptr<Type> base_type = n->get_kid(1)->get_type();
-    // printf("the kid n->get_kid(1)->get_symbol(): %s", n->get_kid(1)->get_symbol()->as_str().c_str());
-    // puts("end");
     // make sure only allocated once
-    if(n->get_kid(1)->get_symbol()->get_addr() == -1){
-      unsigned siz = base_type->get_storage_size();
-      n->get_kid(1)->get_symbol()->set_addr(m_total_local_storage);
-      m_malloc(siz, 1);
+    Symbol* sym = n->get_kid(1)->get_symbol();
+    if(sym->get_addr() == -1 && std::find(m_addr_taken.begin(), m_addr_taken.end(), sym) == m_addr_taken.end()){
+      m_addr_taken.push_back(sym);
     }
   }
 }
@@ -84,12 +94,12 @@ void LocalStorageAllocation::visit_function_declaration(Node* n){}
 
 //do nothing function AGAIN hahahahahahaha
 void LocalStorageAllocation::visit_struct_type_definition(Node* n){
-  printf("%s", debugg ? "lsa visit_struct_type_def\n" : "");
+  TRACE_EVENT(STORAGE, "visit_struct_type_def", n);
   visit_children(n);
 }
 
 void LocalStorageAllocation::visit_literal_value(Node* n){
-  printf("%s", debugg ? "lsa visit_literal_value\n" : "");
+  TRACE_EVENT(STORAGE, "visit_literal_value", n);
   // printf("name: %s\n", n->get_str().c_str());
   // printf("kind: %s\n", t->get_lit().get_str_value().c_str());
   // printf("name: %s\n", t->as_str().c_str());
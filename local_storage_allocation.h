@@ -1,7 +1,9 @@
 #ifndef LOCAL_STORAGE_ALLOCATION_H
 #define LOCAL_STORAGE_ALLOCATION_H
 
+#include <vector>
 #include "storage.h"
+#include "symtab.h"
 #include "ast_visitor.h"
 #include "parse.tab.h"
 
@@ -19,10 +21,17 @@ public:
 
 private:
   StorageCalculator m_storage_calc;
+  // storage used by the enclosing blocks, and the most used by any
+  // path of nested blocks so far
   unsigned m_total_local_storage;
+  unsigned m_max_local_storage;
   int m_next_vreg;
   std::vector<Node *> m_str_node;
   std::vector<Symbol *> m_sym;
+  // variables whose address is taken, which are allocated after the
+  // function's blocks (since they may be used outside the block the
+  // address is taken in)
+  std::vector<Symbol *> m_addr_taken;
 
   //str label start at 0
   int str_lb = 0;
@@ -0,0 +1,657 @@
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <numeric>
+#include <set>
+#include "instruction.h"
+#include "operand.h"
+#include "highlevel.h"
+#include "highlevel_defuse.h"
+#include "loop_nest_optimization.h"
+
+namespace{
+
+  // the size of a cache line, and of the (level 1 data) cache, in bytes
+  const long CACHE_LINE = 64;
+  const long CACHE_SIZE = 32768;
+
+  // the fewest iterations a strip of a tiled loop has
+  const long MIN_TILE = 8;
+
+  // vregs used by the strips of a tiled loop
+  const unsigned TILE_VREGS = 4;
+
+  // the largest coefficient of an affine address kept track of, so
+  // that multiplying it by a step can't overflow
+  const long MAX_COEFFICIENT = 1L << 30;
+
+  // the largest step of a tiled loop, so that a strip's span fits in an int
+  const long MAX_TILED_STEP = 1L << 20;
+
+  bool in_range(int opcode, int first, int last){
+    return opcode >= first && opcode <= last;
+  }
+
+  bool is_cjmp(int opcode){
+    return opcode == HINS_cjmp_t || opcode == HINS_cjmp_f;
+  }
+
+  // the opcodes of an operation come in _b, _w, _l, _q order
+  int get_size_index(unsigned size){
+    return (size == 8) ? 3 : (size == 4) ? 2 : (size == 2) ? 1 : 0;
+  }
+
+  // The instructions of a block, leaving out nops and the branch at
+  // the end (if any)
+  std::vector<Instruction*> get_instructions(const std::vector<Instruction*>& ins){
+    std::vector<Instruction*> result;
+    for(unsigned i = 0; i < ins.size(); i++){
+      int opcode = ins[i]->get_opcode();
+      if(opcode != HINS_nop && !(i == ins.size() - 1 && (opcode == HINS_jmp || is_cjmp(opcode)))){
+        result.push_back(ins[i]);
+      }
+    }
+    return result;
+  }
+
+  // Whether a block has the instructions of run, one after the other
+  bool has_run(const std::vector<Instruction*>& ins, const std::vector<Instruction*>& run){
+    return std::search(ins.begin(), ins.end(), run.begin(), run.end()) != ins.end();
+  }
+
+  // Replace a run of instructions of a block with others
+  void replace(std::vector<Instruction*>& ins, const std::vector<Instruction*>& old, const std::vector<Instruction*>& replacement){
+    auto i = std::find(ins.begin(), ins.end(), old.front());
+    i = ins.erase(i, i + old.size());
+    ins.insert(i, replacement.begin(), replacement.end());
+  }
+
+  // The bytes of the cache lines an access goes on to in each
+  // iteration, when the address changes by stride
+  long get_cost(long stride){
+    return std::min(std::labs(stride), CACHE_LINE);
+  }
+
+}
+
+LoopNestOptimization::LoopNestOptimization(const std::shared_ptr<ControlFlowGraph>& cfg, int next_vreg, unsigned next_label_num)
+  : CountedLoopTransform(cfg, next_vreg, next_label_num, ".LN"){
+}
+
+LoopNestOptimization::~LoopNestOptimization(){
+}
+
+bool LoopNestOptimization::transform_loop(const Loop& loop, const std::vector<Instruction*>& body){
+  Nest nest;
+  std::vector<Access> accesses;
+  if(!find_nest(loop, body, nest) || !check_values(nest) || !get_accesses(nest, accesses)){
+    return false;
+  }
+
+  // interchange the loops if the inner one would then move on to
+  // fewer new cache lines
+  long outer_cost = 0, inner_cost = 0;
+  for(const Access& access : accesses){
+    if(access.address.kind != Affine::UNKNOWN){
+      outer_cost += get_cost(access.address.outer * nest.outer.step);
+      inner_cost += get_cost(access.address.inner * nest.inner.step);
+    }
+  }
+  bool swap = outer_cost < inner_cost;
+
+  // a loop with its test at the end does its first iteration without
+  // one, so the other loop can only take its place if it does at least
+  // one iteration
+  auto has_iterations = [](const Level& level){
+    if(!level.start.is_imm_ival() || !level.bound.is_imm_ival()){
+      return false;
+    }
+    long start = level.start.get_imm_ival(), bound = level.bound.get_imm_ival();
+    switch(level.compare){
+      case 0: return start < bound;
+      case 1: return start <= bound;
+      case 2: return start > bound;
+      default: return start >= bound;
+    }
+  };
+  if((nest.inner_test == nest.inner_body && !has_iterations(nest.outer))
+     || (nest.outer_test == nest.latch && !has_iterations(nest.inner))){
+    swap = false;
+  }
+
+  // tile the (new) inner loop if some accesses go on to a new cache
+  // line in each of its iterations, but not in each of the outer
+  // loop's, so their lines would be used again if they were still in
+  // the cache; the strips are as long as keeps the lines of all of
+  // them in half the cache
+  const Level& inner = swap ? nest.outer : nest.inner;
+  long strided = 0;
+  for(const Access& access : accesses){
+    long inner_stride = swap ? access.address.outer * nest.outer.step : access.address.inner * nest.inner.step;
+    long outer_stride = swap ? access.address.inner * nest.inner.step : access.address.outer * nest.outer.step;
+    if(access.address.kind != Affine::UNKNOWN && std::labs(inner_stride) >= CACHE_LINE
+       && std::labs(outer_stride) < CACHE_LINE){
+      strided++;
+    }
+  }
+  long tile_size = (strided > 0) ? std::max(CACHE_SIZE / (2 * CACHE_LINE * strided), MIN_TILE) : 0;
+  bool tiled = strided > 0 && inner.compare == 0 && inner.step > 0 && inner.step <= MAX_TILED_STEP
+    && m_next_vreg + TILE_VREGS <= LiveVregsAnalysis::MAX_VREGS;
+  if(tiled && inner.start.is_imm_ival() && inner.bound.is_imm_ival()){
+    // a loop with no more iterations than a strip is left alone
+    tiled = (inner.bound.get_imm_ival() - inner.start.get_imm_ival()) / inner.step > tile_size;
+  }
+
+  if((!swap && !tiled) || !is_permutable(nest, accesses)){
+    return false;
+  }
+  if(swap){
+    interchange(nest);
+  }
+  if(tiled){
+    tile(nest, tile_size);
+  }
+  return true;
+}
+
+// Find the loop around a counted loop, which together with it has the
+// shape of a Nest
+bool LoopNestOptimization::find_nest(const Loop& loop, const std::vector<Instruction*>& body, Nest& nest){
+  // the inner loop is a body and a test, or a body ending with the test
+  if(loop.exit < 0 || !(loop.blocks.size() == 1 || (loop.blocks.size() == 2 && loop.entry == 1
+                                                      && m_blocks[loop.blocks[1]].ins.size() == 2))){
+    return false;
+  }
+  nest.inner_body = loop.blocks.front();
+  nest.inner_test = loop.blocks.back();
+  nest.latch = loop.exit;
+  int inner_head = loop.blocks[loop.entry];
+
+  // the inner body ends with the update of its iv
+  std::vector<Instruction*> inner_body = get_instructions(m_blocks[nest.inner_body].ins);
+  if(inner_body.size() + loop.blocks.size() - 1 != body.size() || !HighLevel::is_def(body[body.size() - 2])
+     || body[body.size() - 2]->get_operand(0).get_base_reg() != loop.iv){
+    return false;
+  }
+  nest.work.assign(body.begin(), body.begin() + loop.iv_update);
+  nest.inner_update.assign(body.begin() + loop.iv_update, body.end() - 1);
+  if(!has_run(m_blocks[nest.inner_body].ins, nest.inner_update)){
+    return false;
+  }
+
+  // the blocks around it are only reached the way they are in a pair
+  // of for loops
+  std::vector<std::vector<int>> preds = get_predecessors();
+  auto goes_to = [&](int b, int target){
+    const Block& block = m_blocks[b];
+    return block.table.empty() && ((block.taken == target && block.next == NO_BLOCK)
+                                   || (block.taken == NO_BLOCK && block.next == target));
+  };
+  const std::vector<int>& head_preds = preds[inner_head];
+  if(head_preds.size() != 2 || preds[nest.latch].size() != 1){
+    return false;
+  }
+  nest.inner_init = (head_preds[0] == nest.inner_body) ? head_preds[1] : head_preds[0];
+  if(!goes_to(nest.inner_init, inner_head)){
+    return false;
+  }
+  const Block& latch = m_blocks[nest.latch];
+  bool test_at_end = !latch.ins.empty() && is_cjmp(latch.ins.back()->get_opcode());
+  if(test_at_end){
+    nest.outer_test = nest.latch;
+    nest.outer_entry = nest.inner_init;
+  } else{
+    if(preds[nest.inner_init].size() != 1){
+      return false;
+    }
+    nest.outer_test = nest.outer_entry = preds[nest.inner_init][0];
+    const Block& outer_test = m_blocks[nest.outer_test];
+    if(!goes_to(nest.latch, nest.outer_test) || outer_test.ins.size() != 2 || !is_cjmp(outer_test.ins.back()->get_opcode())){
+      return false;
+    }
+  }
+  const Block& outer_test = m_blocks[nest.outer_test];
+  if(outer_test.taken != nest.inner_init && outer_test.next != nest.inner_init){
+    return false;
+  }
+  nest.exit = (outer_test.taken == nest.inner_init) ? outer_test.next : outer_test.taken;
+  const std::vector<int>& entry_preds = preds[nest.outer_entry];
+  if(entry_preds.size() != 2 || (entry_preds[0] != nest.latch && entry_preds[1] != nest.latch)){
+    return false;
+  }
+  nest.preheader = (entry_preds[0] == nest.latch) ? entry_preds[1] : entry_preds[0];
+  std::vector<int> blocks = { nest.inner_init };
+  blocks.insert(blocks.end(), loop.blocks.begin(), loop.blocks.end());
+  blocks.push_back(nest.latch);
+  if(!test_at_end){
+    blocks.push_back(nest.outer_test);
+  }
+  for(int b : { nest.exit, nest.preheader }){
+    if(b < 0 || std::find(blocks.begin(), blocks.end(), b) != blocks.end()){
+      return false;
+    }
+  }
+  if(!goes_to(nest.preheader, nest.outer_entry) || m_first == nest.outer_entry){
+    return false;
+  }
+
+  // the outer loop is a counted loop too, whose latch just updates its
+  // iv (and tests it, if the test is at the end)
+  Loop outer;
+  outer.blocks = blocks;
+  outer.entry = test_at_end ? 0 : unsigned(blocks.size() - 1);
+  outer.continue_taken = outer_test.taken == nest.inner_init;
+  outer.exit = nest.exit;
+  nest.body = get_body(blocks, 0);
+  if(!find_induction_variable(nest.body, outer)){
+    return false;
+  }
+  nest.outer_update.assign(nest.body.begin() + outer.iv_update, nest.body.end() - 1);
+  std::vector<Instruction*> latch_ins = nest.outer_update;
+  if(test_at_end){
+    latch_ins.push_back(nest.body.back());
+  }
+  if(latch_ins != get_instructions(latch.ins) || !has_run(latch.ins, nest.outer_update)){
+    return false;
+  }
+
+  // the ivs start from, and go up to, values which the nest doesn't
+  // change (so the inner loop's range doesn't depend on the outer iv)
+  auto is_invariant = [&](const Operand& op){
+    return op.is_imm_ival() || (op.get_kind() == Operand::VREG && count_defs(nest.body, op.get_base_reg()) == 0);
+  };
+  auto find_init = [&](int block, int iv, unsigned size, unsigned& pos){
+    const std::vector<Instruction*>& ins = m_blocks[block].ins;
+    pos = unsigned(ins.size());
+    while(pos > 0 && !(HighLevel::is_def(ins[pos - 1]) && ins[pos - 1]->get_operand(0).get_base_reg() == iv)){
+      pos--;
+    }
+    if(pos == 0 || ins[--pos]->get_opcode() != HINS_mov_b + get_size_index(size) || !is_invariant(ins[pos]->get_operand(1))){
+      return false;
+    }
+    return true;
+  };
+  if(!find_init(nest.inner_init, loop.iv, loop.size, nest.inner_init_pos) || !is_invariant(loop.bound)
+     || !find_init(nest.preheader, outer.iv, outer.size, nest.outer_init)){
+    return false;
+  }
+  nest.inner = { loop.iv, loop.step, loop.compare, loop.size, m_blocks[nest.inner_init].ins[nest.inner_init_pos]->get_operand(1), loop.bound };
+  nest.outer = { outer.iv, outer.step, outer.compare, outer.size, m_blocks[nest.preheader].ins[nest.outer_init]->get_operand(1), outer.bound };
+
+  // the initializations are exchanged, or moved, so whatever else the
+  // preheader does after its one either doesn't involve the ivs or
+  // their initial values, or is dead (such as the comparisons left
+  // from tests CfgSimplification has taken out), and inner_init does
+  // nothing else but dead computations
+  std::vector<int> ivs = { outer.iv, loop.iv };
+  for(const Operand& start : { nest.outer.start, nest.inner.start }){
+    if(start.get_kind() == Operand::VREG){
+      ivs.push_back(start.get_base_reg());
+    }
+  }
+  for(auto init : { std::make_pair(nest.preheader, nest.outer_init), std::make_pair(nest.inner_init, nest.inner_init_pos) }){
+    const std::vector<Instruction*>& ins = m_blocks[init.first].ins;
+    for(unsigned i = (init.first == nest.inner_init) ? 0 : init.second + 1; i < ins.size(); i++){
+      if(i == init.second || ins[i]->get_opcode() == HINS_jmp){
+        continue;
+      }
+      std::vector<int> vregs;
+      for(unsigned j = 0; j < ins[i]->get_num_operands(); j++){
+        get_vregs(ins[i]->get_operand(j), vregs);
+      }
+      bool involves_ivs = std::find_first_of(vregs.begin(), vregs.end(), ivs.begin(), ivs.end()) != vregs.end();
+      bool defines_ivs = HighLevel::is_def(ins[i]) && std::count(ivs.begin(), ivs.end(), ins[i]->get_operand(0).get_base_reg()) != 0;
+      if(defines_ivs || ((involves_ivs || init.first == nest.inner_init) && !is_dead(init.first, i))){
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Whether an instruction of a block (of the original cfg) only
+// assigns a vreg which isn't used afterwards
+bool LoopNestOptimization::is_dead(int block, unsigned index){
+  const BasicBlock* bb = m_blocks[block].orig;
+  Instruction* ins = m_blocks[block].ins[index];
+  if(bb == nullptr || !HighLevel::is_def(ins) || ins->get_opcode() == HINS_call){
+    return false;
+  }
+  for(unsigned i = 0; i < ins->get_num_operands(); i++){
+    if(ins->get_operand(i).is_memref()){
+      return false;
+    }
+  }
+  return !get_live_vregs().get_fact_after_instruction(bb, bb->get_instruction(index)).test(ins->get_operand(0).get_base_reg());
+}
+
+const LiveVregs& LoopNestOptimization::get_live_vregs(){
+  if(!m_live_vregs){
+    m_live_vregs.reset(new LiveVregs(m_cfg));
+    m_live_vregs->execute();
+  }
+  return *m_live_vregs;
+}
+
+// Whether the order of the inner body's iterations doesn't matter to
+// the values it computes: the vregs it assigns are either set before
+// they are used in each iteration, or are sums (and the like) of
+// something computed in each iteration, s = s + x, or t = s + x
+// followed by s = t. None of the values the nest computes, but the
+// sums, are used after it.
+bool LoopNestOptimization::check_values(const Nest& nest){
+  const std::vector<Instruction*>& work = nest.work;
+  std::set<int> assigned, carried;
+  for(Instruction* ins : work){
+    for(unsigned i = 0; i < ins->get_num_operands(); i++){
+      if(HighLevel::is_use(ins, i)){
+        std::vector<int> vregs;
+        get_vregs(ins->get_operand(i), vregs);
+        for(int vreg : vregs){
+          if(assigned.count(vreg) == 0 && vreg != nest.outer.iv && vreg != nest.inner.iv && count_defs(nest.body, vreg) != 0){
+            carried.insert(vreg);
+          }
+        }
+      }
+    }
+    if(HighLevel::is_def(ins)){
+      assigned.insert(ins->get_operand(0).get_base_reg());
+    }
+  }
+
+  for(int sum : carried){
+    if(count_defs(nest.body, sum) != 1 || count_uses(work, sum) != 1){
+      return false;
+    }
+    unsigned k = 0;
+    while(count_uses({ work[k] }, sum) == 0){
+      k++;
+    }
+    Instruction* ins = work[k];
+    int opcode = ins->get_opcode();
+    bool is_sub = in_range(opcode, HINS_sub_b, HINS_sub_q);
+    if(!in_range(opcode, HINS_add_b, HINS_add_q) && !is_sub && !in_range(opcode, HINS_and_b, HINS_xor_q)){
+      return false;
+    }
+    Operand left = ins->get_operand(1), right = ins->get_operand(2);
+    bool on_left = left.get_kind() == Operand::VREG && left.get_base_reg() == sum;
+    if(!on_left && (is_sub || right.get_kind() != Operand::VREG || right.get_base_reg() != sum)){
+      return false;
+    }
+    int dest = ins->get_operand(0).get_base_reg();
+    if(dest == sum){
+      continue;
+    }
+    // the partial sum is only copied to the sum
+    unsigned size = highlevel_opcode_get_source_operand_size(HighLevelOpcode(opcode));
+    Instruction* copy = (k + 1 < work.size()) ? work[k + 1] : nullptr;
+    if(copy == nullptr || copy->get_opcode() != HINS_mov_b + get_size_index(size) || copy->get_operand(0).get_base_reg() != sum
+       || copy->get_operand(1).get_kind() != Operand::VREG || copy->get_operand(1).get_base_reg() != dest){
+      return false;
+    }
+    for(unsigned j = k + 2; j < work.size(); j++){
+      if(count_uses({ work[j] }, dest) != 0){
+        return false;
+      }
+      if(HighLevel::is_def(work[j]) && work[j]->get_operand(0).get_base_reg() == dest){
+        break;
+      }
+    }
+  }
+
+  if(m_blocks[nest.exit].orig == nullptr){
+    return false;
+  }
+  const LiveVregs::FactType& live = get_live_vregs().get_fact_at_beginning_of_block(m_blocks[nest.exit].orig);
+  for(Instruction* ins : nest.body){
+    if(HighLevel::is_def(ins)){
+      int vreg = ins->get_operand(0).get_base_reg();
+      if(carried.count(vreg) == 0 && live.test(vreg)){
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// The memory accesses of the inner body, with their addresses as far
+// as they are affine functions of the ivs
+bool LoopNestOptimization::get_accesses(const Nest& nest, std::vector<Access>& accesses){
+  std::map<int, Affine> values;
+  for(Instruction* ins : nest.work){
+    int opcode = ins->get_opcode();
+    bool is_mov = in_range(opcode, HINS_mov_b, HINS_mov_q);
+    unsigned size = is_mov ? highlevel_opcode_get_source_operand_size(HighLevelOpcode(opcode)) : 0;
+    for(unsigned i = 0; i < ins->get_num_operands(); i++){
+      Operand op = ins->get_operand(i);
+      if(!op.is_memref()){
+        continue;
+      }
+      if(!is_mov){
+        return false;
+      }
+      Affine address = { Affine::UNKNOWN, 0, 0, 0, 0 };
+      if(op.get_kind() == Operand::FRAME_MEM_OFF){
+        address = { Affine::FRAME, int(op.get_frame_slot()), 0, 0, op.get_offset() };
+      } else if(op.get_kind() == Operand::VREG_MEM || op.get_kind() == Operand::VREG_MEM_OFF){
+        address = get_affine(nest, Operand(Operand::VREG, op.get_base_reg()), values);
+        if(op.get_kind() == Operand::VREG_MEM_OFF){
+          address.offset += op.get_offset();
+        }
+      }
+      accesses.push_back({ address, size, i == 0 });
+    }
+    if(!HighLevel::is_def(ins)){
+      continue;
+    }
+
+    Affine value = { Affine::UNKNOWN, 0, 0, 0, 0 };
+    Affine left = (ins->get_num_operands() > 1) ? get_affine(nest, ins->get_operand(1), values) : value;
+    Affine right = (ins->get_num_operands() > 2) ? get_affine(nest, ins->get_operand(2), values) : value;
+    bool is_add = in_range(opcode, HINS_add_b, HINS_add_q), is_sub = in_range(opcode, HINS_sub_b, HINS_sub_q);
+    if((is_mov && !ins->get_operand(1).is_memref()) || opcode == HINS_sconv_lq){
+      value = left;
+    } else if(opcode == HINS_localaddr){
+      value = { Affine::FRAME, int(ins->get_operand(1).get_imm_ival()), 0, 0, 0 };
+    } else if(left.kind != Affine::UNKNOWN && right.kind != Affine::UNKNOWN){
+      if(is_add && (left.kind == Affine::NONE || right.kind == Affine::NONE)){
+        value = { (left.kind == Affine::NONE) ? right.kind : left.kind, (left.kind == Affine::NONE) ? right.base : left.base,
+                  left.outer + right.outer, left.inner + right.inner, left.offset + right.offset };
+      } else if(is_sub && right.kind == Affine::NONE){
+        value = { left.kind, left.base, left.outer - right.outer, left.inner - right.inner, left.offset - right.offset };
+      } else if(in_range(opcode, HINS_mul_b, HINS_mul_q) && left.kind == Affine::NONE && right.kind == Affine::NONE
+                && ((right.outer == 0 && right.inner == 0) || (left.outer == 0 && left.inner == 0))){
+        const Affine& a = (right.outer == 0 && right.inner == 0) ? left : right;
+        long factor = (right.outer == 0 && right.inner == 0) ? right.offset : left.offset;
+        if(std::labs(factor) <= MAX_COEFFICIENT){
+          value = { Affine::NONE, 0, a.outer * factor, a.inner * factor, a.offset * factor };
+        }
+      }
+    }
+    if(std::labs(value.outer) > MAX_COEFFICIENT || std::labs(value.inner) > MAX_COEFFICIENT
+       || std::labs(value.offset) > MAX_COEFFICIENT * MAX_COEFFICIENT){
+      value.kind = Affine::UNKNOWN;
+    }
+    values[ins->get_operand(0).get_base_reg()] = value;
+  }
+  return true;
+}
+
+// An operand as an affine function of the ivs; values has the vregs
+// the inner body has assigned so far
+LoopNestOptimization::Affine LoopNestOptimization::get_affine(const Nest& nest, const Operand& op,
+                                                              const std::map<int, Affine>& values){
+  if(op.is_imm_ival()){
+    return { Affine::NONE, 0, 0, 0, op.get_imm_ival() };
+  }
+  if(op.get_kind() != Operand::VREG){
+    return { Affine::UNKNOWN, 0, 0, 0, 0 };
+  }
+  int vreg = op.get_base_reg();
+  auto i = values.find(vreg);
+  if(i != values.end()){
+    return i->second;
+  }
+  if(vreg == nest.outer.iv){
+    return { Affine::NONE, 0, 1, 0, 0 };
+  }
+  if(vreg == nest.inner.iv){
+    return { Affine::NONE, 0, 0, 1, 0 };
+  }
+  if(count_defs(nest.body, vreg) != 0){
+    return { Affine::UNKNOWN, 0, 0, 0, 0 };
+  }
+  return { Affine::VREG, vreg, 0, 0, 0 };
+}
+
+// Whether the iterations can be done in any order as far as memory is
+// concerned: nothing stored to is accessed by another iteration,
+// except by ones with the same outer iv, or the same inner iv (which
+// interchanging and tiling keep in the same order)
+bool LoopNestOptimization::is_permutable(const Nest& nest, const std::vector<Access>& accesses){
+  for(const Access& store : accesses){
+    if(!store.is_store){
+      continue;
+    }
+    for(const Access& access : accesses){
+      if(!is_independent(nest, store, access)){
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool LoopNestOptimization::is_independent(const Nest& nest, const Access& a, const Access& b){
+  const Affine& x = a.address;
+  const Affine& y = b.address;
+  if(x.kind == Affine::UNKNOWN || y.kind == Affine::UNKNOWN){
+    return false;
+  }
+  if(x.kind != y.kind || x.base != y.base){
+    // different local variables don't overlap
+    return x.kind == Affine::FRAME && y.kind == Affine::FRAME;
+  }
+  if(a.size != b.size){
+    return false;
+  }
+
+  // the elements overlap if the difference of the addresses, which is
+  // the difference of the offsets plus a multiple of g, is less than
+  // the size
+  long size = long(a.size), d = x.offset - y.offset;
+  auto no_overlap = [&](long g){
+    if(g == 0){
+      return std::labs(d) >= size;
+    }
+    long r = ((d % g) + g) % g;
+    return r >= size && g - r >= size;
+  };
+  if(x.outer != y.outer || x.inner != y.inner){
+    return no_overlap(std::gcd(std::gcd(x.outer, x.inner), std::gcd(y.outer, y.inner)));
+  }
+  long outer_stride = x.outer * nest.outer.step, inner_stride = x.inner * nest.inner.step;
+  if(no_overlap(std::gcd(outer_stride, inner_stride))){
+    return true;
+  }
+
+  // otherwise, if one iv changing by a step moves the address further
+  // than the other one can over its whole range, only iterations with
+  // the same value of the first one can access the same element
+  auto get_reach = [](long coefficient, const Level& level){
+    if(coefficient == 0){
+      return __int128(0);
+    }
+    if(!level.start.is_imm_ival() || !level.bound.is_imm_ival()){
+      return __int128(INT64_MAX);
+    }
+    // the iv can't reach a bound it is compared to with < or >
+    long range = std::labs(level.bound.get_imm_ival() - level.start.get_imm_ival());
+    if(level.compare == 0 || level.compare == 2){
+      range = std::max(range - 1, 0L);
+    }
+    return __int128(std::labs(coefficient)) * range;
+  };
+  return std::labs(outer_stride) >= get_reach(x.inner, nest.inner) + std::labs(d) + size
+    || std::labs(inner_stride) >= get_reach(x.outer, nest.outer) + std::labs(d) + size;
+}
+
+// Make the outer loop the inner one, and the other way around, by
+// exchanging their initializations, tests and updates
+void LoopNestOptimization::interchange(Nest& nest){
+  std::swap(m_blocks[nest.preheader].ins[nest.outer_init], m_blocks[nest.inner_init].ins[nest.inner_init_pos]);
+  replace(m_blocks[nest.inner_body].ins, nest.inner_update, nest.outer_update);
+  replace(m_blocks[nest.latch].ins, nest.outer_update, nest.inner_update);
+  std::swap(nest.outer_update, nest.inner_update);
+
+  Instruction* outer_cmp = get_comparison(nest.outer_test, nest.inner_init, nest.inner, Operand(Operand::VREG, nest.inner.iv), nest.inner.bound);
+  Instruction* inner_cmp = get_comparison(nest.inner_test, nest.inner_body, nest.outer, Operand(Operand::VREG, nest.outer.iv), nest.outer.bound);
+  for(auto test : { std::make_pair(nest.outer_test, outer_cmp), std::make_pair(nest.inner_test, inner_cmp) }){
+    std::vector<Instruction*>& ins = m_blocks[test.first].ins;
+    delete ins[ins.size() - 2];
+    ins[ins.size() - 2] = test.second;
+  }
+  std::swap(nest.outer, nest.inner);
+}
+
+// Do the inner loop in strips of tile_size iterations, with the strips
+// in a loop around the outer loop:
+//
+//   preheader:   ...; ii = inner start
+//   strip_test:  cjmp to strip_setup if ii < inner bound, or else to exit
+//   strip_setup: limit = min(ii + tile_size * step, inner bound);
+//                outer iv = outer start                     (goes where the preheader went)
+//   outer_test:  ... (to inner_init, or else to strip_latch)
+//   inner_init:  inner iv = ii
+//   inner_test:  cjmp to inner_body if inner iv < limit, or else to latch
+//   ...
+//   strip_latch: ii = limit                                 (goes to strip_test)
+//
+// The minimum is worked out from the distance to the bound, so that
+// ii + tile_size * step is only computed if it doesn't overflow.
+void LoopNestOptimization::tile(Nest& nest, long tile_size){
+  const Level& inner = nest.inner;
+  int s = get_size_index(inner.size);
+  Operand strip(Operand::VREG, m_next_vreg++), limit(Operand::VREG, m_next_vreg++);
+  Operand room(Operand::VREG, m_next_vreg++), flag(Operand::VREG, m_next_vreg++);
+  Operand span(Operand::IMM_IVAL, tile_size * inner.step);
+
+  int code_order = m_blocks[nest.outer_test].code_order;
+  int strip_latch = add_block(code_order, { new Instruction(HINS_mov_b + s, strip, limit) }, NO_BLOCK, NO_BLOCK);
+  int strip_setup = add_block(code_order, {
+      new Instruction(HINS_sub_b + s, room, inner.bound, strip),
+      new Instruction(HINS_cmpgt_b + s, flag, room, span),
+      new Instruction(HINS_add_b + s, room, strip, span),
+      new Instruction(HINS_select_b + s, limit, flag, room, inner.bound),
+      m_blocks[nest.preheader].ins[nest.outer_init]->duplicate(),
+    }, NO_BLOCK, nest.outer_entry);
+  int strip_test = add_block(code_order, { new Instruction(HINS_cmplt_b + s, flag, strip, inner.bound) }, strip_setup, nest.exit);
+  m_blocks[strip_test].ins.push_back(new Instruction(HINS_cjmp_t, flag, Operand(Operand::LABEL, m_blocks[strip_setup].label)));
+  m_blocks[strip_latch].next = strip_test;
+
+  Instruction*& outer_init = m_blocks[nest.preheader].ins[nest.outer_init];
+  delete outer_init;
+  outer_init = new Instruction(HINS_mov_b + s, strip, inner.start);
+  retarget(m_blocks[nest.preheader], nest.outer_entry, strip_test);
+  retarget(m_blocks[nest.outer_test], nest.exit, strip_latch);
+
+  Instruction*& inner_init = m_blocks[nest.inner_init].ins[nest.inner_init_pos];
+  delete inner_init;
+  inner_init = new Instruction(HINS_mov_b + s, Operand(Operand::VREG, inner.iv), strip);
+  Instruction* inner_cmp = get_comparison(nest.inner_test, nest.inner_body, inner, Operand(Operand::VREG, inner.iv), limit);
+  std::vector<Instruction*>& ins = m_blocks[nest.inner_test].ins;
+  delete ins[ins.size() - 2];
+  ins[ins.size() - 2] = inner_cmp;
+}
+
+// A comparison of iv against bound for the test of a loop, going the
+// way of the level's comparison, for the test's cjmp (which goes on
+// with the loop by going to continue_target)
+Instruction* LoopNestOptimization::get_comparison(int test, int continue_target, const Level& level,
+                                                  const Operand& iv, const Operand& bound){
+  const Block& t = m_blocks[test];
+  bool flag_continues = (t.ins.back()->get_opcode() == HINS_cjmp_t) == (t.taken == continue_target);
+  int compare = flag_continues ? level.compare : 3 - level.compare;
+  Operand flag = t.ins[t.ins.size() - 2]->get_operand(0);
+  return new Instruction(HINS_cmplt_b + 4 * compare + get_size_index(level.size), flag, iv, bound);
+}
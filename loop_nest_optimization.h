@@ -0,0 +1,120 @@
+#ifndef LOOP_NEST_OPTIMIZATION_H
+#define LOOP_NEST_OPTIMIZATION_H
+
+#include <map>
+#include <memory>
+#include <vector>
+#include "cfg.h"
+#include "live_vregs.h"
+#include "counted_loop_transform.h"
+
+// LoopNestOptimization improves the locality of the memory accesses of
+// perfectly nested pairs of counted loops (see CountedLoopTransform),
+// such as those going through the elements of two-dimensional arrays:
+//
+//   for(j = ...; j < n; j = j + 1)
+//     for(i = ...; i < m; i = i + 1)
+//       s = s + a[i][j];
+//
+// The addresses the inner body accesses are worked out as affine
+// functions of the two induction variables (as the code generated for
+// a[i][j] computes them), and the loops are interchanged if that makes
+// the inner loop go through memory with smaller strides. If some
+// access still has a stride of a cache line or more in the inner loop,
+// but not in the outer one (as transposing a matrix does), the inner
+// loop is tiled: it is done in strips which are short enough for the
+// cache lines they touch to stay in the cache until the outer loop
+// comes back to them.
+//
+//   for(ii = ...; ii < m; ii = limit){
+//     limit = (m - ii > T) ? ii + T : m;
+//     for(j = ...; j < n; j = j + 1)
+//       for(i = ii; i < limit; i = i + 1)
+//         ...
+//   }
+//
+// Both transformations change the order of the iterations, so they are
+// only done if the inner body's values don't carry over from one
+// iteration to the next (except for sums and the like, which come out
+// the same in any order) and a dependence test shows that no element
+// of memory stored to is also accessed by another iteration which the
+// new order would put on the other side of it. The test only knows the
+// ranges of the induction variables when the loops' bounds are
+// constants, so nests storing to an array mostly need those.
+class LoopNestOptimization : public CountedLoopTransform{
+private:
+  // One of the loops of a nest
+  struct Level{
+    int iv;
+    long step;
+    int compare;           // of the iv against the bound, as in Loop
+    unsigned size;         // of the iv
+    Operand start, bound;  // the iv's initial value, and the bound
+  };
+
+  // A pair of nested loops, in the shape a pair of for loops has:
+  //
+  //   preheader:   ...; outer iv = start                    (goes to outer_test)
+  //   outer_test:  compare; cjmp to inner_init or exit
+  //   inner_init:  inner iv = start                         (goes to inner_test)
+  //   inner_test:  compare; cjmp to inner_body or latch
+  //   inner_body:  ...; inner iv = inner iv + step          (goes to inner_test)
+  //   latch:       outer iv = outer iv + step               (goes to outer_test)
+  //
+  // Either loop may also have its test at the end instead, as
+  // CfgSimplification leaves a loop whose first test always passes:
+  // the inner_test is then the inner_body, and the outer_test the
+  // latch, which goes to inner_init.
+  struct Nest{
+    Level outer, inner;
+    int preheader, outer_test, inner_init, inner_test, inner_body, latch, exit;
+    int outer_entry;                        // the block the preheader goes to
+    unsigned outer_init, inner_init_pos;    // the positions of the ivs' initializations in their blocks
+    std::vector<Instruction*> body;         // all the instructions of the nest (as get_body has them)
+    std::vector<Instruction*> work;         // the inner body, without its iv's update
+    std::vector<Instruction*> outer_update, inner_update;
+  };
+
+  // An address, as base + outer * outer iv + inner * inner iv + offset
+  struct Affine{
+    enum Base{
+      UNKNOWN,  // not an affine function of the ivs
+      NONE,     // just a number
+      VREG,     // the value of a vreg the nest doesn't assign (a pointer)
+      FRAME,    // the address of a local variable (in frame slot base)
+    } kind;
+    int base;
+    long outer, inner, offset;
+  };
+
+  struct Access{
+    Affine address;
+    unsigned size;
+    bool is_store;
+  };
+
+  std::unique_ptr<LiveVregs> m_live_vregs;  // of the original cfg, computed when needed
+
+public:
+  // the new blocks are labeled .LN<n>
+  LoopNestOptimization(const std::shared_ptr<ControlFlowGraph>& cfg, int next_vreg, unsigned next_label_num);
+  virtual ~LoopNestOptimization();
+
+protected:
+  virtual bool transform_loop(const Loop& loop, const std::vector<Instruction*>& body);
+
+private:
+  bool find_nest(const Loop& loop, const std::vector<Instruction*>& body, Nest& nest);
+  bool is_dead(int block, unsigned index);
+  const LiveVregs& get_live_vregs();
+  bool check_values(const Nest& nest);
+  bool get_accesses(const Nest& nest, std::vector<Access>& accesses);
+  Affine get_affine(const Nest& nest, const Operand& op, const std::map<int, Affine>& values);
+  bool is_permutable(const Nest& nest, const std::vector<Access>& accesses);
+  bool is_independent(const Nest& nest, const Access& a, const Access& b);
+  void interchange(Nest& nest);
+  void tile(Nest& nest, long tile_size);
+  Instruction* get_comparison(int test, int continue_target, const Level& level, const Operand& iv, const Operand& bound);
+};
+
+#endif // LOOP_NEST_OPTIMIZATION_H
@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <map>
+#include <set>
+#include "instruction.h"
+#include "operand.h"
+#include "highlevel.h"
+#include "highlevel_defuse.h"
+#include "live_vregs.h"
+#include "local_storage_allocation.h"
+#include "loop_unrolling.h"
+
+namespace{
+
+  // the most instructions an unrolled body may have
+  const unsigned MAX_UNROLLED_SIZE = 64;
+
+  // vregs used by the guard of an unrolled loop
+  const unsigned GUARD_VREGS = 3;
+
+  Operand rename(const Operand& op, const std::map<int, int>& names){
+    auto get_name = [&](int vreg){
+      auto i = names.find(vreg);
+      return (i != names.end()) ? i->second : vreg;
+    };
+    switch(op.get_kind()){
+      case Operand::VREG: case Operand::VREG_MEM:
+        return Operand(op.get_kind(), get_name(op.get_base_reg()));
+      case Operand::VREG_MEM_OFF:
+        return Operand(op.get_kind(), get_name(op.get_base_reg()), op.get_offset());
+      case Operand::VREG_MEM_IDX:
+        return Operand(op.get_kind(), get_name(op.get_base_reg()), get_name(op.get_index_reg()), op.get_scale());
+      default:
+        return op;
+    }
+  }
+
+}
+
+LoopUnrolling::LoopUnrolling(const std::shared_ptr<ControlFlowGraph>& cfg, int next_vreg, unsigned next_label_num, unsigned max_factor)
+  : CountedLoopTransform(cfg, next_vreg, next_label_num, ".LU")
+  , m_max_factor(max_factor){
+}
+
+LoopUnrolling::~LoopUnrolling(){
+}
+
+std::shared_ptr<ControlFlowGraph> LoopUnrolling::transform_cfg(){
+  if(m_max_factor < 2){
+    return m_cfg;
+  }
+  return CountedLoopTransform::transform_cfg();
+}
+
+bool LoopUnrolling::transform_loop(const Loop& loop, const std::vector<Instruction*>& body){
+  // a vector vreg takes up two vreg numbers, which renaming doesn't
+  // allow for
+  for(Instruction* ins : body){
+    if(ins->get_opcode() >= HINS_vmov_l && ins->get_opcode() <= HINS_vsum_q){
+      return false;
+    }
+  }
+  std::vector<int> renamed;
+  unsigned factor = choose_factor(body, renamed);
+  return factor >= 2 && unroll(loop, body, factor, renamed);
+}
+
+// The unroll factor: as many copies of the body as fit in the size
+// limit, up to the maximum, and for which there are enough vregs to
+// give each copy but the last its own temporaries. renamed gets the
+// vregs which are assigned before they are used in the body, so their
+// values don't carry over from one iteration to the next.
+unsigned LoopUnrolling::choose_factor(const std::vector<Instruction*>& body, std::vector<int>& renamed){
+  std::set<int> seen;
+  for(Instruction* ins : body){
+    for(unsigned i = 0; i < ins->get_num_operands(); i++){
+      if(HighLevel::is_use(ins, i)){
+        std::vector<int> vregs;
+        get_vregs(ins->get_operand(i), vregs);
+        seen.insert(vregs.begin(), vregs.end());
+      }
+    }
+    if(HighLevel::is_def(ins)){
+      int dest = ins->get_operand(0).get_base_reg();
+      if(seen.insert(dest).second && dest >= LocalStorageAllocation::VREG_FIRST_LOCAL){
+        renamed.push_back(dest);
+      }
+    }
+  }
+
+  unsigned factor = std::min(m_max_factor, unsigned(MAX_UNROLLED_SIZE / body.size()));
+  while(factor >= 2 && m_next_vreg + (factor - 1) * renamed.size() + GUARD_VREGS > LiveVregsAnalysis::MAX_VREGS){
+    factor--;
+  }
+  return factor;
+}
+
+bool LoopUnrolling::unroll(const Loop& loop, const std::vector<Instruction*>& body, unsigned factor, const std::vector<int>& renamed){
+  std::vector<Instruction*> guard;
+  if(!get_guard(loop, factor, guard)){
+    return false;
+  }
+  int start = loop.blocks.front();
+
+  // the guard goes to the unrolled body, or else to the loop
+  int unrolled = add_block(m_blocks[start].code_order, {}, NO_BLOCK, NO_BLOCK);
+  Operand flag = guard.back()->get_operand(0);
+  guard.push_back(new Instruction(HINS_cjmp_t, flag, Operand(Operand::LABEL, m_blocks[unrolled].label)));
+  int check = add_block(m_blocks[start].code_order, guard, unrolled, start);
+
+  // the unrolled body ends with the test, going back to the guard
+  for(unsigned copy = 0; copy < factor; copy++){
+    bool last = copy == factor - 1;
+    std::map<int, int> names;
+    for(Instruction* ins : body){
+      Instruction* dup = ins->duplicate();
+      for(unsigned i = 0; i < dup->get_num_operands(); i++){
+        if(HighLevel::is_use(dup, i)){
+          dup->set_operand(rename(dup->get_operand(i), names), i);
+        }
+      }
+      // a temporary assigned more than once in the body keeps the same
+      // new name throughout a copy, as choose_factor budgets for
+      if(!last && HighLevel::is_def(dup)){
+        int dest = dup->get_operand(0).get_base_reg();
+        if(std::find(renamed.begin(), renamed.end(), dest) != renamed.end()){
+          auto j = names.find(dest);
+          if(j == names.end()){
+            j = names.insert({ dest, m_next_vreg++ }).first;
+          }
+          dup->set_operand(Operand(Operand::VREG, j->second), 0);
+        }
+      }
+      m_blocks[unrolled].ins.push_back(dup);
+    }
+  }
+  append_test(loop, unrolled, check);
+
+  enter_through(loop, check);
+  return true;
+}
@@ -0,0 +1,56 @@
+#ifndef LOOP_UNROLLING_H
+#define LOOP_UNROLLING_H
+
+#include <memory>
+#include <vector>
+#include "cfg.h"
+#include "counted_loop_transform.h"
+
+// LoopUnrolling unrolls the innermost counted loops (see
+// CountedLoopTransform) of a high-level ControlFlowGraph.
+//
+// The loop is left as it is, to run the remaining iterations, and gets
+// an unrolled copy: a guard, which checks that the next factor
+// iterations will all be run, and a block doing them, with the tests
+// between them left out and the temporaries of all but the last copy
+// renamed to fresh vregs (so the copies can be optimized, and scheduled,
+// together). If the loop is entered in the middle, the part up to the
+// test is copied in front of the guard.
+//
+//        entry                     entry
+//          |                         |
+//          v                         v
+//     +->[body]         =>       +->[guard]---------+
+//     |    |                     |    |             |
+//     +--[test]                  |    v             v
+//          |                     |  [body x N]  +->[body]
+//          v                     |    |         |    |
+//                                +--[test]      +--[test]
+//                                     |              |
+//                                     v              v
+//
+// The factor is the largest one up to the maximum which keeps the
+// unrolled body under a size limit; loops containing calls aren't
+// unrolled, since the loop overhead is small compared to a call, and
+// neither are vectorized loops.
+class LoopUnrolling : public CountedLoopTransform{
+private:
+  unsigned m_max_factor;
+
+public:
+  // the new blocks are labeled .LU<n>; loops are unrolled at most
+  // max_factor times (so 1 disables this)
+  LoopUnrolling(const std::shared_ptr<ControlFlowGraph>& cfg, int next_vreg, unsigned next_label_num, unsigned max_factor);
+  virtual ~LoopUnrolling();
+
+  std::shared_ptr<ControlFlowGraph> transform_cfg();
+
+protected:
+  virtual bool transform_loop(const Loop& loop, const std::vector<Instruction*>& body);
+
+private:
+  unsigned choose_factor(const std::vector<Instruction*>& body, std::vector<int>& renamed);
+  bool unroll(const Loop& loop, const std::vector<Instruction*>& body, unsigned factor, const std::vector<int>& renamed);
+};
+
+#endif // LOOP_UNROLLING_H
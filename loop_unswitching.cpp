@@ -0,0 +1,406 @@
+#include <cassert>
+#include <algorithm>
+#include <map>
+#include "instruction.h"
+#include "operand.h"
+#include "highlevel.h"
+#include "highlevel_defuse.h"
+#include "live_vregs.h"
+#include "local_storage_allocation.h"
+#include "loop_unswitching.h"
+
+namespace{
+
+  // block "indices" for a missing successor and for the exit block
+  const int NO_BLOCK = -1;
+  const int EXIT_BLOCK = -2;
+
+  // the most instructions a loop may have to be unswitched
+  const unsigned MAX_UNSWITCH_SIZE = 80;
+
+  // the most instructions the copies of the loops of a function may
+  // add up to
+  const unsigned MAX_UNSWITCH_GROWTH = 320;
+
+  bool in_range(int opcode, int first, int last){
+    return opcode >= first && opcode <= last;
+  }
+
+  bool is_cjmp(int opcode){
+    return opcode == HINS_cjmp_t || opcode == HINS_cjmp_f;
+  }
+
+  // Whether the instruction only computes a vreg from its operands,
+  // and can't trap, so it can be done before the loop instead
+  bool is_hoistable(Instruction* ins){
+    int opcode = ins->get_opcode();
+    if(!in_range(opcode, HINS_add_b, HINS_mul_q) && !in_range(opcode, HINS_cmplt_b, HINS_compl_q)
+       && !in_range(opcode, HINS_mov_b, HINS_uconv_lq)){
+      return false;
+    }
+    for(unsigned i = 0; i < ins->get_num_operands(); i++){
+      if(ins->get_operand(i).is_memref()){
+        return false;
+      }
+    }
+    return ins->get_operand(0).get_kind() == Operand::VREG;
+  }
+
+}
+
+LoopUnswitching::LoopUnswitching(const std::shared_ptr<ControlFlowGraph>& cfg, int next_vreg, unsigned next_label_num)
+  : m_cfg(cfg)
+  , m_first(NO_BLOCK)
+  , m_next_vreg(next_vreg)
+  , m_next_label_num(next_label_num)
+  , m_growth(0){
+}
+
+LoopUnswitching::~LoopUnswitching(){
+  // instructions not moved into a new cfg
+  for(Block& b : m_blocks){
+    for(Instruction* ins : b.ins){
+      delete ins;
+    }
+  }
+}
+
+std::shared_ptr<ControlFlowGraph> LoopUnswitching::transform_cfg(){
+  load_blocks();
+
+  // unswitching a loop adds blocks to the loops around it, so the
+  // loops are found again after each one, with the outer ones (which
+  // have more blocks than the ones they contain) tried first
+  bool changed = false, progress = true;
+  while(progress){
+    std::vector<Loop> loops = find_loops();
+    std::stable_sort(loops.begin(), loops.end(), [](const Loop& a, const Loop& b){
+      return a.blocks.size() > b.blocks.size();
+    });
+    progress = false;
+    for(const Loop& loop : loops){
+      if(unswitch(loop)){
+        changed = progress = true;
+        break;
+      }
+    }
+  }
+
+  return changed ? build_cfg() : m_cfg;
+}
+
+void LoopUnswitching::load_blocks(){
+  std::map<const BasicBlock*, int> index_of;
+  for(auto i = m_cfg->bb_begin(); i != m_cfg->bb_end(); ++i){
+    BasicBlock* bb = *i;
+    if(bb->get_kind() == BASICBLOCK_INTERIOR){
+      index_of[bb] = int(m_blocks.size());
+      m_blocks.push_back({ bb->get_code_order(), bb->get_label(), {}, NO_BLOCK, NO_BLOCK, {} });
+    } else if(bb->get_kind() == BASICBLOCK_EXIT){
+      index_of[bb] = EXIT_BLOCK;
+    }
+  }
+
+  for(auto i = m_cfg->bb_begin(); i != m_cfg->bb_end(); ++i){
+    BasicBlock* bb = *i;
+    const ControlFlowGraph::EdgeList& outgoing = m_cfg->get_outgoing_edges(bb);
+    if(bb->get_kind() == BASICBLOCK_ENTRY){
+      assert(outgoing.size() == 1);
+      m_first = index_of[outgoing[0]->get_target()];
+      continue;
+    }
+    if(bb->get_kind() != BASICBLOCK_INTERIOR){
+      continue;
+    }
+
+    Block& b = m_blocks[index_of[bb]];
+    for(auto j = bb->cbegin(); j != bb->cend(); ++j){
+      b.ins.push_back((*j)->duplicate());
+    }
+    bool is_jmptab = !b.ins.empty() && b.ins.back()->get_opcode() == HINS_jmptab;
+    for(auto j = outgoing.cbegin(); j != outgoing.cend(); ++j){
+      int target = index_of[(*j)->get_target()];
+      if((*j)->get_kind() != EDGE_BRANCH){
+        b.next = target;
+      } else if(is_jmptab && (*j)->get_target()->get_label() != b.ins.back()->get_operand(1).get_label()){
+        b.table.push_back(target);
+      } else{
+        b.taken = target;
+      }
+    }
+  }
+}
+
+std::shared_ptr<ControlFlowGraph> LoopUnswitching::build_cfg(){
+  std::shared_ptr<ControlFlowGraph> result(new ControlFlowGraph());
+  BasicBlock* entry = result->create_basic_block(BASICBLOCK_ENTRY, -1);
+  BasicBlock* exit = result->create_basic_block(BASICBLOCK_EXIT, 2000000);
+
+  std::vector<BasicBlock*> new_blocks(m_blocks.size(), nullptr);
+  for(unsigned i = 0; i < m_blocks.size(); i++){
+    Block& b = m_blocks[i];
+    new_blocks[i] = result->create_basic_block(BASICBLOCK_INTERIOR, b.code_order, b.label);
+    for(Instruction* ins : b.ins){
+      new_blocks[i]->append(ins);
+    }
+    b.ins.clear();
+  }
+
+  auto get_block = [&](int index){
+    return (index == EXIT_BLOCK) ? exit : new_blocks[index];
+  };
+  result->create_edge(entry, new_blocks[m_first], EDGE_FALLTHROUGH);
+  for(unsigned i = 0; i < m_blocks.size(); i++){
+    if(m_blocks[i].taken != NO_BLOCK){
+      result->create_edge(new_blocks[i], get_block(m_blocks[i].taken), EDGE_BRANCH);
+    }
+    if(m_blocks[i].next != NO_BLOCK){
+      result->create_edge(new_blocks[i], get_block(m_blocks[i].next), EDGE_FALLTHROUGH);
+    }
+    for(int target : m_blocks[i].table){
+      result->create_edge(new_blocks[i], get_block(target), EDGE_BRANCH);
+    }
+  }
+  return result;
+}
+
+// The natural loops which can be copied: back edges are found by a
+// depth-first search from the first block, and the loop of a head is
+// everything reaching one of its back edges without going through it.
+// Loops which are entered anywhere but at the head aren't natural
+// loops, and are left out, as are the ones with a jmptab, or reached
+// through one.
+std::vector<LoopUnswitching::Loop> LoopUnswitching::find_loops(){
+  std::vector<std::vector<int>> preds = get_predecessors();
+  std::vector<std::pair<int, int>> back_edges;
+  std::vector<int> state(m_blocks.size(), 0);  // 0 = unvisited, 1 = on the DFS stack, 2 = finished
+  std::vector<std::pair<int, unsigned>> stack = { std::make_pair(m_first, 0U) };
+  state[m_first] = 1;
+  while(!stack.empty()){
+    const Block& b = m_blocks[stack.back().first];
+    std::vector<int> succs = b.table;
+    succs.push_back(b.taken);
+    succs.push_back(b.next);
+    unsigned next_succ = stack.back().second;
+    if(next_succ == succs.size()){
+      state[stack.back().first] = 2;
+      stack.pop_back();
+      continue;
+    }
+    stack.back().second++;
+
+    int succ = succs[next_succ];
+    if(succ < 0){
+      continue;
+    }
+    if(state[succ] == 0){
+      state[succ] = 1;
+      stack.push_back(std::make_pair(succ, 0U));
+    } else if(state[succ] == 1){
+      back_edges.push_back(std::make_pair(stack.back().first, succ));
+    }
+  }
+
+  std::map<int, std::set<int>> bodies;
+  for(const std::pair<int, int>& edge : back_edges){
+    std::set<int>& body = bodies[edge.second];
+    body.insert(edge.second);
+    std::vector<int> work_list = { edge.first };
+    while(!work_list.empty()){
+      int x = work_list.back();
+      work_list.pop_back();
+      // blocks the search doesn't reach are dead, not part of the loop
+      if(state[x] != 0 && body.insert(x).second){
+        work_list.insert(work_list.end(), preds[x].begin(), preds[x].end());
+      }
+    }
+  }
+
+  std::vector<Loop> loops;
+  for(auto i = bodies.cbegin(); i != bodies.cend(); ++i){
+    Loop loop = { i->first, i->second, 0 };
+    bool ok = loop.blocks.count(m_first) == 0;
+    for(int b : loop.blocks){
+      ok = ok && m_blocks[b].table.empty();
+      for(int pred : preds[b]){
+        bool inside = loop.blocks.count(pred) != 0;
+        ok = ok && (inside || state[pred] == 0 || (b == loop.head && m_blocks[pred].table.empty()));
+      }
+      loop.size += unsigned(m_blocks[b].ins.size());
+    }
+    if(ok){
+      loops.push_back(loop);
+    }
+  }
+  return loops;
+}
+
+// Unswitch a loop on the first invariant test found in it
+bool LoopUnswitching::unswitch(const Loop& loop){
+  if(loop.size > MAX_UNSWITCH_SIZE || m_growth + loop.size > MAX_UNSWITCH_GROWTH){
+    return false;
+  }
+  int block;
+  Instruction* def;
+  if(!find_invariant_test(loop, block, def)
+     || (def != nullptr && m_next_vreg >= int(LiveVregsAnalysis::MAX_VREGS))){
+    return false;
+  }
+
+  // the test: the flag, computed again if the loop computes it, and a
+  // cjmp going to the original loop if the cjmp in the loop would be
+  // taken, or else to the copy
+  Instruction* cjmp = m_blocks[block].ins.back();
+  Operand flag = cjmp->get_operand(0);
+  std::vector<Instruction*> test;
+  if(def != nullptr){
+    flag = Operand(Operand::VREG, m_next_vreg++);
+    test.push_back(def->duplicate());
+    test.back()->set_operand(flag, 0);
+  }
+  if(m_blocks[loop.head].label.empty()){
+    m_blocks[loop.head].label = ".LSW" + std::to_string(m_next_label_num++);
+  }
+  test.push_back(new Instruction(cjmp->get_opcode(), flag, Operand(Operand::LABEL, m_blocks[loop.head].label)));
+
+  std::vector<std::vector<int>> preds = get_predecessors();
+  std::vector<int> copy_of;
+  copy_loop(loop, copy_of);
+  std::string label = ".LSW" + std::to_string(m_next_label_num++);
+  m_blocks.push_back({ m_blocks[loop.head].code_order, label, test, loop.head, copy_of[loop.head], {} });
+  int test_block = int(m_blocks.size()) - 1;
+  for(int pred : preds[loop.head]){
+    if(loop.blocks.count(pred) == 0){
+      retarget(m_blocks[pred], loop.head, test_block);
+    }
+  }
+
+  // the original loop always takes the branch, and the copy never does
+  Block& taken = m_blocks[block];
+  Instruction* jmp = new Instruction(HINS_jmp, cjmp->get_operand(1));
+  delete taken.ins.back();
+  taken.ins.back() = jmp;
+  taken.next = NO_BLOCK;
+  Block& not_taken = m_blocks[copy_of[block]];
+  delete not_taken.ins.back();
+  not_taken.ins.pop_back();
+  not_taken.taken = NO_BLOCK;
+
+  m_growth += loop.size + unsigned(test.size());
+  return true;
+}
+
+// Find a cjmp in the loop on a vreg which the loop doesn't assign, or
+// on one last assigned, in the cjmp's block, by an instruction whose
+// operands the loop doesn't assign (which is returned as def)
+bool LoopUnswitching::find_invariant_test(const Loop& loop, int& block, Instruction*& def){
+  for(int b : loop.blocks){
+    const std::vector<Instruction*>& ins = m_blocks[b].ins;
+    if(ins.empty() || !is_cjmp(ins.back()->get_opcode()) || m_blocks[b].taken == m_blocks[b].next){
+      continue;
+    }
+    block = b;
+    def = nullptr;
+    Operand flag = ins.back()->get_operand(0);
+    if(is_invariant(loop, flag)){
+      return true;
+    }
+    if(flag.get_kind() != Operand::VREG){
+      continue;
+    }
+
+    for(unsigned i = ins.size() - 1; i > 0 && def == nullptr; i--){
+      if(HighLevel::is_def(ins[i - 1]) && ins[i - 1]->get_operand(0).get_base_reg() == flag.get_base_reg()){
+        def = ins[i - 1];
+      }
+    }
+    if(def == nullptr || !is_hoistable(def)){
+      continue;
+    }
+    bool operands_invariant = true;
+    for(unsigned i = 1; i < def->get_num_operands(); i++){
+      operands_invariant = operands_invariant && is_invariant(loop, def->get_operand(i));
+    }
+    if(operands_invariant){
+      return true;
+    }
+  }
+  return false;
+}
+
+// Whether an operand is a constant, or a local vreg the loop doesn't
+// assign (which calls can't change either)
+bool LoopUnswitching::is_invariant(const Loop& loop, const Operand& op){
+  if(op.is_imm_ival()){
+    return true;
+  }
+  if(op.get_kind() != Operand::VREG || op.get_base_reg() < LocalStorageAllocation::VREG_FIRST_LOCAL){
+    return false;
+  }
+  for(int b : loop.blocks){
+    for(Instruction* ins : m_blocks[b].ins){
+      if(HighLevel::is_def(ins) && ins->get_operand(0).get_base_reg() == op.get_base_reg()){
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Add a copy of the blocks of a loop, going to the copies of the
+// blocks they go to in the loop, and to the same blocks outside it;
+// copy_of has the index of the copy of each block of the loop
+void LoopUnswitching::copy_loop(const Loop& loop, std::vector<int>& copy_of){
+  copy_of.assign(m_blocks.size(), NO_BLOCK);
+  for(int b : loop.blocks){
+    copy_of[b] = int(m_blocks.size());
+    std::string label = m_blocks[b].label.empty() ? "" : ".LSW" + std::to_string(m_next_label_num++);
+    m_blocks.push_back({ m_blocks[b].code_order, label, {}, NO_BLOCK, NO_BLOCK, {} });
+  }
+
+  auto get_target = [&](int target){
+    return (target >= 0 && loop.blocks.count(target) != 0) ? copy_of[target] : target;
+  };
+  for(int b : loop.blocks){
+    Block& copy = m_blocks[copy_of[b]];
+    for(Instruction* ins : m_blocks[b].ins){
+      copy.ins.push_back(ins->duplicate());
+    }
+    copy.taken = get_target(m_blocks[b].taken);
+    copy.next = get_target(m_blocks[b].next);
+    if(copy.taken >= 0 && copy.taken != m_blocks[b].taken){
+      Instruction* branch = copy.ins.back();
+      branch->set_operand(Operand(Operand::LABEL, m_blocks[copy.taken].label), branch->get_num_operands() - 1);
+    }
+  }
+}
+
+void LoopUnswitching::retarget(Block& pred, int from, int to){
+  if(pred.taken == from){
+    pred.taken = to;
+    Instruction* branch = pred.ins.back();
+    assert(branch->get_opcode() == HINS_jmp || is_cjmp(branch->get_opcode()));
+    branch->set_operand(Operand(Operand::LABEL, m_blocks[to].label), branch->get_num_operands() - 1);
+  }
+  if(pred.next == from){
+    pred.next = to;
+  }
+}
+
+// The predecessors of each block (a block with two edges to the same
+// successor is listed twice)
+std::vector<std::vector<int>> LoopUnswitching::get_predecessors(){
+  std::vector<std::vector<int>> preds(m_blocks.size());
+  for(unsigned i = 0; i < m_blocks.size(); i++){
+    const Block& b = m_blocks[i];
+    std::vector<int> targets = b.table;
+    targets.push_back(b.taken);
+    targets.push_back(b.next);
+    for(int target : targets){
+      if(target >= 0){
+        preds[target].push_back(int(i));
+      }
+    }
+  }
+  return preds;
+}
@@ -0,0 +1,88 @@
+#ifndef LOOP_UNSWITCHING_H
+#define LOOP_UNSWITCHING_H
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include "cfg.h"
+
+// LoopUnswitching moves the tests of conditions which a loop doesn't
+// change out of the loop, in a high-level ControlFlowGraph (as left by
+// CfgSimplification). Such a test is a cjmp on a vreg the loop doesn't
+// assign, or on a flag which the loop computes (just before the cjmp)
+// from such vregs and constants, as an if statement testing one of the
+// function's parameters has.
+//
+// The loop is copied, and the test is done once, in a new block in
+// front of the two versions: in the original loop the cjmp becomes a
+// jmp to where it goes when the branch is taken, and in the copy it
+// just falls through.
+//
+//          |                              |
+//          v                              v
+//     +->[head]                         [test]-------+
+//     |    |                              |          |
+//     |  [...cjmp]--+      =>             v          v
+//     |    |        |                +->[head]  +->[head']
+//     |    v        v                |    |     |    |
+//     +--[...]    [...]              |  [...]   |  [...']
+//                                    |    |     |    |
+//                                    +--[...]   +--[...']
+//
+// Since every unswitched test doubles the size of the loop, only loops
+// up to a size limit are copied, and the total size of the copies made
+// in a function is limited too. A test is moved out of the outermost
+// loop it is invariant in, if that loop isn't too big; loops with a
+// jmptab, or reached through one, are left alone.
+class LoopUnswitching{
+private:
+  struct Block{
+    int code_order;
+    std::string label;
+    std::vector<Instruction*> ins;
+    int taken;    // target of the branch ending the block
+    int next;     // fall-through successor
+    std::vector<int> table;  // other targets of a jmptab ending the block
+  };
+
+  // A natural loop: the blocks reaching the head, which is the only
+  // block entered from outside, through a back edge
+  struct Loop{
+    int head;
+    std::set<int> blocks;
+    unsigned size;  // the number of instructions
+  };
+
+  std::shared_ptr<ControlFlowGraph> m_cfg;
+  std::vector<Block> m_blocks;
+  int m_first;
+  int m_next_vreg;
+  unsigned m_next_label_num;
+  unsigned m_growth;  // the instructions added so far
+
+public:
+  // next_vreg is the first vreg the function doesn't use; the new
+  // blocks are labeled .LSW<n>, numbered starting from next_label_num
+  LoopUnswitching(const std::shared_ptr<ControlFlowGraph>& cfg, int next_vreg, unsigned next_label_num);
+  ~LoopUnswitching();
+
+  // returns the original cfg if no loop was unswitched
+  std::shared_ptr<ControlFlowGraph> transform_cfg();
+
+  int get_next_vreg() const{ return m_next_vreg; }
+  unsigned get_next_label_num() const{ return m_next_label_num; }
+
+private:
+  void load_blocks();
+  std::shared_ptr<ControlFlowGraph> build_cfg();
+  std::vector<Loop> find_loops();
+  bool unswitch(const Loop& loop);
+  bool find_invariant_test(const Loop& loop, int& block, Instruction*& def);
+  bool is_invariant(const Loop& loop, const Operand& op);
+  void copy_loop(const Loop& loop, std::vector<int>& copy_of);
+  void retarget(Block& pred, int from, int to);
+  std::vector<std::vector<int>> get_predecessors();
+};
+
+#endif // LOOP_UNSWITCHING_H
@@ -0,0 +1,438 @@
+#include <algorithm>
+#include <map>
+#include "instruction.h"
+#include "operand.h"
+#include "highlevel.h"
+#include "highlevel_defuse.h"
+#include "loop_vectorization.h"
+
+namespace{
+
+  // the size of a vector, in bytes
+  const unsigned VECTOR_SIZE = 16;
+
+  // the largest stride of an address (or a value used in computing
+  // one) which is worth keeping track of
+  const long MAX_STRIDE = 1L << 20;
+
+  bool in_range(int opcode, int first, int last){
+    return opcode >= first && opcode <= last;
+  }
+
+  // the opcodes of an operation come in _b, _w, _l, _q order
+  int get_size_index(unsigned size){
+    return (size == 8) ? 3 : (size == 4) ? 2 : (size == 2) ? 1 : 0;
+  }
+
+  // the vector opcodes come in _l, _q order
+  HighLevelOpcode get_vector_opcode(HighLevelOpcode base, unsigned size){
+    return HighLevelOpcode(base + ((size == 8) ? 1 : 0));
+  }
+
+}
+
+// The vectorized copy of a loop, as it is built
+struct LoopVectorization::VectorLoop{
+  unsigned size;                       // of the elements (0 until an array is accessed)
+  std::vector<Instruction*> guard, setup, body, add_up;
+  Instruction* iv_update;
+  std::map<int, Value> values;         // of the vregs of the loop body
+  std::vector<int> sums;
+  std::vector<Operand> loads;          // the addresses loaded from, as of the guard
+  Operand store;                       // the address stored to (or NONE)
+  std::map<long, Operand> imm_vectors, invariant_vectors;
+
+  VectorLoop() : size(0), iv_update(nullptr){ }
+
+  ~VectorLoop(){
+    for(std::vector<Instruction*>* list : { &guard, &setup, &body, &add_up }){
+      for(Instruction* ins : *list){
+        delete ins;
+      }
+    }
+  }
+};
+
+LoopVectorization::LoopVectorization(const std::shared_ptr<ControlFlowGraph>& cfg, int next_vreg, unsigned next_label_num)
+  : CountedLoopTransform(cfg, next_vreg, next_label_num, ".LV"){
+}
+
+LoopVectorization::~LoopVectorization(){
+}
+
+bool LoopVectorization::transform_loop(const Loop& loop, const std::vector<Instruction*>& body){
+  if(loop.exit < 0 || m_blocks[loop.exit].orig == nullptr){
+    return false;
+  }
+  int first_vreg = m_next_vreg;
+  VectorLoop v;
+  if(!vectorize(loop, body, v)){
+    m_next_vreg = first_vreg;
+    return false;
+  }
+  unsigned lanes = VECTOR_SIZE / v.size;
+  v.iv_update->set_operand(Operand(Operand::IMM_IVAL, loop.step * long(lanes)), 2);
+
+  // the vectorized body leaves the other vregs it assigns with the
+  // values for the first element, so they can't be used after the loop
+  if(!m_live_vregs){
+    m_live_vregs.reset(new LiveVregs(m_cfg));
+    m_live_vregs->execute();
+  }
+  const LiveVregs::FactType& live = m_live_vregs->get_fact_at_beginning_of_block(m_blocks[loop.exit].orig);
+  for(Instruction* ins : body){
+    if(HighLevel::is_def(ins)){
+      int vreg = ins->get_operand(0).get_base_reg();
+      if(vreg != loop.iv && std::find(v.sums.begin(), v.sums.end(), vreg) == v.sums.end() && live.test(vreg)){
+        m_next_vreg = first_vreg;
+        return false;
+      }
+    }
+  }
+
+  // the guard checks there are enough iterations left for a vector,
+  // and so does the vectorized body, to go around again
+  if(!get_guard(loop, lanes, v.guard) || !get_guard(loop, lanes, v.body)){
+    m_next_vreg = first_vreg;
+    return false;
+  }
+  Operand flag = v.guard.back()->get_operand(0), again = v.body.back()->get_operand(0);
+  add_alias_checks(v, flag);
+  if(m_next_vreg > int(LiveVregsAnalysis::MAX_VREGS)){
+    m_next_vreg = first_vreg;
+    return false;
+  }
+
+  // the sums are added up, and the loop does the remaining iterations
+  // (if there are any)
+  int start = loop.blocks.front();
+  int code_order = m_blocks[start].code_order;
+  v.add_up.push_back(body.back()->duplicate());
+  int add_up = add_block(code_order, v.add_up, NO_BLOCK, NO_BLOCK);
+  append_test(loop, add_up, start);
+
+  int vector_body = add_block(code_order, v.body, NO_BLOCK, add_up);
+  m_blocks[vector_body].ins.push_back(new Instruction(HINS_cjmp_t, again, Operand(Operand::LABEL, m_blocks[vector_body].label)));
+  m_blocks[vector_body].taken = vector_body;
+
+  int setup = v.setup.empty() ? vector_body : add_block(code_order, v.setup, NO_BLOCK, vector_body);
+  v.guard.push_back(new Instruction(HINS_cjmp_t, flag, Operand(Operand::LABEL, m_blocks[setup].label)));
+  int guard = add_block(code_order, v.guard, setup, start);
+
+  // the blocks have the instructions now
+  v.guard.clear();
+  v.setup.clear();
+  v.body.clear();
+  v.add_up.clear();
+
+  enter_through(loop, guard);
+  return true;
+}
+
+// Build the vectorized body (and the rest, except for the parts
+// depending on the number of elements of a vector), walking the body:
+// the computations of addresses (and whatever else only depends on the
+// iv and values the loop doesn't change) are kept, and computed for
+// the first element, and the rest is replaced by vector operations.
+bool LoopVectorization::vectorize(const Loop& loop, const std::vector<Instruction*>& body, VectorLoop& v){
+  Operand iv(Operand::VREG, loop.iv);
+  unsigned iv_def = loop.iv_update;
+  while(!HighLevel::is_def(body[iv_def]) || body[iv_def]->get_operand(0).get_base_reg() != loop.iv){
+    iv_def++;
+  }
+  v.values[loop.iv] = { Value::SCALAR, loop.step, 0 };
+
+  auto keep = [&](Instruction* ins){
+    v.guard.push_back(ins->duplicate());
+    v.body.push_back(ins->duplicate());
+  };
+
+  // (the comparison of the test, at the end, is left out)
+  for(unsigned k = 0; k + 1 < body.size(); k++){
+    Instruction* ins = body[k];
+    int opcode = ins->get_opcode();
+    unsigned size = highlevel_opcode_get_source_operand_size(HighLevelOpcode(opcode));
+    Operand dest = (ins->get_num_operands() > 0) ? ins->get_operand(0) : Operand();
+
+    // the iv goes up by the number of elements of a vector (which
+    // isn't known yet), where it was assigned
+    if(k == loop.iv_update || k == iv_def){
+      if(k == iv_def){
+        v.iv_update = new Instruction(HINS_add_b + get_size_index(loop.size), iv, iv, Operand(Operand::IMM_IVAL, loop.step));
+        v.body.push_back(v.iv_update);
+      }
+      v.values[dest.get_base_reg()] = { Value::UNAVAILABLE, 0, 0 };
+      continue;
+    }
+
+    if(in_range(opcode, HINS_mov_b, HINS_mov_q)){
+      Operand src = ins->get_operand(1);
+      if(dest.get_kind() == Operand::VREG && src.get_kind() == Operand::VREG_MEM){
+        // load the elements
+        Operand address;
+        if(!get_address(body, src, size, v, address)){
+          return false;
+        }
+        v.loads.push_back(address);
+        Operand vector = new_vector();
+        v.body.push_back(new Instruction(get_vector_opcode(HINS_vmov_l, size), vector, src));
+        v.values[dest.get_base_reg()] = { Value::VECTOR, 0, vector.get_base_reg() };
+        continue;
+      }
+      if(dest.get_kind() == Operand::VREG_MEM){
+        // store the elements
+        Operand address, vector;
+        if(v.store.get_kind() != Operand::NONE || !get_address(body, dest, size, v, address)
+           || !get_vector(body, src, v, vector)){
+          return false;
+        }
+        v.store = address;
+        v.body.push_back(new Instruction(get_vector_opcode(HINS_vmov_l, size), dest, vector));
+        continue;
+      }
+      if(dest.get_kind() != Operand::VREG){
+        return false;
+      }
+      // the copy of a sum to its vreg was done by vectorize_reduction
+      auto sum = (src.get_kind() == Operand::VREG) ? v.values.find(src.get_base_reg()) : v.values.end();
+      if(sum != v.values.end() && sum->second.kind == Value::SUM && sum->second.vreg == dest.get_base_reg()){
+        v.values[dest.get_base_reg()] = { Value::UNAVAILABLE, 0, 0 };
+        continue;
+      }
+      Value value;
+      if(!get_value(body, src, v, value) || (value.kind == Value::VECTOR && size != v.size)){
+        return false;
+      }
+      if(value.kind == Value::SCALAR){
+        keep(ins);
+      }
+      v.values[dest.get_base_reg()] = value;
+      continue;
+    }
+
+    if(dest.get_kind() != Operand::VREG){
+      return false;
+    }
+    if(opcode == HINS_localaddr){
+      keep(ins);
+      v.values[dest.get_base_reg()] = { Value::SCALAR, 0, 0 };
+      continue;
+    }
+    if(opcode == HINS_sconv_lq){
+      Value value;
+      if(!get_value(body, ins->get_operand(1), v, value) || value.kind != Value::SCALAR){
+        return false;
+      }
+      keep(ins);
+      v.values[dest.get_base_reg()] = value;
+      continue;
+    }
+
+    bool is_add = in_range(opcode, HINS_add_b, HINS_add_q), is_sub = in_range(opcode, HINS_sub_b, HINS_sub_q);
+    bool is_mul = in_range(opcode, HINS_mul_b, HINS_mul_q), is_bitwise = in_range(opcode, HINS_and_b, HINS_xor_q);
+    if(!is_add && !is_sub && !is_mul && !is_bitwise){
+      return false;
+    }
+    if((is_add || is_sub) && vectorize_reduction(body, k, v)){
+      continue;
+    }
+    Operand left = ins->get_operand(1), right = ins->get_operand(2);
+    Value left_value, right_value;
+    if(!get_value(body, left, v, left_value) || !get_value(body, right, v, right_value)){
+      return false;
+    }
+    if(left_value.kind == Value::SCALAR && right_value.kind == Value::SCALAR){
+      long stride = 0;
+      if(is_add){
+        stride = left_value.stride + right_value.stride;
+      } else if(is_sub){
+        stride = left_value.stride - right_value.stride;
+      } else if(left_value.stride != 0 || right_value.stride != 0){
+        // a multiple of something changing needs a constant factor
+        if(!is_mul || (left_value.stride != 0 && !right.is_imm_ival()) || (right_value.stride != 0 && !left.is_imm_ival())){
+          return false;
+        }
+        stride = (left_value.stride != 0) ? left_value.stride * right.get_imm_ival() : left.get_imm_ival() * right_value.stride;
+      }
+      if(stride < -MAX_STRIDE || stride > MAX_STRIDE){
+        return false;
+      }
+      keep(ins);
+      v.values[dest.get_base_reg()] = { Value::SCALAR, stride, 0 };
+      continue;
+    }
+
+    // an operation on the elements
+    Operand left_vector, right_vector;
+    if(is_mul || size != v.size || !get_vector(body, left, v, left_vector) || !get_vector(body, right, v, right_vector)){
+      return false;
+    }
+    HighLevelOpcode base;
+    if(is_add){
+      base = HINS_vadd_l;
+    } else if(is_sub){
+      base = HINS_vsub_l;
+    } else if(in_range(opcode, HINS_and_b, HINS_and_q)){
+      base = HINS_vand_l;
+    } else if(in_range(opcode, HINS_or_b, HINS_or_q)){
+      base = HINS_vor_l;
+    } else{
+      base = HINS_vxor_l;
+    }
+    Operand vector = new_vector();
+    v.body.push_back(new Instruction(get_vector_opcode(base, size), vector, left_vector, right_vector));
+    v.values[dest.get_base_reg()] = { Value::VECTOR, 0, vector.get_base_reg() };
+  }
+
+  return v.size != 0;
+}
+
+// A sum of the elements: s = s + x (or x + s, or s - x), the result
+// being copied to s (before its vreg changes) if it isn't s, where s is
+// only used there. The vector sum is set to 0 before the vectorized
+// body, and its elements are added to s after it.
+bool LoopVectorization::vectorize_reduction(const std::vector<Instruction*>& body, unsigned k, VectorLoop& v){
+  Instruction* ins = body[k];
+  int opcode = ins->get_opcode();
+  bool is_sub = in_range(opcode, HINS_sub_b, HINS_sub_q);
+  unsigned size = highlevel_opcode_get_source_operand_size(HighLevelOpcode(opcode));
+  int dest = ins->get_operand(0).get_base_reg();
+  if(size != v.size){
+    return false;
+  }
+
+  for(unsigned i = 1; i <= (is_sub ? 1U : 2U); i++){
+    Operand sum = ins->get_operand(i), elements = ins->get_operand(3 - i);
+    Value value;
+    if(!is_local_vreg(sum) || v.values.count(sum.get_base_reg()) != 0 || !get_value(body, elements, v, value)
+       || value.kind != Value::VECTOR){
+      continue;
+    }
+    int s = sum.get_base_reg();
+    if(count_uses(body, s) != 1 || count_defs(body, s) != 1){
+      continue;
+    }
+    if(dest != s){
+      unsigned j = k + 1;
+      while(j < body.size() && !(HighLevel::is_def(body[j]) && (body[j]->get_operand(0).get_base_reg() == s
+                                                                 || body[j]->get_operand(0).get_base_reg() == dest))){
+        j++;
+      }
+      if(j == body.size() || body[j]->get_opcode() != HINS_mov_b + get_size_index(size)
+         || body[j]->get_operand(0).get_base_reg() != s || body[j]->get_operand(1).get_kind() != Operand::VREG
+         || body[j]->get_operand(1).get_base_reg() != dest){
+        continue;
+      }
+    }
+
+    Operand vector_sum = new_vector(), part(Operand::VREG, m_next_vreg++);
+    v.setup.push_back(new Instruction(get_vector_opcode(HINS_vdup_l, size), vector_sum, Operand(Operand::IMM_IVAL, 0)));
+    v.body.push_back(new Instruction(get_vector_opcode(HINS_vadd_l, size), vector_sum, vector_sum, Operand(Operand::VREG, value.vreg)));
+    v.add_up.push_back(new Instruction(get_vector_opcode(HINS_vsum_l, size), part, vector_sum));
+    v.add_up.push_back(new Instruction((is_sub ? HINS_sub_b : HINS_add_b) + get_size_index(size), sum, sum, part));
+    v.sums.push_back(s);
+    v.values[dest] = (dest == s) ? Value{ Value::UNAVAILABLE, 0, 0 } : Value{ Value::SUM, 0, s };
+    return true;
+  }
+  return false;
+}
+
+// What the vectorized body has for an operand: a vreg the loop doesn't
+// assign (or an immediate) is a SCALAR which doesn't change
+bool LoopVectorization::get_value(const std::vector<Instruction*>& body, const Operand& op, const VectorLoop& v, Value& value){
+  if(op.is_imm_ival()){
+    value = { Value::SCALAR, 0, 0 };
+    return true;
+  }
+  if(op.get_kind() != Operand::VREG){
+    return false;
+  }
+  auto i = v.values.find(op.get_base_reg());
+  if(i != v.values.end()){
+    value = i->second;
+    return value.kind == Value::SCALAR || value.kind == Value::VECTOR;
+  }
+  if(count_defs(body, op.get_base_reg()) != 0){
+    // its value carries over from the previous iteration
+    return false;
+  }
+  value = { Value::SCALAR, 0, 0 };
+  return true;
+}
+
+// The vector of the elements of an operand; a value which doesn't
+// change is put into a vector (before the vectorized body, unless the
+// body computes it)
+bool LoopVectorization::get_vector(const std::vector<Instruction*>& body, const Operand& op, VectorLoop& v, Operand& vector){
+  Value value;
+  if(!get_value(body, op, v, value) || (value.kind == Value::SCALAR && value.stride != 0)){
+    return false;
+  }
+  if(value.kind == Value::VECTOR){
+    vector = Operand(Operand::VREG, value.vreg);
+    return true;
+  }
+
+  HighLevelOpcode dup = get_vector_opcode(HINS_vdup_l, v.size);
+  if(!op.is_imm_ival() && count_defs(body, op.get_base_reg()) != 0){
+    vector = new_vector();
+    v.body.push_back(new Instruction(dup, vector, op));
+    return true;
+  }
+  std::map<long, Operand>& vectors = op.is_imm_ival() ? v.imm_vectors : v.invariant_vectors;
+  long key = op.is_imm_ival() ? op.get_imm_ival() : op.get_base_reg();
+  auto i = vectors.find(key);
+  if(i == vectors.end()){
+    vector = new_vector();
+    v.setup.push_back(new Instruction(dup, vector, op));
+    vectors[key] = vector;
+  } else{
+    vector = i->second;
+  }
+  return true;
+}
+
+// Whether a memory operand accesses the next element of an array (of
+// elements of the given size, which all the accessed arrays have) in
+// each iteration; if so, the guard gets a copy of the address
+bool LoopVectorization::get_address(const std::vector<Instruction*>& body, const Operand& op, unsigned size,
+                                    VectorLoop& v, Operand& address){
+  Value value;
+  if(op.get_kind() != Operand::VREG_MEM || (size != 4 && size != 8) || (v.size != 0 && size != v.size)
+     || !get_value(body, Operand(Operand::VREG, op.get_base_reg()), v, value)
+     || value.kind != Value::SCALAR || value.stride != long(size)){
+    return false;
+  }
+  v.size = size;
+  address = Operand(Operand::VREG, m_next_vreg++);
+  v.guard.push_back(new Instruction(HINS_mov_q, address, Operand(Operand::VREG, op.get_base_reg())));
+  return true;
+}
+
+// The store mustn't change an element loaded for a later iteration done
+// at the same time, nor the other way around: the stored elements have
+// to be the loaded ones, or a vector or more away from them. The
+// guard's flag is cleared if they aren't.
+void LoopVectorization::add_alias_checks(VectorLoop& v, const Operand& flag){
+  if(v.store.get_kind() == Operand::NONE){
+    return;
+  }
+  for(const Operand& load : v.loads){
+    Operand distance(Operand::VREG, m_next_vreg++), ok(Operand::VREG, m_next_vreg++), apart(Operand::VREG, m_next_vreg++);
+    v.guard.push_back(new Instruction(HINS_sub_q, distance, v.store, load));
+    v.guard.push_back(new Instruction(HINS_cmpeq_q, ok, distance, Operand(Operand::IMM_IVAL, 0)));
+    v.guard.push_back(new Instruction(HINS_cmpgte_q, apart, distance, Operand(Operand::IMM_IVAL, long(VECTOR_SIZE))));
+    v.guard.push_back(new Instruction(HINS_or_q, ok, ok, apart));
+    v.guard.push_back(new Instruction(HINS_cmplte_q, apart, distance, Operand(Operand::IMM_IVAL, -long(VECTOR_SIZE))));
+    v.guard.push_back(new Instruction(HINS_or_q, ok, ok, apart));
+    v.guard.push_back(new Instruction(HINS_and_q, flag, flag, ok));
+  }
+}
+
+// A vector vreg takes up two vreg numbers, so its 16 bytes of storage
+// are the slots of both
+Operand LoopVectorization::new_vector(){
+  Operand vector(Operand::VREG, m_next_vreg);
+  m_next_vreg += 2;
+  return vector;
+}
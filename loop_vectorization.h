@@ -0,0 +1,86 @@
+#ifndef LOOP_VECTORIZATION_H
+#define LOOP_VECTORIZATION_H
+
+#include <map>
+#include <memory>
+#include <vector>
+#include "cfg.h"
+#include "live_vregs.h"
+#include "counted_loop_transform.h"
+
+// LoopVectorization vectorizes the innermost counted loops (see
+// CountedLoopTransform) of a high-level ControlFlowGraph which work on
+// consecutive elements of arrays of ints or longs, using the vector
+// operations (SSE2), which do 4 ints or 2 longs at once. The body of
+// such a loop loads a[i], b[i], ... (i being the induction variable,
+// going up by 1), combines them with +, -, &, | and ^, with each other
+// and with values the loop doesn't change, and stores the result to
+// c[i], or adds it to a sum (s = s + ...), or both.
+//
+// The loop is left as it is, to run the remaining iterations, and gets
+// a vectorized copy in front of it: a guard, which checks that there
+// are enough iterations left to fill a vector, and that the stored
+// array doesn't overlap the loaded ones in a way that would change the
+// result; a block setting up the vector sums and the vectors of values
+// the loop doesn't change; the vectorized body, which goes around while
+// there are enough iterations left; and a block adding the elements of
+// the vector sums to the sums, going on to the loop if there are
+// iterations left. If the loop is entered in the middle, the part up to
+// the test is copied in front of the guard.
+//
+//        entry                     entry
+//          |                         |
+//          v                         v
+//     +->[body]         =>         [guard]----------+
+//     |    |                         |              |
+//     +--[test]                      v              |
+//          |                     [set up]           |
+//          v                         |              |
+//                                +->[vector body]   |
+//                                +---|              |
+//                                    v              v
+//                                [add up]------>+->[body]
+//                                    |          |    |
+//                                    |          +--[test]
+//                                    v               |
+//                                                    v
+//
+// Multiplications aren't vectorized (there is no SSE2 instruction
+// multiplying 4 ints), and neither are loops whose other values (than
+// the induction variable and the sums) are used after the loop.
+class LoopVectorization : public CountedLoopTransform{
+private:
+  // What the vectorized body has for a vreg of the loop body
+  struct Value{
+    enum Kind{
+      SCALAR,      // the value for the first element
+      VECTOR,      // a vector vreg with the values for all the elements
+      SUM,         // a sum, before it is copied to the sum vreg
+      UNAVAILABLE, // not usable in the vectorized body
+    } kind;
+    long stride;   // how much a SCALAR changes from one iteration to the next
+    int vreg;      // the vector vreg of a VECTOR
+  };
+  struct VectorLoop;
+
+  std::unique_ptr<LiveVregs> m_live_vregs;  // of the original cfg, computed when needed
+
+public:
+  // the new blocks are labeled .LV<n>
+  LoopVectorization(const std::shared_ptr<ControlFlowGraph>& cfg, int next_vreg, unsigned next_label_num);
+  virtual ~LoopVectorization();
+
+protected:
+  virtual bool transform_loop(const Loop& loop, const std::vector<Instruction*>& body);
+
+private:
+  bool vectorize(const Loop& loop, const std::vector<Instruction*>& body, VectorLoop& v);
+  bool vectorize_reduction(const std::vector<Instruction*>& body, unsigned k, VectorLoop& v);
+  bool get_value(const std::vector<Instruction*>& body, const Operand& op, const VectorLoop& v, Value& value);
+  bool get_vector(const std::vector<Instruction*>& body, const Operand& op, VectorLoop& v, Operand& vector);
+  bool get_address(const std::vector<Instruction*>& body, const Operand& op, unsigned size, VectorLoop& v, Operand& address);
+  void add_alias_checks(VectorLoop& v, const Operand& flag);
+  Operand new_vector();
+};
+
+#endif // LOOP_VECTORIZATION_H
@@ -8,7 +8,7 @@ const char *lowlevel_opcode_to_str(LowLevelOpcode opcode) {
   case MINS_MOVB:
     return "movb";
   case MINS_MOVW:
-    return "move";
+    return "movw";
   case MINS_MOVL:
     return "movl";
   case MINS_MOVQ:
@@ -29,6 +29,62 @@ const char *lowlevel_opcode_to_str(LowLevelOpcode opcode) {
     return "subl";
   case MINS_SUBQ:
     return "subq";
+  case MINS_ANDB:
+    return "andb";
+  case MINS_ANDW:
+    return "andw";
+  case MINS_ANDL:
+    return "andl";
+  case MINS_ANDQ:
+    return "andq";
+  case MINS_ORB:
+    return "orb";
+  case MINS_ORW:
+    return "orw";
+  case MINS_ORL:
+    return "orl";
+  case MINS_ORQ:
+    return "orq";
+  case MINS_XORB:
+    return "xorb";
+  case MINS_XORW:
+    return "xorw";
+  case MINS_XORL:
+    return "xorl";
+  case MINS_XORQ:
+    return "xorq";
+  case MINS_SHLB:
+    return "shlb";
+  case MINS_SHLW:
+    return "shlw";
+  case MINS_SHLL:
+    return "shll";
+  case MINS_SHLQ:
+    return "shlq";
+  case MINS_SARB:
+    return "sarb";
+  case MINS_SARW:
+    return "sarw";
+  case MINS_SARL:
+    return "sarl";
+  case MINS_SARQ:
+    return "sarq";
+  case MINS_SHRB:
+    return "shrb";
+  case MINS_SHRW:
+    return "shrw";
+  case MINS_SHRL:
+    return "shrl";
+  case MINS_SHRQ:
+    return "shrq";
+  case MINS_NOTB:
+    return "notb";
+  case MINS_NOTW:
+    return "notw";
+  case MINS_NOTL:
+    return "notl";
+  case MINS_NOTQ:
+    return "notq";
   case MINS_LEAQ:
     return "leaq";
   case MINS_JMP:
@@ -117,6 +173,42 @@ const char *lowlevel_opcode_to_str(LowLevelOpcode opcode) {
     return "sete";
   case MINS_SETNE:
     return "setne";
+  case MINS_CMOVL:
+    return "cmovl";
+  case MINS_CMOVLE:
+    return "cmovle";
+  case MINS_CMOVG:
+    return "cmovg";
+  case MINS_CMOVGE:
+    return "cmovge";
+  case MINS_CMOVE:
+    return "cmove";
+  case MINS_CMOVNE:
+    return "cmovne";
+  case MINS_JMPQ:
+    return "jmpq";
+  case MINS_MOVD:
+    return "movd";
+  case MINS_MOVDQU:
+    return "movdqu";
+  case MINS_PADDD:
+    return "paddd";
+  case MINS_PADDQ:
+    return "paddq";
+  case MINS_PSUBD:
+    return "psubd";
+  case MINS_PSUBQ:
+    return "psubq";
+  case MINS_PAND:
+    return "pand";
+  case MINS_POR:
+    return "por";
+  case MINS_PXOR:
+    return "pxor";
+  case MINS_PSHUFD:
+    return "pshufd";
+  case MINS_PUNPCKLQDQ:
+    return "punpcklqdq";
   default:
     assert(false);
     return nullptr;
@@ -28,6 +28,23 @@ enum MachineReg {
   MREG_R13,
   MREG_R14,
   MREG_R15,
+  // SSE registers, used (as Operand::MREG128) for vector operations
+  MREG_XMM0,
+  MREG_XMM1,
+  MREG_XMM2,
+  MREG_XMM3,
+  MREG_XMM4,
+  MREG_XMM5,
+  MREG_XMM6,
+  MREG_XMM7,
+  MREG_XMM8,
+  MREG_XMM9,
+  MREG_XMM10,
+  MREG_XMM11,
+  MREG_XMM12,
+  MREG_XMM13,
+  MREG_XMM14,
+  MREG_XMM15,
 };
 
 const int NEED_SUFFIX = 1;
@@ -54,6 +71,34 @@ enum LowLevelOpcode {
   MINS_SUBW,
   MINS_SUBL,
   MINS_SUBQ,
+  MINS_ANDB,
+  MINS_ANDW,
+  MINS_ANDL,
+  MINS_ANDQ,
+  MINS_ORB,
+  MINS_ORW,
+  MINS_ORL,
+  MINS_ORQ,
+  MINS_XORB,
+  MINS_XORW,
+  MINS_XORL,
+  MINS_XORQ,
+  MINS_SHLB,
+  MINS_SHLW,
+  MINS_SHLL,
+  MINS_SHLQ,
+  MINS_SARB,
+  MINS_SARW,
+  MINS_SARL,
+  MINS_SARQ,
+  MINS_SHRB,
+  MINS_SHRW,
+  MINS_SHRL,
+  MINS_SHRQ,
+  MINS_NOTB,
+  MINS_NOTW,
+  MINS_NOTL,
+  MINS_NOTQ,
   MINS_LEAQ, // only one variant, pointers are always 64-bit
   MINS_JMP,
   MINS_JE,
@@ -98,6 +143,25 @@ enum LowLevelOpcode {
   MINS_SETGE,
   MINS_SETE,
   MINS_SETNE,
+  MINS_CMOVL,
+  MINS_CMOVLE,
+  MINS_CMOVG,
+  MINS_CMOVGE,
+  MINS_CMOVE,
+  MINS_CMOVNE,
+  MINS_JMPQ, // indirect jump, through a jump table
+  // SSE2 (movq also moves between a general register and an xmm register)
+  MINS_MOVD,
+  MINS_MOVDQU,
+  MINS_PADDD,
+  MINS_PADDQ,
+  MINS_PSUBD,
+  MINS_PSUBQ,
+  MINS_PAND,
+  MINS_POR,
+  MINS_PXOR,
+  MINS_PSHUFD,
+  MINS_PUNPCKLQDQ,
 };
 
 const char *lowlevel_opcode_to_str(LowLevelOpcode opcode);
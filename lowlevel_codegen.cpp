@@ -1,4 +1,5 @@
 #include <cassert>
+#include <cstdint>
 #include <map>
 #include "node.h"
 #include "instruction.h"
@@ -10,6 +11,18 @@
 #include "lowlevel_codegen.h"
 #include "cfg.h"
 #include "cfg_transform.h"
+#include "tail_call_elimination.h"
+#include "instruction_scheduler.h"
+#include "address_mode_selection.h"
+#include "block_layout.h"
+#include "cfg_simplification.h"
+#include "loop_nest_optimization.h"
+#include "loop_unrolling.h"
+#include "loop_unswitching.h"
+#include "loop_vectorization.h"
+#include "memory_promotion.h"
+#include "phase_timer.h"
+#include "trace_log.h"
 
 namespace{
 
@@ -84,15 +97,35 @@ namespace{
 // is a _b variant opcode. Return true if the hl opcode is any variant
 // of that base.
 bool match_hl(int base, int hl_opcode){
-  if(base == HINS_sconv_bw){
+  if(base == HINS_sconv_bw || base == HINS_uconv_bw){
     return hl_opcode >= base && hl_opcode < (base + 6);
   }
   return hl_opcode >= base && hl_opcode < (base + 4);
 }
 
-LowLevelCodeGen::LowLevelCodeGen(bool optimize)
+namespace{
+
+  bool is_compare(int hl_opcode){
+    return hl_opcode >= HINS_cmplt_b && hl_opcode <= HINS_cmpneq_q;
+  }
+
+  // the setcc and jcc testing the condition of each comparison
+  // (lt, lte, gt, gte, eq, neq), and the jcc testing its inverse
+  const LowLevelOpcode COMPARE_SET[] = { MINS_SETL, MINS_SETLE, MINS_SETG, MINS_SETGE, MINS_SETE, MINS_SETNE };
+  const LowLevelOpcode COMPARE_JUMP[] = { MINS_JL, MINS_JLE, MINS_JG, MINS_JGE, MINS_JE, MINS_JNE };
+  const LowLevelOpcode COMPARE_JUMP_INVERSE[] = { MINS_JGE, MINS_JG, MINS_JLE, MINS_JL, MINS_JNE, MINS_JE };
+
+  int get_compare_kind(int hl_opcode){
+    return (hl_opcode - HINS_cmplt_b) / 4;
+  }
+
+}
+
+LowLevelCodeGen::LowLevelCodeGen(bool optimize, unsigned next_label_num, unsigned max_unroll)
   : m_total_memory_storage(0)
-  , m_optimize(optimize){
+  , m_optimize(optimize)
+  , m_next_label_num(next_label_num)
+  , m_max_unroll(max_unroll){
   highest = 10;
 }
 
@@ -102,34 +135,116 @@ LowLevelCodeGen::~LowLevelCodeGen(){
 std::shared_ptr<InstructionSequence> LowLevelCodeGen::generate(const std::shared_ptr<InstructionSequence>& hl_iseq){
   // TODO: if optimizations are enabled, could do analysis/transformation of high-level code
   Node* funcdef_ast = hl_iseq->get_funcdef_ast();
+  TRACE_EVENT(LL_CODEGEN, "generate", funcdef_ast);
 
   // cur_hl_iseq is the "current" version of the high-level IR,
   // which could be a transformed version if we are doing optimizations
   std::shared_ptr<InstructionSequence> cur_hl_iseq(hl_iseq);
 
-  if(m_optimize){
+  // the analyses can only track a limited number of vregs, so a function
+  // which uses more of them is compiled without optimization
+  if(m_optimize && unsigned(funcdef_ast->get_symbol()->get_vreg()) < LiveVregsAnalysis::MAX_VREGS){
+    PhaseScope phase(Phase::OPTIMIZE);
+
+    // Keep locals whose address doesn't escape in vregs
+    MemoryPromotion promotion(cur_hl_iseq);
+    cur_hl_iseq = promotion.transform();
+
     // Create a control-flow graph representation of the high-level code
     HighLevelControlFlowGraphBuilder hl_cfg_builder(cur_hl_iseq);
     std::shared_ptr<ControlFlowGraph> cfg = hl_cfg_builder.build();
 
+    // Remove empty blocks and jumps to jumps, thread branches whose
+    // outcome is known, and turn short branches into selects
+    CfgSimplification simplification(cfg, funcdef_ast->get_symbol()->get_vreg() + 1);
+    cfg = simplification.simplify();
+    funcdef_ast->get_symbol()->set_vreg(simplification.get_next_vreg() - 1);
+
+    // Move tests of conditions loops don't change out of the loops, and
+    // simplify the versions of the loops that leaves
+    LoopUnswitching unswitching(cfg, funcdef_ast->get_symbol()->get_vreg() + 1, m_next_label_num);
+    std::shared_ptr<ControlFlowGraph> unswitched = unswitching.transform_cfg();
+    funcdef_ast->get_symbol()->set_vreg(unswitching.get_next_vreg() - 1);
+    m_next_label_num = unswitching.get_next_label_num();
+    if(unswitched != cfg){
+      CfgSimplification resimplification(unswitched, funcdef_ast->get_symbol()->get_vreg() + 1);
+      cfg = resimplification.simplify();
+      funcdef_ast->get_symbol()->set_vreg(resimplification.get_next_vreg() - 1);
+    }
+
+    // Interchange and tile nested loops, for better locality
+    LoopNestOptimization nest_optimization(cfg, funcdef_ast->get_symbol()->get_vreg() + 1, m_next_label_num);
+    cfg = nest_optimization.transform_cfg();
+    funcdef_ast->get_symbol()->set_vreg(nest_optimization.get_next_vreg() - 1);
+    m_next_label_num = nest_optimization.get_next_label_num();
+
+    // Vectorize loops over arrays of ints and longs
+    LoopVectorization vectorization(cfg, funcdef_ast->get_symbol()->get_vreg() + 1, m_next_label_num);
+    cfg = vectorization.transform_cfg();
+    funcdef_ast->get_symbol()->set_vreg(vectorization.get_next_vreg() - 1);
+    m_next_label_num = vectorization.get_next_label_num();
+
+    // Unroll small counted loops
+    LoopUnrolling unrolling(cfg, funcdef_ast->get_symbol()->get_vreg() + 1, m_next_label_num, m_max_unroll);
+    cfg = unrolling.transform_cfg();
+    funcdef_ast->get_symbol()->set_vreg(unrolling.get_next_vreg() - 1);
+    m_next_label_num = unrolling.get_next_label_num();
+
     // Do local optimizations
     MyOptimization hl_opts(cfg);
     cfg = hl_opts.transform_cfg();
 
-    // Convert the transformed high-level CFG back to an InstructionSequence
-    cur_hl_iseq = cfg->create_instruction_sequence();
+    // Fold address arithmetic into memory operands
+    AddressModeSelection addr_modes(cfg);
+    cfg = addr_modes.transform_cfg();
+
+    // Convert the transformed high-level CFG back to an InstructionSequence,
+    // placing the blocks so that the most frequent edges fall through
+    BlockLayout layout(cfg, m_next_label_num);
+    cur_hl_iseq = layout.create_instruction_sequence();
+    m_next_label_num = layout.get_next_label_num();
 
     // The function definition AST might have information needed for
     // low-level code generation
     cur_hl_iseq->set_funcdef_ast(funcdef_ast);
+
+    // If every local was promoted, no memory storage is needed
+    bool uses_memory = false;
+    for(auto i = cur_hl_iseq->cbegin(); i != cur_hl_iseq->cend(); ++i){
+      if((*i)->get_opcode() == HINS_localaddr){
+        uses_memory = true;
+      }
+      for(unsigned j = 0; j < (*i)->get_num_operands(); j++){
+        if((*i)->get_operand(j).get_kind() == Operand::FRAME_MEM_OFF){
+          uses_memory = true;
+        }
+      }
+    }
+    if(!uses_memory){
+      funcdef_ast->get_symbol()->set_addr(0);
+    }
+
+    // Turn calls in tail position into jumps
+    TailCallElimination tail_calls(cur_hl_iseq);
+    cur_hl_iseq = tail_calls.transform();
   }
 
   // Translate (possibly transformed) high-level code into low-level code
   std::shared_ptr<InstructionSequence> ll_iseq = translate_hl_to_ll(cur_hl_iseq);
 
   if(m_optimize){
+    PhaseScope phase(Phase::OPTIMIZE);
+
     // ...could do transformations on the low-level code, possible peephole
     //    optimizations...
+
+    // Reorder the instructions in each basic block to hide latencies
+    LowLevelControlFlowGraphBuilder ll_cfg_builder(ll_iseq);
+    std::shared_ptr<ControlFlowGraph> ll_cfg = ll_cfg_builder.build();
+    InstructionScheduler scheduler(ll_cfg);
+    ll_cfg = scheduler.transform_cfg();
+    ll_iseq = ll_cfg->create_instruction_sequence();
+    ll_iseq->set_funcdef_ast(funcdef_ast);
   }
 
   return ll_iseq;
@@ -166,6 +281,7 @@ std::shared_ptr<InstructionSequence> LowLevelCodeGen::translate_hl_to_ll(const s
   m_total_memory_storage += (highest - 9) * 8;
   if((m_total_memory_storage) % 16 != 0)
     m_total_memory_storage += (16 - (m_total_memory_storage % 16));
+  TRACE_EVENT(LL_CODEGEN, "frame size", long(m_total_memory_storage));
 
   // Iterate through high level instructions
   for(auto i = hl_iseq->cbegin(); i != hl_iseq->cend(); ++i){
@@ -176,6 +292,28 @@ std::shared_ptr<InstructionSequence> LowLevelCodeGen::translate_hl_to_ll(const s
     if(i.has_label())
       ll_iseq->define_label(i.get_label());
 
+    // A comparison whose result is only tested by the conditional jump
+    // right after it sets the flags for the jump directly. The high-level
+    // code generator only emits that sequence for conditions, whose
+    // temporaries aren't used again, and the optimizer keeps it that way:
+    // it doesn't propagate a temporary out of its block.
+    auto next = i;
+    ++next;
+    if(is_compare(hl_ins->get_opcode()) && next != hl_iseq->cend() && !next.has_label()){
+      Instruction* branch = *next;
+      Operand dest = hl_ins->get_operand(0);
+      Operand cond = (branch->get_num_operands() > 0) ? branch->get_operand(0) : Operand();
+      if((branch->get_opcode() == HINS_cjmp_t || branch->get_opcode() == HINS_cjmp_f)
+         && dest.get_kind() == Operand::VREG && cond.get_kind() == Operand::VREG && cond.get_base_reg() == dest.get_base_reg()){
+        translate_compare(hl_ins, ll_iseq);
+        int kind = get_compare_kind(hl_ins->get_opcode());
+        LowLevelOpcode jump = (branch->get_opcode() == HINS_cjmp_t) ? COMPARE_JUMP[kind] : COMPARE_JUMP_INVERSE[kind];
+        ll_iseq->append(new Instruction(jump, branch->get_operand(1)));
+        i = next;
+        continue;
+      }
+    }
+
     // Translate the high-level instruction into one or more low-level instructions
     translate_instruction(hl_ins, ll_iseq);
   }
@@ -254,11 +392,24 @@ namespace{
     }
   }
 
+  // Store the flag tested by a setcc in dest, as 0 or 1
+  void store_flag(LowLevelOpcode set_opcode, int size, const Operand& dest, const std::shared_ptr<InstructionSequence>& ll_iseq){
+    Operand r10b(Operand::MREG8, MREG_R10);
+    ll_iseq->append(new Instruction(set_opcode, r10b));
+    if(size == 1){
+      ll_iseq->append(new Instruction(MINS_MOVB, r10b, dest));
+      return;
+    }
+    Operand r11(select_mreg_kind(size), MREG_R11);
+    ll_iseq->append(new Instruction(select_ll_opcode(MINS_MOVZBW, 1, size), r10b, r11));
+    ll_iseq->append(new Instruction(select_ll_opcode(MINS_MOVB, size), r11, dest));
+  }
+
 }
 
 void LowLevelCodeGen::translate_instruction(Instruction* hl_ins, const std::shared_ptr<InstructionSequence>& ll_iseq){
   HighLevelOpcode hl_opcode = HighLevelOpcode(hl_ins->get_opcode());
-  // printf("%s\n", highlevel_opcode_to_str(hl_opcode));
+  TRACE_EVENT(LL_CODEGEN, highlevel_opcode_to_str(hl_opcode));
   // single operand
   if(hl_opcode == HINS_enter){
     ll_iseq->append(new Instruction(MINS_PUSHQ, Operand(Operand::MREG64, MREG_RBP)));
@@ -277,6 +428,10 @@ void LowLevelCodeGen::translate_instruction(Instruction* hl_ins, const std::shar
     ll_iseq->append(new Instruction(MINS_RET));
     return;
   }
+  if(hl_opcode == HINS_nop){
+    ll_iseq->append(new Instruction(MINS_NOP));
+    return;
+  }
 
   // label
   Operand label = hl_ins->get_operand(0);
@@ -288,6 +443,26 @@ void LowLevelCodeGen::translate_instruction(Instruction* hl_ins, const std::shar
     ll_iseq->append(new Instruction(MINS_JMP, label));
     return;
   }
+  if(hl_opcode == HINS_tailcall){
+    // tear down the frame, so the callee returns directly to our caller
+    ll_iseq->append(new Instruction(MINS_ADDQ, Operand(Operand::IMM_IVAL, m_total_memory_storage), Operand(Operand::MREG64, MREG_RSP)));
+    ll_iseq->append(new Instruction(MINS_POPQ, Operand(Operand::MREG64, MREG_RBP)));
+    ll_iseq->append(new Instruction(MINS_JMP, label));
+    return;
+  }
+  if(hl_opcode == HINS_jmptab){
+    // bounds check (unsigned, so this also catches negative indices),
+    // then jump indirectly through the table
+    const JumpTable& table = hl_ins->get_jump_table();
+    Operand r10(Operand::MREG64, MREG_R10);
+    ll_iseq->append(new Instruction(MINS_MOVQ, get_ll_operand(label, 8, ll_iseq), r10));
+    ll_iseq->append(new Instruction(MINS_CMPQ, Operand(Operand::IMM_IVAL, long(table.labels.size()) - 1), r10));
+    ll_iseq->append(new Instruction(MINS_JA, hl_ins->get_operand(1)));
+    Instruction* jmpq = new Instruction(MINS_JMPQ, Operand(Operand::LABEL_MEM_IDX, table.name, MREG_R10, 8));
+    jmpq->set_jump_table(table.name, table.labels);
+    ll_iseq->append(jmpq);
+    return;
+  }
 
   // double operand
 
@@ -313,16 +488,30 @@ void LowLevelCodeGen::translate_instruction(Instruction* hl_ins, const std::shar
 
     return;
   }
+  if(hl_opcode >= HINS_select_b && hl_opcode <= HINS_select_q){
+    translate_select(hl_ins, first_operand, ll_iseq);
+    return;
+  }
+  if(hl_opcode >= HINS_vmov_l && hl_opcode <= HINS_vsum_q){
+    translate_vector(hl_ins, first_operand, ll_iseq);
+    return;
+  }
+  if(is_compare(hl_opcode)){
+    translate_compare(hl_ins, ll_iseq);
+    store_flag(COMPARE_SET[get_compare_kind(hl_opcode)], size, first_operand, ll_iseq);
+    return;
+  }
   LowLevelOpcode mov_opcode = select_ll_opcode(MINS_MOVB, size);
   Operand::Kind mreg_kind = select_mreg_kind(size);
   Operand sec_operand = get_ll_operand(hl_ins->get_operand(1), size, ll_iseq);
   Operand r10(mreg_kind, MREG_R10);
   Operand r11(mreg_kind, MREG_R11);
-  if(match_hl(HINS_sconv_bw, hl_opcode)){
+  bool is_uconv = match_hl(HINS_uconv_bw, hl_opcode);
+  if(match_hl(HINS_sconv_bw, hl_opcode) || is_uconv){
     LowLevelOpcode first_mov;
     LowLevelOpcode sec_mov;
     int first, sec;
-    int dif = hl_opcode - HINS_sconv_bw;
+    int dif = hl_opcode - (is_uconv ? HINS_uconv_bw : HINS_sconv_bw);
     switch(dif){
       case 0:{
         first = 1;
@@ -363,13 +552,20 @@ void LowLevelCodeGen::translate_instruction(Instruction* hl_ins, const std::shar
     Operand first_r10(select_mreg_kind(first), MREG_R10);
     Operand sec_r10(select_mreg_kind(sec), MREG_R10);
     ll_iseq->append(new Instruction(first_mov, sec_operand, first_r10));
-    ll_iseq->append(new Instruction(dif + MINS_MOVSBW, first_r10, sec_r10));
+    // there's no movzlq: the movl into %r10d already cleared the upper half
+    if(!(is_uconv && hl_opcode == HINS_uconv_lq)){
+      ll_iseq->append(new Instruction(dif + (is_uconv ? MINS_MOVZBW : MINS_MOVSBW), first_r10, sec_r10));
+    }
     ll_iseq->append(new Instruction(sec_mov, sec_r10, first_operand));
     return;
   }
   if(match_hl(HINS_mov_b, hl_opcode)){
 
-    if(sec_operand.is_memref() && first_operand.is_memref()){
+    // (a 64 bit immediate which doesn't fit in 32 bits can only be
+    // moved into a register)
+    bool wide_imm = sec_operand.is_imm_ival()
+                    && (sec_operand.get_imm_ival() < INT32_MIN || sec_operand.get_imm_ival() > INT32_MAX);
+    if((sec_operand.is_memref() || wide_imm) && first_operand.is_memref()){
       ll_iseq->append(new Instruction(mov_opcode, sec_operand, r10));
       sec_operand = r10;
     }
@@ -420,7 +616,11 @@ void LowLevelCodeGen::translate_instruction(Instruction* hl_ins, const std::shar
     return;
   }
   if(match_hl(HINS_neg_b, hl_opcode)){
-    if(sec_operand.is_memref() && first_operand.is_memref()){
+    // (a 64 bit immediate which doesn't fit in 32 bits can only be
+    // moved into a register)
+    bool wide_imm = sec_operand.is_imm_ival()
+                    && (sec_operand.get_imm_ival() < INT32_MIN || sec_operand.get_imm_ival() > INT32_MAX);
+    if((sec_operand.is_memref() || wide_imm) && first_operand.is_memref()){
       ll_iseq->append(new Instruction(mov_opcode, sec_operand, r10));
       sec_operand = r10;
     }
@@ -430,12 +630,51 @@ void LowLevelCodeGen::translate_instruction(Instruction* hl_ins, const std::shar
     ll_iseq->append(new Instruction(sub, sec_operand, first_operand));
     return;
   }
-  if(match_hl(HINS_add_b, hl_opcode) || match_hl(HINS_sub_b, hl_opcode)){
+  if(match_hl(HINS_not_b, hl_opcode)){
+    ll_iseq->append(new Instruction(mov_opcode, sec_operand, r10));
+    ll_iseq->append(new Instruction(select_ll_opcode(MINS_CMPB, size), zero, r10));
+    store_flag(MINS_SETE, size, first_operand, ll_iseq);
+    return;
+  }
+  if(match_hl(HINS_compl_b, hl_opcode)){
+    ll_iseq->append(new Instruction(mov_opcode, sec_operand, r10));
+    ll_iseq->append(new Instruction(select_ll_opcode(MINS_NOTB, size), r10));
+    ll_iseq->append(new Instruction(mov_opcode, r10, first_operand));
+    return;
+  }
+  if(match_hl(HINS_lshift_b, hl_opcode) || match_hl(HINS_rshift_b, hl_opcode) || match_hl(HINS_urshift_b, hl_opcode)){
+    LowLevelOpcode opcode = MINS_SHLB;
+    if(match_hl(HINS_rshift_b, hl_opcode)){
+      opcode = MINS_SARB;
+    } else if(match_hl(HINS_urshift_b, hl_opcode)){
+      opcode = MINS_SHRB;
+    }
+    opcode = select_ll_opcode(opcode, size);
+    Operand trd_operand = get_ll_operand(hl_ins->get_operand(2), size, ll_iseq);
+
+    ll_iseq->append(new Instruction(mov_opcode, sec_operand, r10));
+    // a shift count which isn't a constant has to be in %cl
+    if(!trd_operand.is_imm_ival()){
+      ll_iseq->append(new Instruction(mov_opcode, trd_operand, Operand(mreg_kind, MREG_RCX)));
+      trd_operand = Operand(Operand::MREG8, MREG_RCX);
+    }
+    ll_iseq->append(new Instruction(opcode, trd_operand, r10));
+    ll_iseq->append(new Instruction(mov_opcode, r10, first_operand));
+    return;
+  }
+  if(match_hl(HINS_add_b, hl_opcode) || match_hl(HINS_sub_b, hl_opcode) || match_hl(HINS_and_b, hl_opcode)
+     || match_hl(HINS_or_b, hl_opcode) || match_hl(HINS_xor_b, hl_opcode)){
     LowLevelOpcode opcode;
     if(match_hl(HINS_add_b, hl_opcode)){
       opcode = MINS_ADDB;
     } else if(match_hl(HINS_sub_b, hl_opcode)){
       opcode = MINS_SUBB;
+    } else if(match_hl(HINS_and_b, hl_opcode)){
+      opcode = MINS_ANDB;
+    } else if(match_hl(HINS_or_b, hl_opcode)){
+      opcode = MINS_ORB;
+    } else{
+      opcode = MINS_XORB;
     }
     opcode = select_ll_opcode(opcode, size);
 
@@ -450,51 +689,137 @@ void LowLevelCodeGen::translate_instruction(Instruction* hl_ins, const std::shar
     //   sec_operand = r10;
     // }
     ll_iseq->append(new Instruction(opcode, trd_operand, sec_operand));
-    if(sec_operand.is_memref() && first_operand.is_memref()){
+    // (a 64 bit immediate which doesn't fit in 32 bits can only be
+    // moved into a register)
+    bool wide_imm = sec_operand.is_imm_ival()
+                    && (sec_operand.get_imm_ival() < INT32_MIN || sec_operand.get_imm_ival() > INT32_MAX);
+    if((sec_operand.is_memref() || wide_imm) && first_operand.is_memref()){
       ll_iseq->append(new Instruction(mov_opcode, sec_operand, r10));
       sec_operand = r10;
     }
     ll_iseq->append(new Instruction(mov_opcode, sec_operand, first_operand));
     return;
   }
-  if(match_hl(HINS_cmplte_b, hl_opcode) || match_hl(HINS_cmplt_b, hl_opcode) || match_hl(HINS_cmpeq_b, hl_opcode) || match_hl(HINS_cmpgt_b, hl_opcode) || match_hl(HINS_cmpgte_b, hl_opcode)){
-    LowLevelOpcode cmp_opcode = select_ll_opcode(MINS_CMPB, size);
-    LowLevelOpcode movzb_opcode = select_ll_opcode(MINS_MOVZBW, 1, size);
+  printf("%s not handled\n", highlevel_opcode_to_str(hl_opcode));
+  return;
 
-    Operand trd_operand = get_ll_operand(hl_ins->get_operand(2), size, ll_iseq);
+  // RuntimeError::raise("high level opcode %d not handled" , int(hl_opcode));
+}
 
-    if(sec_operand.is_memref() && trd_operand.is_memref()){
-      ll_iseq->append(new Instruction(mov_opcode, sec_operand, r10));
-      sec_operand = r10;
-    }
-    if(sec_operand.is_imm_ival()){
-      ll_iseq->append(new Instruction(mov_opcode, sec_operand, r10));
-      sec_operand = r10;
-    }
-    ll_iseq->append(new Instruction(cmp_opcode, trd_operand, sec_operand));
-    //zero byte
-    Operand r10b(Operand::MREG8, MREG_R10);
-    if(match_hl(HINS_cmplte_b, hl_opcode)){
-      ll_iseq->append(new Instruction(MINS_SETLE, r10b));
-    } else if(match_hl(HINS_cmplt_b, hl_opcode)){
-      ll_iseq->append(new Instruction(MINS_SETL, r10b));
-    } else if(match_hl(HINS_cmpeq_b, hl_opcode)){
-      ll_iseq->append(new Instruction(MINS_SETE, r10b));
-    } else if(match_hl(HINS_cmpgt_b, hl_opcode)){
-      ll_iseq->append(new Instruction(MINS_SETG, r10b));
-    } else if(match_hl(HINS_cmpgte_b, hl_opcode)){
-      ll_iseq->append(new Instruction(MINS_SETGE, r10b));
-    }
-    ll_iseq->append(new Instruction(movzb_opcode, r10b, r11));
-    ll_iseq->append(new Instruction(mov_opcode, r11, first_operand));
+// Compare the source operands of a high-level comparison, leaving
+// the result in the flags
+void LowLevelCodeGen::translate_compare(Instruction* hl_ins, const std::shared_ptr<InstructionSequence>& ll_iseq){
+  int size = highlevel_opcode_get_source_operand_size(HighLevelOpcode(hl_ins->get_opcode()));
+  LowLevelOpcode mov_opcode = select_ll_opcode(MINS_MOVB, size);
+  Operand r10(select_mreg_kind(size), MREG_R10);
 
+  // the left operand is the destination of the cmp, so it can't be an
+  // immediate, and it can only be in memory if the right one is an
+  // immediate (it goes in %r10 first, since a memory operand of the
+  // right one may need %r11 too)
+  Operand sec_operand = get_ll_operand(hl_ins->get_operand(1), size, ll_iseq);
+  if(sec_operand.is_imm_ival() || (sec_operand.is_memref() && !hl_ins->get_operand(2).is_imm_ival())){
+    ll_iseq->append(new Instruction(mov_opcode, sec_operand, r10));
+    sec_operand = r10;
+  }
+  Operand trd_operand = get_ll_operand(hl_ins->get_operand(2), size, ll_iseq);
+  if(trd_operand.is_imm_ival() && (trd_operand.get_imm_ival() < INT32_MIN || trd_operand.get_imm_ival() > INT32_MAX)){
+    // cmpq only takes a 32 bit immediate
+    Operand r11(Operand::MREG64, MREG_R11);
+    ll_iseq->append(new Instruction(MINS_MOVQ, trd_operand, r11));
+    trd_operand = r11;
+  }
+  ll_iseq->append(new Instruction(select_ll_opcode(MINS_CMPB, size), trd_operand, sec_operand));
+}
+
+// Translate select dest, cond, if_true, if_false: the condition is a
+// 0 or 1 flag, tested before the values are loaded (movs don't change
+// the flags, and a memory operand of the condition may use %r11)
+void LowLevelCodeGen::translate_select(Instruction* hl_ins, const Operand& dest, const std::shared_ptr<InstructionSequence>& ll_iseq){
+  int size = highlevel_opcode_get_source_operand_size(HighLevelOpcode(hl_ins->get_opcode()));
+  LowLevelOpcode mov_opcode = select_ll_opcode(MINS_MOVB, size);
+  Operand r10(select_mreg_kind(size), MREG_R10);
+
+  Operand cond = hl_ins->get_operand(1);
+  if(cond.is_imm_ival()){
+    Operand value = get_ll_operand(hl_ins->get_operand(cond.get_imm_ival() ? 2 : 3), size, ll_iseq);
+    ll_iseq->append(new Instruction(mov_opcode, value, r10));
+    ll_iseq->append(new Instruction(mov_opcode, r10, dest));
     return;
   }
+  ll_iseq->append(new Instruction(MINS_CMPB, Operand(Operand::IMM_IVAL, 0), get_ll_operand(cond, 1, ll_iseq)));
+  ll_iseq->append(new Instruction(mov_opcode, get_ll_operand(hl_ins->get_operand(3), size, ll_iseq), r10));
+  Operand r11(select_mreg_kind(size), MREG_R11);
+  ll_iseq->append(new Instruction(mov_opcode, get_ll_operand(hl_ins->get_operand(2), size, ll_iseq), r11));
+
+  // cmov has no 8 bit form, and the 32 bit one is as good as the 16 bit one
+  Operand::Kind cmov_kind = select_mreg_kind(size < 4 ? 4 : size);
+  ll_iseq->append(new Instruction(MINS_CMOVNE, Operand(cmov_kind, MREG_R11), Operand(cmov_kind, MREG_R10)));
+  ll_iseq->append(new Instruction(mov_opcode, r10, dest));
+}
 
-  printf("%s not handled\n", highlevel_opcode_to_str(hl_opcode));
-  return;
+// Translate a vector operation: a vector vreg's slot is followed by
+// the (unused) slot of the next vreg, so the vector is the 16 bytes
+// at the slot. The vectors are worked on in %xmm0 and %xmm1, loaded
+// and stored with movdqu, since neither the slots nor arrays are 16
+// byte aligned (which the other SSE instructions' memory operands
+// would have to be).
+void LowLevelCodeGen::translate_vector(Instruction* hl_ins, const Operand& dest, const std::shared_ptr<InstructionSequence>& ll_iseq){
+  HighLevelOpcode hl_opcode = HighLevelOpcode(hl_ins->get_opcode());
+  int size = highlevel_opcode_get_source_operand_size(hl_opcode);
+  bool quad = size == 8;
+  Operand xmm0(Operand::MREG128, MREG_XMM0), xmm1(Operand::MREG128, MREG_XMM1);
+  Operand r10(select_mreg_kind(size), MREG_R10);
+  Operand src = get_ll_operand(hl_ins->get_operand(1), size, ll_iseq);
+
+  if(hl_opcode >= HINS_vdup_l && hl_opcode <= HINS_vdup_q){
+    // put the scalar in the low element, and copy it to the others
+    ll_iseq->append(new Instruction(select_ll_opcode(MINS_MOVB, size), src, r10));
+    if(quad){
+      ll_iseq->append(new Instruction(MINS_MOVQ, r10, xmm0));
+      ll_iseq->append(new Instruction(MINS_PUNPCKLQDQ, xmm0, xmm0));
+    } else{
+      ll_iseq->append(new Instruction(MINS_MOVD, r10, xmm0));
+      ll_iseq->append(new Instruction(MINS_PSHUFD, Operand(Operand::IMM_IVAL, 0), xmm0, xmm0));
+    }
+    ll_iseq->append(new Instruction(MINS_MOVDQU, xmm0, dest));
+    return;
+  }
 
-  // RuntimeError::raise("high level opcode %d not handled" , int(hl_opcode));
+  ll_iseq->append(new Instruction(MINS_MOVDQU, src, xmm0));
+  if(hl_opcode <= HINS_vmov_q){
+    ll_iseq->append(new Instruction(MINS_MOVDQU, xmm0, dest));
+    return;
+  }
+  if(hl_opcode >= HINS_vsum_l){
+    // add the high half to the low half (and for longs, the second
+    // element to the first), leaving the sum in the low element
+    ll_iseq->append(new Instruction(MINS_PSHUFD, Operand(Operand::IMM_IVAL, 0x4e), xmm0, xmm1));
+    ll_iseq->append(new Instruction(quad ? MINS_PADDQ : MINS_PADDD, xmm1, xmm0));
+    if(!quad){
+      ll_iseq->append(new Instruction(MINS_PSHUFD, Operand(Operand::IMM_IVAL, 0xb1), xmm0, xmm1));
+      ll_iseq->append(new Instruction(MINS_PADDD, xmm1, xmm0));
+    }
+    ll_iseq->append(new Instruction(quad ? MINS_MOVQ : MINS_MOVD, xmm0, r10));
+    ll_iseq->append(new Instruction(select_ll_opcode(MINS_MOVB, size), r10, dest));
+    return;
+  }
+
+  LowLevelOpcode op;
+  if(hl_opcode <= HINS_vadd_q){
+    op = quad ? MINS_PADDQ : MINS_PADDD;
+  } else if(hl_opcode <= HINS_vsub_q){
+    op = quad ? MINS_PSUBQ : MINS_PSUBD;
+  } else if(hl_opcode <= HINS_vand_q){
+    op = MINS_PAND;
+  } else if(hl_opcode <= HINS_vor_q){
+    op = MINS_POR;
+  } else{
+    op = MINS_PXOR;
+  }
+  ll_iseq->append(new Instruction(MINS_MOVDQU, get_ll_operand(hl_ins->get_operand(2), size, ll_iseq), xmm1));
+  ll_iseq->append(new Instruction(op, xmm1, xmm0));
+  ll_iseq->append(new Instruction(MINS_MOVDQU, xmm0, dest));
 }
 
 // TODO: implement other private member functions
@@ -519,17 +844,33 @@ Operand LowLevelCodeGen::get_ll_operand(Operand hl_opcode, int size, const std::
     }
   }
   if(hl_opcode.get_kind() == Operand::VREG_MEM){
-    int base = hl_opcode.get_base_reg();
-    if(base >= 10){
-      base = highest - base;
-      // base -= 10;
-    }
-    Operand op(Operand::MREG64_MEM_OFF, MREG_RBP, mem_addr - base * 8);
-    // printf("memadd = %d\n", mem_addr);
+    // the base may also be an argument register, once optimizations
+    // have propagated a copy of a pointer parameter
+    Operand op = get_ll_operand(Operand(Operand::VREG, hl_opcode.get_base_reg()), 8, ll_iseq);
     Operand r11(Operand::MREG64, MREG_R11);
     ll_iseq->append(new Instruction(MINS_MOVQ, op, r11));
     return r11.to_memref();
   }
+  if(hl_opcode.get_kind() == Operand::VREG_MEM_OFF || hl_opcode.get_kind() == Operand::VREG_MEM_IDX){
+    // address modes selected by AddressModeSelection: the base goes in %r11
+    // and the index (if any) in %rcx, which nothing else uses
+    Operand base = get_ll_operand(Operand(Operand::VREG, hl_opcode.get_base_reg()), 8, ll_iseq);
+    ll_iseq->append(new Instruction(MINS_MOVQ, base, Operand(Operand::MREG64, MREG_R11)));
+    if(hl_opcode.get_kind() == Operand::VREG_MEM_OFF){
+      if(hl_opcode.get_offset() == 0){
+        return Operand(Operand::MREG64_MEM, MREG_R11);
+      }
+      return Operand(Operand::MREG64_MEM_OFF, MREG_R11, hl_opcode.get_offset());
+    }
+    Operand index = get_ll_operand(Operand(Operand::VREG, hl_opcode.get_index_reg()), 8, ll_iseq);
+    ll_iseq->append(new Instruction(MINS_MOVQ, index, Operand(Operand::MREG64, MREG_RCX)));
+    return Operand(Operand::MREG64_MEM_IDX, MREG_R11, MREG_RCX, hl_opcode.get_scale());
+  }
+  if(hl_opcode.get_kind() == Operand::FRAME_MEM_OFF){
+    // at the same place localaddr computes the address of
+    int addr = (hl_opcode.get_frame_slot() + hl_opcode.get_offset() + 8) + mem_addr;
+    return Operand(Operand::MREG64_MEM_OFF, MREG_RBP, addr);
+  }
   // printf("hlopcode, %d", hl_opcode.get_kind());
   return Operand(Operand::MREG64_MEM_OFF, MREG_RBP, (10000 * 8) - m_total_memory_storage);
 }
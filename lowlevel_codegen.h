@@ -13,16 +13,26 @@ private:
   bool m_optimize;
   int mem_addr;
   int highest;
+  unsigned m_next_label_num;
+  unsigned m_max_unroll;
 
 public:
-  LowLevelCodeGen(bool optimize);
+  // next_label_num is the number of the first label the optimizer
+  // may add (see BlockLayout); loops are unrolled at most max_unroll
+  // times (see LoopUnrolling)
+  LowLevelCodeGen(bool optimize, unsigned next_label_num = 0, unsigned max_unroll = 1);
   virtual ~LowLevelCodeGen();
 
   std::shared_ptr<InstructionSequence> generate(const std::shared_ptr<InstructionSequence>& hl_iseq);
 
+  unsigned get_next_label_num() const{ return m_next_label_num; }
+
 private:
   std::shared_ptr<InstructionSequence> translate_hl_to_ll(const std::shared_ptr<InstructionSequence>& hl_iseq);
   void translate_instruction(Instruction* hl_ins, const std::shared_ptr<InstructionSequence>& ll_iseq);
+  void translate_compare(Instruction* hl_ins, const std::shared_ptr<InstructionSequence>& ll_iseq);
+  void translate_select(Instruction* hl_ins, const Operand& dest, const std::shared_ptr<InstructionSequence>& ll_iseq);
+  void translate_vector(Instruction* hl_ins, const Operand& dest, const std::shared_ptr<InstructionSequence>& ll_iseq);
   Operand get_ll_operand(Operand hl_opcode, int size, const std::shared_ptr<InstructionSequence>& ll_iseq);
 };
 bool match_hl(int base, int hl_opcode);
@@ -1,7 +1,9 @@
 #include <cassert>
+#include <cstring>
 #include "instruction.h"
 #include "exceptions.h"
 #include "lowlevel.h"
+#include "output_buffer.h"
 #include "lowlevel_formatter.h"
 
 namespace {
@@ -40,6 +42,44 @@ std::string format_reg(int regnum, int size) {
   return std::string("%") + mreg_operand_names[regnum][size];
 }
 
+void write_reg(int regnum, int size, OutputBuffer &out) {
+  assert(regnum >= 0 && regnum < num_mregs);
+  assert(size >= BYTE && size <= QUAD);
+  out.append('%');
+  out.append(mreg_operand_names[regnum][size]);
+}
+
+// Mnemonics padded to 8 characters (plus the space separating them
+// from the operands), so instructions can be written with a single copy
+struct PaddedMnemonic {
+  char text[24];
+  unsigned len;
+};
+
+const int num_ll_opcodes = MINS_PUNPCKLQDQ + 1;
+
+struct MnemonicTable {
+  PaddedMnemonic entries[num_ll_opcodes];
+
+  MnemonicTable() {
+    for (int i = 0; i < num_ll_opcodes; i++) {
+      const char *mnemonic = lowlevel_opcode_to_str(LowLevelOpcode(i));
+      entries[i].len = 0;
+      if (mnemonic == nullptr) {
+        continue;
+      }
+      unsigned len = strlen(mnemonic);
+      assert(len < 16);
+      memcpy(entries[i].text, mnemonic, len);
+      unsigned padded = (len < 8U) ? 9U : len + 1U;
+      memset(entries[i].text + len, ' ', padded - len);
+      entries[i].len = padded;
+    }
+  }
+};
+
+const MnemonicTable padded_mnemonics;
+
 }
 
 LowLevelFormatter::LowLevelFormatter() {
@@ -71,11 +111,20 @@ std::string LowLevelFormatter::format_operand(const Operand &operand) const {
     return "(" + format_reg(operand.get_base_reg(), QUAD) + ")";
 
   case Operand::MREG64_MEM_IDX:
+    if (operand.get_scale() != 1) {
+      return "(" + format_reg(operand.get_base_reg(), QUAD) + "," + format_reg(operand.get_index_reg(), QUAD) + "," + std::to_string(operand.get_scale()) + ")";
+    }
     return "(" + format_reg(operand.get_base_reg(), QUAD) + "," + format_reg(operand.get_index_reg(), QUAD) + ")";
 
   case Operand::MREG64_MEM_OFF:
     return std::to_string(operand.get_offset()) + "(" + format_reg(operand.get_base_reg(), QUAD) + ")";
 
+  case Operand::MREG128:
+    return "%xmm" + std::to_string(operand.get_base_reg() - MREG_XMM0);
+
+  case Operand::LABEL_MEM_IDX:
+    return operand.get_label() + "(," + format_reg(operand.get_index_reg(), QUAD) + "," + std::to_string(operand.get_scale()) + ")";
+
   default:
     assert(false);
     return "<unknown operand kind>";
@@ -98,6 +147,10 @@ std::string LowLevelFormatter::format_instruction(const Instruction *ins) const
   // pad mnemonics to 8 characters
   unsigned padding = (mnemonic.size() < 8U) ? 8U - mnemonic.size() : 0;
   buf += ("         " + (8U - padding));
+  // the target of an indirect jump is written with a *
+  if (opcode == MINS_JMPQ) {
+    buf += '*';
+  }
   for (unsigned i = 0; i < ins->get_num_operands(); i++) {
     if (i > 0) {
       buf += ", ";
@@ -107,3 +160,90 @@ std::string LowLevelFormatter::format_instruction(const Instruction *ins) const
 
   return buf;
 }
+
+void LowLevelFormatter::write_operand(const Operand &operand, OutputBuffer &out) const {
+  if (operand.is_non_reg()) {
+    Formatter::write_operand(operand, out);
+    return;
+  }
+
+  switch (operand.get_kind()) {
+  case Operand::MREG8:
+    write_reg(operand.get_base_reg(), BYTE, out);
+    break;
+
+  case Operand::MREG16:
+    write_reg(operand.get_base_reg(), WORD, out);
+    break;
+
+  case Operand::MREG32:
+    write_reg(operand.get_base_reg(), DWORD, out);
+    break;
+
+  case Operand::MREG64:
+    write_reg(operand.get_base_reg(), QUAD, out);
+    break;
+
+  case Operand::MREG64_MEM:
+    out.append('(');
+    write_reg(operand.get_base_reg(), QUAD, out);
+    out.append(')');
+    break;
+
+  case Operand::MREG64_MEM_IDX:
+    out.append('(');
+    write_reg(operand.get_base_reg(), QUAD, out);
+    out.append(',');
+    write_reg(operand.get_index_reg(), QUAD, out);
+    if (operand.get_scale() != 1) {
+      out.append(',');
+      out.append_int(operand.get_scale());
+    }
+    out.append(')');
+    break;
+
+  case Operand::MREG64_MEM_OFF:
+    out.append_int(operand.get_offset());
+    out.append('(');
+    write_reg(operand.get_base_reg(), QUAD, out);
+    out.append(')');
+    break;
+
+  case Operand::MREG128:
+    out.append("%xmm", 4);
+    out.append_int(operand.get_base_reg() - MREG_XMM0);
+    break;
+
+  case Operand::LABEL_MEM_IDX:
+    out.append(operand.get_label());
+    out.append("(,", 2);
+    write_reg(operand.get_index_reg(), QUAD, out);
+    out.append(',');
+    out.append_int(operand.get_scale());
+    out.append(')');
+    break;
+
+  default:
+    assert(false);
+    out.append("<unknown operand kind>");
+    break;
+  }
+}
+
+void LowLevelFormatter::write_instruction(const Instruction *ins, OutputBuffer &out) const {
+  int opcode = ins->get_opcode();
+  if (opcode < 0 || opcode >= num_ll_opcodes || padded_mnemonics.entries[opcode].len == 0)
+    RuntimeError::raise("Unknown low level opcode: %d", opcode);
+
+  const PaddedMnemonic &mnemonic = padded_mnemonics.entries[opcode];
+  out.append(mnemonic.text, mnemonic.len);
+  if (opcode == MINS_JMPQ) {
+    out.append('*');
+  }
+  for (unsigned i = 0; i < ins->get_num_operands(); i++) {
+    if (i > 0) {
+      out.append(", ", 2);
+    }
+    write_operand(ins->get_operand(i), out);
+  }
+}
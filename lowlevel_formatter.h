@@ -10,6 +10,9 @@ public:
 
   virtual std::string format_operand(const Operand &operand) const;
   virtual std::string format_instruction(const Instruction *ins) const;
+
+  virtual void write_operand(const Operand &operand, OutputBuffer &out) const;
+  virtual void write_instruction(const Instruction *ins, OutputBuffer &out) const;
 };
 
 #endif // LOWLEVEL_FORMATTER_H
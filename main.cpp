@@ -19,6 +19,9 @@
 // OTHER DEALINGS IN THE SOFTWARE.
 
 #include <cstdlib>
+#include <csignal>
+#include <thread>
+#include <unistd.h>
 #include "context.h"
 #include "ast.h"
 #include "grammar_symbols.h"
@@ -28,18 +31,41 @@
 #include "exceptions.h"
 #include "cfg.h"
 #include "print_cfg.h"
+#include "elf_object_writer.h"
+#include "phase_timer.h"
+#include "trace_log.h"
+#include "compile_server.h"
+#include "cpputil.h"
 
 void usage(){
   fprintf(stderr, "Usage: nearly_cc [options...] <filename>\n"
+    "       nearly_cc --server [-j <n>] [--socket <path>]\n"
     "Options:\n"
     "  -l   print tokens\n"
+    "  -t   report time spent in each phase (as CSV) on stderr\n"
+    "  --stats    report time, memory use and allocations for each phase on stderr\n"
+    "  --trace <file>  write a Chrome trace of the compilation phases to file\n"
+    "  -T <categories>  record trace events for a comma-separated list of\n"
+    "             categories (sema, storage, hl_codegen, ll_codegen, or all),\n"
+    "             and print the most recent ones on stderr when compilation\n"
+    "             ends; they must be compiled in (make TRACE_CATEGORIES=0xf)\n"
     "  -p   print parse tree\n"
     "  -C   print CFG of high-level code\n"
     "  -c   print CFG of low-level code\n"
     "  -L   print CFG of high-level code with liveness info\n"
     "  -a   perform semantic analysis, print symbol table\n"
     "  -h   print results of high-level code generation\n"
-    "  -o   enable code optimization\n");
+    "  -o   enable code optimization\n"
+    "  -funroll=<n>  with -o, unroll counted loops at most n times\n"
+    "             (default: 4, 1 disables unrolling)\n"
+    "  -b   write an ELF object file instead of assembly code\n"
+    "  -f <file>  write generated code to file instead of stdout\n"
+    "Server options:\n"
+    "  --server   read compile requests (options as above, one compilation\n"
+    "             per line) from stdin and run them concurrently\n"
+    "  -j <n>     number of worker threads (default: number of CPUs)\n"
+    "  --socket <path>  accept requests on a Unix domain socket instead\n"
+    "             of stdin\n");
   exit(1);
 }
 
@@ -52,71 +78,284 @@ enum class Mode{
   PRINT_LOWLEVEL_CFG,
   PRINT_HIGHLEVEL_CFG_LIVENESS,
   COMPILE,
+  COMPILE_OBJECT,
 };
 
-void process_source_file(const std::string& filename, Mode mode, bool optimize);
+// Options for a single compilation
+struct Options{
+  Mode mode = Mode::COMPILE;
+  bool optimize = false;
+  unsigned unroll = 4;
+  std::string output_filename;
+  bool timing = false;
+  bool stats = false;
+  std::string trace_filename;
+  std::string trace_categories;
+  std::string filename;
+};
+
+// parse the options and filename of a single compilation starting at
+// args[index]; returns false if they are invalid
+bool parse_options(const std::vector<std::string>& args, size_t index, Options& opts);
+
+// compile one request received in server mode, returning an error
+// message if it fails
+std::string compile_request(const std::vector<std::string>& args);
+
+std::string format_error(const BaseException& ex);
+
+void run_server(int argc, char** argv);
+
+void process_source_file(const std::string& filename, Mode mode, bool optimize, unsigned unroll, FILE* out);
 
 int main(int argc, char** argv){
   if(argc < 2){
     usage();
   }
 
-  Mode mode = Mode::COMPILE;
-  bool optimize = false;
+  if(std::string(argv[1]) == "--server"){
+    run_server(argc, argv);
+    return 0;
+  }
 
-  int index = 1;
-  while(index < argc){
-    std::string arg(argv[index]);
+  Options opts;
+  if(!parse_options(std::vector<std::string>(argv, argv + argc), 1, opts)){
+    usage();
+  }
+
+  if(opts.timing){
+    PhaseTimer::enable();
+  }
+  if(opts.stats || !opts.trace_filename.empty()){
+    PhaseTimer::enable_stats(!opts.trace_filename.empty());
+  }
+  if(!opts.trace_categories.empty()){
+    if(!TraceLog::enable(opts.trace_categories)){
+      fprintf(stderr, "Error: unknown trace category in '%s'\n", opts.trace_categories.c_str());
+      exit(1);
+    }
+    for(int i = 0; i < NUM_TRACE_CATEGORIES; i++){
+      TraceCategory cat = TraceCategory(i);
+      if(TraceLog::is_enabled(cat) && !TraceLog::is_compiled_in(cat)){
+        fprintf(stderr, "Warning: trace category %s is not compiled in\n", TraceLog::get_name(cat));
+      }
+    }
+  }
+
+  FILE* out = stdout;
+  if(!opts.output_filename.empty()){
+    out = fopen(opts.output_filename.c_str(), "w");
+    if(out == nullptr){
+      fprintf(stderr, "Error: couldn't open %s for writing\n", opts.output_filename.c_str());
+      exit(1);
+    }
+  }
+  try{
+    process_source_file(opts.filename, opts.mode, opts.optimize, opts.unroll, out);
+  }
+  catch(BaseException& ex){
+    // the events leading up to the error are the interesting ones
+    if(TraceLog::is_any_enabled()){
+      TraceLog::dump(stderr);
+    }
+    fprintf(stderr, "%s\n", format_error(ex).c_str());
+    exit(1);
+  }
+
+  if(TraceLog::is_any_enabled()){
+    TraceLog::dump(stderr);
+  }
+
+  if(out != stdout && fclose(out) != 0){
+    fprintf(stderr, "Error: couldn't write %s\n", opts.output_filename.c_str());
+    exit(1);
+  }
+
+  if(PhaseTimer::is_enabled()){
+    PhaseTimer::stop();
+    if(opts.timing){
+      PhaseTimer::print(stderr);
+    }
+    if(opts.stats){
+      PhaseTimer::print_stats(stderr);
+    }
+    if(!opts.trace_filename.empty()){
+      FILE* trace = fopen(opts.trace_filename.c_str(), "w");
+      if(trace == nullptr){
+        fprintf(stderr, "Error: couldn't open %s for writing\n", opts.trace_filename.c_str());
+        exit(1);
+      }
+      PhaseTimer::write_trace(trace);
+      fclose(trace);
+    }
+  }
+  return 0;
+}
+
+bool parse_options(const std::vector<std::string>& args, size_t index, Options& opts){
+  while(index < args.size()){
+    const std::string& arg = args[index];
     if(arg == "-l"){
-      mode = Mode::PRINT_TOKENS;
+      opts.mode = Mode::PRINT_TOKENS;
+    } else if(arg == "-t"){
+      opts.timing = true;
+    } else if(arg == "--stats"){
+      opts.stats = true;
+    } else if(arg == "--trace"){
+      if(index + 1 >= args.size()){
+        return false;
+      }
+      opts.trace_filename = args[++index];
+    } else if(arg == "-T"){
+      if(index + 1 >= args.size()){
+        return false;
+      }
+      opts.trace_categories = args[++index];
     } else if(arg == "-p"){
-      mode = Mode::PRINT_PARSE_TREE;
+      opts.mode = Mode::PRINT_PARSE_TREE;
     } else if(arg == "-C"){
-      mode = Mode::PRINT_HIGHLEVEL_CFG;
+      opts.mode = Mode::PRINT_HIGHLEVEL_CFG;
     } else if(arg == "-c"){
-      mode = Mode::PRINT_LOWLEVEL_CFG;
+      opts.mode = Mode::PRINT_LOWLEVEL_CFG;
     } else if(arg == "-L"){
-      mode = Mode::PRINT_HIGHLEVEL_CFG_LIVENESS;
+      opts.mode = Mode::PRINT_HIGHLEVEL_CFG_LIVENESS;
     } else if(arg == "-a"){
-      mode = Mode::SEMANTIC_ANALYSIS;
+      opts.mode = Mode::SEMANTIC_ANALYSIS;
     } else if(arg == "-h"){
-      mode = Mode::HIGHLEVEL_CODEGEN;
+      opts.mode = Mode::HIGHLEVEL_CODEGEN;
+    } else if(arg == "-b"){
+      opts.mode = Mode::COMPILE_OBJECT;
     } else if(arg == "-o"){
       // enable code optimization
-      optimize = true;
+      opts.optimize = true;
+    } else if(arg.compare(0, 9, "-funroll=") == 0){
+      char* end;
+      unsigned long factor = strtoul(arg.c_str() + 9, &end, 10);
+      if(arg.size() == 9 || *end != '\0' || factor < 1 || factor > 64){
+        return false;
+      }
+      opts.unroll = unsigned(factor);
+    } else if(arg == "-f"){
+      if(index + 1 >= args.size()){
+        return false;
+      }
+      opts.output_filename = args[++index];
     } else{
       break;
     }
     index++;
   }
 
-  if(index >= argc){
-    usage();
+  if(index >= args.size()){
+    return false;
   }
+  opts.filename = args[index];
+  return true;
+}
 
-  const char* filename = argv[index];
-  try{
-    process_source_file(filename, mode, optimize);
+std::string format_error(const BaseException& ex){
+  const Location& loc = ex.get_loc();
+  if(loc.is_valid()){
+    return cpputil::format("%s:%d:%d:Error: %s", loc.get_srcfile().c_str(), loc.get_line(), loc.get_col(), ex.what());
+  } else{
+    return cpputil::format("Error: %s", ex.what());
   }
-  catch(BaseException& ex){
-    const Location& loc = ex.get_loc();
-    if(loc.is_valid()){
-      fprintf(stderr, "%s:%d:%d:Error: %s\n", loc.get_srcfile().c_str(), loc.get_line(), loc.get_col(), ex.what());
+}
+
+void run_server(int argc, char** argv){
+  unsigned num_workers = std::thread::hardware_concurrency();
+  std::string socket_path;
+
+  for(int index = 2; index < argc; index++){
+    std::string arg(argv[index]);
+    if(arg == "-j" && index + 1 < argc){
+      num_workers = unsigned(atoi(argv[++index]));
+    } else if(arg == "--socket" && index + 1 < argc){
+      socket_path = argv[++index];
     } else{
-      fprintf(stderr, "Error: %s\n", ex.what());
+      usage();
     }
+  }
+
+  // a client which disconnects before reading its responses shouldn't
+  // bring down the server
+  signal(SIGPIPE, SIG_IGN);
+
+  CompileServer server(compile_request, num_workers);
+  try{
+    if(socket_path.empty()){
+      server.serve(STDIN_FILENO, STDOUT_FILENO);
+    } else{
+      server.listen(socket_path);
+    }
+  }
+  catch(BaseException& ex){
+    fprintf(stderr, "%s\n", format_error(ex).c_str());
     exit(1);
   }
+}
 
-  return 0;
+std::string compile_request(const std::vector<std::string>& args){
+  Options opts;
+  if(!parse_options(args, 0, opts)){
+    return "invalid request";
+  }
+
+  // the server's stdout carries the responses, and the phase timer
+  // is shared by the whole process, so only code generation into a
+  // file is supported
+  if(opts.mode != Mode::COMPILE && opts.mode != Mode::COMPILE_OBJECT && opts.mode != Mode::HIGHLEVEL_CODEGEN){
+    return "only -h, -b, or compiling to assembly are supported in server mode";
+  }
+  if(opts.timing || opts.stats || !opts.trace_filename.empty() || !opts.trace_categories.empty()){
+    return "-t, --stats, --trace and -T are not supported in server mode";
+  }
+  if(opts.output_filename.empty()){
+    return "an output file must be given with -f";
+  }
+
+  FILE* out = fopen(opts.output_filename.c_str(), "w");
+  if(out == nullptr){
+    return cpputil::format("Error: couldn't open %s for writing", opts.output_filename.c_str());
+  }
+  std::string err;
+  try{
+    // each request gets its own Context (in process_source_file)
+    process_source_file(opts.filename, opts.mode, opts.optimize, opts.unroll, out);
+  }
+  catch(BaseException& ex){
+    err = format_error(ex);
+  }
+  catch(std::exception& ex){
+    // an internal error in one request shouldn't stop the others
+    err = cpputil::format("Error: %s", ex.what());
+  }
+  if(fclose(out) != 0 && err.empty()){
+    err = cpputil::format("Error: couldn't write %s", opts.output_filename.c_str());
+  }
+  if(!err.empty()){
+    // don't leave partial output behind for the build to pick up
+    remove(opts.output_filename.c_str());
+  }
+  return err;
 }
 
-void process_source_file(const std::string& filename, Mode mode, bool optimize){
+void process_source_file(const std::string& filename, Mode mode, bool optimize, unsigned unroll, FILE* out){
   Context ctx;
 
   if(mode == Mode::PRINT_TOKENS){
     std::vector<Node*> tokens;
     ctx.scan_tokens(filename, tokens);
+
+    if(PhaseTimer::is_enabled()){
+      double seconds = PhaseTimer::get_seconds(Phase::SCAN);
+      double mb = double(ctx.get_source_size()) / (1024.0 * 1024.0);
+      fprintf(stderr, "%zu bytes, %zu tokens in %.3f ms (%.1f MB/s)\n",
+              ctx.get_source_size(), tokens.size(), seconds * 1000.0,
+              seconds > 0.0 ? mb / seconds : 0.0);
+    }
+
+    PhaseScope phase(Phase::PRINT);
     for(auto i = tokens.begin(); i != tokens.end(); ++i){
       Node* tok = *i;
       printf("%d:%s[%s]\n", tok->get_tag(), get_grammar_symbol_name(tok->get_tag()), tok->get_str().c_str());
@@ -139,9 +378,10 @@ void process_source_file(const std::string& filename, Mode mode, bool optimize){
 
       if(mode >= Mode::HIGHLEVEL_CODEGEN){
         std::unique_ptr<ModuleCollector> module_collector;
+        ElfObjectWriter* elf_writer = nullptr;
 
         if(mode == Mode::HIGHLEVEL_CODEGEN){
-          module_collector.reset(new PrintHighLevelCode());
+          module_collector.reset(new PrintHighLevelCode(out));
         } else  if(mode == Mode::PRINT_HIGHLEVEL_CFG){
           // print a high-level CFG for each function
           module_collector.reset(new PrintHighLevelCFG());
@@ -151,15 +391,22 @@ void process_source_file(const std::string& filename, Mode mode, bool optimize){
         } else if(mode == Mode::PRINT_HIGHLEVEL_CFG_LIVENESS){
           // print high-level CFG with liveness info for each function
           module_collector.reset(new PrintHighLevelCFGWithLiveness());
+        } else if(mode == Mode::COMPILE_OBJECT){
+          elf_writer = new ElfObjectWriter();
+          module_collector.reset(elf_writer);
         } else{
           assert(mode == Mode::COMPILE);
-          module_collector.reset(new PrintLowLevelCode());
+          module_collector.reset(new PrintLowLevelCode(out));
         }
 
-        if(mode == Mode::COMPILE || mode == Mode::PRINT_LOWLEVEL_CFG)
-          ctx.lowlevel_codegen(module_collector.get(), optimize);
+        if(mode == Mode::COMPILE || mode == Mode::COMPILE_OBJECT || mode == Mode::PRINT_LOWLEVEL_CFG)
+          ctx.lowlevel_codegen(module_collector.get(), optimize, unroll);
         else
           ctx.highlevel_codegen(module_collector.get());
+
+        if(elf_writer != nullptr){
+          elf_writer->write(out);
+        }
       }
     }
   }
@@ -0,0 +1,337 @@
+#include <cassert>
+#include "node.h"
+#include "instruction.h"
+#include "operand.h"
+#include "highlevel.h"
+#include "highlevel_defuse.h"
+#include "live_vregs.h"
+#include "memory_promotion.h"
+
+namespace{
+
+  bool is_vreg(const Operand& op){
+    return op.get_kind() == Operand::VREG;
+  }
+
+  bool is_branch(int opcode){
+    return opcode == HINS_jmp || opcode == HINS_cjmp_t || opcode == HINS_cjmp_f
+      || opcode == HINS_jmptab || opcode == HINS_ret || opcode == HINS_tailcall;
+  }
+
+  // size of the value accessed by the given operand
+  int get_access_size(Instruction* ins, unsigned operand){
+    HighLevelOpcode opcode = HighLevelOpcode(ins->get_opcode());
+    return (operand == 0) ? highlevel_opcode_get_dest_operand_size(opcode)
+                          : highlevel_opcode_get_source_operand_size(opcode);
+  }
+
+}
+
+bool MemoryPromotion::Slot::operator<(const Slot& other) const{
+  // locals in different blocks can share storage, so a slot
+  // belongs to one object
+  if(object != other.object){
+    return object < other.object;
+  }
+  if(offset != other.offset){
+    return offset < other.offset;
+  }
+  return size < other.size;
+}
+
+MemoryPromotion::MemoryPromotion(const std::shared_ptr<InstructionSequence>& hl_iseq)
+  : m_hl_iseq(hl_iseq){
+}
+
+MemoryPromotion::~MemoryPromotion(){
+}
+
+std::shared_ptr<InstructionSequence> MemoryPromotion::transform(){
+  Node* funcdef_ast = m_hl_iseq->get_funcdef_ast();
+  if(funcdef_ast->get_symbol()->get_addr() == 0){
+    return m_hl_iseq;
+  }
+
+  find_addr_vregs();
+  if(!find_accesses()){
+    return m_hl_iseq;
+  }
+
+  // give each slot of the promoted objects a vreg
+  int next_vreg = funcdef_ast->get_symbol()->get_vreg() + 1;
+  std::map<Slot, int> slot_vregs;
+  for(auto i = m_accesses.begin(); i != m_accesses.end(); ++i){
+    std::set<Slot> slots(i->second.begin(), i->second.end());
+    if(!is_promotable(i->first) || next_vreg + int(slots.size()) > int(LiveVregsAnalysis::MAX_VREGS)){
+      continue;
+    }
+    for(const Slot& slot : slots){
+      slot_vregs[slot] = next_vreg++;
+    }
+  }
+  if(slot_vregs.empty()){
+    return m_hl_iseq;
+  }
+
+  std::vector<Instruction*> code;
+  std::vector<std::string> labels;
+  unsigned i = 0;
+  for(auto it = m_hl_iseq->cbegin(); it != m_hl_iseq->cend(); ++it, ++i){
+    Instruction* ins = (*it)->duplicate();
+    for(unsigned j = 0; j < ins->get_num_operands(); j++){
+      auto memref = m_memrefs.find(std::make_pair(i, j));
+      if(memref == m_memrefs.end()){
+        continue;
+      }
+      auto slot = slot_vregs.find(memref->second);
+      if(slot != slot_vregs.end()){
+        ins->set_operand(Operand(Operand::VREG, slot->second), j);
+      }
+    }
+    code.push_back(ins);
+    labels.push_back(it.has_label() ? it.get_label() : "");
+  }
+
+  // the address computations for promoted objects are (mostly) no
+  // longer used; remove them here, since dead store elimination only
+  // removes one instruction of a chain at a time
+  std::set<long> promoted;
+  for(auto& slot : slot_vregs){
+    promoted.insert(slot.first.object);
+  }
+  bool changed = true;
+  while(changed){
+    changed = false;
+    std::map<int, int> num_uses;
+    auto count_uses = [&](Instruction* ins, int delta){
+      for(unsigned j = 0; j < ins->get_num_operands(); j++){
+        Operand op = ins->get_operand(j);
+        if(HighLevel::is_use(ins, j)){
+          num_uses[op.get_base_reg()] += delta;
+          if(op.has_index_reg()){
+            num_uses[op.get_index_reg()] += delta;
+          }
+        }
+      }
+    };
+    for(Instruction* ins : code){
+      if(ins != nullptr){
+        count_uses(ins, 1);
+      }
+    }
+    for(auto d = m_addr_defs.begin(); d != m_addr_defs.end(); ++d){
+      Instruction*& ins = code[d->first];
+      if(ins == nullptr || !labels[d->first].empty() || promoted.count(d->second) == 0){
+        continue;
+      }
+      // (an add_q may use its destination as the offset)
+      count_uses(ins, -1);
+      if(num_uses[ins->get_operand(0).get_base_reg()] > 0){
+        count_uses(ins, 1);
+      } else{
+        delete ins;
+        ins = nullptr;
+        changed = true;
+      }
+    }
+  }
+
+  std::shared_ptr<InstructionSequence> result(new InstructionSequence());
+  for(unsigned k = 0; k < code.size(); k++){
+    if(!labels[k].empty()){
+      result->define_label(labels[k]);
+    }
+    if(code[k] != nullptr){
+      result->append(code[k]);
+    }
+  }
+  result->set_funcdef_ast(funcdef_ast);
+  funcdef_ast->get_symbol()->set_vreg(next_vreg - 1);
+  return result;
+}
+
+// Find every vreg which is assigned a local's address (or an address
+// derived from one) anywhere in the function
+void MemoryPromotion::find_addr_vregs(){
+  bool changed = true;
+  while(changed){
+    changed = false;
+    for(auto i = m_hl_iseq->cbegin(); i != m_hl_iseq->cend(); ++i){
+      Instruction* ins = *i;
+      int opcode = ins->get_opcode();
+      if(!HighLevel::is_def(ins)){
+        continue;
+      }
+      bool is_addr = opcode == HINS_localaddr;
+      if(opcode == HINS_add_q || opcode == HINS_mov_q){
+        for(unsigned j = 1; j < ins->get_num_operands(); j++){
+          Operand op = ins->get_operand(j);
+          if(is_vreg(op) && m_addr_vregs.count(op.get_base_reg()) > 0){
+            is_addr = true;
+          }
+        }
+      }
+      if(is_addr && m_addr_vregs.insert(ins->get_operand(0).get_base_reg()).second){
+        changed = true;
+      }
+    }
+  }
+}
+
+// Follow the addresses through the code, recording the memory operands
+// which access locals and the objects whose address escapes. Returns
+// false if an address can't be followed.
+bool MemoryPromotion::find_accesses(){
+  std::map<int, Address> addrs;
+  std::map<int, long> constants;
+  std::set<int> defined;
+
+  for(unsigned i = 0; i < m_hl_iseq->get_length(); i++){
+    if(m_hl_iseq->has_label(i)){
+      addrs.clear();
+      constants.clear();
+      defined.clear();
+    }
+    Instruction* ins = m_hl_iseq->get_instruction(i);
+    int opcode = ins->get_opcode();
+    bool def = HighLevel::is_def(ins);
+
+    // an address vreg used here must have been assigned in the same
+    // straight-line code
+    for(unsigned j = 0; j < ins->get_num_operands(); j++){
+      Operand op = ins->get_operand(j);
+      if(j == 0 && def){
+        continue;
+      }
+      if(op.has_base_reg() && m_addr_vregs.count(op.get_base_reg()) > 0 && defined.count(op.get_base_reg()) == 0){
+        return false;
+      }
+      if(op.has_index_reg() && m_addr_vregs.count(op.get_index_reg()) > 0 && defined.count(op.get_index_reg()) == 0){
+        return false;
+      }
+    }
+
+    auto get_addr = [&](const Operand& op) -> Address*{
+      if(!is_vreg(op)){
+        return nullptr;
+      }
+      auto a = addrs.find(op.get_base_reg());
+      return (a == addrs.end()) ? nullptr : &a->second;
+    };
+
+    Address result;
+    bool defines_addr = false;
+    if(opcode == HINS_localaddr){
+      long offset = ins->get_operand(1).get_imm_ival();
+      result = { offset, offset, true };
+      defines_addr = true;
+    } else if(opcode == HINS_add_q && def && (get_addr(ins->get_operand(1)) != nullptr) != (get_addr(ins->get_operand(2)) != nullptr)){
+      // address plus an offset, in either order
+      bool addr_first = get_addr(ins->get_operand(1)) != nullptr;
+      Address base = *get_addr(ins->get_operand(addr_first ? 1 : 2));
+      Operand index = ins->get_operand(addr_first ? 2 : 1);
+      if(index.is_imm_ival() || is_vreg(index)){
+        result = base;
+        if(index.is_imm_ival()){
+          result.offset += index.get_imm_ival();
+        } else if(constants.count(index.get_base_reg()) > 0){
+          result.offset += constants[index.get_base_reg()];
+        } else{
+          result.known_offset = false;
+        }
+        defines_addr = true;
+      }
+    } else if(opcode == HINS_mov_q && def && ins->get_operand(0).get_base_reg() >= 10 && get_addr(ins->get_operand(1)) != nullptr){
+      result = *get_addr(ins->get_operand(1));
+      defines_addr = true;
+    }
+
+    if(!defines_addr){
+      for(unsigned j = 0; j < ins->get_num_operands(); j++){
+        Operand op = ins->get_operand(j);
+        if(op.get_kind() == Operand::FRAME_MEM_OFF){
+          long object = op.get_frame_slot();
+          add_access(i, j, { object, object + op.get_offset(), true }, get_access_size(ins, j));
+        } else if(op.is_memref()){
+          Address* base = op.has_base_reg() ? get_addr(Operand(Operand::VREG, op.get_base_reg())) : nullptr;
+          Address* index = op.has_index_reg() ? get_addr(Operand(Operand::VREG, op.get_index_reg())) : nullptr;
+          if(index != nullptr){
+            m_escaped.insert(index->object);
+          }
+          if(base != nullptr){
+            if(op.has_index_reg()){
+              m_escaped.insert(base->object);
+              continue;
+            }
+            Address addr = *base;
+            if(op.get_kind() == Operand::VREG_MEM_OFF){
+              addr.offset += op.get_offset();
+            }
+            add_access(i, j, addr, get_access_size(ins, j));
+          }
+        } else if(!(j == 0 && def) && get_addr(op) != nullptr){
+          // the address is used as a value
+          m_escaped.insert(get_addr(op)->object);
+        }
+      }
+    }
+
+    if(def){
+      int dest = ins->get_operand(0).get_base_reg();
+      defined.insert(dest);
+      addrs.erase(dest);
+      constants.erase(dest);
+      if(defines_addr){
+        addrs[dest] = result;
+        m_addr_defs[i] = result.object;
+      } else if(opcode == HINS_mov_q || opcode == HINS_mov_l){
+        Operand src = ins->get_operand(1);
+        if(src.is_imm_ival()){
+          constants[dest] = src.get_imm_ival();
+        }
+      }
+    }
+    if(opcode == HINS_call){
+      // the argument and return value vregs are clobbered
+      for(int vreg = 0; vreg < 10; vreg++){
+        addrs.erase(vreg);
+        constants.erase(vreg);
+      }
+    }
+    if(is_branch(opcode)){
+      addrs.clear();
+      constants.clear();
+      defined.clear();
+    }
+  }
+  return true;
+}
+
+void MemoryPromotion::add_access(unsigned index, unsigned operand, const Address& addr, int size){
+  if(!addr.known_offset){
+    m_escaped.insert(addr.object);
+    return;
+  }
+  Slot slot = { addr.object, addr.offset, size };
+  m_accesses[addr.object].push_back(slot);
+  m_memrefs[std::make_pair(index, operand)] = slot;
+}
+
+// An object can be promoted if its address doesn't escape and its
+// slots don't partially overlap
+bool MemoryPromotion::is_promotable(long object){
+  if(m_escaped.count(object) > 0){
+    return false;
+  }
+  const std::vector<Slot>& slots = m_accesses[object];
+  for(const Slot& a : slots){
+    for(const Slot& b : slots){
+      bool same = a.offset == b.offset && a.size == b.size;
+      bool disjoint = a.offset + a.size <= b.offset || b.offset + b.size <= a.offset;
+      if(!same && !disjoint){
+        return false;
+      }
+    }
+  }
+  return true;
+}
@@ -0,0 +1,66 @@
+#ifndef MEMORY_PROMOTION_H
+#define MEMORY_PROMOTION_H
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include "instruction_seq.h"
+
+// MemoryPromotion moves locals which LocalStorageAllocation put in
+// memory into vregs when their address doesn't escape (mem2reg, and
+// scalar replacement for struct fields and array elements accessed
+// at constant offsets).
+//
+// Each distinct localaddr offset (or frame memref slot) is taken to be
+// the start of one object; frame memrefs access it at a constant
+// offset. An address derived from a localaddr (by copying it or adding
+// a constant) may only be used as the base of memory operands; if it is
+// used any other way (stored, passed to a function, compared, indexed
+// by a non-constant...) the whole object stays in memory. If every
+// access to an object is at a constant offset, and accesses are either
+// identical in offset and size or don't overlap, each accessed slot
+// gets its own vreg, and the memory operands are replaced by it.
+//
+// Addresses are tracked within straight-line code only; if an address
+// vreg is used where its value comes from elsewhere, nothing is
+// promoted.
+class MemoryPromotion{
+private:
+  struct Address{
+    long object;        // localaddr offset the address was derived from
+    long offset;        // offset from the start of the frame
+    bool known_offset;
+  };
+
+  struct Slot{
+    long object;
+    long offset;
+    int size;
+    bool operator<(const Slot& other) const;
+  };
+
+  std::shared_ptr<InstructionSequence> m_hl_iseq;
+  std::set<int> m_addr_vregs;
+  std::set<long> m_escaped;
+  std::map<long, std::vector<Slot>> m_accesses;
+  // (instruction index, operand index) -> slot accessed by that memory operand
+  std::map<std::pair<unsigned, unsigned>, Slot> m_memrefs;
+  // instruction index -> object whose address (or derived address) it computes
+  std::map<unsigned, long> m_addr_defs;
+
+public:
+  MemoryPromotion(const std::shared_ptr<InstructionSequence>& hl_iseq);
+  ~MemoryPromotion();
+
+  std::shared_ptr<InstructionSequence> transform();
+
+private:
+  void find_addr_vregs();
+  bool find_accesses();
+  void add_access(unsigned index, unsigned operand, const Address& addr, int size);
+  bool is_promotable(long object);
+};
+
+#endif // MEMORY_PROMOTION_H
@@ -19,13 +19,20 @@
 // OTHER DEALINGS IN THE SOFTWARE.
 
 #include "node.h"
+#include "source_buffer.h"
+#include "phase_timer.h"
 
 // Private constructor, used only by other constructors
 Node::Node(int tag, const std::string &str, const std::vector<Node *> &kids)
   : m_tag(tag)
   , m_kids(kids)
   , m_str(str)
+  , m_src(nullptr)
+  , m_offset(0)
+  , m_len(0)
+  , m_lexeme(nullptr)
   , m_loc_was_set_explicitly(false) {
+  PhaseTimer::count(CountedObject::NODE);
 }
 
 // Private constructor, used only by other constructors
@@ -33,7 +40,12 @@ Node::Node(int tag, const std::string &str, const std::initializer_list<Node *>
   : m_tag(tag)
   , m_kids(kids)
   , m_str(str)
+  , m_src(nullptr)
+  , m_offset(0)
+  , m_len(0)
+  , m_lexeme(nullptr)
   , m_loc_was_set_explicitly(false) {
+  PhaseTimer::count(CountedObject::NODE);
 }
 
 Node::Node(int tag)
@@ -60,6 +72,13 @@ Node::Node(int tag, const std::string &str)
   : Node(tag, str, {}) {
 }
 
+Node::Node(int tag, SourceBuffer *src, unsigned offset, unsigned len)
+  : Node(tag, "", {}) {
+  m_src = src;
+  m_offset = offset;
+  m_len = len;
+}
+
 Node::~Node() {
   // delete child nodes
   for (auto i = m_kids.begin(); i != m_kids.end(); ++i) {
@@ -94,3 +113,10 @@ void Node::shift_kid() {
     m_loc_was_set_explicitly = false;
   }
 }
+
+const std::string &Node::get_lexeme() const {
+  if (m_lexeme == nullptr) {
+    m_lexeme = &m_src->intern(m_offset, m_len);
+  }
+  return *m_lexeme;
+}
@@ -25,6 +25,7 @@
 #include <string>
 #include "location.h"
 #include "node_base.h"
+class SourceBuffer;
 
 // Tree node class, suitable for parse trees and ASTs.
 // Nodes can also be used as tokens returned by a lexer.
@@ -37,6 +38,11 @@ private:
   int m_tag;
   std::vector<Node *> m_kids;
   std::string m_str;
+  // a token's lexeme is a view into the source buffer until
+  // get_str() is called, at which point it is interned
+  SourceBuffer *m_src;
+  unsigned m_offset, m_len;
+  mutable const std::string *m_lexeme;
   Location m_loc;
   bool m_loc_was_set_explicitly;
 
@@ -54,14 +60,15 @@ public:
   Node(int tag, std::initializer_list<Node *> kids);
   Node(int tag, const std::vector<Node *> &kids);
   Node(int tag, const std::string &str);
+  Node(int tag, SourceBuffer *src, unsigned offset, unsigned len);
 
   virtual ~Node();
 
   int get_tag() const { return m_tag; }
   void set_tag(int tag) { m_tag = tag; }
 
-  std::string get_str() const { return m_str; }
-  void set_str(const std::string &str) { m_str = str; }
+  const std::string &get_str() const { return m_src != nullptr ? get_lexeme() : m_str; }
+  void set_str(const std::string &str) { m_str = str; m_src = nullptr; }
 
   void append_kid(Node *kid);
   void prepend_kid(Node *kid);
@@ -97,6 +104,9 @@ public:
       fn(*i);
     }
   }
+
+private:
+  const std::string &get_lexeme() const;
 };
 
 #endif // NODE_H
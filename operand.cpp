@@ -15,6 +15,7 @@ namespace{
     MEMREF = (1 << 6),  // memory reference
     HAS_INDEX = (1 << 7),  // has index register
     HAS_OFFSET = (1 << 8),  // memory reference with imm offset
+    HAS_LABEL = (1 << 9),  // memory reference with a label as its address
   };
 
   struct OperandProperties{
@@ -28,7 +29,7 @@ namespace{
     bool is_non_reg() const{ return is_imm_ival() || is_label() || is_imm_label(); }
     bool is_memref() const{ return (flags & MEMREF) != 0; }
     bool has_imm_ival() const{ return is_imm_ival() || has_offset(); }
-    bool has_label() const{ return is_label() || is_imm_label(); }
+    bool has_label() const{ return is_label() || is_imm_label() || (flags & HAS_LABEL) != 0; }
   };
 
   const std::map<Operand::Kind, OperandProperties> s_operand_props = {
@@ -40,6 +41,7 @@ namespace{
     { Operand::VREG_MEM,         {.flags = HL | MEMREF } },
     { Operand::VREG_MEM_IDX,     {.flags = HL | MEMREF | HAS_INDEX } },
     { Operand::VREG_MEM_OFF,     {.flags = HL | MEMREF | HAS_OFFSET } },
+    { Operand::FRAME_MEM_OFF,    {.flags = HL | MEMREF | HAS_OFFSET } },
     { Operand::MREG8,            {.flags = LL } },
     { Operand::MREG16,           {.flags = LL } },
     { Operand::MREG32,           {.flags = LL } },
@@ -47,6 +49,8 @@ namespace{
     { Operand::MREG64_MEM,       {.flags = LL | MEMREF } },
     { Operand::MREG64_MEM_IDX,   {.flags = LL | MEMREF | HAS_INDEX } },
     { Operand::MREG64_MEM_OFF,   {.flags = LL | MEMREF | HAS_OFFSET } },
+    { Operand::MREG128,          {.flags = LL } },
+    { Operand::LABEL_MEM_IDX,    {.flags = LL | MEMREF | HAS_INDEX | HAS_LABEL } },
     { Operand::IMM_IVAL,         {.flags = HL | LL | IMM_IVAL } },
     { Operand::LABEL,            {.flags = HL | LL | LABEL } },
     { Operand::IMM_LABEL,        {.flags = HL | LL | IMM_LABEL } },
@@ -64,7 +68,9 @@ Operand::Operand(Kind kind)
   : m_kind(kind)
   , m_basereg(-1)
   , m_index_reg(-1)
-  , m_imm_ival(-1){
+  , m_scale(1)
+  , m_imm_ival(-1)
+  , m_frame_slot(-1){
 }
 
 // ival1 is either basereg or imm_ival (depending on operand Kind)
@@ -85,9 +91,16 @@ Operand::Operand(Kind kind, int basereg, long ival2)
   : m_kind(kind)
   , m_basereg(basereg)
   , m_index_reg(-1)
-  , m_imm_ival(-1){
+  , m_scale(1)
+  , m_imm_ival(-1)
+  , m_frame_slot(-1){
   const OperandProperties& props = oprops(kind);
-  if(props.has_index_reg()){
+  if(kind == Operand::FRAME_MEM_OFF){
+    // a frame memref has no base register, just the slot
+    m_basereg = -1;
+    m_frame_slot = basereg;
+    m_imm_ival = ival2;
+  } else if(props.has_index_reg()){
     m_index_reg = int(ival2);
   } else if(props.has_imm_ival() || props.has_offset()){
     m_imm_ival = ival2;
@@ -96,6 +109,18 @@ Operand::Operand(Kind kind, int basereg, long ival2)
   }
 }
 
+// for memrefs with a scaled index register
+Operand::Operand(Kind kind, int basereg, int index_reg, int scale)
+  : m_kind(kind)
+  , m_basereg(basereg)
+  , m_index_reg(index_reg)
+  , m_scale(scale)
+  , m_imm_ival(-1)
+  , m_frame_slot(-1){
+  assert(oprops(kind).has_index_reg());
+  assert(scale == 1 || scale == 2 || scale == 4 || scale == 8);
+}
+
 // for label or immediate label operands
 Operand::Operand(Kind kind, const std::string& label)
   : Operand(kind){
@@ -104,6 +129,16 @@ Operand::Operand(Kind kind, const std::string& label)
   m_label = label;
 }
 
+// for memrefs addressing a label with a scaled index register
+Operand::Operand(Kind kind, const std::string& label, int index_reg, int scale)
+  : Operand(kind){
+  assert(oprops(kind).has_label() && oprops(kind).has_index_reg());
+  assert(scale == 1 || scale == 2 || scale == 4 || scale == 8);
+  m_index_reg = index_reg;
+  m_scale = scale;
+  m_label = label;
+}
+
 Operand::~Operand(){
 }
 
@@ -171,6 +206,16 @@ long Operand::get_offset() const{
   return m_imm_ival;
 }
 
+int Operand::get_scale() const{
+  assert(oprops(m_kind).has_index_reg());
+  return m_scale;
+}
+
+long Operand::get_frame_slot() const{
+  assert(m_kind == Operand::FRAME_MEM_OFF);
+  return m_frame_slot;
+}
+
 Operand Operand::to_memref() const{
   assert(m_kind == Operand::VREG || m_kind == Operand::MREG64);
   Operand dup = *this;
@@ -178,7 +223,7 @@ Operand Operand::to_memref() const{
   return dup;
 }
 
-std::string Operand::get_label() const{
-  assert(m_kind == Operand::LABEL || m_kind == Operand::IMM_LABEL);
+const std::string& Operand::get_label() const{
+  assert(oprops(m_kind).has_label());
   return m_label;
 }
@@ -18,16 +18,19 @@ public:
 
                      VREG,            // just a vreg                       vr0
                      VREG_MEM,        // memref using vreg ptr             (vr0)
-                     VREG_MEM_IDX,    // memref using vreg ptr+index       (vr0, vr1)
+                     VREG_MEM_IDX,    // memref using vreg ptr+index*scale (vr0, vr1)
                      VREG_MEM_OFF,    // memref using vreg ptr+imm offset  8(vr0q)
+                     FRAME_MEM_OFF,   // memref to a local+imm offset      8(local16)
 
                      MREG8,           // just an mreg                      %al
                      MREG16,          // just an mreg                      %ax
                      MREG32,          // just an mreg                      %eax
                      MREG64,          // just an mreg                      %rax
                      MREG64_MEM,      // memref using mreg ptr             (%rax)
-                     MREG64_MEM_IDX,  // memref using mreg ptr+index       (%rax,%rsi)
+                     MREG64_MEM_IDX,  // memref using mreg ptr+index*scale (%rax,%rsi,4)
                      MREG64_MEM_OFF,  // memref using mreg ptr+imm offset  8(%rax)
+                     MREG128,         // just an xmm register              %xmm0
+                     LABEL_MEM_IDX,   // memref using label+index*scale    .L5(,%rax,8)
 
                      IMM_IVAL,        // immediate 8-bit signed int        $1
 
@@ -37,7 +40,9 @@ public:
 private:
   Kind m_kind;
   int m_basereg, m_index_reg;
+  int m_scale;
   long m_imm_ival;
+  long m_frame_slot;
   std::string m_label;
 
 public:
@@ -46,12 +51,20 @@ public:
   // ival1 is either basereg or imm_ival (depending on operand Kind)
   Operand(Kind kind, long ival1);
 
-  // ival2 is either index_reg or imm_ival (depending on operand kind)
+  // ival2 is either index_reg or imm_ival (depending on operand kind);
+  // for FRAME_MEM_OFF, basereg is the local's offset in local storage
+  // (its slot) and ival2 is the offset within it
   Operand(Kind kind, int basereg, long ival2);
 
+  // for memrefs with a scaled index register (scale is 1, 2, 4, or 8)
+  Operand(Kind kind, int basereg, int index_reg, int scale);
+
   // for label or immediate label operands
   Operand(Kind kind, const std::string& label);
 
+  // for memrefs addressing a label with a scaled index register
+  Operand(Kind kind, const std::string& label, int index_reg, int scale);
+
   ~Operand();
 
   // use compiler-generated copy ctor and assignment op
@@ -89,7 +102,8 @@ public:
   bool has_imm_ival() const;
 
   // Does the operand have a label?
-  // (Either because it is a label, or is an immediate label.)
+  // (Either because it is a label, is an immediate label, or is
+  // a memref addressing a label.)
   bool has_label() const;
 
   // getters
@@ -97,10 +111,12 @@ public:
   int get_index_reg() const;
   long get_imm_ival() const;
   long get_offset() const;
+  int get_scale() const;
+  long get_frame_slot() const;
 
   Operand to_memref() const;
 
-  std::string get_label() const;
+  const std::string& get_label() const;
 };
 
 #endif // OPERAND_H
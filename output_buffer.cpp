@@ -0,0 +1,42 @@
+#include <charconv>
+#include "exceptions.h"
+#include "output_buffer.h"
+
+OutputBuffer::OutputBuffer(FILE *out)
+  : m_out(out)
+  , m_len(0) {
+}
+
+OutputBuffer::~OutputBuffer() {
+  // can't throw from here, so a failed write isn't reported
+  fwrite(m_buf, 1, m_len, m_out);
+}
+
+void OutputBuffer::append_int(long val) {
+  // 20 digits and a sign are enough for any 64 bit value
+  if (BUFFER_SIZE - m_len < 21) {
+    flush();
+  }
+  std::to_chars_result res = std::to_chars(m_buf + m_len, m_buf + BUFFER_SIZE, val);
+  m_len = res.ptr - m_buf;
+}
+
+void OutputBuffer::flush() {
+  if (m_len > 0 && fwrite(m_buf, 1, m_len, m_out) != m_len) {
+    RuntimeError::raise("error writing output");
+  }
+  m_len = 0;
+}
+
+void OutputBuffer::append_slow(const char *s, size_t len) {
+  flush();
+  if (len >= BUFFER_SIZE) {
+    // too big to buffer, write it directly
+    if (fwrite(s, 1, len, m_out) != len) {
+      RuntimeError::raise("error writing output");
+    }
+    return;
+  }
+  memcpy(m_buf, s, len);
+  m_len = len;
+}
@@ -0,0 +1,57 @@
+#ifndef OUTPUT_BUFFER_H
+#define OUTPUT_BUFFER_H
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+// OutputBuffer collects generated text in a fixed-size buffer and
+// writes it to a FILE with a single fwrite whenever the buffer fills
+// up (and when it is flushed or destroyed). The append functions don't
+// allocate, so code can be emitted without building a temporary
+// std::string for each line.
+class OutputBuffer {
+private:
+  static const size_t BUFFER_SIZE = 1 << 16;
+
+  FILE *m_out;
+  size_t m_len;
+  char m_buf[BUFFER_SIZE];
+
+  // value semantics are not allowed
+  OutputBuffer(const OutputBuffer &);
+  OutputBuffer &operator=(const OutputBuffer &);
+
+public:
+  OutputBuffer(FILE *out);
+  ~OutputBuffer();
+
+  void append(const char *s, size_t len) {
+    if (len > BUFFER_SIZE - m_len) {
+      append_slow(s, len);
+      return;
+    }
+    memcpy(m_buf + m_len, s, len);
+    m_len += len;
+  }
+
+  void append(const char *s) { append(s, strlen(s)); }
+  void append(const std::string &s) { append(s.data(), s.size()); }
+
+  void append(char c) {
+    if (m_len == BUFFER_SIZE) {
+      flush();
+    }
+    m_buf[m_len++] = c;
+  }
+
+  // append a signed integer in decimal
+  void append_int(long val);
+
+  void flush();
+
+private:
+  void append_slow(const char *s, size_t len);
+};
+
+#endif // OUTPUT_BUFFER_H
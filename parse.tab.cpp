@@ -203,73 +203,74 @@ enum yysymbol_kind_t
   YYSYMBOL_TOK_DO = 52,                    /* TOK_DO  */
   YYSYMBOL_TOK_SWITCH = 53,                /* TOK_SWITCH  */
   YYSYMBOL_TOK_CASE = 54,                  /* TOK_CASE  */
-  YYSYMBOL_TOK_CHAR = 55,                  /* TOK_CHAR  */
-  YYSYMBOL_TOK_SHORT = 56,                 /* TOK_SHORT  */
-  YYSYMBOL_TOK_INT = 57,                   /* TOK_INT  */
-  YYSYMBOL_TOK_LONG = 58,                  /* TOK_LONG  */
-  YYSYMBOL_TOK_UNSIGNED = 59,              /* TOK_UNSIGNED  */
-  YYSYMBOL_TOK_SIGNED = 60,                /* TOK_SIGNED  */
-  YYSYMBOL_TOK_FLOAT = 61,                 /* TOK_FLOAT  */
-  YYSYMBOL_TOK_DOUBLE = 62,                /* TOK_DOUBLE  */
-  YYSYMBOL_TOK_VOID = 63,                  /* TOK_VOID  */
-  YYSYMBOL_TOK_RETURN = 64,                /* TOK_RETURN  */
-  YYSYMBOL_TOK_BREAK = 65,                 /* TOK_BREAK  */
-  YYSYMBOL_TOK_CONTINUE = 66,              /* TOK_CONTINUE  */
-  YYSYMBOL_TOK_CONST = 67,                 /* TOK_CONST  */
-  YYSYMBOL_TOK_VOLATILE = 68,              /* TOK_VOLATILE  */
-  YYSYMBOL_TOK_STRUCT = 69,                /* TOK_STRUCT  */
-  YYSYMBOL_TOK_UNION = 70,                 /* TOK_UNION  */
-  YYSYMBOL_TOK_UNSPECIFIED_STORAGE = 71,   /* TOK_UNSPECIFIED_STORAGE  */
-  YYSYMBOL_TOK_STATIC = 72,                /* TOK_STATIC  */
-  YYSYMBOL_TOK_EXTERN = 73,                /* TOK_EXTERN  */
-  YYSYMBOL_TOK_AUTO = 74,                  /* TOK_AUTO  */
-  YYSYMBOL_TOK_IDENT = 75,                 /* TOK_IDENT  */
-  YYSYMBOL_TOK_STR_LIT = 76,               /* TOK_STR_LIT  */
-  YYSYMBOL_TOK_CHAR_LIT = 77,              /* TOK_CHAR_LIT  */
-  YYSYMBOL_TOK_INT_LIT = 78,               /* TOK_INT_LIT  */
-  YYSYMBOL_TOK_FP_LIT = 79,                /* TOK_FP_LIT  */
-  YYSYMBOL_YYACCEPT = 80,                  /* $accept  */
-  YYSYMBOL_unit = 81,                      /* unit  */
-  YYSYMBOL_top_level_declaration = 82,     /* top_level_declaration  */
-  YYSYMBOL_function_or_variable_declaration_or_definition = 83, /* function_or_variable_declaration_or_definition  */
-  YYSYMBOL_simple_variable_declaration = 84, /* simple_variable_declaration  */
-  YYSYMBOL_declarator_list = 85,           /* declarator_list  */
-  YYSYMBOL_declarator = 86,                /* declarator  */
-  YYSYMBOL_non_pointer_declarator = 87,    /* non_pointer_declarator  */
-  YYSYMBOL_function_definition_or_declaration = 88, /* function_definition_or_declaration  */
-  YYSYMBOL_function_parameter_list = 89,   /* function_parameter_list  */
-  YYSYMBOL_opt_parameter_list = 90,        /* opt_parameter_list  */
-  YYSYMBOL_parameter_list = 91,            /* parameter_list  */
-  YYSYMBOL_parameter = 92,                 /* parameter  */
-  YYSYMBOL_type = 93,                      /* type  */
-  YYSYMBOL_basic_type = 94,                /* basic_type  */
-  YYSYMBOL_basic_type_keyword = 95,        /* basic_type_keyword  */
-  YYSYMBOL_opt_statement_list = 96,        /* opt_statement_list  */
-  YYSYMBOL_statement_list = 97,            /* statement_list  */
-  YYSYMBOL_statement = 98,                 /* statement  */
-  YYSYMBOL_struct_type_definition = 99,    /* struct_type_definition  */
-  YYSYMBOL_union_type_definition = 100,    /* union_type_definition  */
-  YYSYMBOL_opt_simple_variable_declaration_list = 101, /* opt_simple_variable_declaration_list  */
-  YYSYMBOL_simple_variable_declaration_list = 102, /* simple_variable_declaration_list  */
-  YYSYMBOL_assignment_expression = 103,    /* assignment_expression  */
-  YYSYMBOL_assignment_op = 104,            /* assignment_op  */
-  YYSYMBOL_conditional_expression = 105,   /* conditional_expression  */
-  YYSYMBOL_logical_or_expression = 106,    /* logical_or_expression  */
-  YYSYMBOL_logical_and_expression = 107,   /* logical_and_expression  */
-  YYSYMBOL_bitwise_or_expression = 108,    /* bitwise_or_expression  */
-  YYSYMBOL_bitwise_xor_expression = 109,   /* bitwise_xor_expression  */
-  YYSYMBOL_bitwise_and_expression = 110,   /* bitwise_and_expression  */
-  YYSYMBOL_equality_expression = 111,      /* equality_expression  */
-  YYSYMBOL_relational_expression = 112,    /* relational_expression  */
-  YYSYMBOL_relational_op = 113,            /* relational_op  */
-  YYSYMBOL_shift_expression = 114,         /* shift_expression  */
-  YYSYMBOL_additive_expression = 115,      /* additive_expression  */
-  YYSYMBOL_multiplicative_expression = 116, /* multiplicative_expression  */
-  YYSYMBOL_cast_expression = 117,          /* cast_expression  */
-  YYSYMBOL_unary_expression = 118,         /* unary_expression  */
-  YYSYMBOL_postfix_expression = 119,       /* postfix_expression  */
-  YYSYMBOL_argument_expression_list = 120, /* argument_expression_list  */
-  YYSYMBOL_primary_expression = 121        /* primary_expression  */
+  YYSYMBOL_TOK_DEFAULT = 55,               /* TOK_DEFAULT  */
+  YYSYMBOL_TOK_CHAR = 56,                  /* TOK_CHAR  */
+  YYSYMBOL_TOK_SHORT = 57,                 /* TOK_SHORT  */
+  YYSYMBOL_TOK_INT = 58,                   /* TOK_INT  */
+  YYSYMBOL_TOK_LONG = 59,                  /* TOK_LONG  */
+  YYSYMBOL_TOK_UNSIGNED = 60,              /* TOK_UNSIGNED  */
+  YYSYMBOL_TOK_SIGNED = 61,                /* TOK_SIGNED  */
+  YYSYMBOL_TOK_FLOAT = 62,                 /* TOK_FLOAT  */
+  YYSYMBOL_TOK_DOUBLE = 63,                /* TOK_DOUBLE  */
+  YYSYMBOL_TOK_VOID = 64,                  /* TOK_VOID  */
+  YYSYMBOL_TOK_RETURN = 65,                /* TOK_RETURN  */
+  YYSYMBOL_TOK_BREAK = 66,                 /* TOK_BREAK  */
+  YYSYMBOL_TOK_CONTINUE = 67,              /* TOK_CONTINUE  */
+  YYSYMBOL_TOK_CONST = 68,                 /* TOK_CONST  */
+  YYSYMBOL_TOK_VOLATILE = 69,              /* TOK_VOLATILE  */
+  YYSYMBOL_TOK_STRUCT = 70,                /* TOK_STRUCT  */
+  YYSYMBOL_TOK_UNION = 71,                 /* TOK_UNION  */
+  YYSYMBOL_TOK_UNSPECIFIED_STORAGE = 72,   /* TOK_UNSPECIFIED_STORAGE  */
+  YYSYMBOL_TOK_STATIC = 73,                /* TOK_STATIC  */
+  YYSYMBOL_TOK_EXTERN = 74,                /* TOK_EXTERN  */
+  YYSYMBOL_TOK_AUTO = 75,                  /* TOK_AUTO  */
+  YYSYMBOL_TOK_IDENT = 76,                 /* TOK_IDENT  */
+  YYSYMBOL_TOK_STR_LIT = 77,               /* TOK_STR_LIT  */
+  YYSYMBOL_TOK_CHAR_LIT = 78,              /* TOK_CHAR_LIT  */
+  YYSYMBOL_TOK_INT_LIT = 79,               /* TOK_INT_LIT  */
+  YYSYMBOL_TOK_FP_LIT = 80,                /* TOK_FP_LIT  */
+  YYSYMBOL_YYACCEPT = 81,                  /* $accept  */
+  YYSYMBOL_unit = 82,                      /* unit  */
+  YYSYMBOL_top_level_declaration = 83,     /* top_level_declaration  */
+  YYSYMBOL_function_or_variable_declaration_or_definition = 84, /* function_or_variable_declaration_or_definition  */
+  YYSYMBOL_simple_variable_declaration = 85, /* simple_variable_declaration  */
+  YYSYMBOL_declarator_list = 86,           /* declarator_list  */
+  YYSYMBOL_declarator = 87,                /* declarator  */
+  YYSYMBOL_non_pointer_declarator = 88,    /* non_pointer_declarator  */
+  YYSYMBOL_function_definition_or_declaration = 89, /* function_definition_or_declaration  */
+  YYSYMBOL_function_parameter_list = 90,   /* function_parameter_list  */
+  YYSYMBOL_opt_parameter_list = 91,        /* opt_parameter_list  */
+  YYSYMBOL_parameter_list = 92,            /* parameter_list  */
+  YYSYMBOL_parameter = 93,                 /* parameter  */
+  YYSYMBOL_type = 94,                      /* type  */
+  YYSYMBOL_basic_type = 95,                /* basic_type  */
+  YYSYMBOL_basic_type_keyword = 96,        /* basic_type_keyword  */
+  YYSYMBOL_opt_statement_list = 97,        /* opt_statement_list  */
+  YYSYMBOL_statement_list = 98,            /* statement_list  */
+  YYSYMBOL_statement = 99,                 /* statement  */
+  YYSYMBOL_struct_type_definition = 100,   /* struct_type_definition  */
+  YYSYMBOL_union_type_definition = 101,    /* union_type_definition  */
+  YYSYMBOL_opt_simple_variable_declaration_list = 102, /* opt_simple_variable_declaration_list  */
+  YYSYMBOL_simple_variable_declaration_list = 103, /* simple_variable_declaration_list  */
+  YYSYMBOL_assignment_expression = 104,    /* assignment_expression  */
+  YYSYMBOL_assignment_op = 105,            /* assignment_op  */
+  YYSYMBOL_conditional_expression = 106,   /* conditional_expression  */
+  YYSYMBOL_logical_or_expression = 107,    /* logical_or_expression  */
+  YYSYMBOL_logical_and_expression = 108,   /* logical_and_expression  */
+  YYSYMBOL_bitwise_or_expression = 109,    /* bitwise_or_expression  */
+  YYSYMBOL_bitwise_xor_expression = 110,   /* bitwise_xor_expression  */
+  YYSYMBOL_bitwise_and_expression = 111,   /* bitwise_and_expression  */
+  YYSYMBOL_equality_expression = 112,      /* equality_expression  */
+  YYSYMBOL_relational_expression = 113,    /* relational_expression  */
+  YYSYMBOL_relational_op = 114,            /* relational_op  */
+  YYSYMBOL_shift_expression = 115,         /* shift_expression  */
+  YYSYMBOL_additive_expression = 116,      /* additive_expression  */
+  YYSYMBOL_multiplicative_expression = 117, /* multiplicative_expression  */
+  YYSYMBOL_cast_expression = 118,          /* cast_expression  */
+  YYSYMBOL_unary_expression = 119,         /* unary_expression  */
+  YYSYMBOL_postfix_expression = 120,       /* postfix_expression  */
+  YYSYMBOL_argument_expression_list = 121, /* argument_expression_list  */
+  YYSYMBOL_primary_expression = 122        /* primary_expression  */
 };
 typedef enum yysymbol_kind_t yysymbol_kind_t;
 
@@ -597,19 +598,19 @@ union yyalloc
 /* YYFINAL -- State number of the termination state.  */
 #define YYFINAL  32
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   440
+#define YYLAST   415
 
 /* YYNTOKENS -- Number of terminals.  */
-#define YYNTOKENS  80
+#define YYNTOKENS  81
 /* YYNNTS -- Number of nonterminals.  */
 #define YYNNTS  42
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  136
+#define YYNRULES  140
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES  234
+#define YYNSTATES  248
 
 /* YYMAXUTOK -- Last valid token kind.  */
-#define YYMAXUTOK   334
+#define YYMAXUTOK   335
 
 
 /* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
@@ -656,7 +657,7 @@ static const yytype_int8 yytranslate[] =
       45,    46,    47,    48,    49,    50,    51,    52,    53,    54,
       55,    56,    57,    58,    59,    60,    61,    62,    63,    64,
       65,    66,    67,    68,    69,    70,    71,    72,    73,    74,
-      75,    76,    77,    78,    79
+      75,    76,    77,    78,    79,    80
 };
 
 #if YYDEBUG
@@ -669,14 +670,15 @@ static const yytype_int16 yyrline[] =
      248,   250,   255,   257,   259,   261,   263,   265,   267,   269,
      271,   273,   275,   280,   283,   287,   289,   294,   296,   298,
      300,   302,   304,   306,   308,   310,   312,   319,   323,   325,
-     330,   335,   340,   343,   347,   349,   368,   370,   375,   377,
-     379,   381,   383,   385,   387,   389,   391,   393,   395,   400,
-     402,   407,   409,   414,   416,   421,   423,   428,   430,   435,
-     437,   442,   444,   446,   451,   453,   458,   460,   462,   464,
-     469,   471,   473,   478,   480,   482,   487,   489,   491,   493,
-     498,   500,   505,   507,   509,   511,   513,   515,   517,   519,
-     521,   534,   536,   538,   540,   542,   544,   546,   548,   553,
-     555,   560,   562,   564,   566,   568,   570
+     327,   329,   331,   333,   338,   343,   348,   351,   355,   357,
+     376,   378,   383,   385,   387,   389,   391,   393,   395,   397,
+     399,   401,   403,   408,   410,   415,   417,   422,   424,   429,
+     431,   436,   438,   443,   445,   450,   452,   454,   459,   461,
+     466,   468,   470,   472,   477,   479,   481,   486,   488,   490,
+     495,   497,   499,   501,   506,   508,   513,   515,   517,   519,
+     521,   523,   525,   527,   529,   542,   544,   546,   548,   550,
+     552,   554,   556,   561,   563,   568,   570,   572,   574,   576,
+     578
 };
 #endif
 
@@ -704,10 +706,10 @@ static const char *const yytname[] =
   "TOK_DIV_ASSIGN", "TOK_MOD_ASSIGN", "TOK_ADD_ASSIGN", "TOK_SUB_ASSIGN",
   "TOK_LEFT_ASSIGN", "TOK_RIGHT_ASSIGN", "TOK_AND_ASSIGN",
   "TOK_XOR_ASSIGN", "TOK_OR_ASSIGN", "TOK_IF", "TOK_ELSE", "TOK_WHILE",
-  "TOK_FOR", "TOK_DO", "TOK_SWITCH", "TOK_CASE", "TOK_CHAR", "TOK_SHORT",
-  "TOK_INT", "TOK_LONG", "TOK_UNSIGNED", "TOK_SIGNED", "TOK_FLOAT",
-  "TOK_DOUBLE", "TOK_VOID", "TOK_RETURN", "TOK_BREAK", "TOK_CONTINUE",
-  "TOK_CONST", "TOK_VOLATILE", "TOK_STRUCT", "TOK_UNION",
+  "TOK_FOR", "TOK_DO", "TOK_SWITCH", "TOK_CASE", "TOK_DEFAULT", "TOK_CHAR",
+  "TOK_SHORT", "TOK_INT", "TOK_LONG", "TOK_UNSIGNED", "TOK_SIGNED",
+  "TOK_FLOAT", "TOK_DOUBLE", "TOK_VOID", "TOK_RETURN", "TOK_BREAK",
+  "TOK_CONTINUE", "TOK_CONST", "TOK_VOLATILE", "TOK_STRUCT", "TOK_UNION",
   "TOK_UNSPECIFIED_STORAGE", "TOK_STATIC", "TOK_EXTERN", "TOK_AUTO",
   "TOK_IDENT", "TOK_STR_LIT", "TOK_CHAR_LIT", "TOK_INT_LIT", "TOK_FP_LIT",
   "$accept", "unit", "top_level_declaration",
@@ -750,30 +752,31 @@ yysymbol_name (yysymbol_kind_t yysymbol)
    STATE-NUM.  */
 static const yytype_int16 yypact[] =
 {
-     337,   -93,   -93,   -93,   -93,   -93,   -93,   -93,   -93,   -93,
-     -93,   -93,   -72,   -48,   297,   297,    35,   337,   -93,   -93,
-     -93,     2,   -93,   372,   -93,   -93,    33,    37,   -33,   -29,
-     -93,   -93,   -93,   -93,     3,    62,    57,    78,    63,   -93,
-     297,   297,   -93,   -93,   -93,   -93,   356,   -93,     3,    12,
-     297,     3,    83,   -93,    84,    89,    93,   -93,   -93,    91,
-       3,   -93,    95,   -93,    96,    97,    23,   297,   -93,   -93,
-     -93,   -93,   142,   -93,   -93,   210,   142,   -93,   294,   294,
-     312,   294,   312,   312,   312,   294,   101,   105,   109,   142,
-     100,   297,   297,   -93,   -93,   -93,   -93,   -93,   -93,   113,
-     -93,   142,   104,   -93,    -9,   112,    98,   121,   124,   -14,
-      17,    20,    21,     4,   -93,    90,    26,   -93,   144,   146,
-     145,   -93,   -93,   -93,   294,   -93,   -93,   -93,   -93,   -93,
-     -93,   294,   294,   294,   107,   -93,   154,   -93,   -93,   -93,
-     -93,   -93,   294,   294,   294,   294,   294,   294,   294,   294,
-     -93,   -93,   -93,   -93,   294,   294,   294,   294,   294,   294,
-     294,   294,   -93,   -93,   -93,   -93,   -93,   -93,   -93,   -93,
-     -93,   -93,   -93,   294,   228,   294,    79,    80,   -93,   -93,
-     294,   -93,   -93,   160,   162,   158,   166,   -93,   161,   112,
-      98,   121,   124,   -14,    17,    17,    20,    21,    21,     4,
-       4,   -93,   -93,   -93,   -93,   -93,   159,   168,   167,   -93,
-     -93,   -93,   142,   142,   294,   294,   294,   294,   -93,   -93,
-     125,   -93,   171,   177,   -93,   -93,   142,   294,   173,   -93,
-     179,   -93,   142,   -93
+     278,   -93,   -93,   -93,   -93,   -93,   -93,   -93,   -93,   -93,
+     -93,   -93,   -52,   -24,   307,   307,     4,   278,   -93,   -93,
+     -93,   -17,   -93,   346,   -93,   -93,    48,    51,   -13,    10,
+     -93,   -93,   -93,   -93,     0,    62,    78,    77,    84,   -93,
+     307,   307,   -93,   -93,   -93,   -93,   330,   -93,     0,    31,
+     307,     0,   105,   -93,   106,   113,   114,   -93,   -93,   108,
+       0,   -93,   116,   -93,   111,   118,    25,   307,   -93,   -93,
+     -93,   -93,   151,   -93,   -93,   220,   151,   -93,   238,   238,
+     305,   238,   305,   305,   305,   238,   120,   122,   130,   151,
+     131,   238,   132,   112,   134,   307,   307,   -93,   -93,   -93,
+     -93,   -93,   -93,   133,   -93,   151,   135,   -93,    -8,   117,
+     121,   123,   124,    12,    34,    23,    19,     7,   -93,   228,
+     181,   -93,   145,   148,   153,   -93,   -93,   -93,   238,   -93,
+     -93,   -93,   -93,   -93,   -93,   238,   238,   238,   125,   238,
+     146,   151,   -93,   154,   -93,   -93,   -93,   -93,   -93,   -93,
+     238,   238,   238,   238,   238,   238,   238,   238,   -93,   -93,
+     -93,   -93,   238,   238,   238,   238,   238,   238,   238,   238,
+     -93,   -93,   -93,   -93,   -93,   -93,   -93,   -93,   -93,   -93,
+     -93,   238,    22,   238,    86,    88,   -93,   -93,   238,   -93,
+     -93,   168,   169,   167,   175,   176,   151,   -93,   -93,   171,
+     117,   121,   123,   124,    12,    34,    34,    23,    19,    19,
+       7,     7,   -93,   -93,   -93,   -93,   -93,   172,   178,   173,
+     -93,   -93,   -93,   151,   151,   238,   238,   151,   -93,   238,
+     238,   -93,   -93,   136,   -93,   185,   183,   -93,   -93,   -93,
+     151,   238,   186,   -93,   193,   -93,   151,   -93
 };
 
 /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
@@ -785,46 +788,47 @@ static const yytype_uint8 yydefact[] =
       41,    42,     0,     0,     0,     0,     0,     2,     4,    10,
        9,     0,    27,    30,     7,     8,    28,    29,     0,     0,
        5,     6,     1,     3,     0,    16,     0,    12,    15,    31,
-      63,    63,    28,    29,    16,    14,    23,    11,     0,     0,
-      64,     0,     0,    62,     0,    40,     0,    21,    22,    24,
-       0,    13,     0,    65,     0,     0,     0,     0,    26,    17,
-      60,    61,    44,    19,    25,     0,    44,    47,     0,     0,
+      67,    67,    28,    29,    16,    14,    23,    11,     0,     0,
+      68,     0,     0,    66,     0,    40,     0,    21,    22,    24,
+       0,    13,     0,    69,     0,     0,     0,     0,    26,    17,
+      64,    65,    44,    19,    25,     0,    44,    47,     0,     0,
        0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,   135,   134,   132,   131,   133,    48,     0,
-      43,    45,     0,    67,    79,    81,    83,    85,    87,    89,
-      91,    94,   100,   103,   106,   110,   112,   121,     0,     0,
-       0,   115,   110,   113,     0,   117,   114,   118,   119,   120,
-     116,     0,     0,     0,     0,    52,     0,    49,    50,    18,
-      46,    51,     0,     0,     0,     0,     0,     0,     0,     0,
-      96,    97,    98,    99,     0,     0,     0,     0,     0,     0,
-       0,     0,    68,    69,    70,    71,    72,    73,    74,    75,
-      76,    77,    78,     0,     0,     0,     0,     0,   122,   123,
-       0,   136,    54,     0,     0,     0,     0,    53,     0,    82,
-      84,    86,    88,    90,    92,    93,    95,   101,   102,   104,
-     105,   107,   108,   109,    66,   124,   129,     0,     0,   126,
-     127,   111,     0,     0,     0,     0,     0,     0,   125,   128,
-      58,    55,     0,     0,    80,   130,     0,     0,     0,    59,
-       0,    56,     0,    57
+       0,     0,     0,     0,     0,     0,     0,   139,   138,   136,
+     135,   137,    48,     0,    43,    45,     0,    71,    83,    85,
+      87,    89,    91,    93,    95,    98,   104,   107,   110,   114,
+     116,   125,     0,     0,     0,   119,   114,   117,     0,   121,
+     118,   122,   123,   124,   120,     0,     0,     0,     0,     0,
+       0,     0,    52,     0,    63,    49,    50,    18,    46,    51,
+       0,     0,     0,     0,     0,     0,     0,     0,   100,   101,
+     102,   103,     0,     0,     0,     0,     0,     0,     0,     0,
+      72,    73,    74,    75,    76,    77,    78,    79,    80,    81,
+      82,     0,     0,     0,     0,     0,   126,   127,     0,   140,
+      54,     0,     0,     0,     0,     0,     0,    62,    53,     0,
+      86,    88,    90,    92,    94,    96,    97,    99,   105,   106,
+     108,   109,   111,   112,   113,    70,   128,   133,     0,     0,
+     130,   131,   115,     0,     0,     0,     0,     0,    61,     0,
+       0,   129,   132,    58,    55,     0,     0,    60,    84,   134,
+       0,     0,     0,    59,     0,    56,     0,    57
 };
 
 /* YYPGOTO[NTERM-NUM].  */
 static const yytype_int16 yypgoto[] =
 {
-     -93,   169,   -93,    40,    19,   136,   -32,   -93,   -93,   -93,
-     -93,   118,   -93,   276,   164,   -93,   115,    87,   -88,   -93,
-     -93,   148,   157,   -75,   -93,   -21,   -93,    53,    64,    71,
-      76,    88,   -87,   -93,    69,   -92,   -78,   -65,   -73,   -93,
-       8,   -93
+     -93,   201,   -93,    32,    16,   184,   -11,   -93,   -93,   -93,
+     -93,   159,   -93,   287,   210,   -93,   166,   139,   -87,   -93,
+     -93,   194,   195,   -75,   -93,   -90,   -93,    96,    97,    95,
+      99,   104,   -85,   -93,    89,   -86,   -92,   -64,   -72,   -93,
+      20,   -93
 };
 
 /* YYDEFGOTO[NTERM-NUM].  */
 static const yytype_uint8 yydefgoto[] =
 {
-       0,    16,    17,    18,    98,    36,    37,    38,    20,    56,
-      57,    58,    59,    51,    22,    23,    99,   100,   101,    24,
-      25,    52,    53,   102,   173,   103,   104,   105,   106,   107,
-     108,   109,   110,   154,   111,   112,   113,   114,   115,   116,
-     207,   117
+       0,    16,    17,    18,   102,    36,    37,    38,    20,    56,
+      57,    58,    59,    51,    22,    23,   103,   104,   105,    24,
+      25,    52,    53,   106,   181,   107,   108,   109,   110,   111,
+     112,   113,   114,   162,   115,   116,   117,   118,   119,   120,
+     218,   121
 };
 
 /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
@@ -832,149 +836,145 @@ static const yytype_uint8 yydefgoto[] =
    number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_int16 yytable[] =
 {
-     119,   134,    45,    26,   142,   122,   122,   125,   122,   127,
-     128,   129,   122,   121,   123,   136,   126,   148,   149,    19,
-     130,   143,    34,    34,   159,   160,   161,    27,    68,   174,
-      72,   175,    73,    19,    19,    32,    19,   157,   176,   158,
-      40,   177,    42,   178,    41,   179,    43,   155,   156,   119,
-     150,   151,   152,   153,    30,    31,   183,   184,   185,    50,
-      50,   194,   195,   197,   198,    46,    47,   188,    49,    50,
-     122,   122,   122,   122,   122,   122,   122,    35,    44,   199,
-     200,   122,   122,   122,   122,   122,   122,   122,   122,    48,
-      62,    64,    65,   -20,   201,   202,   203,    66,   204,   206,
-     208,    69,    67,    75,   131,    70,    71,   122,   132,   135,
-     137,   138,   133,   141,    78,   211,    79,    80,    81,    82,
-      83,   139,   145,    84,   220,   221,    85,   162,   163,   164,
-     165,   166,   167,   168,   169,   170,   171,   172,   229,   222,
-     223,   144,   206,   122,   233,    75,   146,   147,   180,    76,
-     181,    77,   230,   182,   209,   210,    78,   186,    79,    80,
-      81,    82,    83,   187,   212,    84,   213,   214,    85,   215,
-     217,   216,   218,   219,   226,    93,    94,    95,    96,    97,
-     227,   228,   231,   232,    61,    74,    33,    39,   140,    54,
-      86,   120,    87,    88,    89,   224,   189,     1,     2,     3,
-       4,     5,     6,     7,     8,     9,    90,    63,   190,    10,
-      11,    28,    29,    75,    91,    92,   191,    93,    94,    95,
-      96,    97,   192,   196,    78,   225,    79,    80,    81,    82,
-      83,    75,   205,    84,     0,   193,    85,     0,     0,     0,
-       0,     0,    78,     0,    79,    80,    81,    82,    83,     0,
-       0,    84,     0,     0,    85,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     1,     2,     3,     4,     5,
-       6,     7,     8,     9,     0,     0,    21,    10,    11,    28,
-      29,     0,     0,     0,     0,    93,    94,    95,    96,    97,
-      21,    21,     0,    21,     0,     0,     0,    75,     0,     0,
-       0,     0,     0,    93,    94,    95,    96,    97,    78,     0,
-      79,    80,    81,    82,    83,   124,     0,    84,     0,     0,
-      85,     0,    60,     0,     0,     0,    78,     0,    79,    80,
-      81,    82,    83,     0,     0,    84,     0,     0,    85,     0,
-       0,     0,     0,    60,     0,     0,     0,     0,     0,     0,
-       0,   118,     1,     2,     3,     4,     5,     6,     7,     8,
-       9,     0,     0,     0,    10,    11,    28,    29,     0,    93,
-      94,    95,    96,    97,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,    93,    94,    95,
-      96,    97,     1,     2,     3,     4,     5,     6,     7,     8,
-       9,     0,     0,     0,    10,    11,    12,    13,     0,    14,
-      15,     1,     2,     3,     4,     5,     6,     7,     8,    55,
-       0,     0,     0,    10,    11,    28,    29,     1,     2,     3,
-       4,     5,     6,     7,     8,     9,     0,     0,     0,    10,
-      11
+     123,   140,   138,    34,    32,   150,   126,   126,   129,   126,
+     131,   132,   133,   126,   125,   127,    19,   130,   143,   126,
+      34,   134,   151,    45,    26,    75,   216,   167,   168,   169,
+      19,    19,    72,    19,    73,   165,    78,   166,    79,    80,
+      81,    82,    83,   156,   157,    84,    30,    31,    85,    68,
+     163,   164,    27,   123,   197,    40,    50,    50,    41,    35,
+     191,   192,   193,    42,   195,    46,    50,   158,   159,   160,
+     161,   205,   206,   210,   211,   199,    44,   208,   209,   126,
+     126,   126,   126,   126,   126,   126,    43,    47,    48,    49,
+     126,   126,   126,   126,   126,   126,   126,   126,    97,    98,
+      99,   100,   101,   212,   213,   214,   215,   217,   219,   228,
+      62,   145,   146,    64,    65,    75,   126,   -20,    66,    67,
+      70,   142,    69,   135,   222,   136,    78,    71,    79,    80,
+      81,    82,    83,   137,   139,    84,   233,   234,    85,   238,
+     237,   147,   141,   144,   149,   153,   152,   155,   154,   188,
+     235,   236,   189,   243,    75,   217,   196,   126,    76,   247,
+      77,   190,   220,   198,   221,    78,   244,    79,    80,    81,
+      82,    83,   223,   224,    84,   194,   225,    85,   226,   232,
+     227,   229,   231,   230,   182,   240,   183,   242,    97,    98,
+      99,   100,   101,   184,   241,   245,   185,   246,   186,    86,
+     187,    87,    88,    89,    90,    91,    92,     1,     2,     3,
+       4,     5,     6,     7,     8,     9,    93,    94,    33,    10,
+      11,    28,    29,    75,    95,    96,    74,    97,    98,    99,
+     100,   101,    61,    39,    78,    54,    79,    80,    81,    82,
+      83,    75,   124,    84,   148,    63,    85,   200,   202,   201,
+     239,   207,    78,   203,    79,    80,    81,    82,    83,   204,
+       0,    84,     0,     0,    85,   170,   171,   172,   173,   174,
+     175,   176,   177,   178,   179,   180,     1,     2,     3,     4,
+       5,     6,     7,     8,     9,     0,     0,    21,    10,    11,
+      28,    29,     0,     0,     0,     0,    97,    98,    99,   100,
+     101,    21,    21,     0,    21,     0,     0,     0,   128,     0,
+       0,     0,     0,     0,    97,    98,    99,   100,   101,    78,
+       0,    79,    80,    81,    82,    83,     0,     0,    84,     0,
+       0,    85,     0,    60,     1,     2,     3,     4,     5,     6,
+       7,     8,     9,     0,     0,     0,    10,    11,    12,    13,
+       0,    14,    15,     0,    60,     0,     0,     0,     0,     0,
+       0,     0,   122,     1,     2,     3,     4,     5,     6,     7,
+       8,     9,     0,     0,     0,    10,    11,    28,    29,     0,
+       0,    97,    98,    99,   100,   101,     1,     2,     3,     4,
+       5,     6,     7,     8,    55,     0,     0,     0,    10,    11,
+      28,    29,     1,     2,     3,     4,     5,     6,     7,     8,
+       9,     0,     0,     0,    10,    11
 };
 
 static const yytype_int16 yycheck[] =
 {
-      75,    89,    34,    75,    13,    78,    79,    80,    81,    82,
-      83,    84,    85,    78,    79,    90,    81,    31,    32,     0,
-      85,    30,    20,    20,    20,    21,    22,    75,    60,     3,
-       7,     5,     9,    14,    15,     0,    17,    16,    12,    18,
-       7,    15,    75,    17,     7,    19,    75,    27,    28,   124,
-      33,    34,    35,    36,    14,    15,   131,   132,   133,    40,
-      41,   148,   149,   155,   156,     3,     9,   142,     5,    50,
-     143,   144,   145,   146,   147,   148,   149,    75,    75,   157,
-     158,   154,   155,   156,   157,   158,   159,   160,   161,    11,
-      78,     8,     8,     4,   159,   160,   161,     4,   173,   174,
-     175,     6,    11,     3,     3,     9,     9,   180,     3,     9,
-      91,    92,     3,     9,    14,   180,    16,    17,    18,    19,
-      20,     8,    24,    23,   212,   213,    26,    37,    38,    39,
-      40,    41,    42,    43,    44,    45,    46,    47,   226,   214,
-     215,    29,   217,   216,   232,     3,    25,    23,     4,     7,
-       4,     9,   227,     8,    75,    75,    14,    50,    16,    17,
-      18,    19,    20,     9,     4,    23,     4,     9,    26,     3,
-      11,    10,     4,     6,    49,    75,    76,    77,    78,    79,
-       9,     4,     9,     4,    48,    67,    17,    23,   101,    41,
-      48,    76,    50,    51,    52,   216,   143,    55,    56,    57,
-      58,    59,    60,    61,    62,    63,    64,    50,   144,    67,
-      68,    69,    70,     3,    72,    73,   145,    75,    76,    77,
-      78,    79,   146,   154,    14,   217,    16,    17,    18,    19,
-      20,     3,     4,    23,    -1,   147,    26,    -1,    -1,    -1,
-      -1,    -1,    14,    -1,    16,    17,    18,    19,    20,    -1,
-      -1,    23,    -1,    -1,    26,    -1,    -1,    -1,    -1,    -1,
-      -1,    -1,    -1,    -1,    -1,    55,    56,    57,    58,    59,
-      60,    61,    62,    63,    -1,    -1,     0,    67,    68,    69,
-      70,    -1,    -1,    -1,    -1,    75,    76,    77,    78,    79,
-      14,    15,    -1,    17,    -1,    -1,    -1,     3,    -1,    -1,
-      -1,    -1,    -1,    75,    76,    77,    78,    79,    14,    -1,
-      16,    17,    18,    19,    20,     3,    -1,    23,    -1,    -1,
-      26,    -1,    46,    -1,    -1,    -1,    14,    -1,    16,    17,
-      18,    19,    20,    -1,    -1,    23,    -1,    -1,    26,    -1,
-      -1,    -1,    -1,    67,    -1,    -1,    -1,    -1,    -1,    -1,
-      -1,    75,    55,    56,    57,    58,    59,    60,    61,    62,
-      63,    -1,    -1,    -1,    67,    68,    69,    70,    -1,    75,
-      76,    77,    78,    79,    -1,    -1,    -1,    -1,    -1,    -1,
-      -1,    -1,    -1,    -1,    -1,    -1,    -1,    75,    76,    77,
-      78,    79,    55,    56,    57,    58,    59,    60,    61,    62,
-      63,    -1,    -1,    -1,    67,    68,    69,    70,    -1,    72,
-      73,    55,    56,    57,    58,    59,    60,    61,    62,    63,
-      -1,    -1,    -1,    67,    68,    69,    70,    55,    56,    57,
-      58,    59,    60,    61,    62,    63,    -1,    -1,    -1,    67,
-      68
+      75,    91,    89,    20,     0,    13,    78,    79,    80,    81,
+      82,    83,    84,    85,    78,    79,     0,    81,    93,    91,
+      20,    85,    30,    34,    76,     3,     4,    20,    21,    22,
+      14,    15,     7,    17,     9,    16,    14,    18,    16,    17,
+      18,    19,    20,    31,    32,    23,    14,    15,    26,    60,
+      27,    28,    76,   128,   141,     7,    40,    41,     7,    76,
+     135,   136,   137,    76,   139,     3,    50,    33,    34,    35,
+      36,   156,   157,   165,   166,   150,    76,   163,   164,   151,
+     152,   153,   154,   155,   156,   157,    76,     9,    11,     5,
+     162,   163,   164,   165,   166,   167,   168,   169,    76,    77,
+      78,    79,    80,   167,   168,   169,   181,   182,   183,   196,
+      79,    95,    96,     8,     8,     3,   188,     4,     4,    11,
+       9,     9,     6,     3,   188,     3,    14,     9,    16,    17,
+      18,    19,    20,     3,     3,    23,   223,   224,    26,   229,
+     227,     8,    10,     9,     9,    24,    29,    23,    25,     4,
+     225,   226,     4,   240,     3,   230,    10,   229,     7,   246,
+       9,     8,    76,     9,    76,    14,   241,    16,    17,    18,
+      19,    20,     4,     4,    23,    50,     9,    26,     3,     6,
+       4,    10,     4,    11,     3,    49,     5,     4,    76,    77,
+      78,    79,    80,    12,     9,     9,    15,     4,    17,    48,
+      19,    50,    51,    52,    53,    54,    55,    56,    57,    58,
+      59,    60,    61,    62,    63,    64,    65,    66,    17,    68,
+      69,    70,    71,     3,    73,    74,    67,    76,    77,    78,
+      79,    80,    48,    23,    14,    41,    16,    17,    18,    19,
+      20,     3,    76,    23,   105,    50,    26,   151,   153,   152,
+     230,   162,    14,   154,    16,    17,    18,    19,    20,   155,
+      -1,    23,    -1,    -1,    26,    37,    38,    39,    40,    41,
+      42,    43,    44,    45,    46,    47,    56,    57,    58,    59,
+      60,    61,    62,    63,    64,    -1,    -1,     0,    68,    69,
+      70,    71,    -1,    -1,    -1,    -1,    76,    77,    78,    79,
+      80,    14,    15,    -1,    17,    -1,    -1,    -1,     3,    -1,
+      -1,    -1,    -1,    -1,    76,    77,    78,    79,    80,    14,
+      -1,    16,    17,    18,    19,    20,    -1,    -1,    23,    -1,
+      -1,    26,    -1,    46,    56,    57,    58,    59,    60,    61,
+      62,    63,    64,    -1,    -1,    -1,    68,    69,    70,    71,
+      -1,    73,    74,    -1,    67,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    75,    56,    57,    58,    59,    60,    61,    62,
+      63,    64,    -1,    -1,    -1,    68,    69,    70,    71,    -1,
+      -1,    76,    77,    78,    79,    80,    56,    57,    58,    59,
+      60,    61,    62,    63,    64,    -1,    -1,    -1,    68,    69,
+      70,    71,    56,    57,    58,    59,    60,    61,    62,    63,
+      64,    -1,    -1,    -1,    68,    69
 };
 
 /* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
    state STATE-NUM.  */
 static const yytype_int8 yystos[] =
 {
-       0,    55,    56,    57,    58,    59,    60,    61,    62,    63,
-      67,    68,    69,    70,    72,    73,    81,    82,    83,    84,
-      88,    93,    94,    95,    99,   100,    75,    75,    69,    70,
-      83,    83,     0,    81,    20,    75,    85,    86,    87,    94,
-       7,     7,    75,    75,    75,    86,     3,     9,    11,     5,
-      84,    93,   101,   102,   101,    63,    89,    90,    91,    92,
-      93,    85,    78,   102,     8,     8,     4,    11,    86,     6,
-       9,     9,     7,     9,    91,     3,     7,     9,    14,    16,
+       0,    56,    57,    58,    59,    60,    61,    62,    63,    64,
+      68,    69,    70,    71,    73,    74,    82,    83,    84,    85,
+      89,    94,    95,    96,   100,   101,    76,    76,    70,    71,
+      84,    84,     0,    82,    20,    76,    86,    87,    88,    95,
+       7,     7,    76,    76,    76,    87,     3,     9,    11,     5,
+      85,    94,   102,   103,   102,    64,    90,    91,    92,    93,
+      94,    86,    79,   103,     8,     8,     4,    11,    87,     6,
+       9,     9,     7,     9,    92,     3,     7,     9,    14,    16,
       17,    18,    19,    20,    23,    26,    48,    50,    51,    52,
-      64,    72,    73,    75,    76,    77,    78,    79,    84,    96,
-      97,    98,   103,   105,   106,   107,   108,   109,   110,   111,
-     112,   114,   115,   116,   117,   118,   119,   121,    93,   103,
-      96,   117,   118,   117,     3,   118,   117,   118,   118,   118,
-     117,     3,     3,     3,    98,     9,   103,    84,    84,     8,
-      97,     9,    13,    30,    29,    24,    25,    23,    31,    32,
-      33,    34,    35,    36,   113,    27,    28,    16,    18,    20,
-      21,    22,    37,    38,    39,    40,    41,    42,    43,    44,
-      45,    46,    47,   104,     3,     5,    12,    15,    17,    19,
-       4,     4,     8,   103,   103,   103,    50,     9,   103,   107,
-     108,   109,   110,   111,   112,   112,   114,   115,   115,   116,
-     116,   117,   117,   117,   103,     4,   103,   120,   103,    75,
-      75,   117,     4,     4,     9,     3,    10,    11,     4,     6,
-      98,    98,   103,   103,   105,   120,    49,     9,     4,    98,
-     103,     9,     4,    98
+      53,    54,    55,    65,    66,    73,    74,    76,    77,    78,
+      79,    80,    85,    97,    98,    99,   104,   106,   107,   108,
+     109,   110,   111,   112,   113,   115,   116,   117,   118,   119,
+     120,   122,    94,   104,    97,   118,   119,   118,     3,   119,
+     118,   119,   119,   119,   118,     3,     3,     3,    99,     3,
+     106,    10,     9,   104,     9,    85,    85,     8,    98,     9,
+      13,    30,    29,    24,    25,    23,    31,    32,    33,    34,
+      35,    36,   114,    27,    28,    16,    18,    20,    21,    22,
+      37,    38,    39,    40,    41,    42,    43,    44,    45,    46,
+      47,   105,     3,     5,    12,    15,    17,    19,     4,     4,
+       8,   104,   104,   104,    50,   104,    10,    99,     9,   104,
+     108,   109,   110,   111,   112,   113,   113,   115,   116,   116,
+     117,   117,   118,   118,   118,   104,     4,   104,   121,   104,
+      76,    76,   118,     4,     4,     9,     3,     4,    99,    10,
+      11,     4,     6,    99,    99,   104,   104,    99,   106,   121,
+      49,     9,     4,    99,   104,     9,     4,    99
 };
 
 /* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr1[] =
 {
-       0,    80,    81,    81,    82,    82,    82,    82,    82,    83,
-      83,    84,    85,    85,    86,    86,    87,    87,    88,    88,
-      89,    89,    90,    90,    91,    91,    92,    93,    93,    93,
-      94,    94,    95,    95,    95,    95,    95,    95,    95,    95,
-      95,    95,    95,    96,    96,    97,    97,    98,    98,    98,
-      98,    98,    98,    98,    98,    98,    98,    98,    98,    98,
-      99,   100,   101,   101,   102,   102,   103,   103,   104,   104,
-     104,   104,   104,   104,   104,   104,   104,   104,   104,   105,
-     105,   106,   106,   107,   107,   108,   108,   109,   109,   110,
-     110,   111,   111,   111,   112,   112,   113,   113,   113,   113,
-     114,   114,   114,   115,   115,   115,   116,   116,   116,   116,
-     117,   117,   118,   118,   118,   118,   118,   118,   118,   118,
-     118,   119,   119,   119,   119,   119,   119,   119,   119,   120,
-     120,   121,   121,   121,   121,   121,   121
+       0,    81,    82,    82,    83,    83,    83,    83,    83,    84,
+      84,    85,    86,    86,    87,    87,    88,    88,    89,    89,
+      90,    90,    91,    91,    92,    92,    93,    94,    94,    94,
+      95,    95,    96,    96,    96,    96,    96,    96,    96,    96,
+      96,    96,    96,    97,    97,    98,    98,    99,    99,    99,
+      99,    99,    99,    99,    99,    99,    99,    99,    99,    99,
+      99,    99,    99,    99,   100,   101,   102,   102,   103,   103,
+     104,   104,   105,   105,   105,   105,   105,   105,   105,   105,
+     105,   105,   105,   106,   106,   107,   107,   108,   108,   109,
+     109,   110,   110,   111,   111,   112,   112,   112,   113,   113,
+     114,   114,   114,   114,   115,   115,   115,   116,   116,   116,
+     117,   117,   117,   117,   118,   118,   119,   119,   119,   119,
+     119,   119,   119,   119,   119,   120,   120,   120,   120,   120,
+     120,   120,   120,   121,   121,   122,   122,   122,   122,   122,
+     122
 };
 
 /* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
@@ -986,14 +986,15 @@ static const yytype_int8 yyr2[] =
        1,     2,     1,     1,     1,     1,     1,     1,     1,     1,
        1,     1,     1,     1,     0,     1,     2,     1,     1,     2,
        2,     2,     2,     3,     3,     5,     7,     9,     5,     7,
-       6,     6,     1,     0,     1,     2,     3,     1,     1,     1,
-       1,     1,     1,     1,     1,     1,     1,     1,     1,     1,
-       5,     1,     3,     1,     3,     1,     3,     1,     3,     1,
-       3,     1,     3,     3,     1,     3,     1,     1,     1,     1,
-       1,     3,     3,     1,     3,     3,     1,     3,     3,     3,
-       1,     4,     1,     2,     2,     2,     2,     2,     2,     2,
-       2,     1,     2,     2,     3,     4,     3,     3,     4,     1,
-       3,     1,     1,     1,     1,     1,     3
+       5,     4,     3,     2,     6,     6,     1,     0,     1,     2,
+       3,     1,     1,     1,     1,     1,     1,     1,     1,     1,
+       1,     1,     1,     1,     5,     1,     3,     1,     3,     1,
+       3,     1,     3,     1,     3,     1,     3,     3,     1,     3,
+       1,     1,     1,     1,     1,     3,     3,     1,     3,     3,
+       1,     3,     3,     3,     1,     4,     1,     2,     2,     2,
+       2,     2,     2,     2,     2,     1,     2,     2,     3,     4,
+       3,     3,     4,     1,     3,     1,     1,     1,     1,     1,
+       3
 };
 
 
@@ -1467,815 +1468,839 @@ yyreduce:
   case 2: /* unit: top_level_declaration  */
 #line 147 "parse_buildast.y"
    { pp->parse_tree = (yyval.node) = new Node(AST_UNIT, {(yyvsp[0].node)}); }
-#line 1471 "parse.tab.cpp"
+#line 1472 "parse.tab.cpp"
     break;
 
   case 3: /* unit: top_level_declaration unit  */
 #line 149 "parse_buildast.y"
     { pp->parse_tree = (yyval.node) = (yyvsp[0].node); (yyval.node)->prepend_kid((yyvsp[-1].node)); }
-#line 1477 "parse.tab.cpp"
+#line 1478 "parse.tab.cpp"
     break;
 
   case 4: /* top_level_declaration: function_or_variable_declaration_or_definition  */
 #line 154 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1483 "parse.tab.cpp"
+#line 1484 "parse.tab.cpp"
     break;
 
   case 5: /* top_level_declaration: TOK_STATIC function_or_variable_declaration_or_definition  */
 #line 156 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); (yyval.node)->shift_kid(); (yyval.node)->prepend_kid((yyvsp[-1].node)); }
-#line 1489 "parse.tab.cpp"
+#line 1490 "parse.tab.cpp"
     break;
 
   case 6: /* top_level_declaration: TOK_EXTERN function_or_variable_declaration_or_definition  */
 #line 158 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); (yyval.node)->shift_kid(); (yyval.node)->prepend_kid((yyvsp[-1].node)); }
-#line 1495 "parse.tab.cpp"
+#line 1496 "parse.tab.cpp"
     break;
 
   case 7: /* top_level_declaration: struct_type_definition  */
 #line 160 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1501 "parse.tab.cpp"
+#line 1502 "parse.tab.cpp"
     break;
 
   case 8: /* top_level_declaration: union_type_definition  */
 #line 162 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1507 "parse.tab.cpp"
+#line 1508 "parse.tab.cpp"
     break;
 
   case 9: /* function_or_variable_declaration_or_definition: function_definition_or_declaration  */
 #line 167 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1513 "parse.tab.cpp"
+#line 1514 "parse.tab.cpp"
     break;
 
   case 10: /* function_or_variable_declaration_or_definition: simple_variable_declaration  */
 #line 169 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1519 "parse.tab.cpp"
+#line 1520 "parse.tab.cpp"
     break;
 
   case 11: /* simple_variable_declaration: type declarator_list TOK_SEMICOLON  */
 #line 174 "parse_buildast.y"
     { (yyval.node) = new Node(AST_VARIABLE_DECLARATION, {(yyvsp[-2].node), (yyvsp[-1].node)}); handle_unspecified_storage((yyval.node), pp);  }
-#line 1525 "parse.tab.cpp"
+#line 1526 "parse.tab.cpp"
     break;
 
   case 12: /* declarator_list: declarator  */
 #line 179 "parse_buildast.y"
     { (yyval.node) = new Node(AST_DECLARATOR_LIST, {(yyvsp[0].node)}); }
-#line 1531 "parse.tab.cpp"
+#line 1532 "parse.tab.cpp"
     break;
 
   case 13: /* declarator_list: declarator TOK_COMMA declarator_list  */
 #line 181 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); (yyval.node)->prepend_kid((yyvsp[-2].node)); }
-#line 1537 "parse.tab.cpp"
+#line 1538 "parse.tab.cpp"
     break;
 
   case 14: /* declarator: TOK_ASTERISK declarator  */
 #line 187 "parse_buildast.y"
     { (yyval.node) = new Node(AST_POINTER_DECLARATOR, {(yyvsp[0].node)}); }
-#line 1543 "parse.tab.cpp"
+#line 1544 "parse.tab.cpp"
     break;
 
   case 15: /* declarator: non_pointer_declarator  */
 #line 189 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1549 "parse.tab.cpp"
+#line 1550 "parse.tab.cpp"
     break;
 
   case 16: /* non_pointer_declarator: TOK_IDENT  */
 #line 195 "parse_buildast.y"
     { (yyval.node) = new Node(AST_NAMED_DECLARATOR, {(yyvsp[0].node)}); }
-#line 1555 "parse.tab.cpp"
+#line 1556 "parse.tab.cpp"
     break;
 
   case 17: /* non_pointer_declarator: non_pointer_declarator TOK_LBRACKET TOK_INT_LIT TOK_RBRACKET  */
 #line 197 "parse_buildast.y"
     { (yyval.node) = new Node(AST_ARRAY_DECLARATOR, {(yyvsp[-3].node), (yyvsp[-1].node)}); }
-#line 1561 "parse.tab.cpp"
+#line 1562 "parse.tab.cpp"
     break;
 
   case 18: /* function_definition_or_declaration: type TOK_IDENT TOK_LPAREN function_parameter_list TOK_RPAREN TOK_LBRACE opt_statement_list TOK_RBRACE  */
 #line 202 "parse_buildast.y"
     { (yyval.node) = new Node(AST_FUNCTION_DEFINITION, {(yyvsp[-7].node), (yyvsp[-6].node), (yyvsp[-4].node), (yyvsp[-1].node)}); }
-#line 1567 "parse.tab.cpp"
+#line 1568 "parse.tab.cpp"
     break;
 
   case 19: /* function_definition_or_declaration: type TOK_IDENT TOK_LPAREN function_parameter_list TOK_RPAREN TOK_SEMICOLON  */
 #line 204 "parse_buildast.y"
     { (yyval.node) = new Node(AST_FUNCTION_DECLARATION, {(yyvsp[-5].node), (yyvsp[-4].node), (yyvsp[-2].node)}); }
-#line 1573 "parse.tab.cpp"
+#line 1574 "parse.tab.cpp"
     break;
 
   case 20: /* function_parameter_list: TOK_VOID  */
 #line 209 "parse_buildast.y"
     { (yyval.node) = new Node(AST_FUNCTION_PARAMETER_LIST); }
-#line 1579 "parse.tab.cpp"
+#line 1580 "parse.tab.cpp"
     break;
 
   case 21: /* function_parameter_list: opt_parameter_list  */
 #line 211 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1585 "parse.tab.cpp"
+#line 1586 "parse.tab.cpp"
     break;
 
   case 22: /* opt_parameter_list: parameter_list  */
 #line 216 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1591 "parse.tab.cpp"
+#line 1592 "parse.tab.cpp"
     break;
 
   case 23: /* opt_parameter_list: %empty  */
 #line 218 "parse_buildast.y"
     { (yyval.node) = new Node(AST_FUNCTION_PARAMETER_LIST); }
-#line 1597 "parse.tab.cpp"
+#line 1598 "parse.tab.cpp"
     break;
 
   case 24: /* parameter_list: parameter  */
 #line 223 "parse_buildast.y"
     { (yyval.node) = new Node(AST_FUNCTION_PARAMETER_LIST, {(yyvsp[0].node)}); }
-#line 1603 "parse.tab.cpp"
+#line 1604 "parse.tab.cpp"
     break;
 
   case 25: /* parameter_list: parameter TOK_COMMA parameter_list  */
 #line 225 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); (yyval.node)->prepend_kid((yyvsp[-2].node)); }
-#line 1609 "parse.tab.cpp"
+#line 1610 "parse.tab.cpp"
     break;
 
   case 26: /* parameter: type declarator  */
 #line 230 "parse_buildast.y"
     { (yyval.node) = new Node(AST_FUNCTION_PARAMETER, {(yyvsp[-1].node), (yyvsp[0].node)}); }
-#line 1615 "parse.tab.cpp"
+#line 1616 "parse.tab.cpp"
     break;
 
   case 27: /* type: basic_type  */
 #line 235 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1621 "parse.tab.cpp"
+#line 1622 "parse.tab.cpp"
     break;
 
   case 28: /* type: TOK_STRUCT TOK_IDENT  */
 #line 237 "parse_buildast.y"
     { (yyval.node) = new Node(AST_STRUCT_TYPE, {(yyvsp[0].node)}); }
-#line 1627 "parse.tab.cpp"
+#line 1628 "parse.tab.cpp"
     break;
 
   case 29: /* type: TOK_UNION TOK_IDENT  */
 #line 239 "parse_buildast.y"
     { (yyval.node) = new Node(AST_UNION_TYPE, {(yyvsp[0].node)}); }
-#line 1633 "parse.tab.cpp"
+#line 1634 "parse.tab.cpp"
     break;
 
   case 30: /* basic_type: basic_type_keyword  */
 #line 249 "parse_buildast.y"
     { (yyval.node) = new Node(AST_BASIC_TYPE, {(yyvsp[0].node)}); }
-#line 1639 "parse.tab.cpp"
+#line 1640 "parse.tab.cpp"
     break;
 
   case 31: /* basic_type: basic_type_keyword basic_type  */
 #line 251 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); (yyval.node)->prepend_kid((yyvsp[-1].node)); }
-#line 1645 "parse.tab.cpp"
+#line 1646 "parse.tab.cpp"
     break;
 
   case 32: /* basic_type_keyword: TOK_CHAR  */
 #line 256 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1651 "parse.tab.cpp"
+#line 1652 "parse.tab.cpp"
     break;
 
   case 33: /* basic_type_keyword: TOK_SHORT  */
 #line 258 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1657 "parse.tab.cpp"
+#line 1658 "parse.tab.cpp"
     break;
 
   case 34: /* basic_type_keyword: TOK_INT  */
 #line 260 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1663 "parse.tab.cpp"
+#line 1664 "parse.tab.cpp"
     break;
 
   case 35: /* basic_type_keyword: TOK_LONG  */
 #line 262 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1669 "parse.tab.cpp"
+#line 1670 "parse.tab.cpp"
     break;
 
   case 36: /* basic_type_keyword: TOK_UNSIGNED  */
 #line 264 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1675 "parse.tab.cpp"
+#line 1676 "parse.tab.cpp"
     break;
 
   case 37: /* basic_type_keyword: TOK_SIGNED  */
 #line 266 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1681 "parse.tab.cpp"
+#line 1682 "parse.tab.cpp"
     break;
 
   case 38: /* basic_type_keyword: TOK_FLOAT  */
 #line 268 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1687 "parse.tab.cpp"
+#line 1688 "parse.tab.cpp"
     break;
 
   case 39: /* basic_type_keyword: TOK_DOUBLE  */
 #line 270 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1693 "parse.tab.cpp"
+#line 1694 "parse.tab.cpp"
     break;
 
   case 40: /* basic_type_keyword: TOK_VOID  */
 #line 272 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1699 "parse.tab.cpp"
+#line 1700 "parse.tab.cpp"
     break;
 
   case 41: /* basic_type_keyword: TOK_CONST  */
 #line 274 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1705 "parse.tab.cpp"
+#line 1706 "parse.tab.cpp"
     break;
 
   case 42: /* basic_type_keyword: TOK_VOLATILE  */
 #line 276 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1711 "parse.tab.cpp"
+#line 1712 "parse.tab.cpp"
     break;
 
   case 43: /* opt_statement_list: statement_list  */
 #line 281 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1717 "parse.tab.cpp"
+#line 1718 "parse.tab.cpp"
     break;
 
   case 44: /* opt_statement_list: %empty  */
 #line 283 "parse_buildast.y"
     { (yyval.node) = new Node(AST_STATEMENT_LIST); }
-#line 1723 "parse.tab.cpp"
+#line 1724 "parse.tab.cpp"
     break;
 
   case 45: /* statement_list: statement  */
 #line 288 "parse_buildast.y"
     { (yyval.node) = new Node(AST_STATEMENT_LIST, {(yyvsp[0].node)}); }
-#line 1729 "parse.tab.cpp"
+#line 1730 "parse.tab.cpp"
     break;
 
   case 46: /* statement_list: statement statement_list  */
 #line 290 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); (yyval.node)->prepend_kid((yyvsp[-1].node)); }
-#line 1735 "parse.tab.cpp"
+#line 1736 "parse.tab.cpp"
     break;
 
   case 47: /* statement: TOK_SEMICOLON  */
 #line 295 "parse_buildast.y"
     { (yyval.node) = new Node(AST_EMPTY_STATEMENT); }
-#line 1741 "parse.tab.cpp"
+#line 1742 "parse.tab.cpp"
     break;
 
   case 48: /* statement: simple_variable_declaration  */
 #line 297 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1747 "parse.tab.cpp"
+#line 1748 "parse.tab.cpp"
     break;
 
   case 49: /* statement: TOK_STATIC simple_variable_declaration  */
 #line 299 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); (yyval.node)->shift_kid(); (yyval.node)->prepend_kid((yyvsp[-1].node)); }
-#line 1753 "parse.tab.cpp"
+#line 1754 "parse.tab.cpp"
     break;
 
   case 50: /* statement: TOK_EXTERN simple_variable_declaration  */
 #line 301 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); (yyval.node)->shift_kid(); (yyval.node)->prepend_kid((yyvsp[-1].node)); }
-#line 1759 "parse.tab.cpp"
+#line 1760 "parse.tab.cpp"
     break;
 
   case 51: /* statement: assignment_expression TOK_SEMICOLON  */
 #line 303 "parse_buildast.y"
     { (yyval.node) = new Node(AST_EXPRESSION_STATEMENT, {(yyvsp[-1].node)}); }
-#line 1765 "parse.tab.cpp"
+#line 1766 "parse.tab.cpp"
     break;
 
   case 52: /* statement: TOK_RETURN TOK_SEMICOLON  */
 #line 305 "parse_buildast.y"
     { (yyval.node) = new Node(AST_RETURN_STATEMENT); }
-#line 1771 "parse.tab.cpp"
+#line 1772 "parse.tab.cpp"
     break;
 
   case 53: /* statement: TOK_RETURN assignment_expression TOK_SEMICOLON  */
 #line 307 "parse_buildast.y"
     { (yyval.node) = new Node(AST_RETURN_EXPRESSION_STATEMENT, {(yyvsp[-1].node)}); }
-#line 1777 "parse.tab.cpp"
+#line 1778 "parse.tab.cpp"
     break;
 
   case 54: /* statement: TOK_LBRACE opt_statement_list TOK_RBRACE  */
 #line 309 "parse_buildast.y"
     { (yyval.node) = (yyvsp[-1].node);  }
-#line 1783 "parse.tab.cpp"
+#line 1784 "parse.tab.cpp"
     break;
 
   case 55: /* statement: TOK_WHILE TOK_LPAREN assignment_expression TOK_RPAREN statement  */
 #line 311 "parse_buildast.y"
     { (yyval.node) = new Node(AST_WHILE_STATEMENT, {(yyvsp[-2].node), (yyvsp[0].node)}); }
-#line 1789 "parse.tab.cpp"
+#line 1790 "parse.tab.cpp"
     break;
 
   case 56: /* statement: TOK_DO statement TOK_WHILE TOK_LPAREN assignment_expression TOK_RPAREN TOK_SEMICOLON  */
 #line 313 "parse_buildast.y"
     { (yyval.node) = new Node(AST_DO_WHILE_STATEMENT, {(yyvsp[-5].node), (yyvsp[-2].node)}); }
-#line 1795 "parse.tab.cpp"
+#line 1796 "parse.tab.cpp"
     break;
 
   case 57: /* statement: TOK_FOR TOK_LPAREN assignment_expression TOK_SEMICOLON assignment_expression TOK_SEMICOLON assignment_expression TOK_RPAREN statement  */
 #line 322 "parse_buildast.y"
     { (yyval.node) = new Node(AST_FOR_STATEMENT, {(yyvsp[-6].node), (yyvsp[-4].node), (yyvsp[-2].node), (yyvsp[0].node)}); }
-#line 1801 "parse.tab.cpp"
+#line 1802 "parse.tab.cpp"
     break;
 
   case 58: /* statement: TOK_IF TOK_LPAREN assignment_expression TOK_RPAREN statement  */
 #line 324 "parse_buildast.y"
     { (yyval.node) = new Node(AST_IF_STATEMENT, {(yyvsp[-2].node), (yyvsp[0].node)}); }
-#line 1807 "parse.tab.cpp"
+#line 1808 "parse.tab.cpp"
     break;
 
   case 59: /* statement: TOK_IF TOK_LPAREN assignment_expression TOK_RPAREN statement TOK_ELSE statement  */
 #line 326 "parse_buildast.y"
     { (yyval.node) = new Node(AST_IF_ELSE_STATEMENT, {(yyvsp[-4].node), (yyvsp[-2].node), (yyvsp[0].node)}); }
-#line 1813 "parse.tab.cpp"
+#line 1814 "parse.tab.cpp"
     break;
 
-  case 60: /* struct_type_definition: TOK_STRUCT TOK_IDENT TOK_LBRACE opt_simple_variable_declaration_list TOK_RBRACE TOK_SEMICOLON  */
-#line 331 "parse_buildast.y"
+  case 60: /* statement: TOK_SWITCH TOK_LPAREN assignment_expression TOK_RPAREN statement  */
+#line 328 "parse_buildast.y"
+    { (yyval.node) = new Node(AST_SWITCH_STATEMENT, {(yyvsp[-2].node), (yyvsp[0].node)}); }
+#line 1820 "parse.tab.cpp"
+    break;
+
+  case 61: /* statement: TOK_CASE conditional_expression TOK_COLON statement  */
+#line 330 "parse_buildast.y"
+    { (yyval.node) = new Node(AST_CASE_STATEMENT, {(yyvsp[-2].node), (yyvsp[0].node)}); }
+#line 1826 "parse.tab.cpp"
+    break;
+
+  case 62: /* statement: TOK_DEFAULT TOK_COLON statement  */
+#line 332 "parse_buildast.y"
+    { (yyval.node) = new Node(AST_DEFAULT_STATEMENT, {(yyvsp[0].node)}); }
+#line 1832 "parse.tab.cpp"
+    break;
+
+  case 63: /* statement: TOK_BREAK TOK_SEMICOLON  */
+#line 334 "parse_buildast.y"
+    { (yyval.node) = new Node(AST_BREAK_STATEMENT); (yyval.node)->set_loc((yyvsp[-1].node)->get_loc()); }
+#line 1838 "parse.tab.cpp"
+    break;
+
+  case 64: /* struct_type_definition: TOK_STRUCT TOK_IDENT TOK_LBRACE opt_simple_variable_declaration_list TOK_RBRACE TOK_SEMICOLON  */
+#line 339 "parse_buildast.y"
     { (yyval.node) = new Node(AST_STRUCT_TYPE_DEFINITION, {(yyvsp[-4].node), (yyvsp[-2].node)}); }
-#line 1819 "parse.tab.cpp"
+#line 1844 "parse.tab.cpp"
     break;
 
-  case 61: /* union_type_definition: TOK_UNION TOK_IDENT TOK_LBRACE opt_simple_variable_declaration_list TOK_RBRACE TOK_SEMICOLON  */
-#line 336 "parse_buildast.y"
+  case 65: /* union_type_definition: TOK_UNION TOK_IDENT TOK_LBRACE opt_simple_variable_declaration_list TOK_RBRACE TOK_SEMICOLON  */
+#line 344 "parse_buildast.y"
     { (yyval.node) = new Node(AST_UNION_TYPE_DEFINITION, {(yyvsp[-4].node), (yyvsp[-2].node)}); }
-#line 1825 "parse.tab.cpp"
+#line 1850 "parse.tab.cpp"
     break;
 
-  case 62: /* opt_simple_variable_declaration_list: simple_variable_declaration_list  */
-#line 341 "parse_buildast.y"
+  case 66: /* opt_simple_variable_declaration_list: simple_variable_declaration_list  */
+#line 349 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1831 "parse.tab.cpp"
+#line 1856 "parse.tab.cpp"
     break;
 
-  case 63: /* opt_simple_variable_declaration_list: %empty  */
-#line 343 "parse_buildast.y"
+  case 67: /* opt_simple_variable_declaration_list: %empty  */
+#line 351 "parse_buildast.y"
     { (yyval.node) = new Node(AST_FIELD_DEFINITION_LIST); }
-#line 1837 "parse.tab.cpp"
+#line 1862 "parse.tab.cpp"
     break;
 
-  case 64: /* simple_variable_declaration_list: simple_variable_declaration  */
-#line 348 "parse_buildast.y"
+  case 68: /* simple_variable_declaration_list: simple_variable_declaration  */
+#line 356 "parse_buildast.y"
     { (yyval.node) = new Node(AST_FIELD_DEFINITION_LIST, {(yyvsp[0].node)}); }
-#line 1843 "parse.tab.cpp"
+#line 1868 "parse.tab.cpp"
     break;
 
-  case 65: /* simple_variable_declaration_list: simple_variable_declaration simple_variable_declaration_list  */
-#line 350 "parse_buildast.y"
+  case 69: /* simple_variable_declaration_list: simple_variable_declaration simple_variable_declaration_list  */
+#line 358 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); (yyval.node)->prepend_kid((yyvsp[-1].node)); }
-#line 1849 "parse.tab.cpp"
+#line 1874 "parse.tab.cpp"
     break;
 
-  case 66: /* assignment_expression: unary_expression assignment_op assignment_expression  */
-#line 369 "parse_buildast.y"
+  case 70: /* assignment_expression: unary_expression assignment_op assignment_expression  */
+#line 377 "parse_buildast.y"
     { (yyval.node) = new Node(AST_BINARY_EXPRESSION, {(yyvsp[-1].node), (yyvsp[-2].node), (yyvsp[0].node)}); }
-#line 1855 "parse.tab.cpp"
+#line 1880 "parse.tab.cpp"
     break;
 
-  case 67: /* assignment_expression: conditional_expression  */
-#line 371 "parse_buildast.y"
+  case 71: /* assignment_expression: conditional_expression  */
+#line 379 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1861 "parse.tab.cpp"
+#line 1886 "parse.tab.cpp"
     break;
 
-  case 68: /* assignment_op: TOK_ASSIGN  */
-#line 376 "parse_buildast.y"
+  case 72: /* assignment_op: TOK_ASSIGN  */
+#line 384 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1867 "parse.tab.cpp"
+#line 1892 "parse.tab.cpp"
     break;
 
-  case 69: /* assignment_op: TOK_MUL_ASSIGN  */
-#line 378 "parse_buildast.y"
+  case 73: /* assignment_op: TOK_MUL_ASSIGN  */
+#line 386 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1873 "parse.tab.cpp"
+#line 1898 "parse.tab.cpp"
     break;
 
-  case 70: /* assignment_op: TOK_DIV_ASSIGN  */
-#line 380 "parse_buildast.y"
+  case 74: /* assignment_op: TOK_DIV_ASSIGN  */
+#line 388 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1879 "parse.tab.cpp"
+#line 1904 "parse.tab.cpp"
     break;
 
-  case 71: /* assignment_op: TOK_MOD_ASSIGN  */
-#line 382 "parse_buildast.y"
+  case 75: /* assignment_op: TOK_MOD_ASSIGN  */
+#line 390 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1885 "parse.tab.cpp"
+#line 1910 "parse.tab.cpp"
     break;
 
-  case 72: /* assignment_op: TOK_ADD_ASSIGN  */
-#line 384 "parse_buildast.y"
+  case 76: /* assignment_op: TOK_ADD_ASSIGN  */
+#line 392 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1891 "parse.tab.cpp"
+#line 1916 "parse.tab.cpp"
     break;
 
-  case 73: /* assignment_op: TOK_SUB_ASSIGN  */
-#line 386 "parse_buildast.y"
+  case 77: /* assignment_op: TOK_SUB_ASSIGN  */
+#line 394 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1897 "parse.tab.cpp"
+#line 1922 "parse.tab.cpp"
     break;
 
-  case 74: /* assignment_op: TOK_LEFT_ASSIGN  */
-#line 388 "parse_buildast.y"
+  case 78: /* assignment_op: TOK_LEFT_ASSIGN  */
+#line 396 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1903 "parse.tab.cpp"
+#line 1928 "parse.tab.cpp"
     break;
 
-  case 75: /* assignment_op: TOK_RIGHT_ASSIGN  */
-#line 390 "parse_buildast.y"
+  case 79: /* assignment_op: TOK_RIGHT_ASSIGN  */
+#line 398 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1909 "parse.tab.cpp"
+#line 1934 "parse.tab.cpp"
     break;
 
-  case 76: /* assignment_op: TOK_AND_ASSIGN  */
-#line 392 "parse_buildast.y"
+  case 80: /* assignment_op: TOK_AND_ASSIGN  */
+#line 400 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1915 "parse.tab.cpp"
+#line 1940 "parse.tab.cpp"
     break;
 
-  case 77: /* assignment_op: TOK_XOR_ASSIGN  */
-#line 394 "parse_buildast.y"
+  case 81: /* assignment_op: TOK_XOR_ASSIGN  */
+#line 402 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1921 "parse.tab.cpp"
+#line 1946 "parse.tab.cpp"
     break;
 
-  case 78: /* assignment_op: TOK_OR_ASSIGN  */
-#line 396 "parse_buildast.y"
+  case 82: /* assignment_op: TOK_OR_ASSIGN  */
+#line 404 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1927 "parse.tab.cpp"
+#line 1952 "parse.tab.cpp"
     break;
 
-  case 79: /* conditional_expression: logical_or_expression  */
-#line 401 "parse_buildast.y"
+  case 83: /* conditional_expression: logical_or_expression  */
+#line 409 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1933 "parse.tab.cpp"
+#line 1958 "parse.tab.cpp"
     break;
 
-  case 80: /* conditional_expression: logical_or_expression TOK_QUESTION assignment_expression TOK_COLON conditional_expression  */
-#line 403 "parse_buildast.y"
+  case 84: /* conditional_expression: logical_or_expression TOK_QUESTION assignment_expression TOK_COLON conditional_expression  */
+#line 411 "parse_buildast.y"
     { (yyval.node) = new Node(AST_CONDITIONAL_EXPRESSION, {(yyvsp[-4].node), (yyvsp[-2].node), (yyvsp[0].node)}); }
-#line 1939 "parse.tab.cpp"
+#line 1964 "parse.tab.cpp"
     break;
 
-  case 81: /* logical_or_expression: logical_and_expression  */
-#line 408 "parse_buildast.y"
+  case 85: /* logical_or_expression: logical_and_expression  */
+#line 416 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1945 "parse.tab.cpp"
+#line 1970 "parse.tab.cpp"
     break;
 
-  case 82: /* logical_or_expression: logical_or_expression TOK_LOGICAL_OR logical_and_expression  */
-#line 410 "parse_buildast.y"
+  case 86: /* logical_or_expression: logical_or_expression TOK_LOGICAL_OR logical_and_expression  */
+#line 418 "parse_buildast.y"
     { (yyval.node) = new Node(AST_BINARY_EXPRESSION, {(yyvsp[-1].node), (yyvsp[-2].node), (yyvsp[0].node)}); }
-#line 1951 "parse.tab.cpp"
+#line 1976 "parse.tab.cpp"
     break;
 
-  case 83: /* logical_and_expression: bitwise_or_expression  */
-#line 415 "parse_buildast.y"
+  case 87: /* logical_and_expression: bitwise_or_expression  */
+#line 423 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1957 "parse.tab.cpp"
+#line 1982 "parse.tab.cpp"
     break;
 
-  case 84: /* logical_and_expression: logical_and_expression TOK_LOGICAL_AND bitwise_or_expression  */
-#line 417 "parse_buildast.y"
+  case 88: /* logical_and_expression: logical_and_expression TOK_LOGICAL_AND bitwise_or_expression  */
+#line 425 "parse_buildast.y"
     { (yyval.node) = new Node(AST_BINARY_EXPRESSION, {(yyvsp[-1].node), (yyvsp[-2].node), (yyvsp[0].node)}); }
-#line 1963 "parse.tab.cpp"
+#line 1988 "parse.tab.cpp"
     break;
 
-  case 85: /* bitwise_or_expression: bitwise_xor_expression  */
-#line 422 "parse_buildast.y"
+  case 89: /* bitwise_or_expression: bitwise_xor_expression  */
+#line 430 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1969 "parse.tab.cpp"
+#line 1994 "parse.tab.cpp"
     break;
 
-  case 86: /* bitwise_or_expression: bitwise_or_expression TOK_BITWISE_OR bitwise_xor_expression  */
-#line 424 "parse_buildast.y"
+  case 90: /* bitwise_or_expression: bitwise_or_expression TOK_BITWISE_OR bitwise_xor_expression  */
+#line 432 "parse_buildast.y"
     { (yyval.node) = new Node(AST_BINARY_EXPRESSION, {(yyvsp[-1].node), (yyvsp[-2].node), (yyvsp[0].node)}); }
-#line 1975 "parse.tab.cpp"
+#line 2000 "parse.tab.cpp"
     break;
 
-  case 87: /* bitwise_xor_expression: bitwise_and_expression  */
-#line 429 "parse_buildast.y"
+  case 91: /* bitwise_xor_expression: bitwise_and_expression  */
+#line 437 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1981 "parse.tab.cpp"
+#line 2006 "parse.tab.cpp"
     break;
 
-  case 88: /* bitwise_xor_expression: bitwise_xor_expression TOK_BITWISE_XOR bitwise_and_expression  */
-#line 431 "parse_buildast.y"
+  case 92: /* bitwise_xor_expression: bitwise_xor_expression TOK_BITWISE_XOR bitwise_and_expression  */
+#line 439 "parse_buildast.y"
     { (yyval.node) = new Node(AST_BINARY_EXPRESSION, {(yyvsp[-1].node), (yyvsp[-2].node), (yyvsp[0].node)}); }
-#line 1987 "parse.tab.cpp"
+#line 2012 "parse.tab.cpp"
     break;
 
-  case 89: /* bitwise_and_expression: equality_expression  */
-#line 436 "parse_buildast.y"
+  case 93: /* bitwise_and_expression: equality_expression  */
+#line 444 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 1993 "parse.tab.cpp"
+#line 2018 "parse.tab.cpp"
     break;
 
-  case 90: /* bitwise_and_expression: bitwise_and_expression TOK_AMPERSAND equality_expression  */
-#line 438 "parse_buildast.y"
+  case 94: /* bitwise_and_expression: bitwise_and_expression TOK_AMPERSAND equality_expression  */
+#line 446 "parse_buildast.y"
     { (yyval.node) = new Node(AST_BINARY_EXPRESSION, {(yyvsp[-1].node), (yyvsp[-2].node), (yyvsp[0].node)}); }
-#line 1999 "parse.tab.cpp"
+#line 2024 "parse.tab.cpp"
     break;
 
-  case 91: /* equality_expression: relational_expression  */
-#line 443 "parse_buildast.y"
+  case 95: /* equality_expression: relational_expression  */
+#line 451 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 2005 "parse.tab.cpp"
+#line 2030 "parse.tab.cpp"
     break;
 
-  case 92: /* equality_expression: equality_expression TOK_EQUALITY relational_expression  */
-#line 445 "parse_buildast.y"
+  case 96: /* equality_expression: equality_expression TOK_EQUALITY relational_expression  */
+#line 453 "parse_buildast.y"
     { (yyval.node) = new Node(AST_BINARY_EXPRESSION, {(yyvsp[-1].node), (yyvsp[-2].node), (yyvsp[0].node)}); }
-#line 2011 "parse.tab.cpp"
+#line 2036 "parse.tab.cpp"
     break;
 
-  case 93: /* equality_expression: equality_expression TOK_INEQUALITY relational_expression  */
-#line 447 "parse_buildast.y"
+  case 97: /* equality_expression: equality_expression TOK_INEQUALITY relational_expression  */
+#line 455 "parse_buildast.y"
     { (yyval.node) = new Node(AST_BINARY_EXPRESSION, {(yyvsp[-1].node), (yyvsp[-2].node), (yyvsp[0].node)}); }
-#line 2017 "parse.tab.cpp"
+#line 2042 "parse.tab.cpp"
     break;
 
-  case 94: /* relational_expression: shift_expression  */
-#line 452 "parse_buildast.y"
+  case 98: /* relational_expression: shift_expression  */
+#line 460 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 2023 "parse.tab.cpp"
+#line 2048 "parse.tab.cpp"
     break;
 
-  case 95: /* relational_expression: relational_expression relational_op shift_expression  */
-#line 454 "parse_buildast.y"
+  case 99: /* relational_expression: relational_expression relational_op shift_expression  */
+#line 462 "parse_buildast.y"
     { (yyval.node) = new Node(AST_BINARY_EXPRESSION, {(yyvsp[-1].node), (yyvsp[-2].node), (yyvsp[0].node)}); }
-#line 2029 "parse.tab.cpp"
+#line 2054 "parse.tab.cpp"
     break;
 
-  case 96: /* relational_op: TOK_LT  */
-#line 459 "parse_buildast.y"
+  case 100: /* relational_op: TOK_LT  */
+#line 467 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 2035 "parse.tab.cpp"
+#line 2060 "parse.tab.cpp"
     break;
 
-  case 97: /* relational_op: TOK_LTE  */
-#line 461 "parse_buildast.y"
+  case 101: /* relational_op: TOK_LTE  */
+#line 469 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 2041 "parse.tab.cpp"
+#line 2066 "parse.tab.cpp"
     break;
 
-  case 98: /* relational_op: TOK_GT  */
-#line 463 "parse_buildast.y"
+  case 102: /* relational_op: TOK_GT  */
+#line 471 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 2047 "parse.tab.cpp"
+#line 2072 "parse.tab.cpp"
     break;
 
-  case 99: /* relational_op: TOK_GTE  */
-#line 465 "parse_buildast.y"
+  case 103: /* relational_op: TOK_GTE  */
+#line 473 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 2053 "parse.tab.cpp"
+#line 2078 "parse.tab.cpp"
     break;
 
-  case 100: /* shift_expression: additive_expression  */
-#line 470 "parse_buildast.y"
+  case 104: /* shift_expression: additive_expression  */
+#line 478 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 2059 "parse.tab.cpp"
+#line 2084 "parse.tab.cpp"
     break;
 
-  case 101: /* shift_expression: shift_expression TOK_LEFT_SHIFT additive_expression  */
-#line 472 "parse_buildast.y"
+  case 105: /* shift_expression: shift_expression TOK_LEFT_SHIFT additive_expression  */
+#line 480 "parse_buildast.y"
     { (yyval.node) = new Node(AST_BINARY_EXPRESSION, {(yyvsp[-1].node), (yyvsp[-2].node), (yyvsp[0].node)}); }
-#line 2065 "parse.tab.cpp"
+#line 2090 "parse.tab.cpp"
     break;
 
-  case 102: /* shift_expression: shift_expression TOK_RIGHT_SHIFT additive_expression  */
-#line 474 "parse_buildast.y"
+  case 106: /* shift_expression: shift_expression TOK_RIGHT_SHIFT additive_expression  */
+#line 482 "parse_buildast.y"
     { (yyval.node) = new Node(AST_BINARY_EXPRESSION, {(yyvsp[-1].node), (yyvsp[-2].node), (yyvsp[0].node)}); }
-#line 2071 "parse.tab.cpp"
+#line 2096 "parse.tab.cpp"
     break;
 
-  case 103: /* additive_expression: multiplicative_expression  */
-#line 479 "parse_buildast.y"
+  case 107: /* additive_expression: multiplicative_expression  */
+#line 487 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 2077 "parse.tab.cpp"
+#line 2102 "parse.tab.cpp"
     break;
 
-  case 104: /* additive_expression: additive_expression TOK_PLUS multiplicative_expression  */
-#line 481 "parse_buildast.y"
+  case 108: /* additive_expression: additive_expression TOK_PLUS multiplicative_expression  */
+#line 489 "parse_buildast.y"
     { (yyval.node) = new Node(AST_BINARY_EXPRESSION, {(yyvsp[-1].node), (yyvsp[-2].node), (yyvsp[0].node)}); }
-#line 2083 "parse.tab.cpp"
+#line 2108 "parse.tab.cpp"
     break;
 
-  case 105: /* additive_expression: additive_expression TOK_MINUS multiplicative_expression  */
-#line 483 "parse_buildast.y"
+  case 109: /* additive_expression: additive_expression TOK_MINUS multiplicative_expression  */
+#line 491 "parse_buildast.y"
     { (yyval.node) = new Node(AST_BINARY_EXPRESSION, {(yyvsp[-1].node), (yyvsp[-2].node), (yyvsp[0].node)}); }
-#line 2089 "parse.tab.cpp"
+#line 2114 "parse.tab.cpp"
     break;
 
-  case 106: /* multiplicative_expression: cast_expression  */
-#line 488 "parse_buildast.y"
+  case 110: /* multiplicative_expression: cast_expression  */
+#line 496 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 2095 "parse.tab.cpp"
+#line 2120 "parse.tab.cpp"
     break;
 
-  case 107: /* multiplicative_expression: multiplicative_expression TOK_ASTERISK cast_expression  */
-#line 490 "parse_buildast.y"
+  case 111: /* multiplicative_expression: multiplicative_expression TOK_ASTERISK cast_expression  */
+#line 498 "parse_buildast.y"
     { (yyval.node) = new Node(AST_BINARY_EXPRESSION, {(yyvsp[-1].node), (yyvsp[-2].node), (yyvsp[0].node)}); }
-#line 2101 "parse.tab.cpp"
+#line 2126 "parse.tab.cpp"
     break;
 
-  case 108: /* multiplicative_expression: multiplicative_expression TOK_DIVIDE cast_expression  */
-#line 492 "parse_buildast.y"
+  case 112: /* multiplicative_expression: multiplicative_expression TOK_DIVIDE cast_expression  */
+#line 500 "parse_buildast.y"
     { (yyval.node) = new Node(AST_BINARY_EXPRESSION, {(yyvsp[-1].node), (yyvsp[-2].node), (yyvsp[0].node)}); }
-#line 2107 "parse.tab.cpp"
+#line 2132 "parse.tab.cpp"
     break;
 
-  case 109: /* multiplicative_expression: multiplicative_expression TOK_MOD cast_expression  */
-#line 494 "parse_buildast.y"
+  case 113: /* multiplicative_expression: multiplicative_expression TOK_MOD cast_expression  */
+#line 502 "parse_buildast.y"
     { (yyval.node) = new Node(AST_BINARY_EXPRESSION, {(yyvsp[-1].node), (yyvsp[-2].node), (yyvsp[0].node)}); }
-#line 2113 "parse.tab.cpp"
+#line 2138 "parse.tab.cpp"
     break;
 
-  case 110: /* cast_expression: unary_expression  */
-#line 499 "parse_buildast.y"
+  case 114: /* cast_expression: unary_expression  */
+#line 507 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 2119 "parse.tab.cpp"
+#line 2144 "parse.tab.cpp"
     break;
 
-  case 111: /* cast_expression: TOK_LPAREN type TOK_RPAREN cast_expression  */
-#line 501 "parse_buildast.y"
+  case 115: /* cast_expression: TOK_LPAREN type TOK_RPAREN cast_expression  */
+#line 509 "parse_buildast.y"
     { (yyval.node) = new Node(AST_CAST_EXPRESSION, {(yyvsp[-3].node), (yyvsp[-2].node)}); }
-#line 2125 "parse.tab.cpp"
+#line 2150 "parse.tab.cpp"
     break;
 
-  case 112: /* unary_expression: postfix_expression  */
-#line 506 "parse_buildast.y"
+  case 116: /* unary_expression: postfix_expression  */
+#line 514 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 2131 "parse.tab.cpp"
+#line 2156 "parse.tab.cpp"
     break;
 
-  case 113: /* unary_expression: TOK_PLUS cast_expression  */
-#line 508 "parse_buildast.y"
+  case 117: /* unary_expression: TOK_PLUS cast_expression  */
+#line 516 "parse_buildast.y"
     { (yyval.node) = new Node(AST_UNARY_EXPRESSION, {(yyvsp[-1].node), (yyvsp[0].node)}); }
-#line 2137 "parse.tab.cpp"
+#line 2162 "parse.tab.cpp"
     break;
 
-  case 114: /* unary_expression: TOK_MINUS cast_expression  */
-#line 510 "parse_buildast.y"
+  case 118: /* unary_expression: TOK_MINUS cast_expression  */
+#line 518 "parse_buildast.y"
     { (yyval.node) = new Node(AST_UNARY_EXPRESSION, {(yyvsp[-1].node), (yyvsp[0].node)}); }
-#line 2143 "parse.tab.cpp"
+#line 2168 "parse.tab.cpp"
     break;
 
-  case 115: /* unary_expression: TOK_NOT cast_expression  */
-#line 512 "parse_buildast.y"
+  case 119: /* unary_expression: TOK_NOT cast_expression  */
+#line 520 "parse_buildast.y"
     { (yyval.node) = new Node(AST_UNARY_EXPRESSION, {(yyvsp[-1].node), (yyvsp[0].node)}); }
-#line 2149 "parse.tab.cpp"
+#line 2174 "parse.tab.cpp"
     break;
 
-  case 116: /* unary_expression: TOK_BITWISE_COMPL cast_expression  */
-#line 514 "parse_buildast.y"
+  case 120: /* unary_expression: TOK_BITWISE_COMPL cast_expression  */
+#line 522 "parse_buildast.y"
     { (yyval.node) = new Node(AST_UNARY_EXPRESSION, {(yyvsp[-1].node), (yyvsp[0].node)}); }
-#line 2155 "parse.tab.cpp"
+#line 2180 "parse.tab.cpp"
     break;
 
-  case 117: /* unary_expression: TOK_INCREMENT unary_expression  */
-#line 516 "parse_buildast.y"
+  case 121: /* unary_expression: TOK_INCREMENT unary_expression  */
+#line 524 "parse_buildast.y"
     { (yyval.node) = new Node(AST_UNARY_EXPRESSION, {(yyvsp[-1].node), (yyvsp[0].node)}); }
-#line 2161 "parse.tab.cpp"
+#line 2186 "parse.tab.cpp"
     break;
 
-  case 118: /* unary_expression: TOK_DECREMENT unary_expression  */
-#line 518 "parse_buildast.y"
+  case 122: /* unary_expression: TOK_DECREMENT unary_expression  */
+#line 526 "parse_buildast.y"
     { (yyval.node) = new Node(AST_UNARY_EXPRESSION, {(yyvsp[-1].node), (yyvsp[0].node)}); }
-#line 2167 "parse.tab.cpp"
+#line 2192 "parse.tab.cpp"
     break;
 
-  case 119: /* unary_expression: TOK_ASTERISK unary_expression  */
-#line 520 "parse_buildast.y"
+  case 123: /* unary_expression: TOK_ASTERISK unary_expression  */
+#line 528 "parse_buildast.y"
     { (yyval.node) = new Node(AST_UNARY_EXPRESSION, {(yyvsp[-1].node), (yyvsp[0].node)}); }
-#line 2173 "parse.tab.cpp"
+#line 2198 "parse.tab.cpp"
     break;
 
-  case 120: /* unary_expression: TOK_AMPERSAND unary_expression  */
-#line 522 "parse_buildast.y"
+  case 124: /* unary_expression: TOK_AMPERSAND unary_expression  */
+#line 530 "parse_buildast.y"
     { (yyval.node) = new Node(AST_UNARY_EXPRESSION, {(yyvsp[-1].node), (yyvsp[0].node)}); }
-#line 2179 "parse.tab.cpp"
+#line 2204 "parse.tab.cpp"
     break;
 
-  case 121: /* postfix_expression: primary_expression  */
-#line 535 "parse_buildast.y"
+  case 125: /* postfix_expression: primary_expression  */
+#line 543 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); }
-#line 2185 "parse.tab.cpp"
+#line 2210 "parse.tab.cpp"
     break;
 
-  case 122: /* postfix_expression: postfix_expression TOK_INCREMENT  */
-#line 537 "parse_buildast.y"
+  case 126: /* postfix_expression: postfix_expression TOK_INCREMENT  */
+#line 545 "parse_buildast.y"
     { (yyval.node) = new Node(AST_POSTFIX_EXPRESSION, {(yyvsp[0].node), (yyvsp[-1].node)}); }
-#line 2191 "parse.tab.cpp"
+#line 2216 "parse.tab.cpp"
     break;
 
-  case 123: /* postfix_expression: postfix_expression TOK_DECREMENT  */
-#line 539 "parse_buildast.y"
+  case 127: /* postfix_expression: postfix_expression TOK_DECREMENT  */
+#line 547 "parse_buildast.y"
     { (yyval.node) = new Node(AST_POSTFIX_EXPRESSION, {(yyvsp[0].node), (yyvsp[-1].node)}); }
-#line 2197 "parse.tab.cpp"
+#line 2222 "parse.tab.cpp"
     break;
 
-  case 124: /* postfix_expression: postfix_expression TOK_LPAREN TOK_RPAREN  */
-#line 541 "parse_buildast.y"
+  case 128: /* postfix_expression: postfix_expression TOK_LPAREN TOK_RPAREN  */
+#line 549 "parse_buildast.y"
     { (yyval.node) = new Node(AST_FUNCTION_CALL_EXPRESSION, {(yyvsp[-2].node), new Node(AST_ARGUMENT_EXPRESSION_LIST)}); }
-#line 2203 "parse.tab.cpp"
+#line 2228 "parse.tab.cpp"
     break;
 
-  case 125: /* postfix_expression: postfix_expression TOK_LPAREN argument_expression_list TOK_RPAREN  */
-#line 543 "parse_buildast.y"
+  case 129: /* postfix_expression: postfix_expression TOK_LPAREN argument_expression_list TOK_RPAREN  */
+#line 551 "parse_buildast.y"
     { (yyval.node) = new Node(AST_FUNCTION_CALL_EXPRESSION, {(yyvsp[-3].node), (yyvsp[-1].node)}); }
-#line 2209 "parse.tab.cpp"
+#line 2234 "parse.tab.cpp"
     break;
 
-  case 126: /* postfix_expression: postfix_expression TOK_DOT TOK_IDENT  */
-#line 545 "parse_buildast.y"
+  case 130: /* postfix_expression: postfix_expression TOK_DOT TOK_IDENT  */
+#line 553 "parse_buildast.y"
     { (yyval.node) = new Node(AST_FIELD_REF_EXPRESSION, {(yyvsp[-2].node), (yyvsp[0].node)}); }
-#line 2215 "parse.tab.cpp"
+#line 2240 "parse.tab.cpp"
     break;
 
-  case 127: /* postfix_expression: postfix_expression TOK_ARROW TOK_IDENT  */
-#line 547 "parse_buildast.y"
+  case 131: /* postfix_expression: postfix_expression TOK_ARROW TOK_IDENT  */
+#line 555 "parse_buildast.y"
     { (yyval.node) = new Node(AST_INDIRECT_FIELD_REF_EXPRESSION, {(yyvsp[-2].node), (yyvsp[0].node)}); }
-#line 2221 "parse.tab.cpp"
+#line 2246 "parse.tab.cpp"
     break;
 
-  case 128: /* postfix_expression: postfix_expression TOK_LBRACKET assignment_expression TOK_RBRACKET  */
-#line 549 "parse_buildast.y"
+  case 132: /* postfix_expression: postfix_expression TOK_LBRACKET assignment_expression TOK_RBRACKET  */
+#line 557 "parse_buildast.y"
     { (yyval.node) = new Node(AST_ARRAY_ELEMENT_REF_EXPRESSION, {(yyvsp[-3].node), (yyvsp[-1].node)}); }
-#line 2227 "parse.tab.cpp"
+#line 2252 "parse.tab.cpp"
     break;
 
-  case 129: /* argument_expression_list: assignment_expression  */
-#line 554 "parse_buildast.y"
+  case 133: /* argument_expression_list: assignment_expression  */
+#line 562 "parse_buildast.y"
     { (yyval.node) = new Node(AST_ARGUMENT_EXPRESSION_LIST, {(yyvsp[0].node)}); }
-#line 2233 "parse.tab.cpp"
+#line 2258 "parse.tab.cpp"
     break;
 
-  case 130: /* argument_expression_list: assignment_expression TOK_COMMA argument_expression_list  */
-#line 556 "parse_buildast.y"
+  case 134: /* argument_expression_list: assignment_expression TOK_COMMA argument_expression_list  */
+#line 564 "parse_buildast.y"
     { (yyval.node) = (yyvsp[0].node); (yyval.node)->prepend_kid((yyvsp[-2].node)); }
-#line 2239 "parse.tab.cpp"
+#line 2264 "parse.tab.cpp"
     break;
 
-  case 131: /* primary_expression: TOK_INT_LIT  */
-#line 561 "parse_buildast.y"
+  case 135: /* primary_expression: TOK_INT_LIT  */
+#line 569 "parse_buildast.y"
     { (yyval.node) = new Node(AST_LITERAL_VALUE, {(yyvsp[0].node)}); }
-#line 2245 "parse.tab.cpp"
+#line 2270 "parse.tab.cpp"
     break;
 
-  case 132: /* primary_expression: TOK_CHAR_LIT  */
-#line 563 "parse_buildast.y"
+  case 136: /* primary_expression: TOK_CHAR_LIT  */
+#line 571 "parse_buildast.y"
     { (yyval.node) = new Node(AST_LITERAL_VALUE, {(yyvsp[0].node)}); }
-#line 2251 "parse.tab.cpp"
+#line 2276 "parse.tab.cpp"
     break;
 
-  case 133: /* primary_expression: TOK_FP_LIT  */
-#line 565 "parse_buildast.y"
+  case 137: /* primary_expression: TOK_FP_LIT  */
+#line 573 "parse_buildast.y"
     { (yyval.node) = new Node(AST_LITERAL_VALUE, {(yyvsp[0].node)}); }
-#line 2257 "parse.tab.cpp"
+#line 2282 "parse.tab.cpp"
     break;
 
-  case 134: /* primary_expression: TOK_STR_LIT  */
-#line 567 "parse_buildast.y"
+  case 138: /* primary_expression: TOK_STR_LIT  */
+#line 575 "parse_buildast.y"
     { (yyval.node) = new Node(AST_LITERAL_VALUE, {(yyvsp[0].node)}); }
-#line 2263 "parse.tab.cpp"
+#line 2288 "parse.tab.cpp"
     break;
 
-  case 135: /* primary_expression: TOK_IDENT  */
-#line 569 "parse_buildast.y"
+  case 139: /* primary_expression: TOK_IDENT  */
+#line 577 "parse_buildast.y"
     { (yyval.node) = new Node(AST_VARIABLE_REF, {(yyvsp[0].node)}); }
-#line 2269 "parse.tab.cpp"
+#line 2294 "parse.tab.cpp"
     break;
 
-  case 136: /* primary_expression: TOK_LPAREN assignment_expression TOK_RPAREN  */
-#line 571 "parse_buildast.y"
+  case 140: /* primary_expression: TOK_LPAREN assignment_expression TOK_RPAREN  */
+#line 579 "parse_buildast.y"
     { (yyval.node) = (yyvsp[-1].node); }
-#line 2275 "parse.tab.cpp"
+#line 2300 "parse.tab.cpp"
     break;
 
 
-#line 2279 "parse.tab.cpp"
+#line 2304 "parse.tab.cpp"
 
       default: break;
     }
@@ -2468,5 +2493,5 @@ yyreturnlab:
   return yyresult;
 }
 
-#line 574 "parse_buildast.y"
+#line 582 "parse_buildast.y"
 
@@ -106,31 +106,32 @@ extern int yydebug;
     TOK_DO = 307,                  /* TOK_DO  */
     TOK_SWITCH = 308,              /* TOK_SWITCH  */
     TOK_CASE = 309,                /* TOK_CASE  */
-    TOK_CHAR = 310,                /* TOK_CHAR  */
-    TOK_SHORT = 311,               /* TOK_SHORT  */
-    TOK_INT = 312,                 /* TOK_INT  */
-    TOK_LONG = 313,                /* TOK_LONG  */
-    TOK_UNSIGNED = 314,            /* TOK_UNSIGNED  */
-    TOK_SIGNED = 315,              /* TOK_SIGNED  */
-    TOK_FLOAT = 316,               /* TOK_FLOAT  */
-    TOK_DOUBLE = 317,              /* TOK_DOUBLE  */
-    TOK_VOID = 318,                /* TOK_VOID  */
-    TOK_RETURN = 319,              /* TOK_RETURN  */
-    TOK_BREAK = 320,               /* TOK_BREAK  */
-    TOK_CONTINUE = 321,            /* TOK_CONTINUE  */
-    TOK_CONST = 322,               /* TOK_CONST  */
-    TOK_VOLATILE = 323,            /* TOK_VOLATILE  */
-    TOK_STRUCT = 324,              /* TOK_STRUCT  */
-    TOK_UNION = 325,               /* TOK_UNION  */
-    TOK_UNSPECIFIED_STORAGE = 326, /* TOK_UNSPECIFIED_STORAGE  */
-    TOK_STATIC = 327,              /* TOK_STATIC  */
-    TOK_EXTERN = 328,              /* TOK_EXTERN  */
-    TOK_AUTO = 329,                /* TOK_AUTO  */
-    TOK_IDENT = 330,               /* TOK_IDENT  */
-    TOK_STR_LIT = 331,             /* TOK_STR_LIT  */
-    TOK_CHAR_LIT = 332,            /* TOK_CHAR_LIT  */
-    TOK_INT_LIT = 333,             /* TOK_INT_LIT  */
-    TOK_FP_LIT = 334               /* TOK_FP_LIT  */
+    TOK_DEFAULT = 310,             /* TOK_DEFAULT  */
+    TOK_CHAR = 311,                /* TOK_CHAR  */
+    TOK_SHORT = 312,               /* TOK_SHORT  */
+    TOK_INT = 313,                 /* TOK_INT  */
+    TOK_LONG = 314,                /* TOK_LONG  */
+    TOK_UNSIGNED = 315,            /* TOK_UNSIGNED  */
+    TOK_SIGNED = 316,              /* TOK_SIGNED  */
+    TOK_FLOAT = 317,               /* TOK_FLOAT  */
+    TOK_DOUBLE = 318,              /* TOK_DOUBLE  */
+    TOK_VOID = 319,                /* TOK_VOID  */
+    TOK_RETURN = 320,              /* TOK_RETURN  */
+    TOK_BREAK = 321,               /* TOK_BREAK  */
+    TOK_CONTINUE = 322,            /* TOK_CONTINUE  */
+    TOK_CONST = 323,               /* TOK_CONST  */
+    TOK_VOLATILE = 324,            /* TOK_VOLATILE  */
+    TOK_STRUCT = 325,              /* TOK_STRUCT  */
+    TOK_UNION = 326,               /* TOK_UNION  */
+    TOK_UNSPECIFIED_STORAGE = 327, /* TOK_UNSPECIFIED_STORAGE  */
+    TOK_STATIC = 328,              /* TOK_STATIC  */
+    TOK_EXTERN = 329,              /* TOK_EXTERN  */
+    TOK_AUTO = 330,                /* TOK_AUTO  */
+    TOK_IDENT = 331,               /* TOK_IDENT  */
+    TOK_STR_LIT = 332,             /* TOK_STR_LIT  */
+    TOK_CHAR_LIT = 333,            /* TOK_CHAR_LIT  */
+    TOK_INT_LIT = 334,             /* TOK_INT_LIT  */
+    TOK_FP_LIT = 335               /* TOK_FP_LIT  */
   };
   typedef enum yytokentype yytoken_kind_t;
 #endif
@@ -143,7 +144,7 @@ union YYSTYPE
 
   Node *node;
 
-#line 147 "parse.tab.h"
+#line 148 "parse.tab.h"
 
 };
 typedef union YYSTYPE YYSTYPE;
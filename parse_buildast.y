@@ -97,7 +97,7 @@ namespace {
 %token<node> TOK_SUB_ASSIGN TOK_LEFT_ASSIGN TOK_RIGHT_ASSIGN TOK_AND_ASSIGN TOK_XOR_ASSIGN
 %token<node> TOK_OR_ASSIGN
 
-%token<node> TOK_IF TOK_ELSE TOK_WHILE TOK_FOR TOK_DO TOK_SWITCH TOK_CASE
+%token<node> TOK_IF TOK_ELSE TOK_WHILE TOK_FOR TOK_DO TOK_SWITCH TOK_CASE TOK_DEFAULT
 %token<node> TOK_CHAR TOK_SHORT TOK_INT TOK_LONG TOK_UNSIGNED TOK_SIGNED
 %token<node> TOK_FLOAT TOK_DOUBLE
 %token<node> TOK_VOID
@@ -324,6 +324,14 @@ statement
     { $$ = new Node(AST_IF_STATEMENT, {$3, $5}); }
   | TOK_IF TOK_LPAREN assignment_expression TOK_RPAREN statement TOK_ELSE statement
     { $$ = new Node(AST_IF_ELSE_STATEMENT, {$3, $5, $7}); }
+  | TOK_SWITCH TOK_LPAREN assignment_expression TOK_RPAREN statement
+    { $$ = new Node(AST_SWITCH_STATEMENT, {$3, $5}); }
+  | TOK_CASE conditional_expression TOK_COLON statement
+    { $$ = new Node(AST_CASE_STATEMENT, {$2, $4}); }
+  | TOK_DEFAULT TOK_COLON statement
+    { $$ = new Node(AST_DEFAULT_STATEMENT, {$3}); }
+  | TOK_BREAK TOK_SEMICOLON
+    { $$ = new Node(AST_BREAK_STATEMENT); $$->set_loc($1->get_loc()); }
   ;
 
 struct_type_definition
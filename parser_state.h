@@ -23,6 +23,7 @@
 
 #include <vector>
 #include "location.h"
+#include "source_buffer.h"
 class Node;
 
 struct ParserState {
@@ -30,6 +31,10 @@ struct ParserState {
   // yyscan_t is just a typedef for void *
   void *scan_info;
 
+  // the source file being scanned; tokens refer to their
+  // lexemes by offset into its contents
+  SourceBuffer *source;
+
   // current location (used by lexer)
   Location cur_loc;
 
@@ -41,7 +46,7 @@ struct ParserState {
   // into the tree built by the parser.
   std::vector<Node *> tokens;
 
-  ParserState() : scan_info(nullptr), parse_tree(nullptr) { }
+  ParserState() : scan_info(nullptr), source(nullptr), parse_tree(nullptr) { }
 };
 
 #endif // PARSER_STATE_H
@@ -0,0 +1,151 @@
+#! /usr/bin/env ruby
+
+# Measure the performance of the code generated for a set of test
+# programs. Each program is compiled with and without -o, assembled
+# and linked with gcc, and run several times under perf_run (which
+# reads the hardware performance counters). For each build, the
+# median cycles, instructions retired and time stamp counter ticks
+# are reported, along with the number of instructions generated for
+# each function.
+#
+# The results are written to perf_out/perf.json. If a baseline file
+# exists, the results are compared against it, and the harness fails
+# if the generated code got worse by more than the threshold: either
+# more instructions retired at run time, or more instructions
+# generated for some function. (Cycles and ticks are reported, but
+# are too noisy to fail on.) The harness also fails if a program's
+# exit status or output differs between the two builds.
+#
+# Usage: ./perf_harness.rb [options] program.c...
+#   -n N      runs per binary (default 5)
+#   -b FILE   baseline to compare with (default perf_baseline.json)
+#   -t PCT    allowed regression in percent (default 2)
+#   -w        write the results as the new baseline
+
+require 'json'
+require 'fileutils'
+require 'optparse'
+require 'open3'
+
+opts = { runs: 5, baseline: 'perf_baseline.json', threshold: 2.0, write_baseline: false }
+OptionParser.new do |p|
+  p.on('-n N', Integer) { |n| opts[:runs] = n }
+  p.on('-b FILE') { |f| opts[:baseline] = f }
+  p.on('-t PCT', Float) { |t| opts[:threshold] = t }
+  p.on('-w') { opts[:write_baseline] = true }
+end.parse!
+
+OUT_DIR = 'perf_out'
+COMPILER = './nearly_cc'
+PERF_RUN = './perf_run'
+
+def median(values)
+  sorted = values.sort
+  sorted[sorted.size / 2]
+end
+
+def run(*cmd)
+  output, status = Open3.capture2e(*cmd)
+  raise "#{cmd.join(' ')} failed:\n#{output}" unless status.success?
+  output
+end
+
+# Count the instructions generated for each function in an assembly
+# file: every line in a function which isn't a label or a directive
+def count_instructions(asm_file)
+  counts = {}
+  globals = []
+  current = nil
+  File.readlines(asm_file).each do |line|
+    if line =~ /^\s*\.globl\s+(\S+)/
+      globals << $1
+    elsif line =~ /^(\S+):/
+      current = $1 if globals.include?($1)
+    elsif line =~ /^\s*\.section/
+      current = nil
+    elsif current && line =~ /^\s+[a-z]/
+      counts[current] = (counts[current] || 0) + 1
+    end
+  end
+  counts
+end
+
+# Run a binary several times, returning its medians, exit status
+# and output
+def measure(binary, runs)
+  samples = []
+  status = nil
+  output = nil
+  runs.times do
+    out, err, _ = Open3.capture3(PERF_RUN, binary)
+    line = err.lines.find { |l| l.start_with?('perf_run:') }
+    raise "#{binary}: no result from perf_run:\n#{err}" if line.nil?
+    fields = Hash[line.scan(/(\w+)=(-?\d+)/).map { |k, v| [k, v.to_i] }]
+    status = fields['status']
+    output = out
+    samples << fields
+  end
+  result = { 'status' => status }
+  %w(cycles instructions tsc).each do |counter|
+    value = median(samples.map { |s| s[counter] })
+    result[counter] = value < 0 ? nil : value
+  end
+  [result, output]
+end
+
+FileUtils.mkdir_p(OUT_DIR)
+failures = []
+results = {}
+
+ARGV.each do |src|
+  name = File.basename(src, '.c')
+  outputs = {}
+  [['', []], ['-o', ['-o']]].each do |suffix, flags|
+    asm_file = File.join(OUT_DIR, "#{name}#{suffix}.s")
+    binary = File.join(OUT_DIR, "#{name}#{suffix}")
+    run(COMPILER, *flags, '-f', asm_file, src)
+    run('gcc', '-no-pie', '-o', binary, asm_file)
+
+    result, outputs[suffix] = measure(binary, opts[:runs])
+    result['functions'] = count_instructions(asm_file)
+    results["#{name}#{suffix}"] = result
+
+    fmt = ->(v) { v.nil? ? '-' : v.to_s }
+    printf("%-20s status=%-3d cycles=%-12s instructions=%-12s tsc=%-12s generated=%d\n",
+           "#{name}#{suffix}", result['status'], fmt.(result['cycles']),
+           fmt.(result['instructions']), fmt.(result['tsc']), result['functions'].values.sum)
+  end
+
+  unreliable = results[name]['status'] != results["#{name}-o"]['status'] || outputs[''] != outputs['-o']
+  failures << "#{name}: optimized program behaves differently" if unreliable
+end
+
+File.open(File.join(OUT_DIR, 'perf.json'), 'w') { |f| f.puts(JSON.pretty_generate(results)) }
+
+if opts[:write_baseline]
+  File.open(opts[:baseline], 'w') { |f| f.puts(JSON.pretty_generate(results)) }
+  puts "Baseline written to #{opts[:baseline]}"
+elsif File.exist?(opts[:baseline])
+  baseline = JSON.parse(File.read(opts[:baseline]))
+  limit = 1.0 + opts[:threshold] / 100.0
+  results.each do |build, result|
+    base = baseline[build]
+    next if base.nil?
+    if result['instructions'] && base['instructions'] && result['instructions'] > base['instructions'] * limit
+      failures << "#{build}: #{result['instructions']} instructions retired, was #{base['instructions']}"
+    end
+    result['functions'].each do |fn, count|
+      old = base['functions'][fn]
+      if old && count > old * limit
+        failures << "#{build}: #{fn} has #{count} instructions, was #{old}"
+      end
+    end
+  end
+end
+
+if failures.empty?
+  puts 'OK'
+else
+  puts failures
+  exit 1
+end
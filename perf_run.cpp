@@ -0,0 +1,110 @@
+// perf_run: run a program once, and report how many cycles and
+// instructions it took (using the hardware performance counters, via
+// perf_event_open) along with the elapsed time stamp counter ticks.
+//
+// Usage: perf_run <program> [args...]
+//
+// The program's stdin/stdout/stderr are passed through. When it exits,
+// a single line of the form
+//
+//   perf_run: status=<n> cycles=<n> instructions=<n> tsc=<n>
+//
+// is printed on stderr. cycles and instructions are -1 if the counters
+// aren't available (e.g., because of the kernel's perf_event_paranoid
+// setting, or in a virtual machine without a PMU). The counters only
+// count user-mode execution of the program itself, starting at exec;
+// the tsc count also includes the time to start it.
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <linux/perf_event.h>
+#include <x86intrin.h>
+
+namespace{
+
+  // open a counter for the given process, which starts counting
+  // when the process calls exec
+  int open_counter(pid_t pid, uint64_t config){
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.enable_on_exec = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return int(syscall(SYS_perf_event_open, &attr, pid, -1, -1, 0));
+  }
+
+  long long read_counter(int fd){
+    uint64_t value;
+    if(fd < 0 || read(fd, &value, sizeof(value)) != sizeof(value)){
+      return -1;
+    }
+    return (long long) value;
+  }
+
+}
+
+int main(int argc, char** argv){
+  if(argc < 2){
+    fprintf(stderr, "Usage: perf_run <program> [args...]\n");
+    return 1;
+  }
+
+  // the child waits until the counters are set up before calling exec
+  int go[2];
+  if(pipe(go) != 0){
+    perror("pipe");
+    return 1;
+  }
+
+  pid_t pid = fork();
+  if(pid < 0){
+    perror("fork");
+    return 1;
+  }
+  if(pid == 0){
+    char c;
+    close(go[1]);
+    if(read(go[0], &c, 1) != 1){
+      _exit(127);
+    }
+    close(go[0]);
+    execv(argv[1], argv + 1);
+    perror(argv[1]);
+    _exit(127);
+  }
+
+  close(go[0]);
+  int cycles_fd = open_counter(pid, PERF_COUNT_HW_CPU_CYCLES);
+  int instructions_fd = open_counter(pid, PERF_COUNT_HW_INSTRUCTIONS);
+
+  uint64_t start = __rdtsc();
+  if(write(go[1], "x", 1) != 1){
+    perror("write");
+  }
+  close(go[1]);
+
+  int status;
+  if(waitpid(pid, &status, 0) < 0){
+    perror("waitpid");
+    return 1;
+  }
+  uint64_t ticks = __rdtsc() - start;
+
+  int exit_status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+  fprintf(stderr, "perf_run: status=%d cycles=%lld instructions=%lld tsc=%llu\n",
+          exit_status, read_counter(cycles_fd), read_counter(instructions_fd),
+          (unsigned long long) ticks);
+
+  if(cycles_fd >= 0) close(cycles_fd);
+  if(instructions_fd >= 0) close(instructions_fd);
+  return 0;
+}
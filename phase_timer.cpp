@@ -0,0 +1,199 @@
+#include <chrono>
+#include <ctime>
+#include <vector>
+#include <sys/resource.h>
+#include "phase_timer.h"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct PhaseStats {
+  double seconds;
+  double cpu_seconds;
+  long rss_growth_kb;
+  unsigned long objects[NUM_COUNTED_OBJECTS];
+};
+
+struct TraceEvent {
+  char type;          // 'B' or 'E'
+  Phase phase;
+  double timestamp;   // microseconds since enable()
+};
+
+// the phase which is current, and the phase which was made current by
+// the most recent PhaseScope (which differ while a FineGrainedPhaseScope
+// is active)
+Phase g_current = Phase::OTHER;
+Phase g_coarse = Phase::OTHER;
+
+bool g_stats = false;
+bool g_trace = false;
+Clock::time_point g_start;
+Clock::time_point g_since;
+double g_cpu_since;
+long g_rss_since;
+unsigned long g_objects_since[NUM_COUNTED_OBJECTS];
+PhaseStats g_phases[NUM_PHASES];
+std::vector<TraceEvent> g_trace_events;
+
+const char *const PHASE_NAMES[NUM_PHASES] = {
+  "other",
+  "scan",
+  "parse",
+  "analyze",
+  "hl_codegen",
+  "optimize",
+  "ll_codegen",
+  "print",
+};
+
+double get_cpu_seconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return double(ts.tv_sec) + double(ts.tv_nsec) * 1e-9;
+}
+
+long get_peak_rss_kb() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+}
+
+bool PhaseTimer::s_enabled = false;
+unsigned long PhaseTimer::s_object_counts[NUM_COUNTED_OBJECTS];
+
+void PhaseTimer::enable() {
+  s_enabled = true;
+  g_current = g_coarse = Phase::OTHER;
+  g_start = g_since = Clock::now();
+  g_cpu_since = get_cpu_seconds();
+  g_rss_since = get_peak_rss_kb();
+  for (int i = 0; i < NUM_COUNTED_OBJECTS; i++) {
+    g_objects_since[i] = s_object_counts[i];
+  }
+}
+
+void PhaseTimer::enable_stats(bool trace) {
+  g_stats = true;
+  g_trace = g_trace || trace;
+  if (!s_enabled) {
+    enable();
+  }
+}
+
+void PhaseTimer::trace_begin(Phase phase) {
+  if (g_trace) {
+    std::chrono::duration<double, std::micro> ts = Clock::now() - g_start;
+    g_trace_events.push_back({ 'B', phase, ts.count() });
+  }
+}
+
+void PhaseTimer::trace_end(Phase phase) {
+  if (g_trace) {
+    std::chrono::duration<double, std::micro> ts = Clock::now() - g_start;
+    g_trace_events.push_back({ 'E', phase, ts.count() });
+  }
+}
+
+void PhaseTimer::stop() {
+  if (s_enabled) {
+    switch_to_slow(Phase::OTHER, false);
+  }
+}
+
+double PhaseTimer::get_seconds(Phase phase) {
+  return g_phases[int(phase)].seconds;
+}
+
+double PhaseTimer::get_total_seconds() {
+  double total = 0.0;
+  for (int i = 0; i < NUM_PHASES; i++) {
+    total += g_phases[i].seconds;
+  }
+  return total;
+}
+
+const char *PhaseTimer::get_name(Phase phase) {
+  return PHASE_NAMES[int(phase)];
+}
+
+void PhaseTimer::print(FILE *out) {
+  fprintf(out, "phase,seconds\n");
+  for (int i = 0; i < NUM_PHASES; i++) {
+    fprintf(out, "%s,%.6f\n", PHASE_NAMES[i], g_phases[i].seconds);
+  }
+  fprintf(out, "total,%.6f\n", get_total_seconds());
+}
+
+void PhaseTimer::print_stats(FILE *out) {
+  fprintf(out, "%-12s %10s %10s %10s %10s %10s %10s %12s %10s\n",
+          "phase", "wall ms", "cpu ms", "rss +KB",
+          "nodes", "symbols", "types", "instructions", "blocks");
+
+  PhaseStats total = PhaseStats();
+  for (int i = 0; i <= NUM_PHASES; i++) {
+    const PhaseStats &s = (i < NUM_PHASES) ? g_phases[i] : total;
+    fprintf(out, "%-12s %10.3f %10.3f %10ld",
+            i < NUM_PHASES ? PHASE_NAMES[i] : "total",
+            s.seconds * 1000.0, s.cpu_seconds * 1000.0, s.rss_growth_kb);
+    fprintf(out, " %10lu %10lu %10lu %12lu %10lu\n",
+            s.objects[int(CountedObject::NODE)],
+            s.objects[int(CountedObject::SYMBOL)],
+            s.objects[int(CountedObject::TYPE)],
+            s.objects[int(CountedObject::INSTRUCTION)],
+            s.objects[int(CountedObject::BASIC_BLOCK)]);
+
+    if (i < NUM_PHASES) {
+      total.seconds += s.seconds;
+      total.cpu_seconds += s.cpu_seconds;
+      total.rss_growth_kb += s.rss_growth_kb;
+      for (int j = 0; j < NUM_COUNTED_OBJECTS; j++) {
+        total.objects[j] += s.objects[j];
+      }
+    }
+  }
+}
+
+void PhaseTimer::write_trace(FILE *out) {
+  fprintf(out, "{\"traceEvents\":[\n");
+  for (size_t i = 0; i < g_trace_events.size(); i++) {
+    const TraceEvent &e = g_trace_events[i];
+    fprintf(out, "{\"name\":\"%s\",\"cat\":\"phase\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":1}%s\n",
+            PHASE_NAMES[int(e.phase)], e.type, e.timestamp,
+            i + 1 < g_trace_events.size() ? "," : "");
+  }
+  fprintf(out, "],\"displayTimeUnit\":\"ms\"}\n");
+}
+
+Phase PhaseTimer::switch_to_slow(Phase phase, bool fine_grained) {
+  Clock::time_point now = Clock::now();
+  std::chrono::duration<double> elapsed = now - g_since;
+  PhaseStats &cur = g_phases[int(g_current)];
+  cur.seconds += elapsed.count();
+  g_since = now;
+
+  for (int i = 0; i < NUM_COUNTED_OBJECTS; i++) {
+    cur.objects[i] += s_object_counts[i] - g_objects_since[i];
+    g_objects_since[i] = s_object_counts[i];
+  }
+
+  if (!fine_grained) {
+    if (g_stats) {
+      double cpu = get_cpu_seconds();
+      long rss = get_peak_rss_kb();
+      PhaseStats &coarse = g_phases[int(g_coarse)];
+      coarse.cpu_seconds += cpu - g_cpu_since;
+      coarse.rss_growth_kb += rss - g_rss_since;
+      g_cpu_since = cpu;
+      g_rss_since = rss;
+    }
+    g_coarse = phase;
+  }
+
+  Phase prev = g_current;
+  g_current = phase;
+  return prev;
+}
@@ -0,0 +1,131 @@
+#ifndef PHASE_TIMER_H
+#define PHASE_TIMER_H
+
+#include <cstdio>
+
+// Phases of compilation whose running time can be measured
+enum class Phase {
+  OTHER,        // anything not covered by one of the phases below
+  SCAN,
+  PARSE,
+  ANALYZE,
+  HL_CODEGEN,
+  OPTIMIZE,
+  LL_CODEGEN,
+  PRINT,
+};
+
+const int NUM_PHASES = int(Phase::PRINT) + 1;
+
+// Kinds of objects whose allocations are counted
+enum class CountedObject {
+  NODE,
+  SYMBOL,
+  TYPE,
+  INSTRUCTION,
+  BASIC_BLOCK,
+};
+
+const int NUM_COUNTED_OBJECTS = int(CountedObject::BASIC_BLOCK) + 1;
+
+// PhaseTimer measures how much wall time is spent in each phase of
+// compilation. At any point exactly one phase is current, and time is
+// charged to it until another phase becomes current, so nested phases
+// (e.g., scanning while parsing) are measured exclusively.
+//
+// Timing is off unless enable() is called, in which case switching
+// phases costs a call to the clock; otherwise it is just a test of a
+// flag. With enable_stats(), each phase is also charged with the CPU
+// time, growth in peak RSS, and the objects allocated while it is
+// current, and (optionally) a Chrome trace of the phases is recorded.
+// Since these cost system calls, they are only measured when a
+// PhaseScope begins or ends, not a FineGrainedPhaseScope.
+class PhaseTimer {
+private:
+  static bool s_enabled;
+  static unsigned long s_object_counts[NUM_COUNTED_OBJECTS];
+
+public:
+  static void enable();
+  static void enable_stats(bool trace);
+  static bool is_enabled() { return s_enabled; }
+
+  // make the given phase current, returning the previously current phase
+  static Phase switch_to(Phase phase) {
+    return s_enabled ? switch_to_slow(phase, false) : phase;
+  }
+  static Phase switch_to_fine_grained(Phase phase) {
+    return s_enabled ? switch_to_slow(phase, true) : phase;
+  }
+
+  // record the beginning or end of a PhaseScope in the trace
+  static void trace_begin(Phase phase);
+  static void trace_end(Phase phase);
+
+  // count the allocation of an object (only while timing is enabled,
+  // since the compile server allocates from several threads)
+  static void count(CountedObject kind) {
+    if (s_enabled) s_object_counts[int(kind)]++;
+  }
+
+  // charge the time up to now to the current phase
+  static void stop();
+
+  static double get_seconds(Phase phase);
+  static double get_total_seconds();
+  static const char *get_name(Phase phase);
+
+  // print the time spent in each phase as CSV
+  static void print(FILE *out);
+
+  // print a table of all of the statistics recorded for each phase
+  static void print_stats(FILE *out);
+
+  // write the recorded trace as Chrome trace event JSON
+  static void write_trace(FILE *out);
+
+private:
+  static Phase switch_to_slow(Phase phase, bool fine_grained);
+};
+
+// PhaseScope makes a phase current for the lifetime of the PhaseScope
+// object, then switches back to the phase that was current before.
+class PhaseScope {
+private:
+  Phase m_phase, m_prev;
+
+  // value semantics are not allowed
+  PhaseScope(const PhaseScope &);
+  PhaseScope &operator=(const PhaseScope &);
+
+public:
+  PhaseScope(Phase phase)
+    : m_phase(phase)
+    , m_prev(PhaseTimer::switch_to(phase)) {
+    if (PhaseTimer::is_enabled()) PhaseTimer::trace_begin(m_phase);
+  }
+
+  ~PhaseScope() {
+    if (PhaseTimer::is_enabled()) PhaseTimer::trace_end(m_phase);
+    PhaseTimer::switch_to(m_prev);
+  }
+};
+
+// FineGrainedPhaseScope is a PhaseScope for code which runs very many
+// times, such as scanning a single token. It only measures wall time
+// and allocations, and doesn't appear in the trace; the CPU time and
+// RSS growth it accounts for are charged to the enclosing PhaseScope.
+class FineGrainedPhaseScope {
+private:
+  Phase m_prev;
+
+  // value semantics are not allowed
+  FineGrainedPhaseScope(const FineGrainedPhaseScope &);
+  FineGrainedPhaseScope &operator=(const FineGrainedPhaseScope &);
+
+public:
+  FineGrainedPhaseScope(Phase phase) : m_prev(PhaseTimer::switch_to_fine_grained(phase)) { }
+  ~FineGrainedPhaseScope() { PhaseTimer::switch_to_fine_grained(m_prev); }
+};
+
+#endif // PHASE_TIMER_H
@@ -9,7 +9,8 @@
 // PrintHighLevelCFG implementation
 ////////////////////////////////////////////////////////////////////////
 
-PrintHighLevelCFG::PrintHighLevelCFG() {
+PrintHighLevelCFG::PrintHighLevelCFG()
+  : PrintCode(stdout) {
 }
 
 PrintHighLevelCFG::~PrintHighLevelCFG() {
@@ -20,6 +21,8 @@ void PrintHighLevelCFG::print_instructions(const std::shared_ptr<InstructionSequ
 
   std::shared_ptr<ControlFlowGraph> hl_cfg = cfg_builder.build();
 
+  // the CFG printers write to stdout directly
+  get_output().flush();
   print_cfg(hl_cfg);
 }
 
@@ -137,7 +140,8 @@ void PrintHighLevelCFGWithLiveness::print_cfg(const std::shared_ptr<ControlFlowG
 // PrintLowLevelCFG implementation
 ////////////////////////////////////////////////////////////////////////
 
-PrintLowLevelCFG::PrintLowLevelCFG() {
+PrintLowLevelCFG::PrintLowLevelCFG()
+  : PrintCode(stdout) {
 }
 
 PrintLowLevelCFG::~PrintLowLevelCFG() {
@@ -146,6 +150,7 @@ PrintLowLevelCFG::~PrintLowLevelCFG() {
 void PrintLowLevelCFG::print_instructions(const std::shared_ptr<InstructionSequence> &iseq) {
   LowLevelControlFlowGraphBuilder ll_cfg_builder(iseq);
   std::shared_ptr<ControlFlowGraph> ll_cfg = ll_cfg_builder.build();
+  get_output().flush();
   print_cfg(ll_cfg);
 }
 
@@ -1,11 +1,14 @@
 #include <cassert>
+#include "instruction.h"
 #include "highlevel_formatter.h"
 #include "print_instruction_seq.h"
 #include "print_highlevel_code.h"
+#include "phase_timer.h"
 
 
-PrintCode::PrintCode()
-  : m_mode(NONE) {
+PrintCode::PrintCode(FILE *out)
+  : m_mode(NONE)
+  , m_out(out) {
 }
 
 PrintCode::~PrintCode() {
@@ -14,24 +17,55 @@ PrintCode::~PrintCode() {
 void PrintCode::collect_string_constant(const std::string &name, const std::string &strval) {
   // FIXME: really, we should encode special characters in the string if there are any
   set_mode(RODATA);
-  printf("\n%s: .string \"%s\"\n", name.c_str(), strval.c_str());
+  m_out.append('\n');
+  m_out.append(name);
+  m_out.append(": .string \"");
+  m_out.append(strval);
+  m_out.append("\"\n");
 }
 
 void PrintCode::collect_global_var(const std::string &name, const std::shared_ptr<Type> &type) {
   set_mode(DATA);
-  printf("\n\t.globl %s\n", name.c_str());
-  printf("\t.align %u\n", type->get_alignment());
-  printf("%s: .space %u\n", name.c_str(), type->get_storage_size());
+  m_out.append("\n\t.globl ");
+  m_out.append(name);
+  m_out.append("\n\t.align ");
+  m_out.append_int(type->get_alignment());
+  m_out.append('\n');
+  m_out.append(name);
+  m_out.append(": .space ");
+  m_out.append_int(type->get_storage_size());
+  m_out.append('\n');
 }
 
 void PrintCode::collect_function(const std::string &name, const std::shared_ptr<InstructionSequence> &iseq) {
+  PhaseScope phase(Phase::PRINT);
   set_mode(CODE);
-  printf("\n\t.globl %s\n", name.c_str());
-  printf("%s:\n", name.c_str());
+  m_out.append("\n\t.globl ");
+  m_out.append(name);
+  m_out.append('\n');
+  m_out.append(name);
+  m_out.append(":\n");
 
   // print_instructions will be overridden by the concrete implementation
   // class to use the appropriate kind of formatter
   print_instructions(iseq);
+
+  // the tables of the function's multiway jumps are read-only data
+  for (auto i = iseq->cbegin(); i != iseq->cend(); i++) {
+    if (!(*i)->has_jump_table()) {
+      continue;
+    }
+    const JumpTable &table = (*i)->get_jump_table();
+    set_mode(RODATA);
+    m_out.append("\t.align 8\n");
+    m_out.append(table.name);
+    m_out.append(":\n");
+    for (const std::string &label : table.labels) {
+      m_out.append("\t.quad ");
+      m_out.append(label);
+      m_out.append('\n');
+    }
+  }
 }
 
 void PrintCode::set_mode(Mode mode) {
@@ -39,15 +73,15 @@ void PrintCode::set_mode(Mode mode) {
 
   switch (mode) {
   case RODATA:
-    printf("\t.section .rodata\n");
+    m_out.append("\t.section .rodata\n");
     break;
 
   case DATA:
-    printf("\t.section .data\n");
+    m_out.append("\t.section .data\n");
     break;
 
   case CODE:
-    printf("\t.section .text\n");
+    m_out.append("\t.section .text\n");
     break;
 
   default:
@@ -1,7 +1,9 @@
 #ifndef PRINT_CODE_H
 #define PRINT_CODE_H
 
+#include <cstdio>
 #include "module_collector.h"
+#include "output_buffer.h"
 
 // Abstract base class for ModuleCollector which print generated code
 class PrintCode : public ModuleCollector {
@@ -10,9 +12,10 @@ private:
     NONE, RODATA, DATA, CODE,
   };
   Mode m_mode;
+  OutputBuffer m_out;
 
 public:
-  PrintCode();
+  PrintCode(FILE *out);
   virtual ~PrintCode();
 
   virtual void collect_string_constant(const std::string &name, const std::string &strval);
@@ -23,6 +26,9 @@ public:
   // or low-level instructions
   virtual void print_instructions(const std::shared_ptr<InstructionSequence> &iseq) = 0;
 
+protected:
+  OutputBuffer &get_output() { return m_out; }
+
 private:
   void set_mode(Mode mode);
 };
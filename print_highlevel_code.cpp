@@ -3,7 +3,8 @@
 #include "print_instruction_seq.h"
 #include "print_highlevel_code.h"
 
-PrintHighLevelCode::PrintHighLevelCode() {
+PrintHighLevelCode::PrintHighLevelCode(FILE *out)
+  : PrintCode(out) {
 }
 
 PrintHighLevelCode::~PrintHighLevelCode() {
@@ -13,5 +14,5 @@ void PrintHighLevelCode::print_instructions(const std::shared_ptr<InstructionSeq
   HighLevelFormatter formatter;
   PrintInstructionSequence print_iseq(&formatter);
 
-  print_iseq.print(iseq.get());
+  print_iseq.print(iseq.get(), get_output());
 }
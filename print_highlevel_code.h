@@ -7,7 +7,7 @@
 // code to stdout for informational/debugging purposes.
 class PrintHighLevelCode : public PrintCode {
 public:
-  PrintHighLevelCode();
+  PrintHighLevelCode(FILE *out);
   virtual ~PrintHighLevelCode();
 
   virtual void print_instructions(const std::shared_ptr<InstructionSequence> &iseq);
@@ -1,6 +1,7 @@
 #include "formatter.h"
 #include "instruction.h"
 #include "instruction_seq.h"
+#include "output_buffer.h"
 #include "print_instruction_seq.h"
 
 PrintInstructionSequence::PrintInstructionSequence(const Formatter *formatter)
@@ -19,3 +20,15 @@ void PrintInstructionSequence::print(const InstructionSequence *iseq) {
     printf("\t%s\n", formatted_ins.c_str());
   }
 }
+
+void PrintInstructionSequence::print(const InstructionSequence *iseq, OutputBuffer &out) {
+  for (auto i = iseq->cbegin(); i != iseq->cend(); i++) {
+    if (i.has_label()) {
+      out.append(i.get_label());
+      out.append(":\n", 2);
+    }
+    out.append('\t');
+    m_formatter->write_instruction(*i, out);
+    out.append('\n');
+  }
+}
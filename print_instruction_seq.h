@@ -3,6 +3,7 @@
 
 class Formatter;
 class InstructionSequence;
+class OutputBuffer;
 
 class PrintInstructionSequence {
 private:
@@ -13,6 +14,7 @@ public:
   ~PrintInstructionSequence();
 
   void print(const InstructionSequence *iseq);
+  void print(const InstructionSequence *iseq, OutputBuffer &out);
 };
 
 #endif // PRINT_INSTRUCTION_SEQ_H
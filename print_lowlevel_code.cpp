@@ -3,7 +3,8 @@
 #include "print_instruction_seq.h"
 #include "print_lowlevel_code.h"
 
-PrintLowLevelCode::PrintLowLevelCode() {
+PrintLowLevelCode::PrintLowLevelCode(FILE *out)
+  : PrintCode(out) {
 }
 
 PrintLowLevelCode::~PrintLowLevelCode() {
@@ -13,5 +14,5 @@ void PrintLowLevelCode::print_instructions(const std::shared_ptr<InstructionSequ
   LowLevelFormatter formatter;
   PrintInstructionSequence print_iseq(&formatter);
 
-  print_iseq.print(iseq.get());
+  print_iseq.print(iseq.get(), get_output());
 }
@@ -7,7 +7,7 @@
 // (x86-64) code
 class PrintLowLevelCode : public PrintCode {
 public:
-  PrintLowLevelCode();
+  PrintLowLevelCode(FILE *out);
   virtual ~PrintLowLevelCode();
 
   virtual void print_instructions(const std::shared_ptr<InstructionSequence> &iseq);
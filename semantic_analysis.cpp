@@ -7,10 +7,170 @@
 #include "node.h"
 #include "ast.h"
 #include "exceptions.h"
+#include "trace_log.h"
 #include "semantic_analysis.h"
 
+namespace{
+
+  // An integer constant, after the integer promotions (so it is always
+  // int or long, signed or unsigned). The value is kept in the range of
+  // its type: unsigned int values are zero-extended, and unsigned long
+  // values are stored as their two's complement bit pattern.
+  struct Constant{
+    int64_t value;
+    bool is_unsigned;
+    bool is_long;
+  };
+
+  int64_t wrap(int64_t value, bool is_unsigned, bool is_long){
+    if(is_long){
+      return value;
+    }
+    return is_unsigned ? int64_t(uint32_t(value)) : int64_t(int32_t(value));
+  }
+
+  bool fits(__int128 value, bool is_long){
+    return is_long ? (value >= INT64_MIN && value <= INT64_MAX) : (value >= INT32_MIN && value <= INT32_MAX);
+  }
+
+  bool get_constant(Node* n, Constant& c){
+    std::shared_ptr<LiteralValue> lit = n->get_lit();
+    if(!lit){
+      return false;
+    }
+    c.is_unsigned = lit->is_unsigned();
+    c.is_long = lit->is_long();
+    c.value = wrap(lit->get_int_value(), c.is_unsigned, c.is_long);
+    return true;
+  }
+
+  // convert to the type of the given constant
+  Constant convert(const Constant& c, bool is_unsigned, bool is_long){
+    return { wrap(c.value, is_unsigned, is_long), is_unsigned, is_long };
+  }
+
+  // Evaluate a binary operator on two constants using the usual
+  // arithmetic conversions. Returns false if the result isn't known at
+  // compile time: signed overflow, division by zero and out of range
+  // shifts are undefined, and are left for the program to run into.
+  bool fold_binary(int tag, Constant a, Constant b, Constant& result){
+    if(tag == TOK_LEFT_SHIFT || tag == TOK_RIGHT_SHIFT){
+      // the result has the type of the left operand
+      int width = a.is_long ? 64 : 32;
+      if((!b.is_unsigned && b.value < 0) || uint64_t(b.value) >= uint64_t(width)){
+        return false;
+      }
+      result = a;
+      if(tag == TOK_RIGHT_SHIFT){
+        result.value = a.is_unsigned ? int64_t(uint64_t(a.value) >> b.value) : (a.value >> b.value);
+      } else if(a.is_unsigned){
+        result.value = wrap(int64_t(uint64_t(a.value) << b.value), true, a.is_long);
+      } else{
+        __int128 shifted = __int128(a.value) << b.value;
+        if(a.value < 0 || !fits(shifted, a.is_long)){
+          return false;
+        }
+        result.value = int64_t(shifted);
+      }
+      return true;
+    }
+    if(tag == TOK_LOGICAL_AND || tag == TOK_LOGICAL_OR){
+      bool value = (tag == TOK_LOGICAL_AND) ? (a.value != 0 && b.value != 0) : (a.value != 0 || b.value != 0);
+      result = { value, false, false };
+      return true;
+    }
+
+    bool is_long = a.is_long || b.is_long;
+    bool is_unsigned = is_long ? ((a.is_long && a.is_unsigned) || (b.is_long && b.is_unsigned))
+                               : (a.is_unsigned || b.is_unsigned);
+    a = convert(a, is_unsigned, is_long);
+    b = convert(b, is_unsigned, is_long);
+
+    if(is_unsigned){
+      uint64_t x = a.value, y = b.value, r;
+      int cmp = (x < y) ? -1 : (x > y);
+      switch(tag){
+        case TOK_PLUS: r = x + y; break;
+        case TOK_MINUS: r = x - y; break;
+        case TOK_ASTERISK: r = x * y; break;
+        case TOK_DIVIDE: if(y == 0){ return false; } r = x / y; break;
+        case TOK_MOD: if(y == 0){ return false; } r = x % y; break;
+        case TOK_AMPERSAND: r = x & y; break;
+        case TOK_BITWISE_OR: r = x | y; break;
+        case TOK_BITWISE_XOR: r = x ^ y; break;
+        case TOK_LT: result = { cmp < 0, false, false }; return true;
+        case TOK_LTE: result = { cmp <= 0, false, false }; return true;
+        case TOK_GT: result = { cmp > 0, false, false }; return true;
+        case TOK_GTE: result = { cmp >= 0, false, false }; return true;
+        case TOK_EQUALITY: result = { cmp == 0, false, false }; return true;
+        case TOK_INEQUALITY: result = { cmp != 0, false, false }; return true;
+        default: return false;
+      }
+      result = { wrap(int64_t(r), true, is_long), true, is_long };
+      return true;
+    }
+
+    __int128 x = a.value, y = b.value, r;
+    switch(tag){
+      case TOK_PLUS: r = x + y; break;
+      case TOK_MINUS: r = x - y; break;
+      case TOK_ASTERISK: r = x * y; break;
+      case TOK_DIVIDE: if(y == 0){ return false; } r = x / y; break;
+      case TOK_MOD: if(y == 0 || !fits(x / y, is_long)){ return false; } r = x % y; break;
+      case TOK_AMPERSAND: r = x & y; break;
+      case TOK_BITWISE_OR: r = x | y; break;
+      case TOK_BITWISE_XOR: r = x ^ y; break;
+      case TOK_LT: result = { x < y, false, false }; return true;
+      case TOK_LTE: result = { x <= y, false, false }; return true;
+      case TOK_GT: result = { x > y, false, false }; return true;
+      case TOK_GTE: result = { x >= y, false, false }; return true;
+      case TOK_EQUALITY: result = { x == y, false, false }; return true;
+      case TOK_INEQUALITY: result = { x != y, false, false }; return true;
+      default: return false;
+    }
+    if(!fits(r, is_long)){
+      return false;
+    }
+    result = { int64_t(r), false, is_long };
+    return true;
+  }
+
+  bool fold_unary(int tag, Constant a, Constant& result){
+    switch(tag){
+      case TOK_MINUS:
+        if(a.is_unsigned){
+          result = { wrap(int64_t(0 - uint64_t(a.value)), true, a.is_long), true, a.is_long };
+          return true;
+        }
+        if(!fits(-__int128(a.value), a.is_long)){
+          return false;
+        }
+        result = { -a.value, false, a.is_long };
+        return true;
+      case TOK_BITWISE_COMPL:
+        result = { wrap(~a.value, a.is_unsigned, a.is_long), a.is_unsigned, a.is_long };
+        return true;
+      case TOK_NOT:
+        result = { a.value == 0, false, false };
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  // Record a folded value on the node; its type becomes that of the
+  // equivalent literal, so later phases treat it as one
+  void set_constant(Node* n, const Constant& c){
+    std::shared_ptr<LiteralValue> lit(new LiteralValue(c.value, c.is_unsigned, c.is_long));
+    n->set_lit(lit);
+    n->set_type(std::shared_ptr<Type>(new BasicType(*lit)));
+  }
+
+}
+
 SemanticAnalysis::SemanticAnalysis()
-  : m_global_symtab(new SymbolTable(nullptr)){
+  : m_global_symtab(new SymbolTable(nullptr))
+  , m_break_depth(0){
   m_cur_symtab = m_global_symtab;
 }
 
@@ -22,9 +182,8 @@ SymbolTable* SemanticAnalysis::get_global_symtab(){
   return m_global_symtab;
 }
 
-int debug = 0;
 void SemanticAnalysis::visit_struct_type(Node* n){
-  if(debug){ puts("visit_struct_type"); }
+  TRACE_EVENT(SEMA, "visit_struct_type", n);
   std::string name = "struct " + n->get_kid(0)->get_str();
   Symbol* target = m_cur_symtab->lookup_recursive_kind(name, SymbolKind::TYPE);
   if(!target){
@@ -38,7 +197,7 @@ void SemanticAnalysis::visit_union_type(Node* n){
 }
 
 void SemanticAnalysis::visit_variable_declaration(Node* n){
-  if(debug){ puts("visit_variable_declaration"); }
+  TRACE_EVENT(SEMA, "visit_variable_declaration", n);
   //kid 0 = storage
   //kid 1 = basic type(char, long, short, int, void, signed, unsigned) list
   //kid 2 = declarator(optional pointer + var name) list
@@ -65,7 +224,7 @@ void SemanticAnalysis::visit_variable_declaration(Node* n){
 }
 
 void SemanticAnalysis::visit_basic_type(Node* n){
-  if(debug){ puts("visit_basic_type"); }
+  TRACE_EVENT(SEMA, "visit_basic_type", n);
   int kid_cnt = n->get_num_kids();
   // Flags for type creation
   int is_signed = -1;
@@ -178,7 +337,7 @@ void SemanticAnalysis::visit_basic_type(Node* n){
 }
 
 void SemanticAnalysis::visit_function_definition(Node* n){
-  if(debug){ puts("visit_function_definition"); }
+  TRACE_EVENT(SEMA, "visit_function_definition", n);
   // get basic type 
   visit(n->get_kid(0));
   std::shared_ptr<Type> func_type(new FunctionType(n->get_kid(0)->get_type()));
@@ -226,7 +385,7 @@ void SemanticAnalysis::visit_function_definition(Node* n){
 }
 
 void SemanticAnalysis::visit_function_declaration(Node* n){
-  if(debug){ puts("visit_function_declaration"); }
+  TRACE_EVENT(SEMA, "visit_function_declaration", n);
   visit(n->get_kid(0));
   std::shared_ptr<Type> func_type(new FunctionType(n->get_kid(0)->get_type()));
 
@@ -252,7 +411,7 @@ void SemanticAnalysis::visit_function_declaration(Node* n){
 }
 
 void SemanticAnalysis::visit_function_parameter(Node* n){
-  if(debug){ puts("visit_function_parameter"); }
+  TRACE_EVENT(SEMA, "visit_function_parameter", n);
   visit(n->get_kid(0));
   std::shared_ptr<Type> base_type = n->get_kid(0)->get_type();
   std::shared_ptr<Type> base_type1 = base_type;
@@ -262,12 +421,12 @@ void SemanticAnalysis::visit_function_parameter(Node* n){
 }
 
 void SemanticAnalysis::visit_statement_list(Node* n){
-  if(debug){ puts("visit_statement_list"); }
+  TRACE_EVENT(SEMA, "visit_statement_list", n);
   visit_children(n);
 }
 
 void SemanticAnalysis::visit_struct_type_definition(Node* n){
-  if(debug){ puts("visit_struct_type_definition"); }
+  TRACE_EVENT(SEMA, "visit_struct_type_definition", n);
 
   //get name
   std::string name = n->get_kid(0)->get_str();
@@ -298,7 +457,7 @@ void SemanticAnalysis::visit_struct_type_definition(Node* n){
 }
 
 void SemanticAnalysis::visit_binary_expression(Node* n){
-  if(debug){ puts("visit_binary_expression"); }
+  TRACE_EVENT(SEMA, "visit_binary_expression", n);
 
   //Operator
   int tag = n->get_kid(0)->get_tag();
@@ -336,7 +495,12 @@ void SemanticAnalysis::visit_binary_expression(Node* n){
     }
     case TOK_DIVIDE:
     case TOK_ASTERISK:
-    case TOK_MOD:{
+    case TOK_MOD:
+    case TOK_AMPERSAND:
+    case TOK_BITWISE_OR:
+    case TOK_BITWISE_XOR:
+    case TOK_LEFT_SHIFT:
+    case TOK_RIGHT_SHIFT:{
       if(l_type->is_pointer() || r_type->is_pointer()){
         SemanticError::raise(n->get_loc(), "Pointer arithmatic not allowed visit_binary_expression");
       }
@@ -367,10 +531,16 @@ void SemanticAnalysis::visit_binary_expression(Node* n){
   }
   n->set_value_type(ValueType::COMPUTED);
   n->set_type(l_type);
+
+  Constant left, right, result;
+  if(tag != TOK_ASSIGN && get_constant(n->get_kid(1), left) && get_constant(n->get_kid(2), right)
+     && fold_binary(tag, left, right, result)){
+    set_constant(n, result);
+  }
 }
 
 void SemanticAnalysis::visit_unary_expression(Node* n){
-  if(debug){ puts("visit_unary_expression"); }
+  TRACE_EVENT(SEMA, "visit_unary_expression", n);
   visit(n->get_kid(1));
   switch(n->get_kid(0)->get_tag()){
     case TOK_ASTERISK:{
@@ -398,25 +568,56 @@ void SemanticAnalysis::visit_unary_expression(Node* n){
         SemanticError::raise(n->get_loc(), "Cannot perform operation on pointer");
       }
       n->set_type(n->get_kid(1)->get_type());
+      Constant operand, result;
+      if(get_constant(n->get_kid(1), operand) && fold_unary(n->get_kid(0)->get_tag(), operand, result)){
+        set_constant(n, result);
+      }
       break;
     }
   }
 }
 
 void SemanticAnalysis::visit_postfix_expression(Node* n){
-  if(debug){ puts("visit_postfix_expression"); }
+  TRACE_EVENT(SEMA, "visit_postfix_expression", n);
 }
 
 void SemanticAnalysis::visit_conditional_expression(Node* n){
-  if(debug){ puts("visit_conditional_expression"); }
+  TRACE_EVENT(SEMA, "visit_conditional_expression", n);
+  visit(n->get_kid(0));
+  visit(n->get_kid(1));
+  visit(n->get_kid(2));
+  std::shared_ptr<Type> cond_type = n->get_kid(0)->get_type();
+  std::shared_ptr<Type> t_type = n->get_kid(1)->get_type();
+  std::shared_ptr<Type> f_type = n->get_kid(2)->get_type();
+
+  if(!cond_type->is_integral() && !cond_type->is_pointer()){
+    SemanticError::raise(n->get_loc(), "Condition of ?: must be an integer or a pointer");
+  }
+  //the result has the type of the wider arm, or the pointer type
+  if(t_type->is_integral() && f_type->is_integral()){
+    n->set_type(f_type->get_storage_size() > t_type->get_storage_size() ? f_type : t_type);
+  } else if(t_type->is_pointer() && (f_type->is_pointer() || f_type->is_integral())){
+    n->set_type(t_type);
+  } else if(f_type->is_pointer() && t_type->is_integral()){
+    n->set_type(f_type);
+  } else{
+    SemanticError::raise(n->get_loc(), "Incompatible operands for ?:");
+  }
+  n->set_value_type(ValueType::COMPUTED);
+
+  Constant cond, result;
+  if(n->get_type()->is_integral() && get_constant(n->get_kid(0), cond)
+     && get_constant(n->get_kid(cond.value ? 1 : 2), result)){
+    set_constant(n, result);
+  }
 }
 
 void SemanticAnalysis::visit_cast_expression(Node* n){
-  if(debug){ puts("visit_cast_expression"); }
+  TRACE_EVENT(SEMA, "visit_cast_expression", n);
 }
 
 void SemanticAnalysis::visit_function_call_expression(Node* n){
-  if(debug){ puts("visit_function_call_expression"); }
+  TRACE_EVENT(SEMA, "visit_function_call_expression", n);
   //func_name
   std::string func_name = n->get_kid(0)->get_kid(0)->get_str();
   //arg_list
@@ -445,7 +646,7 @@ void SemanticAnalysis::visit_function_call_expression(Node* n){
 }
 
 void SemanticAnalysis::visit_field_ref_expression(Node* n){
-  if(debug){ puts("visit_field_ref_expression"); }
+  TRACE_EVENT(SEMA, "visit_field_ref_expression", n);
   visit(n->get_kid(0));
   std::string l_name = n->get_kid(0)->get_str();
   // if(!m_cur_symtab->lookup_recursive_kind(l_name, SymbolKind::VARIABLE)){
@@ -471,7 +672,7 @@ void SemanticAnalysis::visit_field_ref_expression(Node* n){
 }
 
 void SemanticAnalysis::visit_indirect_field_ref_expression(Node* n){
-  if(debug){ puts("visit_indirect_field_ref_expression"); }
+  TRACE_EVENT(SEMA, "visit_indirect_field_ref_expression", n);
   //Initial checking
   visit(n->get_kid(0));
   std::string l_name = n->get_kid(0)->get_str();
@@ -500,7 +701,7 @@ void SemanticAnalysis::visit_indirect_field_ref_expression(Node* n){
 }
 
 void SemanticAnalysis::visit_array_element_ref_expression(Node* n){
-  if(debug){ puts("visit_array_element_ref_expression"); }
+  TRACE_EVENT(SEMA, "visit_array_element_ref_expression", n);
   visit(n->get_kid(0));
   visit(n->get_kid(1));
   //make sure the array index is numeric
@@ -515,7 +716,7 @@ void SemanticAnalysis::visit_array_element_ref_expression(Node* n){
 }
 
 void SemanticAnalysis::visit_variable_ref(Node* n){
-  if(debug){ puts("visit_variable_ref"); }
+  TRACE_EVENT(SEMA, "visit_variable_ref", n);
   std::string name = n->get_kid(0)->get_str();
   Symbol* v_symbol = m_cur_symtab->lookup_recursive(name);
   if(!v_symbol){
@@ -527,7 +728,7 @@ void SemanticAnalysis::visit_variable_ref(Node* n){
 }
 
 void SemanticAnalysis::visit_literal_value(Node* n){
-  if(debug){ puts("visit_literal_value"); }
+  TRACE_EVENT(SEMA, "visit_literal_value", n);
   int tag = n->get_kid(0)->get_tag();
   LiteralValue result;
   std::string name = n->get_kid(0)->get_str();
@@ -545,12 +746,15 @@ void SemanticAnalysis::visit_literal_value(Node* n){
       result = result.from_int_literal(name, n->get_loc());
       std::shared_ptr<Type> v_int(new BasicType(result));
       lit_type = v_int;
+      n->set_lit(std::shared_ptr<LiteralValue>(new LiteralValue(result)));
       break;
     }
     case TOK_CHAR_LIT:{
       result = result.from_char_literal(name, n->get_loc());
       std::shared_ptr<Type> v_char(new BasicType(result));
       lit_type = v_char;
+      // a character constant has type int in expressions
+      n->set_lit(std::shared_ptr<LiteralValue>(new LiteralValue(result.get_char_value(), false, false)));
       break;
     }
   }
@@ -560,7 +764,7 @@ void SemanticAnalysis::visit_literal_value(Node* n){
 }
 
 void SemanticAnalysis::visit_return_expression_statement(Node* n){
-  if(debug){ puts("visit_return_expression_statement"); }
+  TRACE_EVENT(SEMA, "visit_return_expression_statement", n);
   visit(n->get_kid(0));
   if(!is_convertible(n->get_kid(0)->get_type(), m_cur_symtab->get_fn_type()->get_base_type())){
     SemanticError::raise(n->get_loc(), "Does not match function return type");
@@ -574,23 +778,27 @@ void SemanticAnalysis::visit_return_expression_statement(Node* n){
 }
 
 void SemanticAnalysis::visit_while_statement(Node* n){
-  if(debug){ puts("visit_while_statement"); }
+  TRACE_EVENT(SEMA, "visit_while_statement", n);
   visit(n->get_kid(0));
   enter_scope();
+  m_break_depth++;
   visit(n->get_kid(1));
+  m_break_depth--;
   leave_scope();
 }
 
 void SemanticAnalysis::visit_do_while_statement(Node* n){
-  if(debug){ puts("visit_do_while_statement"); }
+  TRACE_EVENT(SEMA, "visit_do_while_statement", n);
   enter_scope();
+  m_break_depth++;
   visit(n->get_kid(0));
+  m_break_depth--;
   leave_scope();
   visit(n->get_kid(1));
 }
 
 void SemanticAnalysis::visit_if_statement(Node* n){
-  if(debug){ puts("visit_if_statement"); }
+  TRACE_EVENT(SEMA, "visit_if_statement", n);
   visit(n->get_kid(0));
   enter_scope();
   visit(n->get_kid(1));
@@ -598,19 +806,21 @@ void SemanticAnalysis::visit_if_statement(Node* n){
 }
 
 void SemanticAnalysis::visit_for_statement(Node* n){
-  if(debug){ puts("visit_for_statement"); }
+  TRACE_EVENT(SEMA, "visit_for_statement", n);
   enter_scope();
   visit(n->get_kid(0));
   visit(n->get_kid(1));
   visit(n->get_kid(2));
   leave_scope();
   enter_scope();
+  m_break_depth++;
   visit(n->get_kid(3));
+  m_break_depth--;
   leave_scope();
 }
 
 void SemanticAnalysis::visit_if_else_statement(Node* n){
-  if(debug){ puts("visit_if_else_statement"); }
+  TRACE_EVENT(SEMA, "visit_if_else_statement", n);
   visit(n->get_kid(0));
   enter_scope();
   visit(n->get_kid(1));
@@ -621,6 +831,66 @@ void SemanticAnalysis::visit_if_else_statement(Node* n){
 
 }
 
+void SemanticAnalysis::visit_switch_statement(Node* n){
+  TRACE_EVENT(SEMA, "visit_switch_statement", n);
+  visit(n->get_kid(0));
+  std::shared_ptr<Type> type = n->get_kid(0)->get_type();
+  if(!type->is_integral()){
+    SemanticError::raise(n->get_loc(), "Switch expression must be an integer");
+  }
+  //case values are compared in the promoted type of the expression
+  SwitchInfo info;
+  info.is_long = type->get_storage_size() == 8;
+  info.is_unsigned = !type->is_signed() && type->get_storage_size() >= 4;
+  info.has_default = false;
+  m_switches.push_back(info);
+  enter_scope();
+  m_break_depth++;
+  visit(n->get_kid(1));
+  m_break_depth--;
+  leave_scope();
+  m_switches.pop_back();
+}
+
+void SemanticAnalysis::visit_case_statement(Node* n){
+  TRACE_EVENT(SEMA, "visit_case_statement", n);
+  if(m_switches.empty()){
+    SemanticError::raise(n->get_loc(), "Case label not within a switch statement");
+  }
+  visit(n->get_kid(0));
+  Constant c;
+  if(!n->get_kid(0)->get_type()->is_integral() || !get_constant(n->get_kid(0), c)){
+    SemanticError::raise(n->get_loc(), "Case label is not an integer constant");
+  }
+  SwitchInfo& info = m_switches.back();
+  c = convert(c, info.is_unsigned, info.is_long);
+  if(!info.values.insert(c.value).second){
+    SemanticError::raise(n->get_loc(), "Duplicate case value");
+  }
+  //the case node carries the converted value for code generation
+  set_constant(n, c);
+  visit(n->get_kid(1));
+}
+
+void SemanticAnalysis::visit_default_statement(Node* n){
+  TRACE_EVENT(SEMA, "visit_default_statement", n);
+  if(m_switches.empty()){
+    SemanticError::raise(n->get_loc(), "Default label not within a switch statement");
+  }
+  if(m_switches.back().has_default){
+    SemanticError::raise(n->get_loc(), "Multiple default labels in one switch");
+  }
+  m_switches.back().has_default = true;
+  visit(n->get_kid(0));
+}
+
+void SemanticAnalysis::visit_break_statement(Node* n){
+  TRACE_EVENT(SEMA, "visit_break_statement", n);
+  if(m_break_depth == 0){
+    SemanticError::raise(n->get_loc(), "Break statement not within a loop or switch");
+  }
+}
+
 void SemanticAnalysis::enter_scope(){
   SymbolTable* scope = new SymbolTable(m_cur_symtab);
   m_cur_symtab = scope;
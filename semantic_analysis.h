@@ -9,11 +9,24 @@
 #include "literal_value.h"
 #include "ast_visitor.h"
 #include <vector>
+#include <set>
 // #include "local_storage_allocation.h"
 
 class SemanticAnalysis : public ASTVisitor {
 private:
+  // the case values seen so far in a switch statement, converted to
+  // the (promoted) type of the controlling expression
+  struct SwitchInfo {
+    bool is_unsigned, is_long;
+    std::set<int64_t> values;
+    bool has_default;
+  };
+
   SymbolTable *m_global_symtab, *m_cur_symtab;
+  // the enclosing switch statements, innermost last
+  std::vector<SwitchInfo> m_switches;
+  // the number of enclosing loops and switches (which break can leave)
+  int m_break_depth;
 
 public:
   SemanticAnalysis();
@@ -46,6 +59,10 @@ public:
   virtual void visit_for_statement(Node *n);
   virtual void visit_if_statement(Node *n);
   virtual void visit_if_else_statement(Node *n);
+  virtual void visit_switch_statement(Node *n);
+  virtual void visit_case_statement(Node *n);
+  virtual void visit_default_statement(Node *n);
+  virtual void visit_break_statement(Node *n);
   virtual SymbolTable *get_global_symtab();
 
 private:
@@ -0,0 +1,109 @@
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "exceptions.h"
+#include "source_buffer.h"
+
+namespace {
+
+// closes a file descriptor when it goes out of scope
+struct FileDescriptor {
+  int fd;
+
+  FileDescriptor(int fd_) : fd(fd_) { }
+  ~FileDescriptor() { if (fd >= 0) close(fd); }
+};
+
+}
+
+SourceBuffer::SourceBuffer(const std::string &filename)
+  : m_filename(filename)
+  , m_data(nullptr)
+  , m_size(0)
+  , m_map_size(0) {
+  FileDescriptor in(open(filename.c_str(), O_RDONLY));
+  if (in.fd < 0) {
+    RuntimeError::raise("Couldn't open '%s'", filename.c_str());
+  }
+
+  struct stat st;
+  if (fstat(in.fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+    m_size = size_t(st.st_size);
+
+    // Reserve enough zero-filled anonymous memory for the contents
+    // plus the two NUL bytes, then map the file over the start of it.
+    // Whatever follows the end of the file (in its last page, and in
+    // the rest of the reservation) reads as zero. The mapping is
+    // private and writable because flex temporarily stores a NUL
+    // after each token it scans.
+    size_t page_size = size_t(sysconf(_SC_PAGESIZE));
+    size_t map_size = (m_size + 2 + page_size - 1) / page_size * page_size;
+    void *reserved = mmap(nullptr, map_size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (reserved != MAP_FAILED) {
+      void *p = mmap(reserved, m_size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_FIXED, in.fd, 0);
+      if (p != MAP_FAILED) {
+        m_data = static_cast<char *>(p);
+        m_map_size = map_size;
+        return;
+      }
+      munmap(reserved, map_size);
+    }
+  }
+
+  // not a regular file, empty, or couldn't be mapped
+  read_contents(in.fd);
+}
+
+SourceBuffer::~SourceBuffer() {
+  if (m_map_size > 0) {
+    munmap(m_data, m_map_size);
+  } else {
+    free(m_data);
+  }
+}
+
+const std::string &SourceBuffer::intern(size_t offset, size_t len) {
+  std::string_view lexeme(m_data + offset, len);
+  auto i = m_interned.find(lexeme);
+  if (i != m_interned.end()) {
+    return *i->second;
+  }
+
+  // the key is a view into the buffer, so it stays valid for
+  // the lifetime of the SourceBuffer
+  m_strings.emplace_back(lexeme);
+  const std::string *str = &m_strings.back();
+  m_interned[lexeme] = str;
+  return *str;
+}
+
+void SourceBuffer::read_contents(int fd) {
+  size_t capacity = 4096;
+  m_size = 0;
+  m_data = static_cast<char *>(malloc(capacity));
+  for (;;) {
+    if (capacity - m_size <= 2) {
+      capacity *= 2;
+      m_data = static_cast<char *>(realloc(m_data, capacity));
+    }
+    ssize_t n = read(fd, m_data + m_size, capacity - m_size - 2);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      RuntimeError::raise("Couldn't read '%s'", m_filename.c_str());
+    }
+    if (n == 0) {
+      break;
+    }
+    m_size += size_t(n);
+  }
+  m_data[m_size] = '\0';
+  m_data[m_size + 1] = '\0';
+}
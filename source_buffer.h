@@ -0,0 +1,52 @@
+#ifndef SOURCE_BUFFER_H
+#define SOURCE_BUFFER_H
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// SourceBuffer holds the contents of a source file, mapped into
+// memory with mmap (or read into memory, if the file can't be
+// mapped). The contents are followed by two NUL bytes, which is
+// what flex's yy_scan_buffer() requires, so the scanner can work
+// directly on the mapped file.
+//
+// Tokens refer to their lexemes as (offset, length) views into
+// the buffer. intern() turns a view into a string the first time
+// one is needed, and returns the same string for every occurrence
+// of the same lexeme.
+class SourceBuffer {
+private:
+  std::string m_filename;
+  char *m_data;
+  size_t m_size;
+  size_t m_map_size;  // 0 if the contents were read into a heap buffer
+  std::unordered_map<std::string_view, const std::string *> m_interned;
+  std::deque<std::string> m_strings;
+
+  // value semantics are not allowed
+  SourceBuffer(const SourceBuffer &);
+  SourceBuffer &operator=(const SourceBuffer &);
+
+public:
+  SourceBuffer(const std::string &filename);
+  ~SourceBuffer();
+
+  const std::string &get_filename() const { return m_filename; }
+
+  // the contents of the file, followed by two NUL bytes
+  char *get_data() { return m_data; }
+  const char *get_data() const { return m_data; }
+
+  // size of the file (not counting the NUL bytes)
+  size_t get_size() const { return m_size; }
+
+  const std::string &intern(size_t offset, size_t len);
+
+private:
+  void read_contents(int fd);
+};
+
+#endif // SOURCE_BUFFER_H
@@ -1,6 +1,7 @@
 #include <cassert>
 #include <cstdio>
 #include "symtab.h"
+#include "phase_timer.h"
 
 ////////////////////////////////////////////////////////////////////////
 // Symbol implementation
@@ -15,6 +16,7 @@ Symbol::Symbol(SymbolKind kind, const std::string& name, const std::shared_ptr<T
   , m_addr(-1)
   , vreg(0){
   from_struct = false;
+  PhaseTimer::count(CountedObject::SYMBOL);
 }
 
 Symbol::~Symbol(){
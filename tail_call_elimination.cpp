@@ -0,0 +1,143 @@
+#include <cassert>
+#include <set>
+#include <vector>
+#include "node.h"
+#include "instruction.h"
+#include "highlevel.h"
+#include "lowlevel_codegen.h"
+#include "tail_call_elimination.h"
+
+TailCallElimination::TailCallElimination(const std::shared_ptr<InstructionSequence>& hl_iseq)
+  : m_hl_iseq(hl_iseq){
+  Node* funcdef_ast = hl_iseq->get_funcdef_ast();
+  assert(funcdef_ast != nullptr);
+  m_fn_name = funcdef_ast->get_kid(1)->get_str();
+  m_return_label_name = ".L" + m_fn_name + "_return";
+  m_recurse_label_name = ".L" + m_fn_name + "_recurse";
+}
+
+TailCallElimination::~TailCallElimination(){
+}
+
+std::shared_ptr<InstructionSequence> TailCallElimination::transform(){
+  Node* funcdef_ast = m_hl_iseq->get_funcdef_ast();
+
+  // the address of a local could escape to the callee, so the
+  // frame has to stay alive for the duration of the call
+  if(funcdef_ast->get_symbol()->get_addr() != 0){
+    return m_hl_iseq;
+  }
+  if(m_hl_iseq->get_length() < 2 || m_hl_iseq->get_instruction(0)->get_opcode() != HINS_enter){
+    return m_hl_iseq;
+  }
+  if(m_hl_iseq->find_labeled_instruction(m_return_label_name) == nullptr){
+    return m_hl_iseq;
+  }
+
+  // find the calls in tail position
+  std::vector<bool> tail_call(m_hl_iseq->get_length(), false);
+  bool has_self_call = false, has_tail_call = false;
+  for(unsigned i = 0; i < m_hl_iseq->get_length(); i++){
+    if(is_tail_call(i)){
+      tail_call[i] = true;
+      has_tail_call = true;
+      if(m_hl_iseq->get_instruction(i)->get_operand(0).get_label() == m_fn_name){
+        has_self_call = true;
+      }
+    }
+  }
+  if(!has_tail_call){
+    return m_hl_iseq;
+  }
+
+  // self-recursive calls jump to the instruction following enter,
+  // reusing its label if it already has one
+  std::string recurse_label;
+  auto second = ++m_hl_iseq->cbegin();
+  bool define_recurse_label = false;
+  if(has_self_call){
+    if(second.has_label()){
+      recurse_label = second.get_label();
+    } else{
+      recurse_label = m_recurse_label_name;
+      define_recurse_label = true;
+    }
+  }
+
+  std::shared_ptr<InstructionSequence> result(new InstructionSequence());
+  result->set_funcdef_ast(funcdef_ast);
+
+  unsigned index = 0;
+  for(auto i = m_hl_iseq->cbegin(); i != m_hl_iseq->cend(); ++i, ++index){
+    Instruction* ins = *i;
+
+    if(i.has_label()){
+      result->define_label(i.get_label());
+    } else if(index == 1 && define_recurse_label){
+      result->define_label(recurse_label);
+    }
+
+    if(!tail_call[index]){
+      result->append(ins->duplicate());
+    } else if(ins->get_operand(0).get_label() == m_fn_name){
+      // the arguments are already in the argument vregs, so just
+      // start over from the parameter moves
+      result->append(new Instruction(HINS_jmp, Operand(Operand::LABEL, recurse_label)));
+    } else{
+      result->append(new Instruction(HINS_tailcall, ins->get_operand(0)));
+    }
+  }
+
+  return result;
+}
+
+// A call is in tail position if it is followed only by moves which
+// copy the return value (directly or through temporaries) back into
+// vr0, and then reaches the return label.
+bool TailCallElimination::is_tail_call(unsigned index) const{
+  Instruction* call = m_hl_iseq->get_instruction(index);
+  if(call->get_opcode() != HINS_call){
+    return false;
+  }
+
+  unsigned return_index = m_hl_iseq->get_index_of_labeled_instruction(m_return_label_name);
+
+  // vregs known to contain the callee's return value
+  std::set<int> holds_retval = { 0 };
+  int mov_opcode = -1;
+
+  for(unsigned j = index + 1; j < m_hl_iseq->get_length(); j++){
+    if(j == return_index){
+      return true;
+    }
+
+    Instruction* ins = m_hl_iseq->get_instruction(j);
+    int opcode = ins->get_opcode();
+
+    if(opcode == HINS_jmp){
+      return ins->get_operand(0).get_label() == m_return_label_name;
+    }
+    if(!match_hl(HINS_mov_b, opcode)){
+      return false;
+    }
+
+    // every move must have the same width, otherwise the value
+    // returned would be truncated or extended
+    if(mov_opcode != -1 && mov_opcode != opcode){
+      return false;
+    }
+    mov_opcode = opcode;
+
+    Operand dest = ins->get_operand(0);
+    Operand src = ins->get_operand(1);
+    if(dest.get_kind() != Operand::VREG || src.get_kind() != Operand::VREG){
+      return false;
+    }
+    if(holds_retval.count(src.get_base_reg()) == 0){
+      return false;
+    }
+    holds_retval.insert(dest.get_base_reg());
+  }
+
+  return false;
+}
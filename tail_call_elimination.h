@@ -0,0 +1,38 @@
+#ifndef TAIL_CALL_ELIMINATION_H
+#define TAIL_CALL_ELIMINATION_H
+
+#include <memory>
+#include <string>
+#include "instruction_seq.h"
+
+// TailCallElimination rewrites calls in tail position in a high-level
+// InstructionSequence. A call is in tail position if the only thing
+// that happens after it is moving the returned value (vr0) back into
+// vr0 and jumping to the function's return label.
+//
+//   - a self-recursive tail call becomes a jump back to the code right
+//     after the enter instruction, which reloads the parameters from
+//     the argument vregs (i.e., the recursion becomes a loop)
+//   - a tail call to any other function becomes a tailcall instruction,
+//     which tears down the stack frame and jumps to the callee
+//
+// Functions which allocate memory storage for locals are left alone,
+// because the address of a local could have been passed to the callee.
+class TailCallElimination{
+private:
+  std::shared_ptr<InstructionSequence> m_hl_iseq;
+  std::string m_fn_name;
+  std::string m_return_label_name;
+  std::string m_recurse_label_name;
+
+public:
+  TailCallElimination(const std::shared_ptr<InstructionSequence>& hl_iseq);
+  ~TailCallElimination();
+
+  std::shared_ptr<InstructionSequence> transform();
+
+private:
+  bool is_tail_call(unsigned index) const;
+};
+
+#endif // TAIL_CALL_ELIMINATION_H
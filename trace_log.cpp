@@ -0,0 +1,105 @@
+#include <vector>
+#include "node.h"
+#include "trace_log.h"
+
+namespace {
+
+struct TraceEntry {
+  enum Kind { PLAIN, NODE, ARG };
+
+  TraceCategory cat;
+  Kind kind;
+  const char *what;
+  long arg;           // the argument, or the source line of the node
+};
+
+// the number of most recent events kept
+const size_t RING_SIZE = 4096;
+
+const char *const CATEGORY_NAMES[NUM_TRACE_CATEGORIES] = {
+  "sema",
+  "storage",
+  "hl_codegen",
+  "ll_codegen",
+};
+
+// allocated on the first event, so threads which don't trace
+// don't pay for the buffer
+thread_local std::vector<TraceEntry> t_ring;
+thread_local unsigned long t_num_events;
+
+void append(const TraceEntry &e) {
+  if (t_ring.empty()) {
+    t_ring.resize(RING_SIZE);
+  }
+  t_ring[t_num_events % RING_SIZE] = e;
+  t_num_events++;
+}
+
+}
+
+unsigned TraceLog::s_enabled = 0;
+
+bool TraceLog::enable(const std::string &names) {
+  size_t start = 0;
+  while (start <= names.size()) {
+    size_t end = names.find(',', start);
+    if (end == std::string::npos) {
+      end = names.size();
+    }
+    std::string name = names.substr(start, end - start);
+    start = end + 1;
+
+    if (name == "all") {
+      s_enabled = (1u << NUM_TRACE_CATEGORIES) - 1;
+      continue;
+    }
+    int i = 0;
+    while (i < NUM_TRACE_CATEGORIES && name != CATEGORY_NAMES[i]) {
+      i++;
+    }
+    if (i == NUM_TRACE_CATEGORIES) {
+      return false;
+    }
+    s_enabled |= 1u << i;
+  }
+  return true;
+}
+
+const char *TraceLog::get_name(TraceCategory cat) {
+  return CATEGORY_NAMES[int(cat)];
+}
+
+void TraceLog::record(TraceCategory cat, const char *what) {
+  append({ cat, TraceEntry::PLAIN, what, 0 });
+}
+
+void TraceLog::record(TraceCategory cat, const char *what, const Node *n) {
+  if (n->get_loc().is_valid()) {
+    append({ cat, TraceEntry::NODE, what, n->get_loc().get_line() });
+  } else {
+    append({ cat, TraceEntry::PLAIN, what, 0 });
+  }
+}
+
+void TraceLog::record(TraceCategory cat, const char *what, long arg) {
+  append({ cat, TraceEntry::ARG, what, arg });
+}
+
+void TraceLog::dump(FILE *out) {
+  unsigned long first = t_num_events > RING_SIZE ? t_num_events - RING_SIZE : 0;
+  if (first > 0) {
+    fprintf(out, "(%lu earlier trace events dropped)\n", first);
+  }
+  for (unsigned long i = first; i < t_num_events; i++) {
+    const TraceEntry &e = t_ring[i % RING_SIZE];
+    fprintf(out, "[%s] %s", CATEGORY_NAMES[int(e.cat)], e.what);
+    if (e.kind == TraceEntry::NODE) {
+      fprintf(out, " (line %ld)", e.arg);
+    } else if (e.kind == TraceEntry::ARG) {
+      fprintf(out, " %ld", e.arg);
+    }
+    fputc('\n', out);
+  }
+  t_num_events = 0;
+}
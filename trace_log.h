@@ -0,0 +1,75 @@
+#ifndef TRACE_LOG_H
+#define TRACE_LOG_H
+
+#include <cstdio>
+#include <string>
+class Node;
+
+// Categories of trace events, one for each pass which is traced
+enum class TraceCategory {
+  SEMA,         // semantic analysis
+  STORAGE,      // local storage allocation
+  HL_CODEGEN,   // high-level code generation
+  LL_CODEGEN,   // low-level code generation
+};
+
+const int NUM_TRACE_CATEGORIES = int(TraceCategory::LL_CODEGEN) + 1;
+
+// The categories compiled into the executable, as a bit mask indexed
+// by TraceCategory (e.g., 0xf for all of them). It is normally set from
+// the Makefile; when a category isn't compiled in, TRACE_EVENT for that
+// category generates no code at all.
+#ifndef TRACE_CATEGORIES
+#define TRACE_CATEGORIES 0
+#endif
+
+// TraceLog records trace events in a ring buffer in memory, keeping the
+// most recent ones, to be dumped on demand: by default, when compilation
+// finishes or fails. Recording an event only stores a few words (no
+// formatting or I/O), and for a category which is compiled in but not
+// enabled at runtime, TRACE_EVENT is just a test of a flag.
+//
+// The ring buffer is per-thread, so concurrent compilations (in server
+// mode) don't mix their events.
+class TraceLog {
+private:
+  static unsigned s_enabled;
+
+public:
+  static constexpr bool is_compiled_in(TraceCategory cat) {
+    return ((TRACE_CATEGORIES) >> int(cat)) & 1;
+  }
+
+  static bool is_enabled(TraceCategory cat) {
+    return s_enabled & (1u << int(cat));
+  }
+
+  // enable the categories in a comma-separated list of category
+  // names (or "all"); returns false if a name isn't recognized
+  static bool enable(const std::string &names);
+  static bool is_any_enabled() { return s_enabled != 0; }
+
+  static const char *get_name(TraceCategory cat);
+
+  // record an event; what must be a string which lives as long as
+  // the program does (e.g., a string literal)
+  static void record(TraceCategory cat, const char *what);
+  static void record(TraceCategory cat, const char *what, const Node *n);
+  static void record(TraceCategory cat, const char *what, long arg);
+
+  // print the events in the current thread's ring buffer, oldest
+  // first, and then clear it
+  static void dump(FILE *out);
+};
+
+// TRACE_EVENT(category, what[, node or integer argument])
+#define TRACE_EVENT(cat, ...) \
+  do { \
+    if constexpr (TraceLog::is_compiled_in(TraceCategory::cat)) { \
+      if (TraceLog::is_enabled(TraceCategory::cat)) { \
+        TraceLog::record(TraceCategory::cat, __VA_ARGS__); \
+      } \
+    } \
+  } while (0)
+
+#endif // TRACE_LOG_H
@@ -2,6 +2,7 @@
 #include "exceptions.h"
 #include "storage.h"
 #include "type.h"
+#include "phase_timer.h"
 
 ////////////////////////////////////////////////////////////////////////
 // Type implementation
@@ -9,6 +10,7 @@
 
 Type::Type(){
   is_lvalue_bool = true;
+  PhaseTimer::count(CountedObject::TYPE);
 }
 
 Type::~Type(){
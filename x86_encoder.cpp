@@ -0,0 +1,545 @@
+#include <cassert>
+#include "lowlevel.h"
+#include "exceptions.h"
+#include "x86_encoder.h"
+
+namespace{
+
+  // hardware register numbers, indexed by MachineReg
+  const int HW_REG[] = { 0, 3, 1, 2, 6, 7, 4, 5, 8, 9, 10, 11, 12, 13, 14, 15,
+                         0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+
+  // condition codes, as used in jcc and setcc opcodes
+  const int CC_B = 0x2;
+  const int CC_AE = 0x3;
+  const int CC_E = 0x4;
+  const int CC_NE = 0x5;
+  const int CC_BE = 0x6;
+  const int CC_A = 0x7;
+  const int CC_L = 0xc;
+  const int CC_GE = 0xd;
+  const int CC_LE = 0xe;
+  const int CC_G = 0xf;
+
+  bool fits_int8(int64_t val){
+    return val >= -128 && val <= 127;
+  }
+
+  bool fits_int32(int64_t val){
+    return val >= INT32_MIN && val <= INT32_MAX;
+  }
+
+  bool is_reg(const Operand& op){
+    Operand::Kind kind = op.get_kind();
+    return kind == Operand::MREG8 || kind == Operand::MREG16 || kind == Operand::MREG32 || kind == Operand::MREG64
+        || kind == Operand::MREG128;
+  }
+
+  bool is_xmm(const Operand& op){
+    return op.get_kind() == Operand::MREG128;
+  }
+
+  bool is_mem(const Operand& op){
+    Operand::Kind kind = op.get_kind();
+    return kind == Operand::MREG64_MEM || kind == Operand::MREG64_MEM_IDX || kind == Operand::MREG64_MEM_OFF
+        || kind == Operand::LABEL_MEM_IDX;
+  }
+
+  bool is_imm(const Operand& op){
+    return op.is_imm_ival() || op.is_imm_label();
+  }
+
+  int hw_reg(int mreg){
+    assert(mreg >= 0 && mreg < 32);
+    return HW_REG[mreg];
+  }
+
+  void append_le(std::vector<uint8_t>& bytes, uint64_t val, unsigned size){
+    for(unsigned i = 0; i < size; i++){
+      bytes.push_back(uint8_t(val >> (8 * i)));
+    }
+  }
+
+  // Builds one instruction: optional operand size prefix and REX,
+  // opcode, ModRM (with SIB and displacement), and immediate
+  class InstructionBuilder{
+  private:
+    X86Encoding& m_enc;
+
+  public:
+    InstructionBuilder(X86Encoding& enc) : m_enc(enc){ }
+
+    // An instruction with a ModRM byte. reg is a hardware register
+    // number or an opcode extension; the byte flags say whether the
+    // reg field and a register rm operand are 8 bit registers (which
+    // need a REX prefix for spl, bpl, sil and dil).
+    void modrm(bool prefix66, bool rex_w, std::initializer_list<uint8_t> opcode,
+               int reg, bool reg_is_byte, const Operand& rm, bool rm_is_byte){
+      int rex = rex_w ? 0x48 : 0;
+      if(reg >= 8){
+        rex |= 0x44;
+      }
+      if(reg_is_byte && reg >= 4 && reg < 8){
+        rex |= 0x40;
+      }
+      // a label with an index register has no base: the SIB byte's
+      // base field is 5 (with mod 00) and the label is a disp32
+      bool label_base = rm.get_kind() == Operand::LABEL_MEM_IDX;
+      int base = 0, index = -1;
+      if(is_reg(rm)){
+        base = hw_reg(rm.get_base_reg());
+        if(rm_is_byte && base >= 4 && base < 8){
+          rex |= 0x40;
+        }
+      } else if(is_mem(rm)){
+        base = label_base ? 5 : hw_reg(rm.get_base_reg());
+        if(rm.get_kind() == Operand::MREG64_MEM_IDX || label_base){
+          index = hw_reg(rm.get_index_reg());
+          assert(index != 4);
+          if(index >= 8){
+            rex |= 0x42;
+          }
+        }
+      } else{
+        RuntimeError::raise("invalid register or memory operand");
+      }
+      if(base >= 8){
+        rex |= 0x41;
+      }
+
+      if(prefix66){
+        m_enc.bytes.push_back(0x66);
+      }
+      if(rex != 0){
+        m_enc.bytes.push_back(uint8_t(rex));
+      }
+      m_enc.bytes.insert(m_enc.bytes.end(), opcode.begin(), opcode.end());
+
+      int reg_bits = (reg & 7) << 3;
+      if(is_reg(rm)){
+        m_enc.bytes.push_back(uint8_t(0xc0 | reg_bits | (base & 7)));
+        return;
+      }
+
+      int64_t disp = (rm.get_kind() == Operand::MREG64_MEM_OFF) ? rm.get_offset() : 0;
+      if(!fits_int32(disp)){
+        RuntimeError::raise("memory operand offset %ld out of range", long(disp));
+      }
+      int mod;
+      if(label_base || (disp == 0 && (base & 7) != 5)){
+        mod = 0x00;
+      } else if(fits_int8(disp)){
+        mod = 0x40;
+      } else{
+        mod = 0x80;
+      }
+      if(index >= 0 || (base & 7) == 4){
+        int scale_bits = 0;
+        if(index >= 0){
+          switch(rm.get_scale()){
+            case 1: scale_bits = 0; break;
+            case 2: scale_bits = 1; break;
+            case 4: scale_bits = 2; break;
+            case 8: scale_bits = 3; break;
+            default: RuntimeError::raise("invalid scale %d", rm.get_scale());
+          }
+        }
+        m_enc.bytes.push_back(uint8_t(mod | reg_bits | 4));
+        m_enc.bytes.push_back(uint8_t((scale_bits << 6) | (((index >= 0) ? index : 4) & 7) << 3 | (base & 7)));
+      } else{
+        m_enc.bytes.push_back(uint8_t(mod | reg_bits | (base & 7)));
+      }
+      if(label_base){
+        m_enc.fixups.push_back({ unsigned(m_enc.bytes.size()), rm.get_label(), X86_RELOC_32S, 0 });
+        append_le(m_enc.bytes, 0, 4);
+      } else if(mod == 0x40){
+        append_le(m_enc.bytes, uint64_t(disp), 1);
+      } else if(mod == 0x80){
+        append_le(m_enc.bytes, uint64_t(disp), 4);
+      }
+    }
+
+    // An instruction with the register encoded in the low bits of the opcode
+    void opcode_reg(bool prefix66, bool rex_w, uint8_t opcode, int reg, bool reg_is_byte){
+      int rex = rex_w ? 0x48 : 0;
+      if(reg >= 8){
+        rex |= 0x41;
+      }
+      if(reg_is_byte && reg >= 4 && reg < 8){
+        rex |= 0x40;
+      }
+      if(prefix66){
+        m_enc.bytes.push_back(0x66);
+      }
+      if(rex != 0){
+        m_enc.bytes.push_back(uint8_t(rex));
+      }
+      m_enc.bytes.push_back(uint8_t(opcode + (reg & 7)));
+    }
+
+    void bytes(std::initializer_list<uint8_t> bytes){
+      m_enc.bytes.insert(m_enc.bytes.end(), bytes.begin(), bytes.end());
+    }
+
+    // An immediate operand; a label becomes a relocation
+    void immediate(const Operand& op, unsigned size, X86RelocType reloc_type){
+      if(op.is_imm_label()){
+        assert(size == 4);
+        m_enc.fixups.push_back({ unsigned(m_enc.bytes.size()), op.get_label(), reloc_type, 0 });
+        append_le(m_enc.bytes, 0, 4);
+      } else{
+        append_le(m_enc.bytes, uint64_t(op.get_imm_ival()), size);
+      }
+    }
+  };
+
+  int get_condition(int opcode){
+    switch(opcode){
+      case MINS_JE: case MINS_SETE: case MINS_CMOVE: return CC_E;
+      case MINS_JNE: case MINS_SETNE: case MINS_CMOVNE: return CC_NE;
+      case MINS_JL: case MINS_SETL: case MINS_CMOVL: return CC_L;
+      case MINS_JLE: case MINS_SETLE: case MINS_CMOVLE: return CC_LE;
+      case MINS_JG: case MINS_SETG: case MINS_CMOVG: return CC_G;
+      case MINS_JGE: case MINS_SETGE: case MINS_CMOVGE: return CC_GE;
+      case MINS_JB: return CC_B;
+      case MINS_JBE: return CC_BE;
+      case MINS_JA: return CC_A;
+      case MINS_JAE: return CC_AE;
+      default: return -1;
+    }
+  }
+
+  void encode_mov(InstructionBuilder& b, unsigned size, const Operand& src, const Operand& dst){
+    bool w16 = size == 2, w64 = size == 8, byte = size == 1;
+    if(is_imm(src)){
+      if(is_reg(dst)){
+        int reg = hw_reg(dst.get_base_reg());
+        if(w64 && (src.is_imm_label() || fits_int32(src.get_imm_ival()))){
+          b.modrm(false, true, { 0xc7 }, 0, false, dst, false);
+          b.immediate(src, 4, X86_RELOC_32S);
+        } else if(w64){
+          // movabs
+          b.opcode_reg(false, true, 0xb8, reg, false);
+          b.immediate(src, 8, X86_RELOC_32S);
+        } else{
+          b.opcode_reg(w16, false, byte ? 0xb0 : 0xb8, reg, byte);
+          b.immediate(src, size, X86_RELOC_32);
+        }
+      } else{
+        if(w64 && src.is_imm_ival() && !fits_int32(src.get_imm_ival())){
+          RuntimeError::raise("immediate %ld out of range", long(src.get_imm_ival()));
+        }
+        b.modrm(w16, w64, { uint8_t(byte ? 0xc6 : 0xc7) }, 0, false, dst, false);
+        b.immediate(src, w64 ? 4 : size, w64 ? X86_RELOC_32S : X86_RELOC_32);
+      }
+    } else if(is_reg(src)){
+      b.modrm(w16, w64, { uint8_t(byte ? 0x88 : 0x89) }, hw_reg(src.get_base_reg()), byte, dst, byte);
+    } else{
+      if(!is_reg(dst)){
+        RuntimeError::raise("mov between two memory operands");
+      }
+      b.modrm(w16, w64, { uint8_t(byte ? 0x8a : 0x8b) }, hw_reg(dst.get_base_reg()), byte, src, byte);
+    }
+  }
+
+  // add, sub, and, or, xor and cmp; op is the base opcode (0x00, 0x28,
+  // 0x20, 0x08, 0x30, 0x38), ext the opcode extension of the immediate forms
+  void encode_alu(InstructionBuilder& b, unsigned size, uint8_t op, int ext, const Operand& src, const Operand& dst){
+    bool w16 = size == 2, w64 = size == 8, byte = size == 1;
+    bool dst_is_acc = is_reg(dst) && hw_reg(dst.get_base_reg()) == 0;
+    if(src.is_imm_ival()){
+      int64_t imm = src.get_imm_ival();
+      if(byte){
+        if(dst_is_acc){
+          b.bytes({ uint8_t(op + 4) });
+        } else{
+          b.modrm(false, false, { 0x80 }, ext, false, dst, true);
+        }
+        b.immediate(src, 1, X86_RELOC_32);
+      } else if(fits_int8(imm)){
+        b.modrm(w16, w64, { 0x83 }, ext, false, dst, false);
+        b.immediate(src, 1, X86_RELOC_32);
+      } else if(dst_is_acc){
+        b.opcode_reg(w16, w64, uint8_t(op + 5), 0, false);
+        b.immediate(src, w16 ? 2 : 4, X86_RELOC_32);
+      } else{
+        b.modrm(w16, w64, { 0x81 }, ext, false, dst, false);
+        b.immediate(src, w16 ? 2 : 4, X86_RELOC_32);
+      }
+    } else if(is_reg(src)){
+      b.modrm(w16, w64, { uint8_t(op + (byte ? 0 : 1)) }, hw_reg(src.get_base_reg()), byte, dst, byte);
+    } else if(is_mem(src) && is_reg(dst)){
+      b.modrm(w16, w64, { uint8_t(op + (byte ? 2 : 3)) }, hw_reg(dst.get_base_reg()), byte, src, byte);
+    } else{
+      RuntimeError::raise("invalid operands for arithmetic instruction");
+    }
+  }
+
+  // shl and sar (ext 4 and 7); the count is an immediate or %cl
+  void encode_shift(InstructionBuilder& b, unsigned size, int ext, const Operand& src, const Operand& dst){
+    bool w16 = size == 2, w64 = size == 8, byte = size == 1;
+    if(src.is_imm_ival()){
+      if(src.get_imm_ival() == 1){
+        b.modrm(w16, w64, { uint8_t(byte ? 0xd0 : 0xd1) }, ext, false, dst, byte);
+      } else{
+        b.modrm(w16, w64, { uint8_t(byte ? 0xc0 : 0xc1) }, ext, false, dst, byte);
+        b.immediate(src, 1, X86_RELOC_32);
+      }
+    } else if(src.get_kind() == Operand::MREG8 && src.get_base_reg() == MREG_RCX){
+      b.modrm(w16, w64, { uint8_t(byte ? 0xd2 : 0xd3) }, ext, false, dst, byte);
+    } else{
+      RuntimeError::raise("shift count must be an immediate or %%cl");
+    }
+  }
+
+  // movs/movz from a smaller source: the reg field is the destination
+  void encode_extend(InstructionBuilder& b, bool prefix66, bool rex_w, std::initializer_list<uint8_t> opcode,
+                     bool src_is_byte, const Operand& src, const Operand& dst){
+    if(!is_reg(dst)){
+      RuntimeError::raise("destination of a sign or zero extension must be a register");
+    }
+    b.modrm(prefix66, rex_w, opcode, hw_reg(dst.get_base_reg()), false, src, src_is_byte);
+  }
+
+  // movd and movq between an xmm register and a general register or
+  // memory (the reg field is the xmm register); a movq load or store
+  // has its own opcodes
+  void encode_movd(InstructionBuilder& b, bool rex_w, const Operand& src, const Operand& dst){
+    if(is_xmm(dst) && rex_w && !is_reg(src)){
+      b.bytes({ 0xf3 });
+      b.modrm(false, false, { 0x0f, 0x7e }, hw_reg(dst.get_base_reg()), false, src, false);
+    } else if(is_xmm(src) && rex_w && !is_reg(dst)){
+      b.modrm(true, false, { 0x0f, 0xd6 }, hw_reg(src.get_base_reg()), false, dst, false);
+    } else if(is_xmm(dst) && !is_xmm(src)){
+      b.modrm(true, rex_w, { 0x0f, 0x6e }, hw_reg(dst.get_base_reg()), false, src, false);
+    } else if(is_xmm(src) && !is_xmm(dst)){
+      b.modrm(true, rex_w, { 0x0f, 0x7e }, hw_reg(src.get_base_reg()), false, dst, false);
+    } else{
+      RuntimeError::raise("invalid operands for movd or movq");
+    }
+  }
+
+  // SSE2 instructions with a 66 prefix and an xmm register destination
+  // (in the reg field)
+  void encode_packed(InstructionBuilder& b, uint8_t op, const Operand& src, const Operand& dst){
+    if(!is_xmm(dst) || (!is_xmm(src) && !is_mem(src))){
+      RuntimeError::raise("invalid operands for packed instruction");
+    }
+    b.modrm(true, false, { 0x0f, op }, hw_reg(dst.get_base_reg()), false, src, false);
+  }
+
+}
+
+X86Encoder::X86Encoder(){
+}
+
+X86Encoder::~X86Encoder(){
+}
+
+void X86Encoder::encode(const Instruction* ins, X86Encoding& enc){
+  enc.bytes.clear();
+  enc.fixups.clear();
+  enc.is_branch = false;
+  enc.condition = -1;
+  enc.target.clear();
+
+  InstructionBuilder b(enc);
+  int opcode = ins->get_opcode();
+  Operand src = (ins->get_num_operands() > 0) ? ins->get_operand(0) : Operand();
+  Operand dst = (ins->get_num_operands() > 1) ? ins->get_operand(1) : Operand();
+
+  switch(opcode){
+    case MINS_NOP:
+      b.bytes({ 0x90 });
+      break;
+    case MINS_MOVB: case MINS_MOVW: case MINS_MOVL: case MINS_MOVQ:
+      if(is_xmm(src) || is_xmm(dst)){
+        encode_movd(b, true, src, dst);
+      } else{
+        encode_mov(b, 1U << (opcode - MINS_MOVB), src, dst);
+      }
+      break;
+    case MINS_ADDB: case MINS_ADDW: case MINS_ADDL: case MINS_ADDQ:
+      encode_alu(b, 1U << (opcode - MINS_ADDB), 0x00, 0, src, dst);
+      break;
+    case MINS_SUBB: case MINS_SUBW: case MINS_SUBL: case MINS_SUBQ:
+      encode_alu(b, 1U << (opcode - MINS_SUBB), 0x28, 5, src, dst);
+      break;
+    case MINS_ANDB: case MINS_ANDW: case MINS_ANDL: case MINS_ANDQ:
+      encode_alu(b, 1U << (opcode - MINS_ANDB), 0x20, 4, src, dst);
+      break;
+    case MINS_ORB: case MINS_ORW: case MINS_ORL: case MINS_ORQ:
+      encode_alu(b, 1U << (opcode - MINS_ORB), 0x08, 1, src, dst);
+      break;
+    case MINS_XORB: case MINS_XORW: case MINS_XORL: case MINS_XORQ:
+      encode_alu(b, 1U << (opcode - MINS_XORB), 0x30, 6, src, dst);
+      break;
+    case MINS_SHLB: case MINS_SHLW: case MINS_SHLL: case MINS_SHLQ:
+      encode_shift(b, 1U << (opcode - MINS_SHLB), 4, src, dst);
+      break;
+    case MINS_SARB: case MINS_SARW: case MINS_SARL: case MINS_SARQ:
+      encode_shift(b, 1U << (opcode - MINS_SARB), 7, src, dst);
+      break;
+    case MINS_SHRB: case MINS_SHRW: case MINS_SHRL: case MINS_SHRQ:
+      encode_shift(b, 1U << (opcode - MINS_SHRB), 5, src, dst);
+      break;
+    case MINS_NOTB: case MINS_NOTW: case MINS_NOTL: case MINS_NOTQ:{
+      unsigned size = 1U << (opcode - MINS_NOTB);
+      b.modrm(size == 2, size == 8, { uint8_t((size == 1) ? 0xf6 : 0xf7) }, 2, false, src, size == 1);
+      break;
+    }
+    case MINS_CMPB: case MINS_CMPW: case MINS_CMPL: case MINS_CMPQ:
+      encode_alu(b, 1U << (opcode - MINS_CMPB), 0x38, 7, src, dst);
+      break;
+    case MINS_LEAQ:
+      if(!is_mem(src) || !is_reg(dst)){
+        RuntimeError::raise("invalid operands for leaq");
+      }
+      b.modrm(false, true, { 0x8d }, hw_reg(dst.get_base_reg()), false, src, false);
+      break;
+    case MINS_JMP: case MINS_JE: case MINS_JNE: case MINS_JL: case MINS_JLE:
+    case MINS_JG: case MINS_JGE: case MINS_JB: case MINS_JBE: case MINS_JA: case MINS_JAE:{
+      if(!src.is_label()){
+        RuntimeError::raise("jump target must be a label");
+      }
+      enc.is_branch = true;
+      enc.condition = get_condition(opcode);
+      enc.target = src.get_label();
+      break;
+    }
+    case MINS_JMPQ:
+      if(src.get_kind() != Operand::LABEL_MEM_IDX){
+        RuntimeError::raise("indirect jump must be through a jump table");
+      }
+      b.modrm(false, false, { 0xff }, 4, false, src, false);
+      break;
+    case MINS_CALL:
+      if(!src.is_label()){
+        RuntimeError::raise("call target must be a label");
+      }
+      b.bytes({ 0xe8, 0, 0, 0, 0 });
+      enc.fixups.push_back({ 1, src.get_label(), X86_RELOC_PLT32, -4 });
+      break;
+    case MINS_IMULL: case MINS_IMULQ:{
+      bool w64 = opcode == MINS_IMULQ;
+      if(!is_reg(dst)){
+        RuntimeError::raise("destination of imul must be a register");
+      }
+      int reg = hw_reg(dst.get_base_reg());
+      if(src.is_imm_ival()){
+        bool imm8 = fits_int8(src.get_imm_ival());
+        b.modrm(false, w64, { uint8_t(imm8 ? 0x6b : 0x69) }, reg, false, dst, false);
+        b.immediate(src, imm8 ? 1 : 4, X86_RELOC_32);
+      } else{
+        b.modrm(false, w64, { 0x0f, 0xaf }, reg, false, src, false);
+      }
+      break;
+    }
+    case MINS_IDIVL: case MINS_IDIVQ:
+      b.modrm(false, opcode == MINS_IDIVQ, { 0xf7 }, 7, false, src, false);
+      break;
+    case MINS_CDQ:
+      b.bytes({ 0x99 });
+      break;
+    case MINS_CQTO:
+      b.bytes({ 0x48, 0x99 });
+      break;
+    case MINS_PUSHQ: case MINS_POPQ:
+      if(src.get_kind() != Operand::MREG64){
+        RuntimeError::raise("push and pop operands must be 64 bit registers");
+      }
+      b.opcode_reg(false, false, (opcode == MINS_PUSHQ) ? 0x50 : 0x58, hw_reg(src.get_base_reg()), false);
+      break;
+    case MINS_RET:
+      b.bytes({ 0xc3 });
+      break;
+    case MINS_MOVSBW: encode_extend(b, true, false, { 0x0f, 0xbe }, true, src, dst); break;
+    case MINS_MOVSBL: encode_extend(b, false, false, { 0x0f, 0xbe }, true, src, dst); break;
+    case MINS_MOVSBQ: encode_extend(b, false, true, { 0x0f, 0xbe }, true, src, dst); break;
+    case MINS_MOVSWL: encode_extend(b, false, false, { 0x0f, 0xbf }, false, src, dst); break;
+    case MINS_MOVSWQ: encode_extend(b, false, true, { 0x0f, 0xbf }, false, src, dst); break;
+    case MINS_MOVSLQ: encode_extend(b, false, true, { 0x63 }, false, src, dst); break;
+    case MINS_MOVZBW: encode_extend(b, true, false, { 0x0f, 0xb6 }, true, src, dst); break;
+    case MINS_MOVZBL: encode_extend(b, false, false, { 0x0f, 0xb6 }, true, src, dst); break;
+    case MINS_MOVZBQ: encode_extend(b, false, true, { 0x0f, 0xb6 }, true, src, dst); break;
+    case MINS_MOVZWL: encode_extend(b, false, false, { 0x0f, 0xb7 }, false, src, dst); break;
+    case MINS_MOVZWQ: encode_extend(b, false, true, { 0x0f, 0xb7 }, false, src, dst); break;
+    case MINS_MOVZLQ:
+      // there is no movzlq: writing a 32 bit register clears the upper half
+      if(!is_reg(dst)){
+        RuntimeError::raise("destination of movzlq must be a register");
+      }
+      if(is_reg(src)){
+        b.modrm(false, false, { 0x89 }, hw_reg(src.get_base_reg()), false, dst, false);
+      } else{
+        b.modrm(false, false, { 0x8b }, hw_reg(dst.get_base_reg()), false, src, false);
+      }
+      break;
+    case MINS_SETL: case MINS_SETLE: case MINS_SETG: case MINS_SETGE: case MINS_SETE: case MINS_SETNE:
+      b.modrm(false, false, { 0x0f, uint8_t(0x90 + get_condition(opcode)) }, 0, false, src, true);
+      break;
+    case MINS_CMOVL: case MINS_CMOVLE: case MINS_CMOVG: case MINS_CMOVGE: case MINS_CMOVE: case MINS_CMOVNE:
+      // there are only 16, 32 and 64 bit forms, and the destination
+      // has to be a register
+      if(!is_reg(dst) || dst.get_kind() == Operand::MREG8){
+        RuntimeError::raise("destination of cmov must be a 16, 32 or 64 bit register");
+      }
+      b.modrm(dst.get_kind() == Operand::MREG16, dst.get_kind() == Operand::MREG64,
+              { 0x0f, uint8_t(0x40 + get_condition(opcode)) }, hw_reg(dst.get_base_reg()), false, src, false);
+      break;
+    case MINS_MOVD:
+      encode_movd(b, false, src, dst);
+      break;
+    case MINS_MOVDQU:
+      // the F3 prefix goes before any REX prefix
+      b.bytes({ 0xf3 });
+      if(is_xmm(dst)){
+        b.modrm(false, false, { 0x0f, 0x6f }, hw_reg(dst.get_base_reg()), false, src, false);
+      } else if(is_xmm(src)){
+        b.modrm(false, false, { 0x0f, 0x7f }, hw_reg(src.get_base_reg()), false, dst, false);
+      } else{
+        RuntimeError::raise("movdqu needs an xmm register operand");
+      }
+      break;
+    case MINS_PADDD: encode_packed(b, 0xfe, src, dst); break;
+    case MINS_PADDQ: encode_packed(b, 0xd4, src, dst); break;
+    case MINS_PSUBD: encode_packed(b, 0xfa, src, dst); break;
+    case MINS_PSUBQ: encode_packed(b, 0xfb, src, dst); break;
+    case MINS_PAND: encode_packed(b, 0xdb, src, dst); break;
+    case MINS_POR: encode_packed(b, 0xeb, src, dst); break;
+    case MINS_PXOR: encode_packed(b, 0xef, src, dst); break;
+    case MINS_PUNPCKLQDQ: encode_packed(b, 0x6c, src, dst); break;
+    case MINS_PSHUFD:
+      // pshufd $imm, src, dst
+      if(!src.is_imm_ival() || ins->get_num_operands() != 3){
+        RuntimeError::raise("invalid operands for pshufd");
+      }
+      encode_packed(b, 0x70, dst, ins->get_operand(2));
+      b.immediate(src, 1, X86_RELOC_32);
+      break;
+    default:
+      RuntimeError::raise("Unknown low level opcode: %d", opcode);
+  }
+}
+
+void X86Encoder::encode_branch(int condition, bool is_short, int32_t displacement, std::vector<uint8_t>& bytes){
+  if(is_short){
+    bytes.push_back((condition < 0) ? 0xeb : uint8_t(0x70 + condition));
+    append_le(bytes, uint32_t(displacement), 1);
+    return;
+  }
+  if(condition < 0){
+    bytes.push_back(0xe9);
+  } else{
+    bytes.push_back(0x0f);
+    bytes.push_back(uint8_t(0x80 + condition));
+  }
+  append_le(bytes, uint32_t(displacement), 4);
+}
+
+unsigned X86Encoder::get_branch_size(int condition, bool is_short){
+  if(is_short){
+    return 2;
+  }
+  return (condition < 0) ? 5 : 6;
+}
@@ -0,0 +1,57 @@
+#ifndef X86_ENCODER_H
+#define X86_ENCODER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "instruction.h"
+#include "operand.h"
+
+// Relocation types used in ELF64 x86-64 object files
+enum X86RelocType{
+  X86_RELOC_64 = 1,
+  X86_RELOC_32 = 10,
+  X86_RELOC_32S = 11,
+  X86_RELOC_PLT32 = 4,
+};
+
+// A reference from an encoded instruction to a symbol whose address
+// isn't known until link time
+struct X86Fixup{
+  unsigned offset;        // offset of the 32 bit field in the instruction bytes
+  std::string symbol;
+  X86RelocType type;
+  int64_t addend;
+};
+
+// The machine code for one low-level instruction. Jumps are left for
+// the caller to lay out: their size depends on the distance to the
+// target, which is known only once the sizes of the instructions in
+// between are.
+struct X86Encoding{
+  std::vector<uint8_t> bytes;
+  std::vector<X86Fixup> fixups;
+
+  bool is_branch;
+  int condition;          // condition code of a jcc, or -1 for jmp
+  std::string target;
+};
+
+// X86Encoder translates low-level instructions (LowLevelOpcode with
+// machine register, memory and immediate operands) into x86-64 machine
+// code. Where the instruction set has several encodings it picks the
+// one GNU as uses, so that the code is identical to what assembling
+// the printed output would produce.
+class X86Encoder{
+public:
+  X86Encoder();
+  ~X86Encoder();
+
+  void encode(const Instruction* ins, X86Encoding& enc);
+
+  // the bytes of a jump (short is 2 bytes, near is 5 or 6)
+  static void encode_branch(int condition, bool is_short, int32_t displacement, std::vector<uint8_t>& bytes);
+  static unsigned get_branch_size(int condition, bool is_short);
+};
+
+#endif // X86_ENCODER_H